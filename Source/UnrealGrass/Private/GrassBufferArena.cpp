@@ -0,0 +1,202 @@
+// GrassBufferArena.cpp
+// 共享 GPU Buffer 池实现
+
+#include "GrassBufferArena.h"
+#include "GrassInstancePacking.h"
+#include "GrassStats.h"
+#include "RHICommandList.h"
+#include "RenderingThread.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarGrassBufferArena(
+    TEXT("r.Grass.BufferArena"),
+    1,
+    TEXT("Sub-allocate grass instance and visible buffers from shared pages (0 = every allocation gets its own buffer). Takes effect on the next generation."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassBufferArenaPageSizeMB(
+    TEXT("r.Grass.BufferArena.PageSizeMB"),
+    32,
+    TEXT("Size of a shared grass buffer page in MB. Allocations larger than a page get a dedicated page."),
+    ECVF_RenderThreadSafe
+);
+
+static TGlobalResource<FGrassBufferArena> GGrassBufferArena;
+
+FGrassBufferArena& FGrassBufferArena::Get()
+{
+    return GGrassBufferArena;
+}
+
+uint32 FGrassBufferArena::GetStride(EGrassBufferPool Pool)
+{
+    return Pool == EGrassBufferPool::VisibleIndices ? sizeof(uint32) : FGrassInstancePacking::PackedStride;
+}
+
+// ============================================================================
+// 分配
+// ============================================================================
+FGrassBufferArena::FPage& FGrassBufferArena::CreatePage(FRHICommandListBase& RHICmdList, EGrassBufferPool Pool, uint32 NumElements, bool bDedicated)
+{
+    static const TCHAR* PageNames[] = {
+        TEXT("GrassArenaInstances"),
+        TEXT("GrassArenaVisibleIndices"),
+        TEXT("GrassArenaVisibleInstances"),
+    };
+    static_assert(UE_ARRAY_COUNT(PageNames) == (int32)EGrassBufferPool::Num, "PageNames must match EGrassBufferPool");
+
+    const uint32 Stride = GetStride(Pool);
+
+    FPage& Page = Pools[(int32)Pool].AddDefaulted_GetRef();
+    Page.Id = NextPageId++;
+    Page.bDedicated = bDedicated;
+    Page.Allocator.Reset(NumElements);
+
+    FRHIBufferCreateDesc Desc = FRHIBufferCreateDesc::CreateStructured(PageNames[(int32)Pool], NumElements * Stride, Stride)
+        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
+        .SetInitialState(ERHIAccess::SRVMask);
+    if (Pool == EGrassBufferPool::Instances)
+    {
+        LLM_SCOPE_BYTAG(Grass_Instances);
+        Page.Buffer = RHICmdList.CreateBuffer(Desc);
+    }
+    else
+    {
+        LLM_SCOPE_BYTAG(Grass_VisibleBuffers);
+        Page.Buffer = RHICmdList.CreateBuffer(Desc);
+    }
+    INC_MEMORY_STAT_BY(STAT_GrassBufferArenaMemory, (uint64)NumElements * Stride);
+
+    Page.SRV = RHICmdList.CreateShaderResourceView(Page.Buffer,
+        FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumElements));
+    Page.UAV = RHICmdList.CreateUnorderedAccessView(Page.Buffer,
+        FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumElements));
+
+    UE_LOG(LogTemp, Log, TEXT("GrassBufferArena: created %s page %d (%u elements, %.2f MB%s)"),
+        PageNames[(int32)Pool], Page.Id, NumElements, NumElements * Stride / (1024.0 * 1024.0), bDedicated ? TEXT(", dedicated") : TEXT(""));
+    return Page;
+}
+
+FGrassBufferAllocationRef FGrassBufferArena::Allocate(FRHICommandListBase& RHICmdList, EGrassBufferPool Pool, uint32 Count, bool bDedicated)
+{
+    check(IsInRenderingThread());
+    check(Count > 0);
+
+    const uint32 Stride = GetStride(Pool);
+    const uint32 PageElements = (uint32)FMath::Max(CVarGrassBufferArenaPageSizeMB.GetValueOnRenderThread(), 1) * 1024u * 1024u / Stride;
+    bDedicated |= CVarGrassBufferArena.GetValueOnRenderThread() == 0 || Count > PageElements;
+
+    TArray<FPage>& Pages = Pools[(int32)Pool];
+    FPage* Page = nullptr;
+    uint32 Offset = FGrassRangeAllocator::InvalidOffset;
+    if (!bDedicated)
+    {
+        for (FPage& Candidate : Pages)
+        {
+            if (!Candidate.bDedicated)
+            {
+                Offset = Candidate.Allocator.Allocate(Count);
+                if (Offset != FGrassRangeAllocator::InvalidOffset)
+                {
+                    Page = &Candidate;
+                    break;
+                }
+            }
+        }
+    }
+    if (!Page)
+    {
+        Page = &CreatePage(RHICmdList, Pool, bDedicated ? Count : PageElements, bDedicated);
+        Offset = Page->Allocator.Allocate(Count);
+        check(Offset != FGrassRangeAllocator::InvalidOffset);
+    }
+
+    FGrassBufferAllocationRef Allocation = MakeShared<FGrassBufferAllocation, ESPMode::ThreadSafe>();
+    Allocation->Buffer = Page->Buffer;
+    Allocation->SRV = Page->SRV;
+    Allocation->UAV = Page->UAV;
+    Allocation->Offset = Offset;
+    Allocation->Count = Count;
+    Allocation->Pool = Pool;
+    Allocation->PageId = Page->Id;
+    return Allocation;
+}
+
+// ============================================================================
+// 释放
+// ============================================================================
+FGrassBufferAllocation::~FGrassBufferAllocation()
+{
+    if (PageId == INDEX_NONE)
+    {
+        return;
+    }
+
+    // 之前提交的渲染命令已经在渲染线程排队，区间在它们之后才归还，新的写入不会覆盖还在使用的数据
+    if (IsInRenderingThread())
+    {
+        FGrassBufferArena::Get().Free_RenderThread(Pool, PageId, Offset);
+    }
+    else
+    {
+        ENQUEUE_RENDER_COMMAND(FreeGrassBufferAllocation)(
+            [Pool = Pool, PageId = PageId, Offset = Offset](FRHICommandListImmediate&)
+            {
+                FGrassBufferArena::Get().Free_RenderThread(Pool, PageId, Offset);
+            });
+    }
+}
+
+void FGrassBufferArena::Free_RenderThread(EGrassBufferPool Pool, int32 PageId, uint32 Offset)
+{
+    TArray<FPage>& Pages = Pools[(int32)Pool];
+    const int32 PageIndex = Pages.IndexOfByPredicate([PageId](const FPage& Page) { return Page.Id == PageId; });
+    if (PageIndex == INDEX_NONE)
+    {
+        // ReleaseRHI 已经销毁了所有页 (引擎退出)
+        return;
+    }
+
+    FPage& Page = Pages[PageIndex];
+    Page.Allocator.Free(Offset);
+
+    // 专用页整页销毁；共享页全部空闲时也销毁，但每个池保留一个空的共享页，避免组件反复重新生成时来回创建
+    if (Page.Allocator.IsEmpty())
+    {
+        const bool bKeep = !Page.bDedicated && !Pages.ContainsByPredicate([&Page](const FPage& Other)
+        {
+            return &Other != &Page && !Other.bDedicated;
+        });
+        if (!bKeep)
+        {
+            UE_LOG(LogTemp, Log, TEXT("GrassBufferArena: released page %d"), Page.Id);
+            DEC_MEMORY_STAT_BY(STAT_GrassBufferArenaMemory, (uint64)Page.Allocator.GetCapacity() * GetStride(Pool));
+            Pages.RemoveAtSwap(PageIndex);
+        }
+    }
+}
+
+void FGrassBufferArena::ReleaseRHI()
+{
+    for (TArray<FPage>& Pages : Pools)
+    {
+        Pages.Empty();
+    }
+    SET_MEMORY_STAT(STAT_GrassBufferArenaMemory, 0);
+}
+
+FGrassBufferArena::FStats FGrassBufferArena::GetStats(EGrassBufferPool Pool) const
+{
+    const uint32 Stride = GetStride(Pool);
+    FStats Stats;
+    for (const FPage& Page : Pools[(int32)Pool])
+    {
+        ++Stats.NumPages;
+        Stats.NumAllocations += Page.Allocator.GetNumAllocations();
+        Stats.CapacityBytes += (uint64)Page.Allocator.GetCapacity() * Stride;
+        Stats.UsedBytes += (uint64)Page.Allocator.GetUsedSize() * Stride;
+        Stats.LargestFreeBytes = FMath::Max(Stats.LargestFreeBytes, Page.bDedicated ? (uint64)0 : (uint64)Page.Allocator.GetLargestFreeRange() * Stride);
+    }
+    return Stats;
+}
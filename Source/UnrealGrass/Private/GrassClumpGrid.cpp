@@ -0,0 +1,245 @@
+// GrassClumpGrid.cpp
+// Clump 空间哈希网格 CPU 参考实现
+
+#include "GrassClumpGrid.h"
+
+// 网格每边最多 256 个单元格 (65536 个单元格)
+static constexpr int32 MaxClumpGridDim = 256;
+
+int32 FGrassClumpGrid::ComputeGridDim(int32 NumClumps)
+{
+    const int32 Dim = FMath::CeilToInt(FMath::Sqrt((float)FMath::Max(NumClumps, 1)));
+    return FMath::Clamp(Dim, 1, MaxClumpGridDim);
+}
+
+FIntPoint FGrassClumpGrid::GetCell(const FVector2f& UV, int32 GridDim)
+{
+    const int32 CellX = FMath::FloorToInt(UV.X * (float)GridDim);
+    const int32 CellY = FMath::FloorToInt(UV.Y * (float)GridDim);
+    return FIntPoint(FMath::Clamp(CellX, 0, GridDim - 1), FMath::Clamp(CellY, 0, GridDim - 1));
+}
+
+void FGrassClumpGrid::Build(TConstArrayView<FVector2f> ClumpCentresUV)
+{
+    const int32 NumClumps = ClumpCentresUV.Num();
+    GridDim = ComputeGridDim(NumClumps);
+    const int32 NumCells = GridDim * GridDim;
+
+    // 计数
+    TArray<uint32> CellCounts;
+    CellCounts.SetNumZeroed(NumCells);
+    TArray<int32> ClumpCells;
+    ClumpCells.SetNumUninitialized(NumClumps);
+    for (int32 ClumpIndex = 0; ClumpIndex < NumClumps; ++ClumpIndex)
+    {
+        const FIntPoint Cell = GetCell(ClumpCentresUV[ClumpIndex], GridDim);
+        ClumpCells[ClumpIndex] = Cell.Y * GridDim + Cell.X;
+        CellCounts[ClumpCells[ClumpIndex]]++;
+    }
+
+    // Exclusive 前缀和
+    CellStart.SetNumUninitialized(NumCells + 1);
+    uint32 Running = 0;
+    for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+    {
+        CellStart[CellIndex] = Running;
+        Running += CellCounts[CellIndex];
+    }
+    CellStart[NumCells] = Running;
+
+    // 分散写入 (按 Clump 索引升序，结果确定)
+    CellClumps.SetNumUninitialized(NumClumps);
+    FMemory::Memzero(CellCounts.GetData(), CellCounts.Num() * sizeof(uint32));
+    for (int32 ClumpIndex = 0; ClumpIndex < NumClumps; ++ClumpIndex)
+    {
+        const int32 CellIndex = ClumpCells[ClumpIndex];
+        CellClumps[CellStart[CellIndex] + CellCounts[CellIndex]++] = (uint32)ClumpIndex;
+    }
+}
+
+static FORCEINLINE FVector2f ClumpCentreToLocal(const FVector2f& CentreUV, float HalfSizeX, float HalfSizeY)
+{
+    return FVector2f(
+        CentreUV.X * HalfSizeX * 2.0f - HalfSizeX,
+        CentreUV.Y * HalfSizeY * 2.0f - HalfSizeY);
+}
+
+static FORCEINLINE float ClumpDistance(const FVector2f& A, const FVector2f& B)
+{
+    const float DX = A.X - B.X;
+    const float DY = A.Y - B.Y;
+    return FMath::Sqrt(DX * DX + DY * DY);
+}
+
+int32 FGrassClumpGrid::FindNearest(TConstArrayView<FVector2f> ClumpCentresUV, const FVector2f& PositionLocal,
+    float HalfSizeX, float HalfSizeY, FVector2f* OutCentreLocal) const
+{
+    const FVector2f UV(
+        (PositionLocal.X + HalfSizeX) / (HalfSizeX * 2.0f),
+        (PositionLocal.Y + HalfSizeY) / (HalfSizeY * 2.0f));
+    const FIntPoint HomeCell = GetCell(UV, GridDim);
+    const float CellSize = FMath::Min(HalfSizeX, HalfSizeY) * 2.0f / (float)GridDim;
+
+    float MinDist = 1e10f;
+    int32 NearestIndex = -1;
+    FVector2f NearestCentreLocal(0.0f, 0.0f);
+
+    for (int32 Ring = 0; Ring < GridDim; ++Ring)
+    {
+        if (NearestIndex >= 0 && MinDist < (float)(Ring - 1) * CellSize)
+        {
+            break;
+        }
+
+        for (int32 DY = -Ring; DY <= Ring; ++DY)
+        {
+            const int32 CellY = HomeCell.Y + DY;
+            if (CellY < 0 || CellY >= GridDim)
+            {
+                continue;
+            }
+
+            // 环的上下两行遍历整行，中间行只取左右两端
+            const int32 StepX = (FMath::Abs(DY) == Ring) ? 1 : FMath::Max(Ring * 2, 1);
+            for (int32 DX = -Ring; DX <= Ring; DX += StepX)
+            {
+                const int32 CellX = HomeCell.X + DX;
+                if (CellX < 0 || CellX >= GridDim)
+                {
+                    continue;
+                }
+
+                const int32 CellIndex = CellY * GridDim + CellX;
+                for (uint32 K = CellStart[CellIndex]; K < CellStart[CellIndex + 1]; ++K)
+                {
+                    const int32 J = (int32)CellClumps[K];
+                    const FVector2f CentreLocal = ClumpCentreToLocal(ClumpCentresUV[J], HalfSizeX, HalfSizeY);
+                    const float D = ClumpDistance(PositionLocal, CentreLocal);
+
+                    if (D < MinDist || (D == MinDist && J < NearestIndex))
+                    {
+                        MinDist = D;
+                        NearestIndex = J;
+                        NearestCentreLocal = CentreLocal;
+                    }
+                }
+            }
+        }
+    }
+
+    if (OutCentreLocal)
+    {
+        *OutCentreLocal = NearestCentreLocal;
+    }
+    return FMath::Max(NearestIndex, 0);
+}
+
+int32 FGrassClumpGrid::FindNearestBruteForce(TConstArrayView<FVector2f> ClumpCentresUV, const FVector2f& PositionLocal,
+    float HalfSizeX, float HalfSizeY, FVector2f* OutCentreLocal)
+{
+    float MinDist = 1e10f;
+    int32 NearestIndex = 0;
+    FVector2f NearestCentreLocal(0.0f, 0.0f);
+
+    for (int32 J = 0; J < ClumpCentresUV.Num(); ++J)
+    {
+        const FVector2f CentreLocal = ClumpCentreToLocal(ClumpCentresUV[J], HalfSizeX, HalfSizeY);
+        const float D = ClumpDistance(PositionLocal, CentreLocal);
+
+        if (D < MinDist)
+        {
+            MinDist = D;
+            NearestIndex = J;
+            NearestCentreLocal = CentreLocal;
+        }
+    }
+
+    if (OutCentreLocal)
+    {
+        *OutCentreLocal = NearestCentreLocal;
+    }
+    return NearestIndex;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 网格查询与暴力查找的对照：随机 Clump (包括 [0,1] 之外的) 和采样点 (包括单元格边界上的点)，索引和中心必须完全一致
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassClumpGridFindNearestTest, "UnrealGrass.ClumpGrid.FindNearest",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassClumpGridFindNearestTest::RunTest(const FString& Parameters)
+{
+    FRandomStream Random(0x6C756D70);
+
+    const int32 ClumpCounts[] = { 1, 2, 7, 64, 300, 1000 };
+    // 正方形和长方形的网格范围 (单元格在本地坐标下不是正方形)
+    const FVector2f HalfSizes[] = { FVector2f(500.0f, 500.0f), FVector2f(800.0f, 300.0f) };
+
+    int32 NumMismatches = 0;
+    int32 NumQueries = 0;
+    for (const int32 NumClumps : ClumpCounts)
+    {
+        for (const FVector2f& HalfSize : HalfSizes)
+        {
+            // 大约 1/8 的 Clump 在 [0,1] 之外 (被夹到边界单元格)
+            TArray<FVector2f> Centres;
+            Centres.SetNumUninitialized(NumClumps);
+            for (FVector2f& Centre : Centres)
+            {
+                const float Range = Random.FRand() < 0.125f ? 0.5f : 0.0f;
+                Centre = FVector2f(Random.FRandRange(-Range, 1.0f + Range), Random.FRandRange(-Range, 1.0f + Range));
+            }
+
+            FGrassClumpGrid Grid;
+            Grid.Build(Centres);
+
+            auto CheckQuery = [&](const FVector2f& UV)
+            {
+                const FVector2f PositionLocal(UV.X * HalfSize.X * 2.0f - HalfSize.X, UV.Y * HalfSize.Y * 2.0f - HalfSize.Y);
+                FVector2f GridCentre, BruteCentre;
+                const int32 GridIndex = Grid.FindNearest(Centres, PositionLocal, HalfSize.X, HalfSize.Y, &GridCentre);
+                const int32 BruteIndex = FGrassClumpGrid::FindNearestBruteForce(Centres, PositionLocal, HalfSize.X, HalfSize.Y, &BruteCentre);
+                ++NumQueries;
+                if (GridIndex != BruteIndex || GridCentre != BruteCentre)
+                {
+                    if (NumMismatches++ < 8)
+                    {
+                        AddError(FString::Printf(TEXT("NumClumps=%d HalfSize=%s UV=%s: grid %d, brute force %d"),
+                            NumClumps, *HalfSize.ToString(), *UV.ToString(), GridIndex, BruteIndex));
+                    }
+                }
+            };
+
+            // 随机采样点 (稍微超出网格范围)
+            for (int32 Sample = 0; Sample < 2000; ++Sample)
+            {
+                CheckQuery(FVector2f(Random.FRandRange(-0.05f, 1.05f), Random.FRandRange(-0.05f, 1.05f)));
+            }
+
+            // 单元格边界上的点 (一个或两个坐标正好在边界上)
+            const int32 GridDim = Grid.GridDim;
+            for (int32 Line = 0; Line <= GridDim; ++Line)
+            {
+                const float Border = (float)Line / (float)GridDim;
+                CheckQuery(FVector2f(Border, Random.FRand()));
+                CheckQuery(FVector2f(Random.FRand(), Border));
+                CheckQuery(FVector2f(Border, (float)Random.RandRange(0, GridDim) / (float)GridDim));
+            }
+
+            // Clump 中心本身 (距离为 0，包括重合的 Clump)
+            for (int32 ClumpIndex = 0; ClumpIndex < FMath::Min(NumClumps, 64); ++ClumpIndex)
+            {
+                CheckQuery(Centres[ClumpIndex]);
+            }
+        }
+    }
+
+    TestEqual(FString::Printf(TEXT("Grid lookup mismatches out of %d queries"), NumQueries), NumMismatches, 0);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,146 @@
+// GrassClumpVoronoi.cpp
+// Clump Voronoi 查找纹理 CPU 参考实现
+
+#include "GrassClumpVoronoi.h"
+#include "GrassClumpGrid.h"
+#include "Async/ParallelFor.h"
+
+FGrassClumpCacheKey FGrassClumpVoronoi::ComputeCacheKey(int32 NumClumps, int32 NumClumpTypes, int32 VoronoiTextureSize)
+{
+    FGrassClumpCacheKey Key;
+    Key.NumClumps = NumClumps;
+    Key.NumClumpTypes = NumClumpTypes;
+    Key.VoronoiTextureSize = VoronoiTextureSize;
+    Key.ClumpShaderVersion = ClumpShaderVersion;
+    return Key;
+}
+
+FIntPoint FGrassClumpVoronoi::GetTexel(const FVector2f& UV, int32 TextureSize)
+{
+    const int32 TexelX = FMath::FloorToInt(UV.X * (float)TextureSize);
+    const int32 TexelY = FMath::FloorToInt(UV.Y * (float)TextureSize);
+    return FIntPoint(FMath::Clamp(TexelX, 0, TextureSize - 1), FMath::Clamp(TexelY, 0, TextureSize - 1));
+}
+
+void FGrassClumpVoronoi::Bake(TConstArrayView<FVector2f> ClumpCentresUV, int32 TextureSize, TArray<FVector4f>& OutTexels)
+{
+    OutTexels.SetNumZeroed(TextureSize * TextureSize);
+    if (ClumpCentresUV.Num() == 0 || TextureSize <= 0)
+    {
+        return;
+    }
+
+    FGrassClumpGrid Grid;
+    Grid.Build(ClumpCentresUV);
+
+    ParallelFor(TextureSize, [&](int32 Y)
+    {
+        for (int32 X = 0; X < TextureSize; ++X)
+        {
+            const FVector2f UV(
+                ((float)X + 0.5f) / (float)TextureSize,
+                ((float)Y + 0.5f) / (float)TextureSize);
+
+            // 以 UV 中心为原点、半尺寸 0.5 查询，与 GrassVoronoiCS 一致
+            const FVector2f PositionLocal = UV - FVector2f(0.5f, 0.5f);
+            FVector2f NearestCentreLocal;
+            const int32 NearestIndex = Grid.FindNearest(ClumpCentresUV, PositionLocal, 0.5f, 0.5f, &NearestCentreLocal);
+
+            const FVector2f& NearestCentre = ClumpCentresUV[NearestIndex];
+            const float Distance = FVector2f::Distance(PositionLocal, NearestCentreLocal);
+
+            OutTexels[Y * TextureSize + X] = FVector4f((float)NearestIndex, NearestCentre.X, NearestCentre.Y, Distance);
+        }
+    });
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 缓存 Key 逐字段比较；GetTexel 的纹素映射；烘焙的纹素与暴力查找一致
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassClumpVoronoiTest, "UnrealGrass.ClumpVoronoi.CacheKeyAndTexels",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassClumpVoronoiTest::RunTest(const FString& Parameters)
+{
+    // -------- 缓存 Key --------
+    {
+        const FGrassClumpCacheKey Key = FGrassClumpVoronoi::ComputeCacheKey(50, 3, 256);
+        TestTrue(TEXT("Same inputs give equal keys"), Key == FGrassClumpVoronoi::ComputeCacheKey(50, 3, 256));
+        TestEqual(TEXT("Key records the shader version"), (int32)Key.ClumpShaderVersion, (int32)FGrassClumpVoronoi::ClumpShaderVersion);
+        TestTrue(TEXT("NumClumps changes the key"), Key != FGrassClumpVoronoi::ComputeCacheKey(51, 3, 256));
+        TestTrue(TEXT("NumClumpTypes changes the key"), Key != FGrassClumpVoronoi::ComputeCacheKey(50, 4, 256));
+        TestTrue(TEXT("VoronoiTextureSize changes the key"), Key != FGrassClumpVoronoi::ComputeCacheKey(50, 3, 128));
+        TestTrue(TEXT("Disabling the Voronoi lookup changes the key"), Key != FGrassClumpVoronoi::ComputeCacheKey(50, 3, 0));
+
+        FGrassClumpCacheKey OldShaderKey = Key;
+        OldShaderKey.ClumpShaderVersion = FGrassClumpVoronoi::ClumpShaderVersion + 1;
+        TestTrue(TEXT("ClumpShaderVersion changes the key"), Key != OldShaderKey);
+
+        // 参数互换不能得到相同的 Key (哈希组合时可能碰撞)
+        TestTrue(TEXT("Swapped fields give different keys"), FGrassClumpVoronoi::ComputeCacheKey(3, 50, 0) != FGrassClumpVoronoi::ComputeCacheKey(50, 3, 0));
+    }
+
+    // -------- 纹素映射 --------
+    {
+        const int32 TextureSize = 64;
+        for (int32 Texel = 0; Texel < TextureSize; ++Texel)
+        {
+            const float Centre = ((float)Texel + 0.5f) / (float)TextureSize;
+            const float Edge = (float)Texel / (float)TextureSize;
+            TestTrue(TEXT("Texel centre maps to its texel"), FGrassClumpVoronoi::GetTexel(FVector2f(Centre, Centre), TextureSize) == FIntPoint(Texel, Texel));
+            TestTrue(TEXT("Texel edge maps to the texel it starts"), FGrassClumpVoronoi::GetTexel(FVector2f(Edge, Centre), TextureSize) == FIntPoint(Texel, Texel));
+        }
+        TestTrue(TEXT("UV 1 clamps to the last texel"), FGrassClumpVoronoi::GetTexel(FVector2f(1.0f, 1.0f), TextureSize) == FIntPoint(TextureSize - 1, TextureSize - 1));
+        TestTrue(TEXT("Negative UV clamps to the first texel"), FGrassClumpVoronoi::GetTexel(FVector2f(-0.3f, -2.0f), TextureSize) == FIntPoint(0, 0));
+        TestTrue(TEXT("UV above 1 clamps to the last texel"), FGrassClumpVoronoi::GetTexel(FVector2f(1.7f, 0.0f), TextureSize) == FIntPoint(TextureSize - 1, 0));
+    }
+
+    // -------- 烘焙的纹素内容 --------
+    {
+        FRandomStream Random(0x766F726F);
+        const int32 TextureSize = 48;
+        for (const int32 NumClumps : { 1, 5, 50, 400 })
+        {
+            TArray<FVector2f> Centres;
+            Centres.SetNumUninitialized(NumClumps);
+            for (FVector2f& Centre : Centres)
+            {
+                Centre = FVector2f(Random.FRand(), Random.FRand());
+            }
+
+            TArray<FVector4f> Texels;
+            FGrassClumpVoronoi::Bake(Centres, TextureSize, Texels);
+            if (!TestEqual(TEXT("Baked texel count"), Texels.Num(), TextureSize * TextureSize))
+            {
+                continue;
+            }
+
+            int32 NumMismatches = 0;
+            for (int32 Y = 0; Y < TextureSize; ++Y)
+            {
+                for (int32 X = 0; X < TextureSize; ++X)
+                {
+                    const FVector2f PositionLocal(((float)X + 0.5f) / (float)TextureSize - 0.5f, ((float)Y + 0.5f) / (float)TextureSize - 0.5f);
+                    FVector2f CentreLocal;
+                    const int32 Expected = FGrassClumpGrid::FindNearestBruteForce(Centres, PositionLocal, 0.5f, 0.5f, &CentreLocal);
+                    const FVector4f ExpectedTexel((float)Expected, Centres[Expected].X, Centres[Expected].Y, FVector2f::Distance(PositionLocal, CentreLocal));
+
+                    if (Texels[Y * TextureSize + X] != ExpectedTexel && NumMismatches++ < 4)
+                    {
+                        AddError(FString::Printf(TEXT("NumClumps=%d texel (%d, %d): baked %s, expected %s"),
+                            NumClumps, X, Y, *Texels[Y * TextureSize + X].ToString(), *ExpectedTexel.ToString()));
+                    }
+                }
+            }
+            TestEqual(FString::Printf(TEXT("Texel mismatches with %d clumps"), NumClumps), NumMismatches, 0);
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -3,8 +3,14 @@
 
 #include "GrassComponent.h"
 #include "GrassSceneProxy.h"
+#include "GrassClumpGrid.h"
+#include "GrassClumpVoronoi.h"
+#include "GrassCpuGenerator.h"
+#include "GrassInstanceCache.h"
+#include "GrassGenerationSubsystem.h"
 #include "RenderGraphBuilder.h"
 #include "RenderGraphUtils.h"
+#include "RHIGPUReadback.h"
 #include "GlobalShader.h"
 #include "ShaderParameterStruct.h"
 #include "Materials/Material.h"
@@ -15,7 +21,18 @@
 #include "Landscape.h"
 #include "LandscapeProxy.h"
 #include "LandscapeComponent.h"
+#include "LandscapeLayerInfoObject.h"
 #include "EngineUtils.h"  // For TActorIterator
+#include "HAL/IConsoleManager.h"
+#include "GrassBufferArena.h"
+#include "GrassStats.h"
+
+static TAutoConsoleVariable<int32> CVarGrassVisibleIndexLists(
+    TEXT("r.Grass.Culling.VisibleIndexLists"),
+    1,
+    TEXT("GPU culling appends only a uint instance index per LOD and the vertex factory fetches the packed instance indirectly (0 = copy the full packed instance into the visible buffers). Takes effect on the next generation."),
+    ECVF_RenderThreadSafe
+);
 
 // ============================================================================
 // Compute Shader 定义 - 位置生成
@@ -30,30 +47,51 @@ public:
         // Landscape 高度图 Texture 输入 (RGBA8, RG=高度, BA=法线)
         SHADER_PARAMETER_SRV(Texture2D, InLandscapeHeightmap)
         SHADER_PARAMETER_SAMPLER(SamplerState, InLandscapeHeightmapSampler)
+        // 密度贴图和 Landscape 权重图
+        SHADER_PARAMETER_SRV(Texture2D, InDensityMask)
+        SHADER_PARAMETER_SAMPLER(SamplerState, InDensityMaskSampler)
+        SHADER_PARAMETER_SRV(Texture2D, InLandscapeWeightmap)
+        SHADER_PARAMETER_SAMPLER(SamplerState, InLandscapeWeightmapSampler)
         // Clump Buffer 输入
         SHADER_PARAMETER_SRV(StructuredBuffer<FVector4f>, InClumpData0) // Centre.xy, Direction.xy
         SHADER_PARAMETER_SRV(StructuredBuffer<FVector4f>, InClumpData1) // HeightScale, WidthScale, WindPhase, Padding
+        // Clump 空间哈希网格输入
+        SHADER_PARAMETER_SRV(StructuredBuffer<uint>, InClumpGridCellStart)
+        SHADER_PARAMETER_SRV(StructuredBuffer<uint>, InClumpGridIndices)
+        // Voronoi 查找纹理 (可选)
+        SHADER_PARAMETER_TEXTURE(Texture2D<float4>, InVoronoiTexture)
         // ClumpType 参数 Buffer (每种簇类型的独立参数)
         SHADER_PARAMETER_SRV(StructuredBuffer<FVector4f>, InClumpTypeParams)
+        // 分块参数 Buffer (每个分块 5 个 float4)
+        SHADER_PARAMETER_SRV(StructuredBuffer<FVector4f>, InTileParams)
         // 输出 Buffers
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector3f>, OutPositions)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector4f>, OutGrassData0)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector4f>, OutGrassData1)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<float>, OutGrassData2)
-        SHADER_PARAMETER(int32, GridSize)
-        SHADER_PARAMETER(float, Spacing)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<FUintVector4>, OutInstances) // 16 字节压缩实例 (GrassInstancePacking.ush)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, OutInstanceCounter) // 存活的草叶数量 (紧凑输出)
+        SHADER_PARAMETER(uint32, InstanceBaseOffset)        // 实例区间在 Buffer 池页中的起始元素
+        SHADER_PARAMETER(int32, GridSize)                   // 每个分块的网格尺寸
+        SHADER_PARAMETER(int32, FirstTile)                  // 本次 Dispatch 的第一个分块
         SHADER_PARAMETER(float, JitterStrength)
         SHADER_PARAMETER(int32, NumClumps)
         SHADER_PARAMETER(int32, NumClumpTypes)
-        SHADER_PARAMETER(float, TaperAmount) // 全局参数，所有簇类型共享
-        // Landscape 高度图参数
-        SHADER_PARAMETER(FVector4f, HeightmapScaleBias)    // UV 缩放和偏移 (从 LandscapeComponent 获取)
+        SHADER_PARAMETER(int32, ClumpGridDim)
+        SHADER_PARAMETER(int32, bUseVoronoiLookup)
+        SHADER_PARAMETER(int32, VoronoiTextureSize)
+        SHADER_PARAMETER(FVector2f, ClumpDomainCentre)      // Clump 分布范围 (所有分块的并集)
+        SHADER_PARAMETER(FVector2f, ClumpDomainHalfSize)
+        SHADER_PARAMETER(FVector3f, QuantizationMin)        // 位置量化范围 (本地坐标)
+        SHADER_PARAMETER(FVector3f, QuantizationSize)
+        // Landscape 高度图参数 (每个分块的 HeightmapScaleBias 在 InTileParams 中)
         SHADER_PARAMETER(FVector3f, LandscapeScale)        // Landscape 的世界缩放 (GetActorScale3D)
         SHADER_PARAMETER(FVector3f, LandscapeLocation)     // Landscape 的世界位置 (GetActorLocation)
-        SHADER_PARAMETER(FVector2f, ComponentWorldOrigin)   // Component 在世界空间中的 XY 原点
-        SHADER_PARAMETER(float, ComponentWorldSizeX)        // Component 在世界空间中的 X 尺寸
-        SHADER_PARAMETER(float, ComponentWorldSizeY)        // Component 在世界空间中的 Y 尺寸
+        SHADER_PARAMETER(float, ComponentLocationZ)         // 草地组件的世界 Z
         SHADER_PARAMETER(int32, bUseLandscapeHeightmap)     // 是否启用 Landscape 高度图
+        // 密度参数
+        SHADER_PARAMETER(int32, bCompactOutput)             // 按密度剔除并紧凑输出
+        SHADER_PARAMETER(int32, bUseDensityMask)
+        SHADER_PARAMETER(int32, bUseDensityLayer)
+        SHADER_PARAMETER(int32, bInvertDensityLayer)
+        SHADER_PARAMETER(FVector2f, DensityMaskOrigin)      // 密度贴图覆盖范围 (本地坐标)
+        SHADER_PARAMETER(FVector2f, DensityMaskInvSize)
     END_SHADER_PARAMETER_STRUCT()
 
     static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
@@ -88,6 +126,127 @@ public:
 
 IMPLEMENT_GLOBAL_SHADER(FClumpGenerationCS, "/Plugin/UnrealGrass/Private/GrassClumpCS.usf", "MainCS", SF_Compute);
 
+// ============================================================================
+// Compute Shader 定义 - Clump 空间哈希网格构建 (计数 / 前缀和 / 分散写入)
+// ============================================================================
+class FClumpGridCountCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FClumpGridCountCS);
+    SHADER_USE_PARAMETER_STRUCT(FClumpGridCountCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_SRV(StructuredBuffer<float4>, InClumpData0)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, RWCellCounts)
+        SHADER_PARAMETER(int32, NumClumps)
+        SHADER_PARAMETER(int32, ClumpGridDim)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FClumpGridCountCS, "/Plugin/UnrealGrass/Private/GrassClumpGridCS.usf", "CountClumpsCS", SF_Compute);
+
+class FClumpGridPrefixSumCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FClumpGridPrefixSumCS);
+    SHADER_USE_PARAMETER_STRUCT(FClumpGridPrefixSumCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, RWCellCounts)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, RWCellStart)
+        SHADER_PARAMETER(int32, ClumpGridDim)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FClumpGridPrefixSumCS, "/Plugin/UnrealGrass/Private/GrassClumpGridCS.usf", "PrefixSumCS", SF_Compute);
+
+class FClumpGridScatterCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FClumpGridScatterCS);
+    SHADER_USE_PARAMETER_STRUCT(FClumpGridScatterCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_SRV(StructuredBuffer<float4>, InClumpData0)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, RWCellCounts)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, RWCellStart)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, RWCellClumps)
+        SHADER_PARAMETER(int32, NumClumps)
+        SHADER_PARAMETER(int32, ClumpGridDim)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FClumpGridScatterCS, "/Plugin/UnrealGrass/Private/GrassClumpGridCS.usf", "ScatterClumpsCS", SF_Compute);
+
+// ============================================================================
+// Compute Shader 定义 - Clump Voronoi 查找纹理烘焙
+// ============================================================================
+class FGrassVoronoiCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassVoronoiCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassVoronoiCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_SRV(StructuredBuffer<float4>, InClumpData0)
+        SHADER_PARAMETER_SRV(StructuredBuffer<uint>, InClumpGridCellStart)
+        SHADER_PARAMETER_SRV(StructuredBuffer<uint>, InClumpGridIndices)
+        SHADER_PARAMETER_UAV(RWTexture2D<float4>, OutVoronoiTexture)
+        SHADER_PARAMETER(int32, NumClumps)
+        SHADER_PARAMETER(int32, ClumpGridDim)
+        SHADER_PARAMETER(int32, TextureSize)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassVoronoiCS, "/Plugin/UnrealGrass/Private/GrassVoronoiCS.usf", "MainCS", SF_Compute);
+
+// ============================================================================
+// Compute Shader 定义 - 剔除块包围盒 (分块层次剔除)
+// ============================================================================
+class FGrassCullTileBuildCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassCullTileBuildCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassCullTileBuildCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_SRV(StructuredBuffer<FUintVector4>, InInstances)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<FGrassCullTile>, OutCullTiles)
+        SHADER_PARAMETER(uint32, InstanceBaseOffset)
+        SHADER_PARAMETER(uint32, TotalInstanceCount)
+        SHADER_PARAMETER(uint32, NumCullTiles)
+        SHADER_PARAMETER(FVector3f, QuantizationMin)
+        SHADER_PARAMETER(FVector3f, QuantizationSize)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassCullTileBuildCS, "/Plugin/UnrealGrass/Private/GrassCullTileBuildCS.usf", "MainCS", SF_Compute);
+
 
 
 // ============================================================================
@@ -98,6 +257,8 @@ UGrassComponent::UGrassComponent()
     PrimaryComponentTick.bCanEverTick = true;
     PrimaryComponentTick.bStartWithTickEnabled = true;
     bWantsInitializeComponent = true;
+    // 编辑器中也需要 Tick 来完成异步生成
+    bTickInEditor = true;
 
     // 默认添加一个簇类型
     ClumpTypes.SetNum(1);
@@ -132,6 +293,14 @@ void UGrassComponent::OnRegister()
 {
     Super::OnRegister();
 
+    if (UGrassGenerationSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UGrassGenerationSubsystem>() : nullptr)
+    {
+        Scheduler->RegisterComponent(this);
+    }
+
+    // 重新注册 (移动、属性修改) 时实例数据还在，重新计入内存统计
+    UpdateMemoryStats();
+
     if (GetWorld() && GetWorld()->IsGameWorld() == false)
     {
         if (InstanceCount == 0)
@@ -142,715 +311,1646 @@ void UGrassComponent::OnRegister()
     }
 }
 
+void UGrassComponent::OnUnregister()
+{
+    if (UGrassGenerationSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UGrassGenerationSubsystem>() : nullptr)
+    {
+        Scheduler->CancelGeneration(this);
+        Scheduler->UnregisterComponent(this);
+    }
+
+    Super::OnUnregister();
+
+    // 注销后不再计入内存统计 (Buffer 随 Proxy 释放)
+    UpdateMemoryStats();
+}
+
 void UGrassComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-    if (GetWorld() && GetWorld()->Scene)
+    // 实例缓存读取完成后提交上传 (或回退到 GPU 生成)
+    if (PendingCacheLoad.IsValid() && PendingCacheLoad.IsReady())
     {
-        FVector WindDirection;
-        float WindSpeed;
-        float WindMinGust;
-        float WindMaxGust;
-
-        // 在组件所在位置采样风力参数
-        GetWorld()->Scene->GetWindParameters(GetComponentLocation(), WindDirection, WindSpeed, WindMinGust, WindMaxGust);
+        FinishCacheLoad();
+    }
 
-        // 格式化输出信息
-        FString DebugInfo = FString::Printf(
-            TEXT("Wind Data at %s:\nDirection: %s\nSpeed: %.2f\nMin Gust: %.2f\nMax Gust: %.2f"),
-            *GetComponentLocation().ToString(),
-            *WindDirection.ToString(),
-            WindSpeed,
-            WindMinGust,
-            WindMaxGust
-        );
+    // 异步生成完成后提交新 Buffer
+    if (bGenerationInFlight && !PendingCacheLoad.IsValid() && GenerationFence.IsFenceComplete())
+    {
+        FinishGeneration();
+    }
 
-        // 打印到屏幕
-        if (GEngine)
+    // 缓存未命中时的 GPU 回读：每帧检查一次，就绪后在线程池中写入缓存文件
+    if (PendingCacheReadback.IsValid())
+    {
+        if (PendingCacheReadback->IsComplete())
+        {
+            PendingCacheReadback.Reset();
+        }
+        else
         {
-            GEngine->AddOnScreenDebugMessage(1, DeltaTime, FColor::Cyan, DebugInfo);
+            ENQUEUE_RENDER_COMMAND(PollGrassCacheReadback)(
+                [Readback = PendingCacheReadback](FRHICommandListImmediate& RHICmdList)
+                {
+                    Readback->Poll_RenderThread();
+                }
+            );
         }
     }
 }
 
 void UGrassComponent::GenerateGrass()
 {
-    InstanceCount = GridSize * GridSize;
-    int32 CapturedGridSize = GridSize;
-    float CapturedSpacing = Spacing;
-    float CapturedJitterStrength = JitterStrength;
-    bool CapturedUseIndirectDraw = bUseIndirectDraw;
-    bool CapturedEnableFrustumCulling = bEnableFrustumCulling;
+    // 交给世界级调度器排队，按到相机的距离和每帧预算发起 (关卡流送时避免同一帧生成所有组件)
+    UGrassGenerationSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UGrassGenerationSubsystem>() : nullptr;
+    if (Scheduler && UGrassGenerationSubsystem::IsEnabled())
+    {
+        Scheduler->RequestGeneration(this, EGrassGenerationStage::All);
+        return;
+    }
+
+    RegenerateStages(EGrassGenerationStage::All);
+}
+
+void UGrassComponent::RegenerateStages(EGrassGenerationStage Stages)
+{
+    if (Stages == EGrassGenerationStage::None)
+    {
+        return;
+    }
+
+    // 风、剔除、LOD 等参数只在 SceneProxy 构造时读取，重建 Proxy 即可 (使用当前已提交的 Buffer)
+    if (EnumHasAnyFlags(Stages, EGrassGenerationStage::ProxyParams))
+    {
+        MarkRenderStateDirty();
+        EnumRemoveFlags(Stages, EGrassGenerationStage::ProxyParams);
+        if (Stages == EGrassGenerationStage::None)
+        {
+            return;
+        }
+    }
+
+    // 上一次异步生成尚未完成：合并请求，完成后使用最新参数再生成一次
+    if (bGenerationInFlight)
+    {
+        RequestedStages |= Stages;
+        return;
+    }
+
+    FGrassGenerationParams GenParams;
+    GenParams.GridSize = GridSize;
+    GenParams.Spacing = Spacing;
+    GenParams.JitterStrength = JitterStrength;
+    GenParams.bUseIndirectDraw = bUseIndirectDraw;
+    GenParams.bEnableFrustumCulling = bEnableFrustumCulling;
+    GenParams.bVisibleIndexLists = CVarGrassVisibleIndexLists.GetValueOnGameThread() != 0;
     
     // 确保 ClumpTypes 数组有效
     EnsureValidClumpTypes();
     
     // Clump 参数
-    int32 CapturedNumClumps = NumClumps;
-    int32 CapturedNumClumpTypes = GetNumClumpTypes();
-    
-    // 全局渲染参数
-    float CapturedTaperAmount = RenderParameters.TaperAmount;
+    GenParams.NumClumps = NumClumps;
+    GenParams.NumClumpTypes = GetNumClumpTypes();
+    GenParams.ClumpGridDim = FGrassClumpGrid::ComputeGridDim(GenParams.NumClumps);
+    GenParams.VoronoiTextureSize = bUseVoronoiClumpLookup ? VoronoiTextureSize : 0;
     
-    // ========== Landscape Heightmap 自动获取 ==========
-    bool CapturedUseLandscapeHeightmap = false;
-    FVector4f CapturedHeightmapScaleBias = FVector4f(0, 0, 0, 0);
-    FVector3f CapturedLandscapeScale = FVector3f(100.0f, 100.0f, 100.0f);
-    FVector3f CapturedLandscapeLocation = FVector3f(0, 0, 0);
-    FVector2f CapturedComponentWorldOrigin = FVector2f(0, 0);
-    float CapturedComponentWorldSizeX = 0.0f;
-    float CapturedComponentWorldSizeY = 0.0f;
-    FTextureResource* HeightmapResource = nullptr;
+    // Clump 数据只依赖簇数量、簇类型数量和 Voronoi 分辨率
+    // 缓存 Key 不变时 (例如只修改了 Jitter / Spacing) 跳过整个 Clump Pass
+    // 这里没有进行中的生成 (见上面)，ClumpCacheKey 就是渲染线程当前持有的 Clump 数据
+    const FGrassClumpCacheKey NewClumpCacheKey = FGrassClumpVoronoi::ComputeCacheKey(GenParams.NumClumps, GenParams.NumClumpTypes, GenParams.VoronoiTextureSize);
+    GenParams.bReuseClumpData = ClumpCacheKey.IsSet() && ClumpCacheKey.GetValue() == NewClumpCacheKey;
     
+    // ========== 生成分块 ==========
+    // 默认是以组件为中心的单个 GridSize x GridSize 分块；启用地形时每个 Landscape Component 一个分块
+    GenParams.ComponentLocation = FVector3f(GetComponentLocation());
     if (bUseLandscapeHeightmap && GetWorld())
     {
-        FVector ActorLocation = GetOwner() ? GetOwner()->GetActorLocation() : GetComponentLocation();
-        
-        // 遍历场景中的 Landscape Proxy，查找覆盖当前位置的 Component
-        for (TActorIterator<ALandscapeProxy> It(GetWorld()); It; ++It)
-        {
-            ALandscapeProxy* LandscapeProxy = *It;
-            if (!LandscapeProxy) continue;
-            
-            FVector LandscapeScale = LandscapeProxy->GetActorScale3D();
-            FVector LandscapeLoc = LandscapeProxy->GetActorLocation();
-            
-            // 遍历所有 LandscapeComponent 找到包含当前位置的那个
-            for (ULandscapeComponent* LandscapeComp : LandscapeProxy->LandscapeComponents)
-            {
-                if (!LandscapeComp || !LandscapeComp->GetHeightmap()) continue;
-                
-                // Component 在世界空间中的原点 (SectionBase * Scale + LandscapeLoc)
-                float CompWorldX = LandscapeComp->SectionBaseX * LandscapeScale.X + LandscapeLoc.X;
-                float CompWorldY = LandscapeComp->SectionBaseY * LandscapeScale.Y + LandscapeLoc.Y;
-                float CompWorldSizeX = LandscapeComp->ComponentSizeQuads * LandscapeScale.X;
-                float CompWorldSizeY = LandscapeComp->ComponentSizeQuads * LandscapeScale.Y;
-                
-                // 检查 Actor 位置是否在这个 Component 的范围内
-                if (ActorLocation.X >= CompWorldX && ActorLocation.X <= CompWorldX + CompWorldSizeX &&
-                    ActorLocation.Y >= CompWorldY && ActorLocation.Y <= CompWorldY + CompWorldSizeY)
-                {
-                    // 找到了！获取高度图参数
-                    CapturedUseLandscapeHeightmap = true;
-                    CapturedHeightmapScaleBias = FVector4f(
-                        LandscapeComp->HeightmapScaleBias.X,
-                        LandscapeComp->HeightmapScaleBias.Y,
-                        LandscapeComp->HeightmapScaleBias.Z,
-                        LandscapeComp->HeightmapScaleBias.W
-                    );
-                    CapturedLandscapeScale = FVector3f(LandscapeScale.X, LandscapeScale.Y, LandscapeScale.Z);
-                    CapturedLandscapeLocation = FVector3f(LandscapeLoc.X, LandscapeLoc.Y, LandscapeLoc.Z);
-                    CapturedComponentWorldOrigin = FVector2f(CompWorldX, CompWorldY);
-                    CapturedComponentWorldSizeX = CompWorldSizeX;
-                    CapturedComponentWorldSizeY = CompWorldSizeY;
-                    HeightmapResource = LandscapeComp->GetHeightmap()->GetResource();
-                    
-                    // ========== 自动铺满整个 Landscape Component ==========
-                    // 将 Actor 移动到 Component 中心，使草叶网格完全覆盖 Component
-                    FVector CompCenterWorld = FVector(
-                        CompWorldX + CompWorldSizeX * 0.5f,
-                        CompWorldY + CompWorldSizeY * 0.5f,
-                        0.0f  // Z 设为 0，这样 Position.z 可以直接存储世界高度
-                    );
-                    if (GetOwner())
-                    {
-                        GetOwner()->SetActorLocation(CompCenterWorld);
-                    }
-                    
-                    // 根据 Component 尺寸自动计算 GridSize，使网格铺满 Component
-                    // GridSize * Spacing 需要覆盖 CompWorldSize
-                    // 保持用户设置的 Spacing (草叶密度)，自动计算所需的 GridSize
-                    CapturedGridSize = FMath::CeilToInt(FMath::Max(CompWorldSizeX, CompWorldSizeY) / CapturedSpacing) + 1;
-                    CapturedGridSize = FMath::Clamp(CapturedGridSize, 2, 1024);
-                    InstanceCount = CapturedGridSize * CapturedGridSize;
-                    
-                    UE_LOG(LogTemp, Log, TEXT("Found Landscape Component at SectionBase(%d, %d), WorldOrigin(%.1f, %.1f), Size(%.1f x %.1f)"),
-                        LandscapeComp->SectionBaseX, LandscapeComp->SectionBaseY,
-                        CompWorldX, CompWorldY, CompWorldSizeX, CompWorldSizeY);
-                    UE_LOG(LogTemp, Log, TEXT("  Auto-fill: Actor moved to (%.1f, %.1f), GridSize=%d, Spacing=%.1f, Total=%d instances"),
-                        CompCenterWorld.X, CompCenterWorld.Y, CapturedGridSize, CapturedSpacing, InstanceCount);
-                    UE_LOG(LogTemp, Log, TEXT("  HeightmapScaleBias: (%.6f, %.6f, %.6f, %.6f)"),
-                        CapturedHeightmapScaleBias.X, CapturedHeightmapScaleBias.Y,
-                        CapturedHeightmapScaleBias.Z, CapturedHeightmapScaleBias.W);
-                    UE_LOG(LogTemp, Log, TEXT("  LandscapeScale: (%.1f, %.1f, %.1f), Location: (%.1f, %.1f, %.1f)"),
-                        LandscapeScale.X, LandscapeScale.Y, LandscapeScale.Z,
-                        LandscapeLoc.X, LandscapeLoc.Y, LandscapeLoc.Z);
-                    break;
-                }
-            }
-            if (CapturedUseLandscapeHeightmap) break;
-        }
-        
-        if (!CapturedUseLandscapeHeightmap)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("GrassComponent: No Landscape Component found at location (%.1f, %.1f, %.1f). Heightmap disabled."),
-                ActorLocation.X, ActorLocation.Y, ActorLocation.Z);
-        }
+        CollectLandscapeTiles(GenParams);
+    }
+    if (GenParams.Tiles.Num() == 0)
+    {
+        GenParams.Tiles.Add(FGrassGenerationTile::MakeGridTile(GenParams.GridSize, GenParams.Spacing));
+    }
+    InstanceCount = GenParams.GetInstanceCount();
+
+    // CPU 生成只在 bGenerateOnCpu 时使用：不采样高度图和密度，剔除和 Vertex Factory 仍然需要 SM5，不作为低端平台的回退
+    const bool bUseCpuGeneration = bGenerateOnCpu;
+
+    // ========== 密度遮罩 ==========
+    GenParams.DensityMaskResource = DensityMask ? DensityMask->GetResource() : nullptr;
+    GenParams.DensityMaskContentHash = FGrassInstanceCache::HashTexture(DensityMask);
+    GenParams.bUseDensityLayer = GenParams.bUseLandscapeHeightmap && !DensityLandscapeLayer.IsNone();
+    GenParams.bInvertDensityLayer = GenParams.bUseDensityLayer && bInvertDensityLayer;
+    if (bUseCpuGeneration && GenParams.UsesDensity())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("GrassComponent: CPU generation does not support density masks, all %d grid instances will be kept."), InstanceCount);
+        GenParams.DensityMaskResource = nullptr;
+        GenParams.bUseDensityLayer = false;
+        GenParams.bInvertDensityLayer = false;
+    }
+
+    // 包围盒跟随生成范围 (地形高度变化使用固定的 Z 范围)
+    const FBox2f TileBounds = GenParams.GetTileBounds();
+    const FBox NewLocalBounds(
+        FVector(TileBounds.Min.X - GrassBoundingRadius, TileBounds.Min.Y - GrassBoundingRadius, -5000.0f),
+        FVector(TileBounds.Max.X + GrassBoundingRadius, TileBounds.Max.Y + GrassBoundingRadius, 5000.0f));
+    if (!(NewLocalBounds == GeneratedLocalBounds))
+    {
+        GeneratedLocalBounds = NewLocalBounds;
+        UpdateBounds();
+        MarkRenderTransformDirty();
     }
     
     // 复制 ClumpTypes 数组供渲染线程使用
-    TArray<FClumpTypeParameters> CapturedClumpTypes = ClumpTypes;
-
-    UE_LOG(LogTemp, Log, TEXT("Generating %d grass positions on GPU (FrustumCulling=%d, NumClumps=%d, UseLandscapeHeightmap=%d)..."), 
-        InstanceCount, CapturedEnableFrustumCulling ? 1 : 0, CapturedNumClumps, CapturedUseLandscapeHeightmap ? 1 : 0);
+    GenParams.ClumpTypes = ClumpTypes;
+
+    // ========== 确定需要执行的阶段 ==========
+    // 实例数量和量化范围不变时直接写入当前 Buffer，跳过 Buffer 的重新分配和初始拷贝
+    // 使用密度遮罩时存活数量在生成后才能确定，总是重新分配
+    const bool bReuseAllocation = !EnumHasAnyFlags(Stages, EGrassGenerationStage::Allocation)
+        && InstanceBuffers.IsValid()
+        && !GenParams.UsesDensity()
+        && InstanceBuffers.InstanceCount == InstanceCount
+        && InstanceBuffers.Quantization == GenParams.GetQuantization()
+        && InstanceBuffers.bVisibleIndexLists == GenParams.bVisibleIndexLists;
+    if (bReuseAllocation)
+    {
+        GenParams.ReuseBuffers = InstanceBuffers;
+    }
+    else
+    {
+        Stages |= EGrassGenerationStage::Allocation;
+    }
+    // 每个实例的所有属性压缩在同一个 16 字节里，渲染线程总是完整生成
+    Stages |= EGrassGenerationStage::Positions;
+    if (!GenParams.bReuseClumpData)
+    {
+        Stages |= EGrassGenerationStage::Clumps | EGrassGenerationStage::Positions;
+    }
+    if (EnumHasAnyFlags(Stages, EGrassGenerationStage::Clumps))
+    {
+        Stages |= EGrassGenerationStage::Positions;
+    }
+    GenParams.Stages = Stages;
 
-    ENQUEUE_RENDER_COMMAND(GenerateGrassPositions)(
-        [this, CapturedGridSize, CapturedSpacing, CapturedJitterStrength, 
-         CapturedUseIndirectDraw, CapturedEnableFrustumCulling,
-         CapturedNumClumps, CapturedNumClumpTypes,
-         CapturedTaperAmount, CapturedClumpTypes,
-         CapturedUseLandscapeHeightmap, CapturedHeightmapScaleBias,
-         CapturedLandscapeScale, CapturedLandscapeLocation,
-         CapturedComponentWorldOrigin, CapturedComponentWorldSizeX, CapturedComponentWorldSizeY,
-         HeightmapResource](FRHICommandListImmediate& RHICmdList)
+    // ========== CPU 生成 ==========
+    if (bUseCpuGeneration)
+    {
+        // CPU 路径总是完整生成 (Clump 数据每次重新计算，成本可以忽略)
+        if (GenParams.bUseLandscapeHeightmap)
         {
-            int32 Total = CapturedGridSize * CapturedGridSize;
+            UE_LOG(LogTemp, Warning, TEXT("GrassComponent: CPU generation does not sample the landscape heightmap, grass heights will be 0."));
+        }
 
-            // ========== 获取 Landscape 高度图 SRV ==========
-            FShaderResourceViewRHIRef LocalHeightmapSRV;
-            if (CapturedUseLandscapeHeightmap && HeightmapResource)
-            {
-                FTextureRHIRef HeightmapRHI = HeightmapResource->TextureRHI;
-                if (HeightmapRHI.IsValid())
-                {
-                    LocalHeightmapSRV = RHICmdList.CreateShaderResourceView(
-                        HeightmapRHI, 
-                        FRHIViewDesc::CreateTextureSRV().SetDimensionFromTexture(HeightmapRHI)
-                    );
-                    HeightmapTextureSRV = LocalHeightmapSRV;
-                    UE_LOG(LogTemp, Log, TEXT("Created Landscape Heightmap SRV for terrain height sampling"));
-                }
-            }
+        TSharedPtr<FGrassCpuInstanceData, ESPMode::ThreadSafe> NewCpuData = MakeShared<FGrassCpuInstanceData, ESPMode::ThreadSafe>();
+        const double CpuStartTime = FPlatformTime::Seconds();
+        FGrassCpuGenerator::Generate(GenParams, *NewCpuData);
+        UE_LOG(LogTemp, Log, TEXT("Generated %d grass instances on CPU in %.2f ms"), NewCpuData->Num(), (FPlatformTime::Seconds() - CpuStartTime) * 1000.0);
+
+        GenParams.CpuInstanceData = NewCpuData;
+        CpuInstanceData = NewCpuData;
+    }
+    else
+    {
+        CpuInstanceData.Reset();
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("Generating %d grass positions on GPU (Stages=0x%02x, FrustumCulling=%d, NumClumps=%d, UseLandscapeHeightmap=%d, ReuseClumps=%d, ReuseBuffers=%d, Async=%d)..."), 
+        InstanceCount, (uint32)Stages, GenParams.bEnableFrustumCulling ? 1 : 0, GenParams.NumClumps, GenParams.bUseLandscapeHeightmap ? 1 : 0,
+        GenParams.bReuseClumpData ? 1 : 0, bReuseAllocation ? 1 : 0, bAsyncGeneration ? 1 : 0);
 
-            // ========== 创建 Clump Buffer ==========
-            // ClumpData 使用两个 float4 来存储:
-            // ClumpData0: Centre.x, Centre.y, Direction.x, Direction.y
-            // ClumpData1: HeightScale, WidthScale, WindPhase, Padding
+    // ========== 实例缓存 (只对完整的 GPU 位置生成有效，CPU 生成本身就很快) ==========
+    TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> CacheReadback;
+    bRecordCacheMiss = false;
+    if (bUseInstanceCache && FGrassInstanceCache::IsEnabled()
+        && !GenParams.CpuInstanceData.IsValid()
+        && EnumHasAnyFlags(GenParams.Stages, EGrassGenerationStage::Positions))
+    {
+        const FString CacheKey = FGrassInstanceCache::ComputeKey(GenParams);
+        CacheRequestStartTime = FPlatformTime::Seconds();
+
+        if (FGrassInstanceCache::Contains(CacheKey))
+        {
+            // 命中：在线程池中读取文件，完成后走 CPU 数据上传路径
+            UE_LOG(LogTemp, Log, TEXT("GrassInstanceCache: Loading %s..."), *CacheKey);
+            bGenerationInFlight = true;
+            PendingCacheKey = CacheKey;
+            PendingCacheParams = GenParams;
+            PendingCacheLoad = FGrassInstanceCache::LoadAsync(CacheKey, InstanceCount);
+            if (!bAsyncGeneration)
             {
-                // 创建 ClumpData0 Buffer
-                FRHIBufferCreateDesc ClumpData0Desc = FRHIBufferCreateDesc::CreateStructured(
-                    TEXT("GrassClumpData0Buffer"),
-                    CapturedNumClumps * sizeof(FVector4f),
-                    sizeof(FVector4f))
-                    .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                    .SetInitialState(ERHIAccess::UAVCompute);
-                FBufferRHIRef ClumpData0Buffer = RHICmdList.CreateBuffer(ClumpData0Desc);
-                
-                // 创建 ClumpData1 Buffer
-                FRHIBufferCreateDesc ClumpData1Desc = FRHIBufferCreateDesc::CreateStructured(
-                    TEXT("GrassClumpData1Buffer"),
-                    CapturedNumClumps * sizeof(FVector4f),
-                    sizeof(FVector4f))
-                    .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                    .SetInitialState(ERHIAccess::UAVCompute);
-                FBufferRHIRef ClumpData1Buffer = RHICmdList.CreateBuffer(ClumpData1Desc);
-
-                // 创建 UAV
-                auto ClumpData0UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(CapturedNumClumps);
-                FUnorderedAccessViewRHIRef ClumpData0UAV = RHICmdList.CreateUnorderedAccessView(ClumpData0Buffer, ClumpData0UAVDesc);
-                auto ClumpData1UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(CapturedNumClumps);
-                FUnorderedAccessViewRHIRef ClumpData1UAV = RHICmdList.CreateUnorderedAccessView(ClumpData1Buffer, ClumpData1UAVDesc);
-
-                // 执行 Clump 生成 Compute Shader
-                TShaderMapRef<FClumpGenerationCS> ClumpCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
-                FClumpGenerationCS::FParameters ClumpParams;
-                ClumpParams.OutClumpData0 = ClumpData0UAV;
-                ClumpParams.OutClumpData1 = ClumpData1UAV;
-                ClumpParams.NumClumps = CapturedNumClumps;
-                ClumpParams.NumClumpTypes = CapturedNumClumpTypes;
-
-                FComputeShaderUtils::Dispatch(RHICmdList, ClumpCS, ClumpParams,
-                    FIntVector(FMath::DivideAndRoundUp(CapturedNumClumps, 64), 1, 1));
-
-                // 转换到 SRV 状态
-                RHICmdList.Transition(FRHITransitionInfo(ClumpData0Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-                RHICmdList.Transition(FRHITransitionInfo(ClumpData1Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-
-                // 创建 SRV
-                auto ClumpSRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(CapturedNumClumps);
-                ClumpBufferSRV = RHICmdList.CreateShaderResourceView(ClumpData0Buffer, ClumpSRVDesc);
-                ClumpBuffer = ClumpData0Buffer;
-                
-                // 创建 ClumpData1 的 SRV
-                auto Clump1SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(CapturedNumClumps);
-                ClumpData1BufferSRV = RHICmdList.CreateShaderResourceView(ClumpData1Buffer, Clump1SRVDesc);
-                this->ClumpData1Buffer = ClumpData1Buffer;
-
-                UE_LOG(LogTemp, Log, TEXT("Created ClumpBuffer with %d clumps"), 
-                    CapturedNumClumps);
+                PendingCacheLoad.Wait();
+                FinishCacheLoad();
             }
+            return;
+        }
 
-            // ========== 创建所有实例位置的 StructuredBuffer ==========
-            FRHIBufferCreateDesc Desc = FRHIBufferCreateDesc::CreateStructured(
-                TEXT("GrassPositionBuffer"),
-                Total * sizeof(FVector3f),
-                sizeof(FVector3f))
-                .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                .SetInitialState(ERHIAccess::UAVCompute);
-
-            PositionBuffer = RHICmdList.CreateBuffer(Desc);
-
-            // UAV for compute shader
-            auto UAVDesc = FRHIViewDesc::CreateBufferUAV()
-                .SetType(FRHIViewDesc::EBufferType::Structured)
-                .SetNumElements(Total);
-            FUnorderedAccessViewRHIRef UAV = RHICmdList.CreateUnorderedAccessView(PositionBuffer, UAVDesc);
-
-            // SRV for culling shader input
-            auto SRVDesc = FRHIViewDesc::CreateBufferSRV()
-                .SetType(FRHIViewDesc::EBufferType::Structured)
-                .SetNumElements(Total);
-            PositionBufferSRV = RHICmdList.CreateShaderResourceView(PositionBuffer, SRVDesc);
-
-            // ========== 创建草叶数据 Buffers ==========
-            // GrassData0: Height, Width, Tilt, Bend (float4)
-            FRHIBufferCreateDesc Data0Desc = FRHIBufferCreateDesc::CreateStructured(
-                TEXT("GrassData0Buffer"),
-                Total * sizeof(FVector4f),
-                sizeof(FVector4f))
-                .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                .SetInitialState(ERHIAccess::UAVCompute);
-            FBufferRHIRef GrassData0Buffer = RHICmdList.CreateBuffer(Data0Desc);
-            auto Data0UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-            FUnorderedAccessViewRHIRef Data0UAV = RHICmdList.CreateUnorderedAccessView(GrassData0Buffer, Data0UAVDesc);
-            auto Data0SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-            GrassDataBufferSRV = RHICmdList.CreateShaderResourceView(GrassData0Buffer, Data0SRVDesc);
-            GrassDataBuffer = GrassData0Buffer;
-
-            // GrassData1: TaperAmount, FacingDir.x, FacingDir.y, P1Offset (float4)
-            FRHIBufferCreateDesc Data1Desc = FRHIBufferCreateDesc::CreateStructured(
-                TEXT("GrassData1Buffer"),
-                Total * sizeof(FVector4f),
-                sizeof(FVector4f))
-                .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                .SetInitialState(ERHIAccess::UAVCompute);
-            GrassData1Buffer = RHICmdList.CreateBuffer(Data1Desc);
-            auto Data1UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-            FUnorderedAccessViewRHIRef Data1UAV = RHICmdList.CreateUnorderedAccessView(GrassData1Buffer, Data1UAVDesc);
-            auto Data1SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-            GrassData1BufferSRV = RHICmdList.CreateShaderResourceView(GrassData1Buffer, Data1SRVDesc);
-
-            // GrassData2: P2Offset (float)
-            FRHIBufferCreateDesc Data2Desc = FRHIBufferCreateDesc::CreateStructured(
-                TEXT("GrassData2Buffer"),
-                Total * sizeof(float),
-                sizeof(float))
-                .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                .SetInitialState(ERHIAccess::UAVCompute);
-            GrassData2Buffer = RHICmdList.CreateBuffer(Data2Desc);
-            auto Data2UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-            FUnorderedAccessViewRHIRef Data2UAV = RHICmdList.CreateUnorderedAccessView(GrassData2Buffer, Data2UAVDesc);
-            auto Data2SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-            GrassData2BufferSRV = RHICmdList.CreateShaderResourceView(GrassData2Buffer, Data2SRVDesc);
-
-            // ========== 创建 ClumpType 参数 Buffer ==========
-            // 每种簇类型的参数打包成 float4 数组:
-            // [0]: PullToCentre, PointInSameDirection, BaseHeight, HeightRandom
-            // [1]: BaseWidth, WidthRandom, BaseTilt, TiltRandom
-            // [2]: BaseBend, BendRandom, 0, 0
-            const int32 FloatsPerClumpType = 12; // 3 个 float4
-            TArray<float> ClumpTypeData;
-            ClumpTypeData.SetNum(CapturedNumClumpTypes * FloatsPerClumpType);
-            
-            for (int32 i = 0; i < CapturedNumClumpTypes; ++i)
+        // 未命中：GPU 生成后回读结果写入缓存
+        CacheReadback = MakeShared<FGrassCacheReadback, ESPMode::ThreadSafe>(CacheKey);
+        bRecordCacheMiss = true;
+    }
+
+    SubmitGeneration(GenParams, CacheReadback);
+}
+
+void UGrassComponent::CollectLandscapeTiles(FGrassGenerationParams& GenParams) const
+{
+    const FVector Location = GetComponentLocation();
+    const FVector2D Location2D(Location.X, Location.Y);
+
+    // 组件在世界空间中的覆盖范围 (Component 原点 = SectionBase * Scale + LandscapeLoc)
+    auto GetComponentRect = [](const ALandscapeProxy* LandscapeProxy, const ULandscapeComponent* LandscapeComp)
+    {
+        const FVector LandscapeScale = LandscapeProxy->GetActorScale3D();
+        const FVector LandscapeLoc = LandscapeProxy->GetActorLocation();
+        const FVector2D Min(
+            LandscapeComp->SectionBaseX * LandscapeScale.X + LandscapeLoc.X,
+            LandscapeComp->SectionBaseY * LandscapeScale.Y + LandscapeLoc.Y);
+        const FVector2D Size(
+            LandscapeComp->ComponentSizeQuads * LandscapeScale.X,
+            LandscapeComp->ComponentSizeQuads * LandscapeScale.Y);
+        return FBox2D(Min, Min + Size);
+    };
+
+    // 先找到组件所在的 Landscape Component，只合并同一个 Landscape 的 Proxy (缩放和高度解码一致)
+    ALandscapeProxy* ContainingProxy = nullptr;
+    const ULandscapeComponent* ContainingComp = nullptr;
+    for (TActorIterator<ALandscapeProxy> It(GetWorld()); It && !ContainingComp; ++It)
+    {
+        for (ULandscapeComponent* LandscapeComp : It->LandscapeComponents)
+        {
+            if (LandscapeComp && LandscapeComp->GetHeightmap() && GetComponentRect(*It, LandscapeComp).IsInside(Location2D))
             {
-                const FClumpTypeParameters& TypeParams = CapturedClumpTypes[i];
-                int32 BaseIdx = i * FloatsPerClumpType;
-                // float4[0]
-                ClumpTypeData[BaseIdx + 0] = TypeParams.PullToCentre;
-                ClumpTypeData[BaseIdx + 1] = TypeParams.PointInSameDirection;
-                ClumpTypeData[BaseIdx + 2] = TypeParams.BaseHeight;
-                ClumpTypeData[BaseIdx + 3] = TypeParams.HeightRandom;
-                // float4[1]
-                ClumpTypeData[BaseIdx + 4] = TypeParams.BaseWidth;
-                ClumpTypeData[BaseIdx + 5] = TypeParams.WidthRandom;
-                ClumpTypeData[BaseIdx + 6] = TypeParams.BaseTilt;
-                ClumpTypeData[BaseIdx + 7] = TypeParams.TiltRandom;
-                // float4[2]
-                ClumpTypeData[BaseIdx + 8] = TypeParams.BaseBend;
-                ClumpTypeData[BaseIdx + 9] = TypeParams.BendRandom;
-                ClumpTypeData[BaseIdx + 10] = 0.0f; // Reserved
-                ClumpTypeData[BaseIdx + 11] = 0.0f; // Reserved
+                ContainingProxy = *It;
+                ContainingComp = LandscapeComp;
+                break;
             }
-            
-            // 创建 ClumpType 参数 Buffer
-            FRHIBufferCreateDesc ClumpTypeParamsDesc = FRHIBufferCreateDesc::CreateStructured(
-                TEXT("GrassClumpTypeParamsBuffer"),
-                CapturedNumClumpTypes * FloatsPerClumpType * sizeof(float),
-                sizeof(FVector4f))
-                .AddUsage(EBufferUsageFlags::ShaderResource)
-                .SetInitialState(ERHIAccess::CopyDest);
-            ClumpTypeParamsBuffer = RHICmdList.CreateBuffer(ClumpTypeParamsDesc);
-            
-            // 上传数据
-            void* ClumpTypeParamsData = RHICmdList.LockBuffer(ClumpTypeParamsBuffer, 0, ClumpTypeData.Num() * sizeof(float), RLM_WriteOnly);
-            FMemory::Memcpy(ClumpTypeParamsData, ClumpTypeData.GetData(), ClumpTypeData.Num() * sizeof(float));
-            RHICmdList.UnlockBuffer(ClumpTypeParamsBuffer);
-            RHICmdList.Transition(FRHITransitionInfo(ClumpTypeParamsBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-            
-            // 创建 SRV
-            auto ClumpTypeSRVDesc = FRHIViewDesc::CreateBufferSRV()
-                .SetType(FRHIViewDesc::EBufferType::Structured)
-                .SetNumElements(CapturedNumClumpTypes * 3); // 每种类型 3 个 float4
-            ClumpTypeParamsBufferSRV = RHICmdList.CreateShaderResourceView(ClumpTypeParamsBuffer, ClumpTypeSRVDesc);
-            
-            UE_LOG(LogTemp, Log, TEXT("Created ClumpTypeParamsBuffer for %d clump types"), CapturedNumClumpTypes);
-
-            // ========== 执行位置生成 Compute Shader ==========
-            TShaderMapRef<FGrassPositionCS> CS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
-            FGrassPositionCS::FParameters Params;
-            // Landscape 高度图 Texture 输入
-            if (CapturedUseLandscapeHeightmap && LocalHeightmapSRV.IsValid())
+        }
+    }
+
+    if (!ContainingComp)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("GrassComponent: No Landscape Component found at location (%.1f, %.1f, %.1f). Heightmap disabled."),
+            Location.X, Location.Y, Location.Z);
+        return;
+    }
+
+    const FGuid LandscapeGuid = ContainingProxy->GetLandscapeGuid();
+    const float FootprintHalfSize = (GridSize - 1) * Spacing * 0.5f;
+    const FBox2D Footprint(Location2D - FVector2D(FootprintHalfSize), Location2D + FVector2D(FootprintHalfSize));
+
+    struct FLandscapeTileSource
+    {
+        const ULandscapeComponent* Component;
+        FBox2D Rect;
+        FString HeightmapName;
+        UTexture2D* Weightmap;
+        int32 WeightmapChannel;
+        FString WeightmapName;
+    };
+
+    // 密度绘制层所在的权重图和通道 (Component 没有绘制该层时权重为 0)
+    auto FindDensityWeightmap = [this](const ULandscapeComponent* LandscapeComp, UTexture2D*& OutWeightmap, int32& OutChannel)
+    {
+        OutWeightmap = nullptr;
+        OutChannel = INDEX_NONE;
+        if (DensityLandscapeLayer.IsNone())
+        {
+            return;
+        }
+        const TArray<TObjectPtr<UTexture2D>>& Weightmaps = LandscapeComp->GetWeightmapTextures();
+        for (const FWeightmapLayerAllocationInfo& Allocation : LandscapeComp->GetWeightmapLayerAllocations())
+        {
+            if (Allocation.LayerInfo && Allocation.LayerInfo->GetLayerName() == DensityLandscapeLayer
+                && Weightmaps.IsValidIndex(Allocation.WeightmapTextureIndex))
             {
-                Params.InLandscapeHeightmap = LocalHeightmapSRV;
+                OutWeightmap = Weightmaps[Allocation.WeightmapTextureIndex];
+                OutChannel = Allocation.WeightmapTextureChannel;
+                return;
             }
-            else
+        }
+    };
+    TArray<FLandscapeTileSource> Sources;
+    for (TActorIterator<ALandscapeProxy> It(GetWorld()); It; ++It)
+    {
+        if (It->GetLandscapeGuid() != LandscapeGuid)
+        {
+            continue;
+        }
+        for (ULandscapeComponent* LandscapeComp : It->LandscapeComponents)
+        {
+            if (!LandscapeComp || !LandscapeComp->GetHeightmap())
             {
-                // 使用黑色纹理作为占位符（不会被实际使用，因为 bUseLandscapeHeightmap = 0）
-                Params.InLandscapeHeightmap = RHICmdList.CreateShaderResourceView(
-                    GBlackTexture->TextureRHI,
-                    FRHIViewDesc::CreateTextureSRV().SetDimensionFromTexture(GBlackTexture->TextureRHI));
+                continue;
             }
-            Params.InLandscapeHeightmapSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
-            // ClumpBuffer 输入
-            Params.InClumpData0 = ClumpBufferSRV;
-            Params.InClumpData1 = ClumpData1BufferSRV;
-            // ClumpType 参数 Buffer
-            Params.InClumpTypeParams = ClumpTypeParamsBufferSRV;
-            // 输出 Buffers
-            Params.OutPositions = UAV;
-            Params.OutGrassData0 = Data0UAV;
-            Params.OutGrassData1 = Data1UAV;
-            Params.OutGrassData2 = Data2UAV;
-            Params.GridSize = CapturedGridSize;
-            Params.Spacing = CapturedSpacing;
-            Params.JitterStrength = CapturedJitterStrength;
-            Params.NumClumps = CapturedNumClumps;
-            Params.NumClumpTypes = CapturedNumClumpTypes;
-            Params.TaperAmount = CapturedTaperAmount;
-            // Landscape 高度图参数
-            Params.HeightmapScaleBias = CapturedHeightmapScaleBias;
-            Params.LandscapeScale = CapturedLandscapeScale;
-            Params.LandscapeLocation = CapturedLandscapeLocation;
-            Params.ComponentWorldOrigin = CapturedComponentWorldOrigin;
-            Params.ComponentWorldSizeX = CapturedComponentWorldSizeX;
-            Params.ComponentWorldSizeY = CapturedComponentWorldSizeY;
-            Params.bUseLandscapeHeightmap = CapturedUseLandscapeHeightmap ? 1 : 0;
-
-            FComputeShaderUtils::Dispatch(RHICmdList, CS, Params,
-                FIntVector(
-                    FMath::DivideAndRoundUp(CapturedGridSize, 8),
-                    FMath::DivideAndRoundUp(CapturedGridSize, 8),
-                    1));
-
-            RHICmdList.Transition(FRHITransitionInfo(PositionBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-            RHICmdList.Transition(FRHITransitionInfo(GrassData0Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-            RHICmdList.Transition(FRHITransitionInfo(GrassData1Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-            RHICmdList.Transition(FRHITransitionInfo(GrassData2Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-
-            // ========== 创建可见实例位置 Buffer（用于剔除输出）==========
-            if (CapturedEnableFrustumCulling || CapturedUseIndirectDraw)
-            {
-                FRHIBufferCreateDesc VisibleDesc = FRHIBufferCreateDesc::CreateStructured(
-                    TEXT("GrassVisiblePositionBuffer"),
-                    Total * sizeof(FVector3f),
-                    sizeof(FVector3f))
-                    .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                    .SetInitialState(ERHIAccess::CopyDest);
-
-                VisiblePositionBuffer = RHICmdList.CreateBuffer(VisibleDesc);
-
-                // Copy all positions from PositionBuffer to VisiblePositionBuffer as initial data
-                // This ensures rendering works even before culling is executed
-                RHICmdList.Transition(FRHITransitionInfo(PositionBuffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                RHICmdList.CopyBufferRegion(VisiblePositionBuffer, 0, PositionBuffer, 0, Total * sizeof(FVector3f));
-                RHICmdList.Transition(FRHITransitionInfo(PositionBuffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-
-                // UAV for culling output
-                auto VisibleUAVDesc = FRHIViewDesc::CreateBufferUAV()
-                    .SetType(FRHIViewDesc::EBufferType::Structured)
-                    .SetNumElements(Total);
-                VisiblePositionBufferUAV = RHICmdList.CreateUnorderedAccessView(VisiblePositionBuffer, VisibleUAVDesc);
-
-                // SRV for rendering
-                auto VisibleSRVDesc = FRHIViewDesc::CreateBufferSRV()
-                    .SetType(FRHIViewDesc::EBufferType::Structured)
-                    .SetNumElements(Total);
-                VisiblePositionBufferSRV = RHICmdList.CreateShaderResourceView(VisiblePositionBuffer, VisibleSRVDesc);
-
-                // ========== 创建可见实例属性 Buffers（用于剔除输出）==========
-                // VisibleGrassData0: Height, Width, Tilt, Bend (float4)
-                {
-                    FRHIBufferCreateDesc VisibleData0Desc = FRHIBufferCreateDesc::CreateStructured(
-                        TEXT("GrassVisibleData0Buffer"),
-                        Total * sizeof(FVector4f),
-                        sizeof(FVector4f))
-                        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                        .SetInitialState(ERHIAccess::CopyDest);
-                    VisibleGrassData0Buffer = RHICmdList.CreateBuffer(VisibleData0Desc);
-                    
-                    // Copy initial data
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData0Buffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                    RHICmdList.CopyBufferRegion(VisibleGrassData0Buffer, 0, GrassData0Buffer, 0, Total * sizeof(FVector4f));
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData0Buffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0Buffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-                    
-                    auto VisibleData0UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData0BufferUAV = RHICmdList.CreateUnorderedAccessView(VisibleGrassData0Buffer, VisibleData0UAVDesc);
-                    auto VisibleData0SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData0BufferSRV = RHICmdList.CreateShaderResourceView(VisibleGrassData0Buffer, VisibleData0SRVDesc);
-                }
-                
-                // VisibleGrassData1: TaperAmount, FacingDir.x, FacingDir.y, P1Offset (float4)
-                {
-                    FRHIBufferCreateDesc VisibleData1Desc = FRHIBufferCreateDesc::CreateStructured(
-                        TEXT("GrassVisibleData1Buffer"),
-                        Total * sizeof(FVector4f),
-                        sizeof(FVector4f))
-                        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                        .SetInitialState(ERHIAccess::CopyDest);
-                    VisibleGrassData1Buffer = RHICmdList.CreateBuffer(VisibleData1Desc);
-                    
-                    // Copy initial data
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData1Buffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                    RHICmdList.CopyBufferRegion(VisibleGrassData1Buffer, 0, GrassData1Buffer, 0, Total * sizeof(FVector4f));
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData1Buffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1Buffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-                    
-                    auto VisibleData1UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData1BufferUAV = RHICmdList.CreateUnorderedAccessView(VisibleGrassData1Buffer, VisibleData1UAVDesc);
-                    auto VisibleData1SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData1BufferSRV = RHICmdList.CreateShaderResourceView(VisibleGrassData1Buffer, VisibleData1SRVDesc);
-                }
-                
-                // VisibleGrassData2: P2Offset (float)
-                {
-                    FRHIBufferCreateDesc VisibleData2Desc = FRHIBufferCreateDesc::CreateStructured(
-                        TEXT("GrassVisibleData2Buffer"),
-                        Total * sizeof(float),
-                        sizeof(float))
-                        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                        .SetInitialState(ERHIAccess::CopyDest);
-                    VisibleGrassData2Buffer = RHICmdList.CreateBuffer(VisibleData2Desc);
-                    
-                    // Copy initial data
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData2Buffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                    RHICmdList.CopyBufferRegion(VisibleGrassData2Buffer, 0, GrassData2Buffer, 0, Total * sizeof(float));
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData2Buffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2Buffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-                    
-                    auto VisibleData2UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData2BufferUAV = RHICmdList.CreateUnorderedAccessView(VisibleGrassData2Buffer, VisibleData2UAVDesc);
-                    auto VisibleData2SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData2BufferSRV = RHICmdList.CreateShaderResourceView(VisibleGrassData2Buffer, VisibleData2SRVDesc);
-                }
 
-                UE_LOG(LogTemp, Log, TEXT("Created Visible Buffers for GPU Culling (initialized with all %d instances)"), Total);
+            const FBox2D Rect = GetComponentRect(*It, LandscapeComp);
+            bool bCovered = false;
+            switch (LandscapeCoverage)
+            {
+            case EGrassLandscapeCoverage::ContainingComponent:
+                bCovered = LandscapeComp == ContainingComp;
+                break;
+            case EGrassLandscapeCoverage::GridFootprint:
+                bCovered = Rect.Intersect(Footprint);
+                break;
+            case EGrassLandscapeCoverage::EntireLandscape:
+                bCovered = true;
+                break;
             }
-
-            // ========== 创建 Indirect Draw Args Buffer (LOD 0 - 15 顶点, 39 索引) ==========
-            if (CapturedUseIndirectDraw)
+            if (bCovered)
             {
-                const uint32 IndirectArgsSize = 5 * sizeof(uint32);
-                
-                // LOD 0 IndirectArgsBuffer
-                FRHIBufferCreateDesc IndirectDesc = FRHIBufferCreateDesc::Create(
-                    TEXT("GrassIndirectArgsBuffer"),
-                    IndirectArgsSize,
-                    sizeof(uint32),
-                    EBufferUsageFlags::DrawIndirect | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                    .SetInitialState(ERHIAccess::IndirectArgs);
-                
-                IndirectArgsBuffer = RHICmdList.CreateBuffer(IndirectDesc);
-
-                // 创建 UAV 用于 Culling Shader 写入
-                auto IndirectUAVDesc = FRHIViewDesc::CreateBufferUAV()
-                    .SetType(FRHIViewDesc::EBufferType::Raw);
-                IndirectArgsBufferUAV = RHICmdList.CreateUnorderedAccessView(IndirectArgsBuffer, IndirectUAVDesc);
-                
-                // 初始化 Indirect Args for LOD 0
-                RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::IndirectArgs, ERHIAccess::CopyDest));
-                uint32* IndirectArgs = (uint32*)RHICmdList.LockBuffer(IndirectArgsBuffer, 0, IndirectArgsSize, RLM_WriteOnly);
-                IndirectArgs[0] = 39;    // IndexCountPerInstance (15 vertices, 13 triangles = 39 indices)
-                IndirectArgs[1] = Total; // InstanceCount
-                IndirectArgs[2] = 0;     // StartIndexLocation
-                IndirectArgs[3] = 0;     // BaseVertexLocation
-                IndirectArgs[4] = 0;     // StartInstanceLocation
-                RHICmdList.UnlockBuffer(IndirectArgsBuffer);
-                RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::CopyDest, ERHIAccess::IndirectArgs));
-                
-                UE_LOG(LogTemp, Log, TEXT("Created IndirectArgsBuffer (LOD 0) with UAV for GPU Culling"));
-
-                // ========== 创建 LOD 1 的 Indirect Draw Args Buffer (7 顶点, 15 索引) ==========
-                FRHIBufferCreateDesc IndirectDescLOD1 = FRHIBufferCreateDesc::Create(
-                    TEXT("GrassIndirectArgsBufferLOD1"),
-                    IndirectArgsSize,
-                    sizeof(uint32),
-                    EBufferUsageFlags::DrawIndirect | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
-                    .SetInitialState(ERHIAccess::IndirectArgs);
-                
-                IndirectArgsBufferLOD1 = RHICmdList.CreateBuffer(IndirectDescLOD1);
-
-                // 创建 UAV 用于 Culling Shader 写入
-                auto IndirectUAVDescLOD1 = FRHIViewDesc::CreateBufferUAV()
-                    .SetType(FRHIViewDesc::EBufferType::Raw);
-                IndirectArgsBufferLOD1UAV = RHICmdList.CreateUnorderedAccessView(IndirectArgsBufferLOD1, IndirectUAVDescLOD1);
-                
-                // 初始化 Indirect Args for LOD 1
-                RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::IndirectArgs, ERHIAccess::CopyDest));
-                uint32* IndirectArgsLOD1 = (uint32*)RHICmdList.LockBuffer(IndirectArgsBufferLOD1, 0, IndirectArgsSize, RLM_WriteOnly);
-                IndirectArgsLOD1[0] = 15;    // IndexCountPerInstance (7 vertices, 5 triangles = 15 indices)
-                IndirectArgsLOD1[1] = 0;     // InstanceCount (starts at 0, filled by culling shader)
-                IndirectArgsLOD1[2] = 0;     // StartIndexLocation
-                IndirectArgsLOD1[3] = 0;     // BaseVertexLocation
-                IndirectArgsLOD1[4] = 0;     // StartInstanceLocation (LOD 1 从 index 0 开始)
-                RHICmdList.UnlockBuffer(IndirectArgsBufferLOD1);
-                RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::CopyDest, ERHIAccess::IndirectArgs));
-                
-                UE_LOG(LogTemp, Log, TEXT("Created IndirectArgsBufferLOD1 with UAV for GPU Culling"));
-
-                // ========== 创建 LOD 1 的独立 Visible Buffers ==========
-                // LOD 1 使用独立的 buffer，从 index 0 开始存储，避免与 LOD 0 冲突
-                
-                // VisiblePositionBufferLOD1
-                {
-                    FRHIBufferCreateDesc VisibleDescLOD1 = FRHIBufferCreateDesc::CreateStructured(
-                        TEXT("GrassVisiblePositionBufferLOD1"),
-                        Total * sizeof(FVector3f),
-                        sizeof(FVector3f))
-                        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                        .SetInitialState(ERHIAccess::CopyDest);
-
-                    VisiblePositionBufferLOD1 = RHICmdList.CreateBuffer(VisibleDescLOD1);
-
-                    // Copy initial data to ensure valid data before GPU Culling runs
-                    RHICmdList.Transition(FRHITransitionInfo(PositionBuffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                    RHICmdList.CopyBufferRegion(VisiblePositionBufferLOD1, 0, PositionBuffer, 0, Total * sizeof(FVector3f));
-                    RHICmdList.Transition(FRHITransitionInfo(PositionBuffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                    RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBufferLOD1, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-
-                    auto VisibleLOD1UAVDesc = FRHIViewDesc::CreateBufferUAV()
-                        .SetType(FRHIViewDesc::EBufferType::Structured)
-                        .SetNumElements(Total);
-                    VisiblePositionBufferLOD1UAV = RHICmdList.CreateUnorderedAccessView(VisiblePositionBufferLOD1, VisibleLOD1UAVDesc);
-
-                    auto VisibleLOD1SRVDesc = FRHIViewDesc::CreateBufferSRV()
-                        .SetType(FRHIViewDesc::EBufferType::Structured)
-                        .SetNumElements(Total);
-                    VisiblePositionBufferLOD1SRV = RHICmdList.CreateShaderResourceView(VisiblePositionBufferLOD1, VisibleLOD1SRVDesc);
-                }
-
-                // VisibleGrassData0BufferLOD1
-                {
-                    FRHIBufferCreateDesc VisibleData0DescLOD1 = FRHIBufferCreateDesc::CreateStructured(
-                        TEXT("GrassVisibleData0BufferLOD1"),
-                        Total * sizeof(FVector4f),
-                        sizeof(FVector4f))
-                        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                        .SetInitialState(ERHIAccess::CopyDest);
-                    VisibleGrassData0BufferLOD1 = RHICmdList.CreateBuffer(VisibleData0DescLOD1);
-                    
-                    // Copy initial data
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData0Buffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                    RHICmdList.CopyBufferRegion(VisibleGrassData0BufferLOD1, 0, GrassData0Buffer, 0, Total * sizeof(FVector4f));
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData0Buffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0BufferLOD1, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-                    
-                    auto VisibleData0LOD1UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData0BufferLOD1UAV = RHICmdList.CreateUnorderedAccessView(VisibleGrassData0BufferLOD1, VisibleData0LOD1UAVDesc);
-                    auto VisibleData0LOD1SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData0BufferLOD1SRV = RHICmdList.CreateShaderResourceView(VisibleGrassData0BufferLOD1, VisibleData0LOD1SRVDesc);
-                }
-                
-                // VisibleGrassData1BufferLOD1
-                {
-                    FRHIBufferCreateDesc VisibleData1DescLOD1 = FRHIBufferCreateDesc::CreateStructured(
-                        TEXT("GrassVisibleData1BufferLOD1"),
-                        Total * sizeof(FVector4f),
-                        sizeof(FVector4f))
-                        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                        .SetInitialState(ERHIAccess::CopyDest);
-                    VisibleGrassData1BufferLOD1 = RHICmdList.CreateBuffer(VisibleData1DescLOD1);
-                    
-                    // Copy initial data
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData1Buffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                    RHICmdList.CopyBufferRegion(VisibleGrassData1BufferLOD1, 0, GrassData1Buffer, 0, Total * sizeof(FVector4f));
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData1Buffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1BufferLOD1, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-                    
-                    auto VisibleData1LOD1UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData1BufferLOD1UAV = RHICmdList.CreateUnorderedAccessView(VisibleGrassData1BufferLOD1, VisibleData1LOD1UAVDesc);
-                    auto VisibleData1LOD1SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData1BufferLOD1SRV = RHICmdList.CreateShaderResourceView(VisibleGrassData1BufferLOD1, VisibleData1LOD1SRVDesc);
-                }
-                
-                // VisibleGrassData2BufferLOD1
-                {
-                    FRHIBufferCreateDesc VisibleData2DescLOD1 = FRHIBufferCreateDesc::CreateStructured(
-                        TEXT("GrassVisibleData2BufferLOD1"),
-                        Total * sizeof(float),
-                        sizeof(float))
-                        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource | EBufferUsageFlags::SourceCopy)
-                        .SetInitialState(ERHIAccess::CopyDest);
-                    VisibleGrassData2BufferLOD1 = RHICmdList.CreateBuffer(VisibleData2DescLOD1);
-                    
-                    // Copy initial data
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData2Buffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
-                    RHICmdList.CopyBufferRegion(VisibleGrassData2BufferLOD1, 0, GrassData2Buffer, 0, Total * sizeof(float));
-                    RHICmdList.Transition(FRHITransitionInfo(GrassData2Buffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
-                    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2BufferLOD1, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
-                    
-                    auto VisibleData2LOD1UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData2BufferLOD1UAV = RHICmdList.CreateUnorderedAccessView(VisibleGrassData2BufferLOD1, VisibleData2LOD1UAVDesc);
-                    auto VisibleData2LOD1SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(Total);
-                    VisibleGrassData2BufferLOD1SRV = RHICmdList.CreateShaderResourceView(VisibleGrassData2BufferLOD1, VisibleData2LOD1SRVDesc);
-                }
-
-                UE_LOG(LogTemp, Log, TEXT("Created LOD 1 independent Visible Buffers (initialized with all %d instances)"), Total);
+                UTexture2D* Weightmap = nullptr;
+                int32 WeightmapChannel = INDEX_NONE;
+                FindDensityWeightmap(LandscapeComp, Weightmap, WeightmapChannel);
+                Sources.Add({ LandscapeComp, Rect, LandscapeComp->GetHeightmap()->GetPathName(),
+                    Weightmap, WeightmapChannel, Weightmap ? Weightmap->GetPathName() : FString() });
             }
         }
-    );
+    }
 
-    FlushRenderingCommands();
-    MarkRenderStateDirty();
+    // 按高度图和权重图分组 (渲染线程每组一次 Dispatch)，组内按 SectionBase 排序，保证分块顺序稳定 (实例缓存 Key 依赖分块顺序)
+    Sources.Sort([](const FLandscapeTileSource& A, const FLandscapeTileSource& B)
+    {
+        if (A.HeightmapName != B.HeightmapName)
+        {
+            return A.HeightmapName < B.HeightmapName;
+        }
+        if (A.WeightmapName != B.WeightmapName)
+        {
+            return A.WeightmapName < B.WeightmapName;
+        }
+        if (A.Component->SectionBaseY != B.Component->SectionBaseY)
+        {
+            return A.Component->SectionBaseY < B.Component->SectionBaseY;
+        }
+        return A.Component->SectionBaseX < B.Component->SectionBaseX;
+    });
+
+    // 同一个 Landscape 的 Component 尺寸相同，所有分块共享 GridSize
+    // 保持用户设置的 Spacing (草叶密度)，自动计算铺满 Component 所需的 GridSize
+    const FVector2D CompWorldSize(ContainingProxy->GetActorScale3D() * ContainingComp->ComponentSizeQuads);
+    GenParams.GridSize = FMath::CeilToInt(FMath::Max(CompWorldSize.X, CompWorldSize.Y) / GenParams.Spacing);
+    GenParams.GridSize = FMath::Clamp(GenParams.GridSize, 2, 1024);
+
+    const FVector LandscapeScale = ContainingProxy->GetActorScale3D();
+    const FVector LandscapeLoc = ContainingProxy->GetActorLocation();
+    GenParams.bUseLandscapeHeightmap = true;
+    GenParams.LandscapeScale = FVector3f(LandscapeScale);
+    GenParams.LandscapeLocation = FVector3f(LandscapeLoc);
+
+    const int32 ComponentSizeQuads = FMath::Max(ContainingComp->ComponentSizeQuads, 1);
+    TSet<const FTextureResource*> Heightmaps;
+    for (const FLandscapeTileSource& Source : Sources)
+    {
+        const ULandscapeComponent* LandscapeComp = Source.Component;
+        const FVector2D TileSize = Source.Rect.GetSize();
+
+        FGrassGenerationTile& Tile = GenParams.Tiles.AddDefaulted_GetRef();
+        Tile.TileMin = FVector2f(Source.Rect.Min - Location2D);
+        Tile.TileSize = FVector2f(TileSize);
+        // 草叶位于网格单元格中心，相邻分块的边界上不会重复
+        Tile.CellSize = Tile.TileSize / (float)GenParams.GridSize;
+        Tile.SampleOrigin = Tile.TileMin + Tile.CellSize * 0.5f;
+        Tile.SeedOffset = FIntPoint(
+            LandscapeComp->SectionBaseX / ComponentSizeQuads * GenParams.GridSize,
+            LandscapeComp->SectionBaseY / ComponentSizeQuads * GenParams.GridSize);
+        Tile.HeightmapScaleBias = FVector4f(LandscapeComp->HeightmapScaleBias);
+        Tile.HeightmapResource = LandscapeComp->GetHeightmap()->GetResource();
+        Tile.HeightmapContentHash = FGrassInstanceCache::HashTexture(LandscapeComp->GetHeightmap());
+        Heightmaps.Add(Tile.HeightmapResource);
+
+        if (Source.Weightmap)
+        {
+            Tile.WeightmapScaleBias = FVector4f(LandscapeComp->WeightmapScaleBias);
+            Tile.WeightmapChannelMask[Source.WeightmapChannel] = 1.0f;
+            Tile.WeightmapResource = Source.Weightmap->GetResource();
+            Tile.WeightmapContentHash = FGrassInstanceCache::HashTexture(Source.Weightmap);
+        }
+    }
 
-    UE_LOG(LogTemp, Log, TEXT("Done. %d grass instances ready."), InstanceCount);
+    UE_LOG(LogTemp, Log, TEXT("Covering %d Landscape Component(s) with %d heightmap(s): GridSize=%d per tile, Spacing=%.1f, Total=%d instances"),
+        GenParams.Tiles.Num(), Heightmaps.Num(), GenParams.GridSize, GenParams.Spacing, GenParams.GetInstanceCount());
+    UE_LOG(LogTemp, Log, TEXT("  LandscapeScale: (%.1f, %.1f, %.1f), Location: (%.1f, %.1f, %.1f)"),
+        LandscapeScale.X, LandscapeScale.Y, LandscapeScale.Z,
+        LandscapeLoc.X, LandscapeLoc.Y, LandscapeLoc.Z);
 }
 
-FPrimitiveSceneProxy* UGrassComponent::CreateSceneProxy()
+void UGrassComponent::FinishCacheLoad()
 {
-    if (InstanceCount == 0 || !PositionBufferSRV.IsValid())
+    check(IsInGameThread());
+
+    FGrassCpuInstanceDataPtr CachedData = PendingCacheLoad.Get();
+    PendingCacheLoad.Reset();
+
+    FGrassGenerationParams GenParams = MoveTemp(PendingCacheParams);
+    PendingCacheParams = FGrassGenerationParams();
+
+    TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> CacheReadback;
+    if (CachedData.IsValid())
     {
-        UE_LOG(LogTemp, Warning, TEXT("CreateSceneProxy: InstanceCount=%d, SRV Valid=%d"), InstanceCount, PositionBufferSRV.IsValid());
-        return nullptr;
+        const double LoadSeconds = FPlatformTime::Seconds() - CacheRequestStartTime;
+        FGrassInstanceCache::RecordHit(CachedData->GetAllocatedSize(), LoadSeconds);
+        UE_LOG(LogTemp, Log, TEXT("GrassInstanceCache: Loaded %d instances from %s in %.2f ms"), CachedData->Num(), *PendingCacheKey, LoadSeconds * 1000.0);
+
+        GenParams.CpuInstanceData = CachedData;
     }
-    UE_LOG(LogTemp, Log, TEXT("CreateSceneProxy: Creating FGrassSceneProxy with GPU Culling=%d"), bEnableFrustumCulling ? 1 : 0);
-    return new FGrassSceneProxy(this);
-}
+    else
+    {
+        // 文件损坏或版本不匹配：重新生成并覆盖
+        CacheReadback = MakeShared<FGrassCacheReadback, ESPMode::ThreadSafe>(PendingCacheKey);
+        bRecordCacheMiss = true;
+    }
+    PendingCacheKey.Reset();
 
-FBoxSphereBounds UGrassComponent::CalcBounds(const FTransform& LocalToWorld) const
-{
-    float HalfSize = GridSize * Spacing * 0.5f + 100.0f;
-    // 使用更大的 Z 范围以容纳地形高度变化
-    float ZMin = -5000.0f;
-    float ZMax = 5000.0f;
-    FBox Box(FVector(-HalfSize, -HalfSize, ZMin), FVector(HalfSize, HalfSize, ZMax));
-    return FBoxSphereBounds(Box).TransformBy(LocalToWorld);
+    // SubmitGeneration 会重新设置生成状态
+    bGenerationInFlight = false;
+    SubmitGeneration(GenParams, CacheReadback);
 }
 
-void UGrassComponent::GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials) const
+void UGrassComponent::SubmitGeneration(const FGrassGenerationParams& GenParams, TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> CacheReadback)
 {
-    if (GrassMaterial)
+    // 异步模式下新 Buffer 在渲染线程直接交换到当前的 Proxy，交换前旧草地保持渲染
+    // 渲染命令按顺序执行，Proxy 的销毁一定排在本命令之后，所以这里捕获裸指针是安全的
+    FGrassSceneProxy* TargetProxy = bAsyncGeneration ? static_cast<FGrassSceneProxy*>(SceneProxy) : nullptr;
+    GenerationProxy = TargetProxy;
+    bGenerationInFlight = true;
+
+    // CPU 数据 (CPU 生成 / 实例缓存) 只上传，渲染线程不修改 Clump 数据；否则复用或重新生成与 GenParams 一致的 Clump 数据
+    PendingClumpCacheKey = GenParams.CpuInstanceData.IsValid()
+        ? ClumpCacheKey
+        : TOptional<FGrassClumpCacheKey>(FGrassClumpVoronoi::ComputeCacheKey(GenParams.NumClumps, GenParams.NumClumpTypes, GenParams.VoronoiTextureSize));
+
+    // GPU 生成的密度剔除：存活数量读回后才紧凑拷贝 (FinishGeneration)，缓存回读和 Proxy 交换也推迟到那时
+    TSharedPtr<FGrassCompactionReadback, ESPMode::ThreadSafe> CompactionReadback;
+    if (GenParams.UsesDensity() && !GenParams.CpuInstanceData.IsValid())
     {
-        OutMaterials.Add(GrassMaterial);
+        CompactionReadback = MakeShared<FGrassCompactionReadback, ESPMode::ThreadSafe>(GenParams, CacheReadback);
     }
-}
+    PendingCompaction = CompactionReadback;
 
-#if WITH_EDITOR
-void UGrassComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
-{
+    ENQUEUE_RENDER_COMMAND(GenerateGrassPositions)(
+        [this, GenParams, TargetProxy, CacheReadback, CompactionReadback](FRHICommandListImmediate& RHICmdList)
+        {
+            GenerateGrass_RenderThread(RHICmdList, GenParams, PendingInstanceBuffers, CompactionReadback.Get());
+
+            if (CompactionReadback.IsValid())
+            {
+                return;
+            }
+
+            if (CacheReadback.IsValid())
+            {
+                CacheReadback->EnqueueCopy_RenderThread(RHICmdList, PendingInstanceBuffers);
+            }
+
+            if (TargetProxy)
+            {
+                TargetProxy->SwapInstanceBuffers_RenderThread(PendingInstanceBuffers);
+            }
+        }
+    );
+
+    if (CacheReadback.IsValid() && !CompactionReadback.IsValid())
+    {
+        PendingCacheReadback = CacheReadback;
+    }
+
+    if (bAsyncGeneration)
+    {
+        // 完成后由 TickComponent / WaitForGeneration 调用 FinishGeneration
+        GenerationFence.BeginFence();
+        return;
+    }
+
+    // 同步模式要求返回时实例数量已经确定：在渲染线程等待 GPU 读回存活数量
+    FlushRenderingCommands();
+    if (PendingCompaction.IsValid())
+    {
+        EnqueueCompaction(true);
+        FlushRenderingCommands();
+    }
+    FinishGeneration();
+}
+
+void UGrassComponent::EnqueueCompaction(bool bWait)
+{
+    check(IsInGameThread() && PendingCompaction.IsValid());
+
+    // 生成期间 Proxy 被重建时不交换 (FinishGeneration 会用新 Buffer 重新创建 Proxy)；
+    // SceneProxy 仍是 GenerationProxy 时，它的销毁一定排在本命令之后
+    FGrassSceneProxy* TargetProxy = (GenerationProxy != nullptr && SceneProxy == GenerationProxy) ? GenerationProxy : nullptr;
+
+    ENQUEUE_RENDER_COMMAND(CompactGrassInstances)(
+        [this, Compaction = PendingCompaction, TargetProxy, bWait](FRHICommandListImmediate& RHICmdList)
+        {
+            if (Compaction->IsReady() || !Compaction->Poll_RenderThread(RHICmdList, bWait))
+            {
+                return;
+            }
+
+            CompactInstanceBuffers_RenderThread(RHICmdList, Compaction->GenParams, Compaction->GetNumSurvivors(), PendingInstanceBuffers);
+
+            if (Compaction->CacheReadback.IsValid())
+            {
+                Compaction->CacheReadback->EnqueueCopy_RenderThread(RHICmdList, PendingInstanceBuffers);
+            }
+
+            if (TargetProxy)
+            {
+                TargetProxy->SwapInstanceBuffers_RenderThread(PendingInstanceBuffers);
+            }
+        }
+    );
+
+    GenerationFence.BeginFence();
+}
+
+void UGrassComponent::FinishGeneration()
+{
+    check(IsInGameThread());
+
+    // 密度剔除的存活数量还没有读回：每帧尝试一次紧凑拷贝，完成 (下一次 GenerationFence 通过) 之后再提交
+    if (PendingCompaction.IsValid())
+    {
+        if (!PendingCompaction->IsReady())
+        {
+            EnqueueCompaction(false);
+            return;
+        }
+        if (PendingCompaction->CacheReadback.IsValid())
+        {
+            PendingCacheReadback = PendingCompaction->CacheReadback;
+        }
+        PendingCompaction.Reset();
+    }
+
+    bGenerationInFlight = false;
+
+    // 渲染线程已经写完 PendingInstanceBuffers，提交为当前 Buffer
+    InstanceBuffers = MoveTemp(PendingInstanceBuffers);
+    PendingInstanceBuffers = FGrassInstanceBuffers();
+
+    // Clump 数据也已经写完，之后的生成可以按这个 Key 复用
+    ClumpCacheKey = PendingClumpCacheKey;
+    PendingClumpCacheKey.Reset();
+
+    // 使用密度遮罩时实际数量在 GPU 生成后才确定
+    InstanceCount = InstanceBuffers.InstanceCount;
+
+    // 任何一次完成的生成都让被释放的组件重新常驻
+    bInstanceDataEvicted = false;
+    EvictedGpuBytes = 0;
+    ResidentSinceTime = FPlatformTime::Seconds();
+    UpdateMemoryStats();
+
+    // 同步模式、首次生成 (还没有 Proxy) 或者生成期间 Proxy 被重建时，需要用新 Buffer 重新创建 Proxy
+    if (SceneProxy == nullptr || SceneProxy != GenerationProxy)
+    {
+        MarkRenderStateDirty();
+    }
+    GenerationProxy = nullptr;
+
+    UE_LOG(LogTemp, Log, TEXT("Done. %d grass instances ready."), InstanceBuffers.InstanceCount);
+
+    if (bRecordCacheMiss)
+    {
+        FGrassInstanceCache::RecordMiss(FPlatformTime::Seconds() - CacheRequestStartTime);
+        bRecordCacheMiss = false;
+    }
+
+    OnGenerationComplete.Broadcast(InstanceBuffers.InstanceCount);
+
+    if (RequestedStages != EGrassGenerationStage::None)
+    {
+        const EGrassGenerationStage NextStages = RequestedStages;
+        RequestedStages = EGrassGenerationStage::None;
+        RegenerateStages(NextStages);
+    }
+}
+
+void UGrassComponent::WaitForGeneration()
+{
+    // 还在调度器队列中的请求立即发起
+    if (UGrassGenerationSubsystem* Scheduler = GetWorld() ? GetWorld()->GetSubsystem<UGrassGenerationSubsystem>() : nullptr)
+    {
+        Scheduler->FlushGeneration(this);
+    }
+
+    // FinishGeneration 可能发起被合并的下一次生成，循环直到全部完成
+    while (bGenerationInFlight)
+    {
+        if (PendingCacheLoad.IsValid())
+        {
+            PendingCacheLoad.Wait();
+            FinishCacheLoad();
+            continue;
+        }
+        GenerationFence.Wait();
+        if (PendingCompaction.IsValid() && !PendingCompaction->IsReady())
+        {
+            // 调用者要求阻塞：在渲染线程等待 GPU 读回存活数量
+            EnqueueCompaction(true);
+            GenerationFence.Wait();
+        }
+        FinishGeneration();
+    }
+}
+
+bool UGrassComponent::EvictInstanceData()
+{
+    check(IsInGameThread());
+
+    if (bGenerationInFlight || !InstanceBuffers.IsValid())
+    {
+        return false;
+    }
+
+    EvictedGpuBytes = GetResidentGpuBytes();
+    bInstanceDataEvicted = true;
+
+    // Proxy 持有的那份 Buffer 在 Proxy 销毁后释放，Buffer 池区间在渲染线程归还
+    InstanceBuffers = FGrassInstanceBuffers();
+    CpuInstanceData.Reset();
+    MarkRenderStateDirty();
+    UpdateMemoryStats();
+
+    UE_LOG(LogTemp, Log, TEXT("GrassComponent %s: evicted %.2f MB of instance data"), *GetPathName(), EvictedGpuBytes / (1024.0 * 1024.0));
+    return true;
+}
+
+void UGrassComponent::ReloadInstanceData()
+{
+    if (!bInstanceDataEvicted)
+    {
+        return;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("GrassComponent %s: reloading evicted instance data"), *GetPathName());
+    GenerateGrass();
+}
+
+void UGrassComponent::UpdateMemoryStats()
+{
+    const FGrassMemoryFootprint Footprint = IsRegistered() ? GetGpuMemoryFootprint() : FGrassMemoryFootprint();
+    FGrassMemoryFootprint::UpdateStats(ReportedMemoryFootprint, Footprint);
+    ReportedMemoryFootprint = Footprint;
+}
+
+bool UGrassComponent::IsReadyForFinishDestroy()
+{
+    // 生成命令捕获了 this，必须等渲染线程执行完毕才能释放
+    return Super::IsReadyForFinishDestroy() && GenerationFence.IsFenceComplete();
+}
+
+// ============================================================================
+// 实例 Buffer 创建 (GPU 生成和 CPU 上传共用)
+// ============================================================================
+/** 从 Buffer 池分配一段区间，并把页的 Buffer / 视图 / 偏移写入 FGrassInstanceBuffers 的对应字段 */
+static void AllocateFromArena_RenderThread(FRHICommandListImmediate& RHICmdList, EGrassBufferPool Pool, uint32 Count, bool bDedicated,
+    FGrassBufferAllocationRef& OutAllocation, FBufferRHIRef& OutBuffer, FShaderResourceViewRHIRef& OutSRV, FUnorderedAccessViewRHIRef& OutUAV, uint32& OutOffset)
+{
+    OutAllocation = FGrassBufferArena::Get().Allocate(RHICmdList, Pool, Count, bDedicated);
+    OutBuffer = OutAllocation->Buffer;
+    OutSRV = OutAllocation->SRV;
+    OutUAV = OutAllocation->UAV;
+    OutOffset = OutAllocation->Offset;
+}
+
+/**
+ * 分配实例区间 (所有实例属性压缩在 16 字节 uint4 中，布局见 GrassInstancePacking.ush)
+ * 页在分配后处于 SRVMask 状态；bDedicated 用于密度剔除前的网格大小临时输出，紧凑拷贝后整页释放
+ */
+static void AllocateInstanceBuffers_RenderThread(FRHICommandListImmediate& RHICmdList, int32 Total, FGrassInstanceBuffers& OutBuffers, bool bDedicated = false)
+{
+    AllocateFromArena_RenderThread(RHICmdList, EGrassBufferPool::Instances, Total, bDedicated,
+        OutBuffers.InstanceAllocation, OutBuffers.InstanceBuffer, OutBuffers.InstanceBufferSRV, OutBuffers.InstanceBufferUAV, OutBuffers.InstanceOffset);
+}
+
+/**
+ * 分配一个剔除输出区间，剔除执行之前也能正常渲染所有实例：
+ * bVisibleIndexLists 时填充 0..N-1 的实例索引 (相对于 InstanceOffset)，否则拷贝已经生成好的实例
+ */
+static void CreateVisibleInstanceBuffer_RenderThread(FRHICommandListImmediate& RHICmdList, FGrassInstanceBuffers& OutBuffers,
+    FGrassBufferAllocationRef& OutAllocation, FBufferRHIRef& OutBuffer, FShaderResourceViewRHIRef& OutSRV, FUnorderedAccessViewRHIRef& OutUAV, uint32& OutOffset)
+{
+    const int32 Total = OutBuffers.InstanceCount;
+    const EGrassBufferPool Pool = OutBuffers.bVisibleIndexLists ? EGrassBufferPool::VisibleIndices : EGrassBufferPool::VisibleInstances;
+    const uint32 Stride = FGrassBufferArena::GetStride(Pool);
+
+    AllocateFromArena_RenderThread(RHICmdList, Pool, Total, false, OutAllocation, OutBuffer, OutSRV, OutUAV, OutOffset);
+
+    RHICmdList.Transition(FRHITransitionInfo(OutBuffer, ERHIAccess::SRVMask, ERHIAccess::CopyDest));
+    if (OutBuffers.bVisibleIndexLists)
+    {
+        uint32* Indices = static_cast<uint32*>(RHICmdList.LockBuffer(OutBuffer, OutOffset * Stride, Total * Stride, RLM_WriteOnly));
+        for (int32 i = 0; i < Total; ++i)
+        {
+            Indices[i] = (uint32)i;
+        }
+        RHICmdList.UnlockBuffer(OutBuffer);
+    }
+    else
+    {
+        // 实例和可见实例拷贝来自不同的池，不会是同一个 Buffer
+        RHICmdList.Transition(FRHITransitionInfo(OutBuffers.InstanceBuffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
+        RHICmdList.CopyBufferRegion(OutBuffer, OutOffset * Stride, OutBuffers.InstanceBuffer, OutBuffers.InstanceOffset * Stride, Total * Stride);
+        RHICmdList.Transition(FRHITransitionInfo(OutBuffers.InstanceBuffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
+    }
+    RHICmdList.Transition(FRHITransitionInfo(OutBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
+}
+
+/** 创建剔除输出 (Visible Buffers) 和 Indirect Args，初始内容直接对应所有实例 */
+static void CreateCullingBuffers_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassGenerationParams& GenParams, FGrassInstanceBuffers& OutBuffers)
+{
+    const int32 Total = OutBuffers.InstanceCount;
+
+    // ========== 创建可见实例 Buffer（用于剔除输出）==========
+    if (GenParams.bEnableFrustumCulling || GenParams.bUseIndirectDraw)
+    {
+        OutBuffers.bVisibleIndexLists = GenParams.bVisibleIndexLists;
+        CreateVisibleInstanceBuffer_RenderThread(RHICmdList, OutBuffers, OutBuffers.VisibleInstanceAllocation,
+            OutBuffers.VisibleInstanceBuffer, OutBuffers.VisibleInstanceBufferSRV, OutBuffers.VisibleInstanceBufferUAV, OutBuffers.VisibleInstanceOffset);
+
+        UE_LOG(LogTemp, Log, TEXT("Created Visible Buffers for GPU Culling (initialized with all %d instances, IndexLists=%d)"), Total, OutBuffers.bVisibleIndexLists ? 1 : 0);
+    }
+
+    // ========== 创建 Indirect Draw Args Buffer (LOD 0 - 15 顶点, 39 索引) ==========
+    if (GenParams.bUseIndirectDraw)
+    {
+        LLM_SCOPE_BYTAG(Grass_IndirectArgs);
+        const uint32 IndirectArgsSize = 5 * sizeof(uint32);
+        
+        // LOD 0 IndirectArgsBuffer
+        FRHIBufferCreateDesc IndirectDesc = FRHIBufferCreateDesc::Create(
+            TEXT("GrassIndirectArgsBuffer"),
+            IndirectArgsSize,
+            sizeof(uint32),
+            EBufferUsageFlags::DrawIndirect | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+            .SetInitialState(ERHIAccess::IndirectArgs);
+        
+        OutBuffers.IndirectArgsBuffer = RHICmdList.CreateBuffer(IndirectDesc);
+
+        // 创建 UAV 用于 Culling Shader 写入
+        auto IndirectUAVDesc = FRHIViewDesc::CreateBufferUAV()
+            .SetType(FRHIViewDesc::EBufferType::Raw);
+        OutBuffers.IndirectArgsBufferUAV = RHICmdList.CreateUnorderedAccessView(OutBuffers.IndirectArgsBuffer, IndirectUAVDesc);
+        
+        // 初始化 Indirect Args for LOD 0
+        RHICmdList.Transition(FRHITransitionInfo(OutBuffers.IndirectArgsBuffer, ERHIAccess::IndirectArgs, ERHIAccess::CopyDest));
+        uint32* IndirectArgs = (uint32*)RHICmdList.LockBuffer(OutBuffers.IndirectArgsBuffer, 0, IndirectArgsSize, RLM_WriteOnly);
+        IndirectArgs[0] = 39;    // IndexCountPerInstance (15 vertices, 13 triangles = 39 indices)
+        IndirectArgs[1] = Total; // InstanceCount
+        IndirectArgs[2] = 0;     // StartIndexLocation
+        IndirectArgs[3] = 0;     // BaseVertexLocation
+        IndirectArgs[4] = 0;     // StartInstanceLocation
+        RHICmdList.UnlockBuffer(OutBuffers.IndirectArgsBuffer);
+        RHICmdList.Transition(FRHITransitionInfo(OutBuffers.IndirectArgsBuffer, ERHIAccess::CopyDest, ERHIAccess::IndirectArgs));
+        
+        UE_LOG(LogTemp, Log, TEXT("Created IndirectArgsBuffer (LOD 0) with UAV for GPU Culling"));
+
+        // ========== 创建 LOD 1 的 Indirect Draw Args Buffer (7 顶点, 15 索引) ==========
+        FRHIBufferCreateDesc IndirectDescLOD1 = FRHIBufferCreateDesc::Create(
+            TEXT("GrassIndirectArgsBufferLOD1"),
+            IndirectArgsSize,
+            sizeof(uint32),
+            EBufferUsageFlags::DrawIndirect | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+            .SetInitialState(ERHIAccess::IndirectArgs);
+        
+        OutBuffers.IndirectArgsBufferLOD1 = RHICmdList.CreateBuffer(IndirectDescLOD1);
+
+        // 创建 UAV 用于 Culling Shader 写入
+        auto IndirectUAVDescLOD1 = FRHIViewDesc::CreateBufferUAV()
+            .SetType(FRHIViewDesc::EBufferType::Raw);
+        OutBuffers.IndirectArgsBufferLOD1UAV = RHICmdList.CreateUnorderedAccessView(OutBuffers.IndirectArgsBufferLOD1, IndirectUAVDescLOD1);
+        
+        // 初始化 Indirect Args for LOD 1
+        RHICmdList.Transition(FRHITransitionInfo(OutBuffers.IndirectArgsBufferLOD1, ERHIAccess::IndirectArgs, ERHIAccess::CopyDest));
+        uint32* IndirectArgsLOD1 = (uint32*)RHICmdList.LockBuffer(OutBuffers.IndirectArgsBufferLOD1, 0, IndirectArgsSize, RLM_WriteOnly);
+        IndirectArgsLOD1[0] = 15;    // IndexCountPerInstance (7 vertices, 5 triangles = 15 indices)
+        IndirectArgsLOD1[1] = 0;     // InstanceCount (starts at 0, filled by culling shader)
+        IndirectArgsLOD1[2] = 0;     // StartIndexLocation
+        IndirectArgsLOD1[3] = 0;     // BaseVertexLocation
+        IndirectArgsLOD1[4] = 0;     // StartInstanceLocation (LOD 1 从 index 0 开始)
+        RHICmdList.UnlockBuffer(OutBuffers.IndirectArgsBufferLOD1);
+        RHICmdList.Transition(FRHITransitionInfo(OutBuffers.IndirectArgsBufferLOD1, ERHIAccess::CopyDest, ERHIAccess::IndirectArgs));
+        
+        UE_LOG(LogTemp, Log, TEXT("Created IndirectArgsBufferLOD1 with UAV for GPU Culling"));
+
+        // ========== 创建 LOD 1 的独立 Visible Buffer ==========
+        // LOD 1 使用独立的 buffer，从 index 0 开始存储，避免与 LOD 0 冲突
+        CreateVisibleInstanceBuffer_RenderThread(RHICmdList, OutBuffers, OutBuffers.VisibleInstanceLOD1Allocation,
+            OutBuffers.VisibleInstanceBufferLOD1, OutBuffers.VisibleInstanceBufferLOD1SRV, OutBuffers.VisibleInstanceBufferLOD1UAV, OutBuffers.VisibleInstanceLOD1Offset);
+
+        UE_LOG(LogTemp, Log, TEXT("Created LOD 1 independent Visible Buffers (initialized with all %d instances)"), Total);
+    }
+}
+
+/**
+ * 创建分块层次剔除的 Buffer (剔除块包围盒 / 存活块列表 / 间接 Dispatch 参数 / 稳定顺序剔除的每块计数 / 两阶段遮挡剔除的可见位)
+ * 剔除块使用 Compute Shader 计算，不支持 SM5 时不创建，剔除回退到逐实例 (实际上这时也不会执行 GPU Culling)
+ */
+static void CreateCullTileBuffers_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassGenerationParams& GenParams, FGrassInstanceBuffers& OutBuffers)
+{
+    if (!GenParams.bEnableFrustumCulling || !GenParams.bUseIndirectDraw || GMaxRHIFeatureLevel < ERHIFeatureLevel::SM5)
+    {
+        return;
+    }
+
+    LLM_SCOPE_BYTAG(Grass_CullTiles);
+    const int32 NumCullTiles = FGrassInstanceBuffers::GetNumCullTiles(OutBuffers.InstanceCount);
+    OutBuffers.NumCullTiles = NumCullTiles;
+
+    FRHIBufferCreateDesc CullTileDesc = FRHIBufferCreateDesc::CreateStructured(
+        TEXT("GrassCullTileBuffer"),
+        NumCullTiles * FGrassInstanceBuffers::CullTileStride,
+        FGrassInstanceBuffers::CullTileStride)
+        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+        .SetInitialState(ERHIAccess::SRVMask);
+    OutBuffers.CullTileBuffer = RHICmdList.CreateBuffer(CullTileDesc);
+    OutBuffers.CullTileBufferSRV = RHICmdList.CreateShaderResourceView(OutBuffers.CullTileBuffer,
+        FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCullTiles));
+    OutBuffers.CullTileBufferUAV = RHICmdList.CreateUnorderedAccessView(OutBuffers.CullTileBuffer,
+        FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCullTiles));
+
+    FRHIBufferCreateDesc VisibleTileDesc = FRHIBufferCreateDesc::CreateStructured(
+        TEXT("GrassVisibleTileBuffer"),
+        NumCullTiles * sizeof(uint32),
+        sizeof(uint32))
+        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+        .SetInitialState(ERHIAccess::SRVMask);
+    OutBuffers.VisibleTileBuffer = RHICmdList.CreateBuffer(VisibleTileDesc);
+    OutBuffers.VisibleTileBufferSRV = RHICmdList.CreateShaderResourceView(OutBuffers.VisibleTileBuffer,
+        FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCullTiles));
+    OutBuffers.VisibleTileBufferUAV = RHICmdList.CreateUnorderedAccessView(OutBuffers.VisibleTileBuffer,
+        FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCullTiles));
+
+    // 与 Indirect Draw 参数相同，以 Buffer<uint> / RWBuffer<uint> 访问
+    FRHIBufferCreateDesc DispatchArgsDesc = FRHIBufferCreateDesc::Create(
+        TEXT("GrassTileDispatchArgsBuffer"),
+        4 * sizeof(uint32),
+        sizeof(uint32),
+        EBufferUsageFlags::DrawIndirect | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+        .SetInitialState(ERHIAccess::IndirectArgs);
+    OutBuffers.TileDispatchArgsBuffer = RHICmdList.CreateBuffer(DispatchArgsDesc);
+    OutBuffers.TileDispatchArgsBufferSRV = RHICmdList.CreateShaderResourceView(OutBuffers.TileDispatchArgsBuffer,
+        FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Typed).SetFormat(PF_R32_UINT));
+    OutBuffers.TileDispatchArgsBufferUAV = RHICmdList.CreateUnorderedAccessView(OutBuffers.TileDispatchArgsBuffer,
+        FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Typed).SetFormat(PF_R32_UINT));
+
+    // 每个块 (LOD 0, LOD 1) 两个 uint；很小，总是创建，组件切换 bStableVisibleOrder 时不需要重新生成
+    FRHIBufferCreateDesc TileVisibleCountDesc = FRHIBufferCreateDesc::CreateStructured(
+        TEXT("GrassTileVisibleCountBuffer"),
+        NumCullTiles * 2 * sizeof(uint32),
+        2 * sizeof(uint32))
+        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+        .SetInitialState(ERHIAccess::SRVMask);
+    OutBuffers.TileVisibleCountBuffer = RHICmdList.CreateBuffer(TileVisibleCountDesc);
+    OutBuffers.TileVisibleCountBufferSRV = RHICmdList.CreateShaderResourceView(OutBuffers.TileVisibleCountBuffer,
+        FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCullTiles));
+    OutBuffers.TileVisibleCountBufferUAV = RHICmdList.CreateUnorderedAccessView(OutBuffers.TileVisibleCountBuffer,
+        FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCullTiles));
+
+    // 每个实例一位 (每个块两个 uint)，只以 UAV 访问；新的实例全部清零，第一帧由后 Pass 测试所有实例
+    const int32 NumVisibilityWords = NumCullTiles * FGrassInstanceBuffers::VisibilityWordsPerCullTile;
+    FRHIBufferCreateDesc VisibilityBitsDesc = FRHIBufferCreateDesc::CreateStructured(
+        TEXT("GrassVisibilityBitsBuffer"),
+        NumVisibilityWords * sizeof(uint32),
+        sizeof(uint32))
+        .AddUsage(EBufferUsageFlags::UnorderedAccess)
+        .SetInitialState(ERHIAccess::UAVCompute);
+    OutBuffers.VisibilityBitsBuffer = RHICmdList.CreateBuffer(VisibilityBitsDesc);
+    OutBuffers.VisibilityBitsBufferUAV = RHICmdList.CreateUnorderedAccessView(OutBuffers.VisibilityBitsBuffer,
+        FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumVisibilityWords));
+    RHICmdList.ClearUAVUint(OutBuffers.VisibilityBitsBufferUAV, FUintVector4(0, 0, 0, 0));
+
+    UE_LOG(LogTemp, Log, TEXT("Created %d cull tiles (%d instances each) for tile-hierarchical GPU culling"), NumCullTiles, FGrassInstanceBuffers::CullTileSize);
+}
+
+/**
+ * 从生成好的实例计算每个剔除块的本地包围盒 (所有生成路径在实例写入后调用；复用分配时覆盖旧的包围盒)
+ * 同时回读包围盒，供渲染线程构建 CPU 四叉树
+ */
+static void BuildCullTiles_RenderThread(FRHICommandListImmediate& RHICmdList, FGrassInstanceBuffers& Buffers)
+{
+    if (!Buffers.CullTileBufferUAV.IsValid() || Buffers.NumCullTiles == 0)
+    {
+        return;
+    }
+
+    RHICmdList.Transition(FRHITransitionInfo(Buffers.CullTileBuffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
+
+    TShaderMapRef<FGrassCullTileBuildCS> BuildCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    FGrassCullTileBuildCS::FParameters BuildParams;
+    BuildParams.InInstances = Buffers.InstanceBufferSRV;
+    BuildParams.OutCullTiles = Buffers.CullTileBufferUAV;
+    BuildParams.InstanceBaseOffset = Buffers.InstanceOffset;
+    BuildParams.TotalInstanceCount = Buffers.InstanceCount;
+    BuildParams.NumCullTiles = Buffers.NumCullTiles;
+    BuildParams.QuantizationMin = Buffers.Quantization.Min;
+    BuildParams.QuantizationSize = Buffers.Quantization.Size;
+    FComputeShaderUtils::Dispatch(RHICmdList, BuildCS, BuildParams, FIntVector(FMath::DivideAndRoundUp(Buffers.NumCullTiles, 64), 1, 1));
+
+    RHICmdList.Transition(FRHITransitionInfo(Buffers.CullTileBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+
+    // 新建而不是复用：旧的 Scene Proxy 可能还持有上一次生成的四叉树
+    Buffers.CullTileHierarchy = MakeShared<FGrassCullTileHierarchy, ESPMode::ThreadSafe>();
+    Buffers.CullTileHierarchy->EnqueueCopy_RenderThread(RHICmdList, Buffers.CullTileBuffer, Buffers.NumCullTiles, FGrassInstanceBuffers::CullTileSize);
+}
+
+/** 上传 CPU 生成的实例数据 (FGrassCpuGenerator) */
+static void UploadCpuInstanceData_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassCpuInstanceData& CpuData, FGrassInstanceBuffers& Buffers)
+{
+    auto Upload = [&RHICmdList](FRHIBuffer* Buffer, uint32 Offset, const void* Data, uint32 Size)
+    {
+        RHICmdList.Transition(FRHITransitionInfo(Buffer, ERHIAccess::SRVMask, ERHIAccess::CopyDest));
+        void* Dest = RHICmdList.LockBuffer(Buffer, Offset, Size, RLM_WriteOnly);
+        FMemory::Memcpy(Dest, Data, Size);
+        RHICmdList.UnlockBuffer(Buffer);
+        RHICmdList.Transition(FRHITransitionInfo(Buffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
+    };
+
+    Upload(Buffers.InstanceBuffer, Buffers.InstanceOffset * FGrassInstancePacking::PackedStride,
+        CpuData.Instances.GetData(), CpuData.Instances.Num() * FGrassInstancePacking::PackedStride);
+}
+
+void UGrassComponent::GenerateGrass_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassGenerationParams& GenParams, FGrassInstanceBuffers& OutBuffers,
+    FGrassCompactionReadback* CompactionReadback)
+{
+    LLM_SCOPE_BYTAG(Grass);
+
+    // 网格上的草叶数量；使用密度遮罩时是生成 Pass 的上限，实际数量以复用的 Buffer / CPU 数据 / GPU 计数为准
+    int32 Total = GenParams.GetInstanceCount();
+    if (GenParams.ReuseBuffers.IsValid())
+    {
+        Total = GenParams.ReuseBuffers.InstanceCount;
+    }
+    else if (GenParams.CpuInstanceData.IsValid())
+    {
+        Total = GenParams.CpuInstanceData->Num();
+    }
+
+    // 实例数量没有变化时直接写入当前 Buffer，Proxy 在下一次绘制时就能看到新数据
+    const bool bReuseAllocation = GenParams.ReuseBuffers.IsValid();
+    if (bReuseAllocation)
+    {
+        check(!GenParams.UsesDensity() && GenParams.ReuseBuffers.InstanceCount == GenParams.GetInstanceCount());
+        OutBuffers = GenParams.ReuseBuffers;
+    }
+    else
+    {
+        OutBuffers = FGrassInstanceBuffers();
+        OutBuffers.InstanceCount = Total;
+        OutBuffers.Quantization = GenParams.CpuInstanceData.IsValid() ? GenParams.CpuInstanceData->Quantization : GenParams.GetQuantization();
+    }
+
+    // CPU 生成的数据 (bGenerateOnCpu)：只上传，不执行生成 Compute Shader (支持 SM5 时只计算剔除块包围盒)
+    if (GenParams.CpuInstanceData.IsValid())
+    {
+        check(GenParams.CpuInstanceData->Num() == Total);
+        OutBuffers.ClumpBytes = 0;
+        if (Total == 0)
+        {
+            // 缓存中的密度遮罩结果没有存活的草叶
+            UE_LOG(LogTemp, Log, TEXT("No grass instances survived the density mask"));
+            return;
+        }
+        if (!bReuseAllocation)
+        {
+            AllocateInstanceBuffers_RenderThread(RHICmdList, Total, OutBuffers);
+        }
+        UploadCpuInstanceData_RenderThread(RHICmdList, *GenParams.CpuInstanceData, OutBuffers);
+        if (!bReuseAllocation)
+        {
+            CreateCullingBuffers_RenderThread(RHICmdList, GenParams, OutBuffers);
+            CreateCullTileBuffers_RenderThread(RHICmdList, GenParams, OutBuffers);
+        }
+        BuildCullTiles_RenderThread(RHICmdList, OutBuffers);
+        UE_LOG(LogTemp, Log, TEXT("Uploaded %d CPU generated grass instances"), Total);
+        return;
+    }
+
+    // Clump 数据复用时大小不变 (缓存 Key 包含数量、网格和纹理尺寸)
+    OutBuffers.ClumpBytes = FGrassMemoryFootprint::ComputeClumpBytes(GenParams.NumClumps, GenParams.ClumpGridDim, GenParams.VoronoiTextureSize, GenParams.NumClumpTypes);
+
+    // ========== 创建 Clump Buffer ==========
+    // ClumpData 使用两个 float4 来存储:
+    // ClumpData0: Centre.x, Centre.y, Direction.x, Direction.y
+    // ClumpData1: HeightScale, WidthScale, WindPhase, Padding
+    if (!GenParams.bReuseClumpData)
+    {
+        LLM_SCOPE_BYTAG(Grass_Clumps);
+
+        // 创建 ClumpData0 Buffer
+        FRHIBufferCreateDesc ClumpData0Desc = FRHIBufferCreateDesc::CreateStructured(
+            TEXT("GrassClumpData0Buffer"),
+            GenParams.NumClumps * sizeof(FVector4f),
+            sizeof(FVector4f))
+            .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+            .SetInitialState(ERHIAccess::UAVCompute);
+        FBufferRHIRef ClumpData0Buffer = RHICmdList.CreateBuffer(ClumpData0Desc);
+        
+        // 创建 ClumpData1 Buffer
+        FRHIBufferCreateDesc ClumpData1Desc = FRHIBufferCreateDesc::CreateStructured(
+            TEXT("GrassClumpData1Buffer"),
+            GenParams.NumClumps * sizeof(FVector4f),
+            sizeof(FVector4f))
+            .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+            .SetInitialState(ERHIAccess::UAVCompute);
+        FBufferRHIRef ClumpData1Buffer = RHICmdList.CreateBuffer(ClumpData1Desc);
+
+        // 创建 UAV
+        auto ClumpData0UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(GenParams.NumClumps);
+        FUnorderedAccessViewRHIRef ClumpData0UAV = RHICmdList.CreateUnorderedAccessView(ClumpData0Buffer, ClumpData0UAVDesc);
+        auto ClumpData1UAVDesc = FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(GenParams.NumClumps);
+        FUnorderedAccessViewRHIRef ClumpData1UAV = RHICmdList.CreateUnorderedAccessView(ClumpData1Buffer, ClumpData1UAVDesc);
+
+        // 执行 Clump 生成 Compute Shader
+        TShaderMapRef<FClumpGenerationCS> ClumpCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        FClumpGenerationCS::FParameters ClumpParams;
+        ClumpParams.OutClumpData0 = ClumpData0UAV;
+        ClumpParams.OutClumpData1 = ClumpData1UAV;
+        ClumpParams.NumClumps = GenParams.NumClumps;
+        ClumpParams.NumClumpTypes = GenParams.NumClumpTypes;
+
+        FComputeShaderUtils::Dispatch(RHICmdList, ClumpCS, ClumpParams,
+            FIntVector(FMath::DivideAndRoundUp(GenParams.NumClumps, 64), 1, 1));
+
+        // 转换到 SRV 状态
+        RHICmdList.Transition(FRHITransitionInfo(ClumpData0Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+        RHICmdList.Transition(FRHITransitionInfo(ClumpData1Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+
+        // 创建 SRV
+        auto ClumpSRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(GenParams.NumClumps);
+        ClumpBufferSRV = RHICmdList.CreateShaderResourceView(ClumpData0Buffer, ClumpSRVDesc);
+        ClumpBuffer = ClumpData0Buffer;
+        
+        // 创建 ClumpData1 的 SRV
+        auto Clump1SRVDesc = FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(GenParams.NumClumps);
+        ClumpData1BufferSRV = RHICmdList.CreateShaderResourceView(ClumpData1Buffer, Clump1SRVDesc);
+        this->ClumpData1Buffer = ClumpData1Buffer;
+
+        UE_LOG(LogTemp, Log, TEXT("Created ClumpBuffer with %d clumps"), 
+            GenParams.NumClumps);
+    }
+
+    // ========== 构建 Clump 空间哈希网格 ==========
+    // 按 Clump 中心点 (UV 空间) 分桶，草叶生成时只需检查相邻单元格
+    if (!GenParams.bReuseClumpData)
+    {
+        LLM_SCOPE_BYTAG(Grass_Clumps);
+        const int32 NumCells = GenParams.ClumpGridDim * GenParams.ClumpGridDim;
+
+        // 单元格计数 (临时 Buffer，Scatter 时复用为写入游标)
+        FRHIBufferCreateDesc CellCountsDesc = FRHIBufferCreateDesc::CreateStructured(
+            TEXT("GrassClumpGridCellCounts"),
+            NumCells * sizeof(uint32),
+            sizeof(uint32))
+            .AddUsage(EBufferUsageFlags::UnorderedAccess)
+            .SetInitialState(ERHIAccess::UAVCompute);
+        FBufferRHIRef CellCountsBuffer = RHICmdList.CreateBuffer(CellCountsDesc);
+        FUnorderedAccessViewRHIRef CellCountsUAV = RHICmdList.CreateUnorderedAccessView(CellCountsBuffer,
+            FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCells));
+
+        // 单元格起始偏移 (NumCells + 1)
+        FRHIBufferCreateDesc CellStartDesc = FRHIBufferCreateDesc::CreateStructured(
+            TEXT("GrassClumpGridCellStart"),
+            (NumCells + 1) * sizeof(uint32),
+            sizeof(uint32))
+            .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+            .SetInitialState(ERHIAccess::UAVCompute);
+        ClumpGridCellStartBuffer = RHICmdList.CreateBuffer(CellStartDesc);
+        FUnorderedAccessViewRHIRef CellStartUAV = RHICmdList.CreateUnorderedAccessView(ClumpGridCellStartBuffer,
+            FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCells + 1));
+
+        // 按单元格排序的 Clump 索引
+        FRHIBufferCreateDesc CellClumpsDesc = FRHIBufferCreateDesc::CreateStructured(
+            TEXT("GrassClumpGridIndices"),
+            GenParams.NumClumps * sizeof(uint32),
+            sizeof(uint32))
+            .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+            .SetInitialState(ERHIAccess::UAVCompute);
+        ClumpGridIndicesBuffer = RHICmdList.CreateBuffer(CellClumpsDesc);
+        FUnorderedAccessViewRHIRef CellClumpsUAV = RHICmdList.CreateUnorderedAccessView(ClumpGridIndicesBuffer,
+            FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(GenParams.NumClumps));
+
+        RHICmdList.ClearUAVUint(CellCountsUAV, FUintVector4(0, 0, 0, 0));
+        RHICmdList.Transition(FRHITransitionInfo(CellCountsBuffer, ERHIAccess::UAVCompute, ERHIAccess::UAVCompute));
+
+        // Pass 1: 计数
+        TShaderMapRef<FClumpGridCountCS> CountCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        FClumpGridCountCS::FParameters CountParams;
+        CountParams.InClumpData0 = ClumpBufferSRV;
+        CountParams.RWCellCounts = CellCountsUAV;
+        CountParams.NumClumps = GenParams.NumClumps;
+        CountParams.ClumpGridDim = GenParams.ClumpGridDim;
+        FComputeShaderUtils::Dispatch(RHICmdList, CountCS, CountParams,
+            FIntVector(FMath::DivideAndRoundUp(GenParams.NumClumps, 64), 1, 1));
+
+        RHICmdList.Transition(FRHITransitionInfo(CellCountsBuffer, ERHIAccess::UAVCompute, ERHIAccess::UAVCompute));
+
+        // Pass 2: 前缀和 (单个 Group)
+        TShaderMapRef<FClumpGridPrefixSumCS> PrefixSumCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        FClumpGridPrefixSumCS::FParameters PrefixSumParams;
+        PrefixSumParams.RWCellCounts = CellCountsUAV;
+        PrefixSumParams.RWCellStart = CellStartUAV;
+        PrefixSumParams.ClumpGridDim = GenParams.ClumpGridDim;
+        FComputeShaderUtils::Dispatch(RHICmdList, PrefixSumCS, PrefixSumParams, FIntVector(1, 1, 1));
+
+        RHICmdList.Transition(FRHITransitionInfo(CellCountsBuffer, ERHIAccess::UAVCompute, ERHIAccess::UAVCompute));
+        RHICmdList.Transition(FRHITransitionInfo(ClumpGridCellStartBuffer, ERHIAccess::UAVCompute, ERHIAccess::UAVCompute));
+
+        // Pass 3: 分散写入
+        TShaderMapRef<FClumpGridScatterCS> ScatterCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        FClumpGridScatterCS::FParameters ScatterParams;
+        ScatterParams.InClumpData0 = ClumpBufferSRV;
+        ScatterParams.RWCellCounts = CellCountsUAV;
+        ScatterParams.RWCellStart = CellStartUAV;
+        ScatterParams.RWCellClumps = CellClumpsUAV;
+        ScatterParams.NumClumps = GenParams.NumClumps;
+        ScatterParams.ClumpGridDim = GenParams.ClumpGridDim;
+        FComputeShaderUtils::Dispatch(RHICmdList, ScatterCS, ScatterParams,
+            FIntVector(FMath::DivideAndRoundUp(GenParams.NumClumps, 64), 1, 1));
+
+        RHICmdList.Transition(FRHITransitionInfo(ClumpGridCellStartBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+        RHICmdList.Transition(FRHITransitionInfo(ClumpGridIndicesBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+
+        ClumpGridCellStartSRV = RHICmdList.CreateShaderResourceView(ClumpGridCellStartBuffer,
+            FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(NumCells + 1));
+        ClumpGridIndicesSRV = RHICmdList.CreateShaderResourceView(ClumpGridIndicesBuffer,
+            FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(GenParams.NumClumps));
+        ClumpGridDim = GenParams.ClumpGridDim;
+
+        UE_LOG(LogTemp, Log, TEXT("Built clump grid %dx%d for %d clumps"),
+            GenParams.ClumpGridDim, GenParams.ClumpGridDim, GenParams.NumClumps);
+    }
+
+    // ========== 烘焙 Clump Voronoi 查找纹理 (可选) ==========
+    if (!GenParams.bReuseClumpData)
+    {
+        VoronoiTexture.SafeRelease();
+    }
+    if (!GenParams.bReuseClumpData && GenParams.VoronoiTextureSize > 0)
+    {
+        LLM_SCOPE_BYTAG(Grass_Clumps);
+        FRHITextureCreateDesc VoronoiDesc = FRHITextureCreateDesc::Create2D(TEXT("GrassVoronoiTexture"))
+            .SetExtent(GenParams.VoronoiTextureSize, GenParams.VoronoiTextureSize)
+            .SetFormat(PF_A32B32G32R32F)
+            .SetFlags(ETextureCreateFlags::ShaderResource | ETextureCreateFlags::UAV)
+            .SetInitialState(ERHIAccess::UAVCompute);
+        VoronoiTexture = RHICreateTexture(VoronoiDesc);
+
+        TShaderMapRef<FGrassVoronoiCS> VoronoiCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        FGrassVoronoiCS::FParameters VoronoiParams;
+        VoronoiParams.InClumpData0 = ClumpBufferSRV;
+        VoronoiParams.InClumpGridCellStart = ClumpGridCellStartSRV;
+        VoronoiParams.InClumpGridIndices = ClumpGridIndicesSRV;
+        VoronoiParams.OutVoronoiTexture = RHICmdList.CreateUnorderedAccessView(
+            VoronoiTexture.GetReference(),
+            FRHIViewDesc::CreateTextureUAV().SetDimensionFromTexture(VoronoiTexture.GetReference()));
+        VoronoiParams.NumClumps = GenParams.NumClumps;
+        VoronoiParams.ClumpGridDim = GenParams.ClumpGridDim;
+        VoronoiParams.TextureSize = GenParams.VoronoiTextureSize;
+
+        FComputeShaderUtils::Dispatch(RHICmdList, VoronoiCS, VoronoiParams,
+            FIntVector(
+                FMath::DivideAndRoundUp(GenParams.VoronoiTextureSize, 8),
+                FMath::DivideAndRoundUp(GenParams.VoronoiTextureSize, 8),
+                1));
+
+        RHICmdList.Transition(FRHITransitionInfo(VoronoiTexture, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+
+        UE_LOG(LogTemp, Log, TEXT("Baked clump Voronoi texture %dx%d"), GenParams.VoronoiTextureSize, GenParams.VoronoiTextureSize);
+    }
+
+    // ========== 分配所有实例的区间 ==========
+    // 密度剔除时先输出到网格大小的专用临时页，读回存活数量后再拷贝到池中刚好大小的区间
+    const bool bCompactOutput = GenParams.UsesDensity();
+    check(!bCompactOutput || CompactionReadback != nullptr);
+    if (!bReuseAllocation)
+    {
+        AllocateInstanceBuffers_RenderThread(RHICmdList, Total, OutBuffers, bCompactOutput);
+    }
+
+    // 页平时处于可读状态 (其他组件可能正在使用同一个页)，写入前切换到 UAV
+    RHICmdList.Transition(FRHITransitionInfo(OutBuffers.InstanceBuffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
+
+    // ========== 创建 ClumpType 参数 Buffer ==========
+    // 每种簇类型的参数打包成 float4 数组:
+    // [0]: PullToCentre, PointInSameDirection, BaseHeight, HeightRandom
+    // [1]: BaseWidth, WidthRandom, BaseTilt, TiltRandom
+    // [2]: BaseBend, BendRandom, 0, 0
+    const int32 FloatsPerClumpType = 12; // 3 个 float4
+    TArray<float> ClumpTypeData;
+    ClumpTypeData.SetNum(GenParams.NumClumpTypes * FloatsPerClumpType);
+    
+    for (int32 i = 0; i < GenParams.NumClumpTypes; ++i)
+    {
+        const FClumpTypeParameters& TypeParams = GenParams.ClumpTypes[i];
+        int32 BaseIdx = i * FloatsPerClumpType;
+        // float4[0]
+        ClumpTypeData[BaseIdx + 0] = TypeParams.PullToCentre;
+        ClumpTypeData[BaseIdx + 1] = TypeParams.PointInSameDirection;
+        ClumpTypeData[BaseIdx + 2] = TypeParams.BaseHeight;
+        ClumpTypeData[BaseIdx + 3] = TypeParams.HeightRandom;
+        // float4[1]
+        ClumpTypeData[BaseIdx + 4] = TypeParams.BaseWidth;
+        ClumpTypeData[BaseIdx + 5] = TypeParams.WidthRandom;
+        ClumpTypeData[BaseIdx + 6] = TypeParams.BaseTilt;
+        ClumpTypeData[BaseIdx + 7] = TypeParams.TiltRandom;
+        // float4[2]
+        ClumpTypeData[BaseIdx + 8] = TypeParams.BaseBend;
+        ClumpTypeData[BaseIdx + 9] = TypeParams.BendRandom;
+        ClumpTypeData[BaseIdx + 10] = 0.0f; // Reserved
+        ClumpTypeData[BaseIdx + 11] = 0.0f; // Reserved
+    }
+    
+    // 创建 ClumpType 参数 Buffer
+    FRHIBufferCreateDesc ClumpTypeParamsDesc = FRHIBufferCreateDesc::CreateStructured(
+        TEXT("GrassClumpTypeParamsBuffer"),
+        GenParams.NumClumpTypes * FloatsPerClumpType * sizeof(float),
+        sizeof(FVector4f))
+        .AddUsage(EBufferUsageFlags::ShaderResource)
+        .SetInitialState(ERHIAccess::CopyDest);
+    ClumpTypeParamsBuffer = RHICmdList.CreateBuffer(ClumpTypeParamsDesc);
+    
+    // 上传数据
+    void* ClumpTypeParamsData = RHICmdList.LockBuffer(ClumpTypeParamsBuffer, 0, ClumpTypeData.Num() * sizeof(float), RLM_WriteOnly);
+    FMemory::Memcpy(ClumpTypeParamsData, ClumpTypeData.GetData(), ClumpTypeData.Num() * sizeof(float));
+    RHICmdList.UnlockBuffer(ClumpTypeParamsBuffer);
+    RHICmdList.Transition(FRHITransitionInfo(ClumpTypeParamsBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
+    
+    // 创建 SRV
+    auto ClumpTypeSRVDesc = FRHIViewDesc::CreateBufferSRV()
+        .SetType(FRHIViewDesc::EBufferType::Structured)
+        .SetNumElements(GenParams.NumClumpTypes * 3); // 每种类型 3 个 float4
+    ClumpTypeParamsBufferSRV = RHICmdList.CreateShaderResourceView(ClumpTypeParamsBuffer, ClumpTypeSRVDesc);
+    
+    UE_LOG(LogTemp, Log, TEXT("Created ClumpTypeParamsBuffer for %d clump types"), GenParams.NumClumpTypes);
+
+    // ========== 创建分块参数 Buffer ==========
+    // 每个分块的参数打包成 float4 数组:
+    // [0]: HeightmapScaleBias
+    // [1]: SampleOrigin.xy, CellSize.xy
+    // [2]: TileMin.xy, SeedOffset.xy
+    // [3]: WeightmapScaleBias
+    // [4]: WeightmapChannelMask
+    TArray<FGrassGenerationTile> Tiles = GenParams.Tiles;
+    if (Tiles.Num() == 0)
+    {
+        Tiles.Add(FGrassGenerationTile::MakeGridTile(GenParams.GridSize, GenParams.Spacing));
+    }
+    const int32 NumTiles = Tiles.Num();
+
+    const int32 Float4sPerTile = 5;
+    TArray<FVector4f> TileData;
+    TileData.SetNumUninitialized(NumTiles * Float4sPerTile);
+    for (int32 i = 0; i < NumTiles; ++i)
+    {
+        const FGrassGenerationTile& Tile = Tiles[i];
+        TileData[i * Float4sPerTile + 0] = Tile.HeightmapScaleBias;
+        TileData[i * Float4sPerTile + 1] = FVector4f(Tile.SampleOrigin.X, Tile.SampleOrigin.Y, Tile.CellSize.X, Tile.CellSize.Y);
+        TileData[i * Float4sPerTile + 2] = FVector4f(Tile.TileMin.X, Tile.TileMin.Y, (float)Tile.SeedOffset.X, (float)Tile.SeedOffset.Y);
+        TileData[i * Float4sPerTile + 3] = Tile.WeightmapScaleBias;
+        TileData[i * Float4sPerTile + 4] = Tile.WeightmapChannelMask;
+    }
+
+    FRHIBufferCreateDesc TileParamsDesc = FRHIBufferCreateDesc::CreateStructured(
+        TEXT("GrassTileParamsBuffer"),
+        TileData.Num() * sizeof(FVector4f),
+        sizeof(FVector4f))
+        .AddUsage(EBufferUsageFlags::ShaderResource)
+        .SetInitialState(ERHIAccess::CopyDest);
+    FBufferRHIRef TileParamsBuffer = RHICmdList.CreateBuffer(TileParamsDesc);
+
+    void* TileParamsData = RHICmdList.LockBuffer(TileParamsBuffer, 0, TileData.Num() * sizeof(FVector4f), RLM_WriteOnly);
+    FMemory::Memcpy(TileParamsData, TileData.GetData(), TileData.Num() * sizeof(FVector4f));
+    RHICmdList.UnlockBuffer(TileParamsBuffer);
+    RHICmdList.Transition(FRHITransitionInfo(TileParamsBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
+
+    FShaderResourceViewRHIRef TileParamsSRV = RHICmdList.CreateShaderResourceView(TileParamsBuffer,
+        FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(TileData.Num()));
+
+    // ========== 存活草叶计数器 (密度剔除时原地紧凑输出) ==========
+    FRHIBufferCreateDesc CounterDesc = FRHIBufferCreateDesc::CreateStructured(
+        TEXT("GrassInstanceCounterBuffer"),
+        sizeof(uint32),
+        sizeof(uint32))
+        .AddUsage(EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::SourceCopy)
+        .SetInitialState(ERHIAccess::CopyDest);
+    FBufferRHIRef CounterBuffer = RHICmdList.CreateBuffer(CounterDesc);
+    void* CounterData = RHICmdList.LockBuffer(CounterBuffer, 0, sizeof(uint32), RLM_WriteOnly);
+    FMemory::Memzero(CounterData, sizeof(uint32));
+    RHICmdList.UnlockBuffer(CounterBuffer);
+    RHICmdList.Transition(FRHITransitionInfo(CounterBuffer, ERHIAccess::CopyDest, ERHIAccess::UAVCompute));
+
+    // 黑色纹理占位 (不使用地形 / 密度贴图时不会被实际采样；没有绘制密度层的 Component 权重为 0)
+    FShaderResourceViewRHIRef BlackTextureSRV;
+    auto GetTextureSRV = [&RHICmdList, &BlackTextureSRV](FTextureResource* Resource) -> FShaderResourceViewRHIRef
+    {
+        FTextureRHIRef TextureRHI = Resource ? Resource->TextureRHI : nullptr;
+        if (TextureRHI.IsValid())
+        {
+            return RHICmdList.CreateShaderResourceView(TextureRHI, FRHIViewDesc::CreateTextureSRV().SetDimensionFromTexture(TextureRHI));
+        }
+        if (!BlackTextureSRV.IsValid())
+        {
+            BlackTextureSRV = RHICmdList.CreateShaderResourceView(
+                GBlackTexture->TextureRHI,
+                FRHIViewDesc::CreateTextureSRV().SetDimensionFromTexture(GBlackTexture->TextureRHI));
+        }
+        return BlackTextureSRV;
+    };
+
+    // ========== 执行位置生成 Compute Shader ==========
+    TShaderMapRef<FGrassPositionCS> CS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    FGrassPositionCS::FParameters Params;
+    Params.InLandscapeHeightmapSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+    Params.InDensityMaskSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+    Params.InLandscapeWeightmapSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+    // ClumpBuffer 输入
+    Params.InClumpData0 = ClumpBufferSRV;
+    Params.InClumpData1 = ClumpData1BufferSRV;
+    Params.InClumpGridCellStart = ClumpGridCellStartSRV;
+    Params.InClumpGridIndices = ClumpGridIndicesSRV;
+    // Voronoi 查找纹理 (未启用时使用黑色纹理占位)
+    Params.InVoronoiTexture = (GenParams.VoronoiTextureSize > 0 && VoronoiTexture.IsValid())
+        ? VoronoiTexture.GetReference()
+        : GBlackTexture->TextureRHI.GetReference();
+    // ClumpType / 分块参数 Buffer
+    Params.InClumpTypeParams = ClumpTypeParamsBufferSRV;
+    Params.InTileParams = TileParamsSRV;
+    // 输出 Buffers
+    Params.OutInstances = OutBuffers.InstanceBufferUAV;
+    Params.InstanceBaseOffset = OutBuffers.InstanceOffset;
+    Params.OutInstanceCounter = RHICmdList.CreateUnorderedAccessView(CounterBuffer,
+        FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Structured).SetNumElements(1));
+    Params.GridSize = GenParams.GridSize;
+    Params.JitterStrength = GenParams.JitterStrength;
+    Params.NumClumps = GenParams.NumClumps;
+    Params.NumClumpTypes = GenParams.NumClumpTypes;
+    Params.ClumpGridDim = GenParams.ClumpGridDim;
+    Params.bUseVoronoiLookup = (GenParams.VoronoiTextureSize > 0 && VoronoiTexture.IsValid()) ? 1 : 0;
+    Params.VoronoiTextureSize = FMath::Max(GenParams.VoronoiTextureSize, 1);
+    const FBox2f ClumpDomain = GenParams.GetTileBounds();
+    Params.ClumpDomainCentre = ClumpDomain.GetCenter();
+    Params.ClumpDomainHalfSize = ClumpDomain.GetExtent();
+    Params.QuantizationMin = OutBuffers.Quantization.Min;
+    Params.QuantizationSize = OutBuffers.Quantization.Size;
+    // Landscape 高度图参数
+    Params.LandscapeScale = GenParams.LandscapeScale;
+    Params.LandscapeLocation = GenParams.LandscapeLocation;
+    Params.ComponentLocationZ = GenParams.ComponentLocation.Z;
+    Params.bUseLandscapeHeightmap = GenParams.bUseLandscapeHeightmap ? 1 : 0;
+    // 密度参数 (密度贴图拉伸覆盖所有分块的并集)
+    Params.InDensityMask = GetTextureSRV(GenParams.DensityMaskResource);
+    Params.bCompactOutput = bCompactOutput ? 1 : 0;
+    Params.bUseDensityMask = GenParams.DensityMaskResource != nullptr ? 1 : 0;
+    Params.bUseDensityLayer = GenParams.bUseDensityLayer ? 1 : 0;
+    Params.bInvertDensityLayer = GenParams.bInvertDensityLayer ? 1 : 0;
+    Params.DensityMaskOrigin = ClumpDomain.Min;
+    Params.DensityMaskInvSize = FVector2f(1.0f / FMath::Max(ClumpDomain.GetSize().X, 1.0f), 1.0f / FMath::Max(ClumpDomain.GetSize().Y, 1.0f));
+
+    // 同一个高度图 Atlas (以及密度层权重图) 中的分块 (游戏线程已按纹理排序) 合并为一次 Dispatch
+    // 同一个 Landscape 的 Component 通常共享少数几张高度图，8x8 的地图一般只需要 1 次 Dispatch
+    int32 NumDispatches = 0;
+    for (int32 FirstTile = 0; FirstTile < NumTiles; )
+    {
+        FTextureResource* HeightmapResource = GenParams.bUseLandscapeHeightmap ? Tiles[FirstTile].HeightmapResource : nullptr;
+        FTextureResource* WeightmapResource = GenParams.bUseDensityLayer ? Tiles[FirstTile].WeightmapResource : nullptr;
+        int32 EndTile = FirstTile + 1;
+        while (EndTile < NumTiles
+            && (!GenParams.bUseLandscapeHeightmap || Tiles[EndTile].HeightmapResource == HeightmapResource)
+            && (!GenParams.bUseDensityLayer || Tiles[EndTile].WeightmapResource == WeightmapResource))
+        {
+            ++EndTile;
+        }
+
+        // Landscape 高度图 / 权重图 Texture 输入
+        HeightmapTextureSRV = GetTextureSRV(HeightmapResource);
+        Params.InLandscapeHeightmap = HeightmapTextureSRV;
+        Params.InLandscapeWeightmap = GetTextureSRV(WeightmapResource);
+        Params.FirstTile = FirstTile;
+
+        FComputeShaderUtils::Dispatch(RHICmdList, CS, Params,
+            FIntVector(
+                FMath::DivideAndRoundUp(GenParams.GridSize, 8),
+                FMath::DivideAndRoundUp(GenParams.GridSize, 8),
+                EndTile - FirstTile));
+
+        ++NumDispatches;
+        FirstTile = EndTile;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("Generated %d grass tiles (%dx%d each) in %d dispatch(es)"), NumTiles, GenParams.GridSize, GenParams.GridSize, NumDispatches);
+
+    // ========== 密度剔除后的紧凑输出 ==========
+    // 存活的草叶已经原子追加到临时页前部；这里只拷贝计数器，不等待 GPU
+    // 计数读回后 CompactInstanceBuffers_RenderThread 把它们拷贝到刚好大小的区间并创建剔除 Buffer
+    if (bCompactOutput)
+    {
+        RHICmdList.Transition({
+            FRHITransitionInfo(CounterBuffer, ERHIAccess::UAVCompute, ERHIAccess::CopySrc),
+            FRHITransitionInfo(OutBuffers.InstanceBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask) });
+        CompactionReadback->EnqueueCopy_RenderThread(RHICmdList, CounterBuffer);
+        return;
+    }
+
+    RHICmdList.Transition(FRHITransitionInfo(OutBuffers.InstanceBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+
+    // 复用分配时 Visible / Indirect Args / 剔除块 Buffer 保持不变 (GPU Culling 每帧都会从上面的 Buffer 重新写入)
+    if (!bReuseAllocation)
+    {
+        CreateCullingBuffers_RenderThread(RHICmdList, GenParams, OutBuffers);
+        CreateCullTileBuffers_RenderThread(RHICmdList, GenParams, OutBuffers);
+    }
+    BuildCullTiles_RenderThread(RHICmdList, OutBuffers);
+}
+
+void UGrassComponent::CompactInstanceBuffers_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassGenerationParams& GenParams, int32 NumSurvivors, FGrassInstanceBuffers& InOutBuffers)
+{
+    LLM_SCOPE_BYTAG(Grass);
+
+    const int32 GridInstances = InOutBuffers.InstanceCount;
+    const int32 Total = FMath::Min(NumSurvivors, GridInstances);
+    UE_LOG(LogTemp, Log, TEXT("Density mask kept %d of %d grass instances (%.1f%%)"),
+        Total, GridInstances, GridInstances > 0 ? Total * 100.0 / GridInstances : 0.0);
+
+    if (Total == 0)
+    {
+        InOutBuffers = FGrassInstanceBuffers();
+        return;
+    }
+
+    FGrassInstanceBuffers CompactBuffers;
+    CompactBuffers.InstanceCount = Total;
+    CompactBuffers.Quantization = InOutBuffers.Quantization;
+    CompactBuffers.ClumpBytes = InOutBuffers.ClumpBytes;
+    AllocateInstanceBuffers_RenderThread(RHICmdList, Total, CompactBuffers);
+
+    // 临时页是专用页，和池中的区间不会是同一个 Buffer
+    RHICmdList.Transition({
+        FRHITransitionInfo(InOutBuffers.InstanceBuffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc),
+        FRHITransitionInfo(CompactBuffers.InstanceBuffer, ERHIAccess::SRVMask, ERHIAccess::CopyDest) });
+    RHICmdList.CopyBufferRegion(
+        CompactBuffers.InstanceBuffer, CompactBuffers.InstanceOffset * FGrassInstancePacking::PackedStride,
+        InOutBuffers.InstanceBuffer, InOutBuffers.InstanceOffset * FGrassInstancePacking::PackedStride,
+        Total * FGrassInstancePacking::PackedStride);
+    RHICmdList.Transition(FRHITransitionInfo(CompactBuffers.InstanceBuffer, ERHIAccess::CopyDest, ERHIAccess::SRVMask));
+
+    // 网格大小的临时页在这里释放
+    InOutBuffers = MoveTemp(CompactBuffers);
+
+    CreateCullingBuffers_RenderThread(RHICmdList, GenParams, InOutBuffers);
+    CreateCullTileBuffers_RenderThread(RHICmdList, GenParams, InOutBuffers);
+    BuildCullTiles_RenderThread(RHICmdList, InOutBuffers);
+}
+
+// ============================================================================
+// FGrassCompactionReadback
+// ============================================================================
+FGrassCompactionReadback::FGrassCompactionReadback(const FGrassGenerationParams& InGenParams, TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> InCacheReadback)
+    : GenParams(InGenParams)
+    , CacheReadback(MoveTemp(InCacheReadback))
+{
+    Readback = MakeUnique<FRHIGPUBufferReadback>(TEXT("GrassInstanceCounterReadback"));
+}
+
+FGrassCompactionReadback::~FGrassCompactionReadback() = default;
+
+void FGrassCompactionReadback::EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, FRHIBuffer* CounterBuffer)
+{
+    Readback->EnqueueCopy(RHICmdList, CounterBuffer, sizeof(uint32));
+}
+
+bool FGrassCompactionReadback::Poll_RenderThread(FRHICommandListImmediate& RHICmdList, bool bWait)
+{
+    check(IsInRenderingThread());
+
+    if (!Readback->IsReady())
+    {
+        if (!bWait)
+        {
+            return false;
+        }
+        RHICmdList.BlockUntilGPUIdle();
+    }
+
+    NumSurvivors = (int32)*static_cast<const uint32*>(Readback->Lock(sizeof(uint32)));
+    Readback->Unlock();
+    bReady = true;
+    return true;
+}
+
+FPrimitiveSceneProxy* UGrassComponent::CreateSceneProxy()
+{
+    if (!InstanceBuffers.IsValid())
+    {
+        // 被显存预算释放的组件不渲染，直到重新加载完成
+        if (!bInstanceDataEvicted)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("CreateSceneProxy: InstanceCount=%d, SRV Valid=%d"), InstanceBuffers.InstanceCount, InstanceBuffers.InstanceBufferSRV.IsValid());
+        }
+        return nullptr;
+    }
+    UE_LOG(LogTemp, Log, TEXT("CreateSceneProxy: Creating FGrassSceneProxy with GPU Culling=%d"), bEnableFrustumCulling ? 1 : 0);
+    return new FGrassSceneProxy(this);
+}
+
+FBoxSphereBounds UGrassComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+    // 已生成时使用实际覆盖的范围 (覆盖多个 Landscape Component 时不再以组件为中心)
+    if (GeneratedLocalBounds.IsValid)
+    {
+        return FBoxSphereBounds(GeneratedLocalBounds).TransformBy(LocalToWorld);
+    }
+
+    float HalfSize = GridSize * Spacing * 0.5f + 100.0f;
+    // 使用更大的 Z 范围以容纳地形高度变化
+    float ZMin = -5000.0f;
+    float ZMax = 5000.0f;
+    FBox Box(FVector(-HalfSize, -HalfSize, ZMin), FVector(HalfSize, HalfSize, ZMax));
+    return FBoxSphereBounds(Box).TransformBy(LocalToWorld);
+}
+
+void UGrassComponent::GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials) const
+{
+    if (GrassMaterial)
+    {
+        OutMaterials.Add(GrassMaterial);
+    }
+}
+
+EGrassGenerationStage UGrassComponent::GetInvalidatedStages(FName PropertyName, FName MemberPropertyName)
+{
+    // 全局渲染参数 (包括 TaperAmount) 只在 Vertex Factory 中使用，不写入实例数据
+    if (MemberPropertyName == GET_MEMBER_NAME_CHECKED(UGrassComponent, RenderParameters))
+    {
+        return EGrassGenerationStage::ProxyParams;
+    }
+
+    static const TMap<FName, EGrassGenerationStage> PropertyStages = {
+        // 基础网格参数 (实例数量变化时自动重新分配 Buffer)
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, GridSize), EGrassGenerationStage::Positions },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, Spacing), EGrassGenerationStage::Positions },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, JitterStrength), EGrassGenerationStage::Positions },
+        // 簇参数
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, NumClumps), EGrassGenerationStage::Clumps },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bUseVoronoiClumpLookup), EGrassGenerationStage::Clumps },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, VoronoiTextureSize), EGrassGenerationStage::Clumps },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, ClumpTypes), EGrassGenerationStage::Clumps },
+        // 高度图参数
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bUseLandscapeHeightmap), EGrassGenerationStage::Positions },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, LandscapeCoverage), EGrassGenerationStage::Positions },
+        // 密度参数
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, DensityMask), EGrassGenerationStage::Positions },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, DensityLandscapeLayer), EGrassGenerationStage::Positions },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bInvertDensityLayer), EGrassGenerationStage::Positions },
+        // 改变 Buffer 布局 (Visible / Indirect Args Buffer 是否存在)
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bUseIndirectDraw), EGrassGenerationStage::All },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bEnableFrustumCulling), EGrassGenerationStage::All },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bGenerateOnCpu), EGrassGenerationStage::All },
+        // 剔除 / LOD 参数
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bEnableDistanceCulling), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, MaxVisibleDistance), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, GrassBoundingRadius), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bEnableOcclusionCulling), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bStableVisibleOrder), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bTwoPhaseOcclusion), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, CaptureMaxDistanceScale), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, CaptureLOD0DistanceScale), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, CaptureDensity), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bCastGrassShadows), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, ShadowMaxDistance), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, ShadowDensity), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bShadowUseLOD1), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, bEnableLOD), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, LOD0Distance), EGrassGenerationStage::ProxyParams },
+        // 风场噪声参数
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseTexture), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseScale), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseStrength), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseSpeed), EGrassGenerationStage::ProxyParams },
+        // 正弦波风参数
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindWaveSpeed), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindWaveAmplitude), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindSinOffsetRange), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, WindPushTipForward), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, LocalWindRotateAmount), EGrassGenerationStage::ProxyParams },
+        // 网格和材质
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, GrassMesh), EGrassGenerationStage::ProxyParams },
+        { GET_MEMBER_NAME_CHECKED(UGrassComponent, GrassMaterial), EGrassGenerationStage::ProxyParams },
+    };
+
+    const FName Key = (MemberPropertyName != NAME_None) ? MemberPropertyName : PropertyName;
+    const EGrassGenerationStage* Found = PropertyStages.Find(Key);
+    return Found ? *Found : EGrassGenerationStage::None;
+}
+
+#if WITH_EDITOR
+void UGrassComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
     Super::PostEditChangeProperty(PropertyChangedEvent);
     
     // 如果没有启用实时预览，直接返回
@@ -869,72 +1969,13 @@ void UGrassComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChan
         ? PropertyChangedEvent.MemberProperty->GetFName()
         : NAME_None;
     
-    // 需要重新生成草地的属性列表
-    static const TArray<FName> RegenerateProperties = {
-        // 基础网格参数
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, GridSize),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, Spacing),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, JitterStrength),
-        // 簇参数
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, NumClumps),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, ClumpTypes),
-        // 渲染参数
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, RenderParameters),
-        // 高度图参数
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, bUseLandscapeHeightmap),
-        // 风场噪声参数
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseTexture),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseScale),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseStrength),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindNoiseSpeed),
-        // 正弦波风参数
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindWaveSpeed),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindWaveAmplitude),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindSinOffsetRange),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, WindPushTipForward),
-        GET_MEMBER_NAME_CHECKED(UGrassComponent, LocalWindRotateAmount),
-    };
-    
-    // 检查是否需要重新生成
-    bool bShouldRegenerate = false;
-    
-    // 检查直接属性变化
-    if (RegenerateProperties.Contains(PropertyName) || RegenerateProperties.Contains(MemberPropertyName))
+    // 根据属性依赖表只重新执行受影响的阶段
+    // 嵌套在 ClumpTypes / RenderParameters 内的属性 (包括数组增删) 通过 MemberPropertyName 归到外层属性
+    const EGrassGenerationStage Stages = GetInvalidatedStages(PropertyName, MemberPropertyName);
+    if (Stages != EGrassGenerationStage::None)
     {
-        bShouldRegenerate = true;
-    }
-    
-    // 对于数组元素的修改（如 ClumpTypes 数组中的元素）
-    // PropertyChangedEvent.ChangeType 可以帮助判断是添加/删除/修改
-    if (PropertyChangedEvent.ChangeType == EPropertyChangeType::ArrayAdd ||
-        PropertyChangedEvent.ChangeType == EPropertyChangeType::ArrayRemove ||
-        PropertyChangedEvent.ChangeType == EPropertyChangeType::ArrayClear)
-    {
-        bShouldRegenerate = true;
-    }
-    
-    // 如果修改的是 ClumpTypes 数组内的属性（通过检查属性链）
-    if (PropertyChangedEvent.Property != nullptr)
-    {
-        // 遍历属性链查找是否在 ClumpTypes 或 RenderParameters 内
-        for (int32 i = 0; i < PropertyChangedEvent.GetNumObjectsBeingEdited(); ++i)
-        {
-            // 检查是否修改了 FClumpTypeParameters 或 FGrassRenderParameters 结构体内的属性
-            FString PropertyPath = PropertyChangedEvent.Property->GetPathName();
-            if (PropertyPath.Contains(TEXT("ClumpTypeParameters")) || 
-                PropertyPath.Contains(TEXT("GrassRenderParameters")))
-            {
-                bShouldRegenerate = true;
-                break;
-            }
-        }
-    }
-    
-    // 执行重新生成
-    if (bShouldRegenerate)
-    {
-        UE_LOG(LogTemp, Log, TEXT("GrassComponent: Property '%s' changed, regenerating grass..."), *PropertyName.ToString());
-        GenerateGrass();
+        UE_LOG(LogTemp, Log, TEXT("GrassComponent: Property '%s' changed, regenerating stages 0x%02x..."), *PropertyName.ToString(), (uint32)Stages);
+        RegenerateStages(Stages);
     }
 }
 #endif
\ No newline at end of file
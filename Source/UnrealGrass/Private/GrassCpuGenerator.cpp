@@ -0,0 +1,506 @@
+// GrassCpuGenerator.cpp
+// 草地实例数据的 CPU 生成 (SIMD + ParallelFor)
+
+#include "GrassCpuGenerator.h"
+#include "GrassComponent.h"
+#include "GrassClumpGrid.h"
+#include "GrassClumpVoronoi.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+// ============================================================================
+// 哈希函数 (与 GrassClumpCS.usf / GrassPositionCS.usf 一致)
+// ============================================================================
+static FORCEINLINE float GrassFrac(float X)
+{
+    // HLSL frac(x) = x - floor(x)，负数时与截断不同
+    return X - FMath::FloorToFloat(X);
+}
+
+static FORCEINLINE float GrassHash(float X, float Y)
+{
+    return GrassFrac(FMath::Sin(X * 127.1f + Y * 311.7f) * 43758.5453f);
+}
+
+static FORCEINLINE FVector2f GrassHash22(float X, float Y)
+{
+    float A0 = GrassFrac(X * 123.34f);
+    float A1 = GrassFrac(Y * 234.34f);
+    float A2 = GrassFrac(X * 345.65f);
+    const float D = A0 * (A0 + 34.45f) + A1 * (A1 + 34.45f) + A2 * (A2 + 34.45f);
+    A0 += D;
+    A1 += D;
+    A2 += D;
+    return FVector2f(GrassFrac(A0 * A1), GrassFrac(A1 * A2));
+}
+
+static FORCEINLINE FVector2f GrassRandom2D(float X, float Y)
+{
+    return FVector2f(GrassHash(X, Y) * 2.0f - 1.0f, GrassHash(X + 1.0f, Y) * 2.0f - 1.0f);
+}
+
+/** 4 个草叶同时计算 Hash */
+static FORCEINLINE VectorRegister4Float VectorGrassHash(const VectorRegister4Float& X, const VectorRegister4Float& Y)
+{
+    const VectorRegister4Float Dot = VectorMultiplyAdd(X, VectorSetFloat1(127.1f), VectorMultiply(Y, VectorSetFloat1(311.7f)));
+    const VectorRegister4Float S = VectorMultiply(VectorSin(Dot), VectorSetFloat1(43758.5453f));
+    return VectorSubtract(S, VectorFloor(S));
+}
+
+// ============================================================================
+// 每个草叶使用的 10 个哈希值 (与 GrassPositionCS MainCS 中的调用一一对应)
+// ============================================================================
+enum EGrassBladeHash
+{
+    BladeHash_JitterX,      // Random2D(SeedCoord).x
+    BladeHash_JitterY,      // Random2D(SeedCoord).y
+    BladeHash_Height,       // Hash(Seed1)
+    BladeHash_Width,        // Hash(Seed2)
+    BladeHash_Tilt,         // Hash(Seed3)
+    BladeHash_Bend,         // Hash(Seed4)
+    BladeHash_DirX,         // Random2D(float2(sx * 0.15, sy * 0.15)).x
+    BladeHash_DirY,         // Random2D(float2(sx * 0.15, sy * 0.15)).y
+    BladeHash_P1Offset,     // Hash(Seed1 + float2(10, 20))
+    BladeHash_P2Offset,     // Hash(Seed2 + float2(30, 40))
+    BladeHash_Num
+};
+
+/**
+ * 每个通道一个草叶，OutHashes[Hash][Lane]
+ * 标量路径只使用第 0 个通道：所有运算都是逐通道的，两条路径使用同一个 sin 近似 (VectorSin) 和同样的乘加，结果逐位相同
+ */
+static FORCEINLINE void ComputeBladeHashes(const VectorRegister4Float& FX, const VectorRegister4Float& FY, float OutHashes[BladeHash_Num][4])
+{
+    const VectorRegister4Float One = VectorOne();
+
+    auto Seed = [](const VectorRegister4Float& V, float Scale, float Offset)
+    {
+        return VectorMultiplyAdd(V, VectorSetFloat1(Scale), VectorSetFloat1(Offset));
+    };
+
+    const VectorRegister4Float Seed1X = Seed(FX, 0.1f, 0.5f), Seed1Y = Seed(FY, 0.1f, 0.7f);
+    const VectorRegister4Float Seed2X = Seed(FX, 0.2f, 1.3f), Seed2Y = Seed(FY, 0.2f, 2.1f);
+    const VectorRegister4Float Seed3X = Seed(FX, 0.3f, 3.7f), Seed3Y = Seed(FY, 0.3f, 4.9f);
+    const VectorRegister4Float Seed4X = Seed(FX, 0.4f, 5.2f), Seed4Y = Seed(FY, 0.4f, 6.8f);
+    const VectorRegister4Float DirX = VectorMultiply(FX, VectorSetFloat1(0.15f));
+    const VectorRegister4Float DirY = VectorMultiply(FY, VectorSetFloat1(0.15f));
+
+    VectorStore(VectorGrassHash(FX, FY), OutHashes[BladeHash_JitterX]);
+    VectorStore(VectorGrassHash(VectorAdd(FX, One), FY), OutHashes[BladeHash_JitterY]);
+    VectorStore(VectorGrassHash(Seed1X, Seed1Y), OutHashes[BladeHash_Height]);
+    VectorStore(VectorGrassHash(Seed2X, Seed2Y), OutHashes[BladeHash_Width]);
+    VectorStore(VectorGrassHash(Seed3X, Seed3Y), OutHashes[BladeHash_Tilt]);
+    VectorStore(VectorGrassHash(Seed4X, Seed4Y), OutHashes[BladeHash_Bend]);
+    VectorStore(VectorGrassHash(DirX, DirY), OutHashes[BladeHash_DirX]);
+    VectorStore(VectorGrassHash(VectorAdd(DirX, One), DirY), OutHashes[BladeHash_DirY]);
+    VectorStore(VectorGrassHash(VectorAdd(Seed1X, VectorSetFloat1(10.0f)), VectorAdd(Seed1Y, VectorSetFloat1(20.0f))), OutHashes[BladeHash_P1Offset]);
+    VectorStore(VectorGrassHash(VectorAdd(Seed2X, VectorSetFloat1(30.0f)), VectorAdd(Seed2Y, VectorSetFloat1(40.0f))), OutHashes[BladeHash_P2Offset]);
+}
+
+// ============================================================================
+// 生成上下文 (所有行共享的只读数据)
+// ============================================================================
+struct FGrassCpuGenContext
+{
+    const FGrassGenerationParams& Params;
+    const FGrassCpuClumpData& Clumps;
+    const FGrassCpuGenerator::FHeightSampler& HeightSampler;
+
+    TArray<FClumpTypeParameters> ClumpTypes;
+    int32 NumClumpTypes = 1;
+
+    // 生成分块 (Params.Tiles 为空时为单个网格分块)
+    TArray<FGrassGenerationTile> Tiles;
+
+    // Clump 分布范围 (所有分块的并集)
+    FVector2f ClumpDomainCentre = FVector2f::ZeroVector;
+    float HalfSizeX = 0.0f;
+    float HalfSizeY = 0.0f;
+
+    // 最近 Clump 查找 (空间哈希网格或 Voronoi 纹理)
+    TArray<FVector2f> ClumpCentresUV;
+    FGrassClumpGrid ClumpGrid;
+    TArray<FVector4f> VoronoiTexels;
+
+    // 位置量化范围
+    FGrassInstanceQuantization Quantization;
+
+    FGrassCpuGenContext(const FGrassGenerationParams& InParams, const FGrassCpuClumpData& InClumps, const FGrassCpuGenerator::FHeightSampler& InHeightSampler)
+        : Params(InParams)
+        , Clumps(InClumps)
+        , HeightSampler(InHeightSampler)
+    {
+        NumClumpTypes = FMath::Clamp(Params.NumClumpTypes, 1, MAX_CLUMP_TYPES);
+        ClumpTypes = Params.ClumpTypes;
+        ClumpTypes.SetNum(NumClumpTypes);
+
+        Tiles = Params.Tiles;
+        if (Tiles.Num() == 0)
+        {
+            Tiles.Add(FGrassGenerationTile::MakeGridTile(Params.GridSize, Params.Spacing));
+        }
+
+        Quantization = Params.GetQuantization();
+
+        const FBox2f ClumpDomain = Params.GetTileBounds();
+        ClumpDomainCentre = ClumpDomain.GetCenter();
+        HalfSizeX = ClumpDomain.GetExtent().X;
+        HalfSizeY = ClumpDomain.GetExtent().Y;
+
+        ClumpCentresUV.SetNumUninitialized(Clumps.ClumpData0.Num());
+        for (int32 i = 0; i < Clumps.ClumpData0.Num(); ++i)
+        {
+            ClumpCentresUV[i] = FVector2f(Clumps.ClumpData0[i].X, Clumps.ClumpData0[i].Y);
+        }
+
+        if (Params.VoronoiTextureSize > 0)
+        {
+            FGrassClumpVoronoi::Bake(ClumpCentresUV, Params.VoronoiTextureSize, VoronoiTexels);
+        }
+        else
+        {
+            ClumpGrid.Build(ClumpCentresUV);
+        }
+    }
+
+    /**
+     * 使用预先计算的哈希值生成一个草叶 (MainCS 除哈希以外的部分)
+     * X / Y 为分块内的网格坐标，哈希值使用全局网格坐标 (X, Y) + Tile.SeedOffset 计算
+     */
+    void GenerateBlade(int32 TileIndex, int32 X, int32 Y, const float* Hashes, int32 HashStride, FGrassCpuInstanceData& Out) const
+    {
+        auto H = [Hashes, HashStride](EGrassBladeHash Which) { return Hashes[Which * HashStride]; };
+
+        const FGrassGenerationTile& Tile = Tiles[TileIndex];
+        const int32 GridSize = Params.GridSize;
+        const int32 Index = (TileIndex * GridSize + Y) * GridSize + X;
+
+        // 基础位置 (本地坐标，相对于草地组件)
+        FVector3f Position;
+        Position.X = Tile.SampleOrigin.X + (float)X * Tile.CellSize.X;
+        Position.Y = Tile.SampleOrigin.Y + (float)Y * Tile.CellSize.Y;
+        Position.Z = 0.0f;
+
+        // Jitter
+        const float JitterScale = Tile.CellSize.X * Params.JitterStrength * 0.5f;
+        Position.X += (H(BladeHash_JitterX) * 2.0f - 1.0f) * JitterScale;
+        Position.Y += (H(BladeHash_JitterY) * 2.0f - 1.0f) * JitterScale;
+
+        // 地形高度
+        if (Params.bUseLandscapeHeightmap && HeightSampler)
+        {
+            const FVector2f WorldXY = FVector2f(Position.X, Position.Y)
+                + FVector2f(Params.ComponentLocation.X, Params.ComponentLocation.Y);
+            Position.Z = HeightSampler(WorldXY) - Params.ComponentLocation.Z;
+        }
+
+        // 最近的 Clump (使用相对于 Clump 分布范围中心的坐标)
+        const FVector2f PositionLocal = FVector2f(Position.X, Position.Y) - ClumpDomainCentre;
+        int32 NearestClumpIndex = 0;
+        FVector2f NearestClumpCentreLocal(0.0f, 0.0f);
+        if (VoronoiTexels.Num() > 0)
+        {
+            const FVector2f UV(
+                (PositionLocal.X + HalfSizeX) / (HalfSizeX * 2.0f),
+                (PositionLocal.Y + HalfSizeY) / (HalfSizeY * 2.0f));
+            const FIntPoint Texel = FGrassClumpVoronoi::GetTexel(UV, Params.VoronoiTextureSize);
+            const FVector4f& Voronoi = VoronoiTexels[Texel.Y * Params.VoronoiTextureSize + Texel.X];
+            NearestClumpIndex = FMath::Clamp((int32)(Voronoi.X + 0.5f), 0, Clumps.ClumpData0.Num() - 1);
+            NearestClumpCentreLocal = FVector2f(
+                Voronoi.Y * HalfSizeX * 2.0f - HalfSizeX,
+                Voronoi.Z * HalfSizeY * 2.0f - HalfSizeY);
+        }
+        else
+        {
+            NearestClumpIndex = ClumpGrid.FindNearest(ClumpCentresUV, PositionLocal, HalfSizeX, HalfSizeY, &NearestClumpCentreLocal);
+        }
+        NearestClumpCentreLocal += ClumpDomainCentre;
+
+        const FVector4f& ClumpData0 = Clumps.ClumpData0[NearestClumpIndex];
+        const FVector4f& ClumpData1 = Clumps.ClumpData1[NearestClumpIndex];
+        const FVector2f ClumpDirection(ClumpData0.Z, ClumpData0.W);
+        const float ClumpHeightScale = ClumpData1.X;
+        const float ClumpWidthScale = ClumpData1.Y;
+        const int32 ClumpTypeIndex = FMath::Clamp((int32)(ClumpData1.W + 0.5f), 0, NumClumpTypes - 1);
+        const FClumpTypeParameters& TypeData = ClumpTypes[ClumpTypeIndex];
+
+        // Pull to centre
+        Position.X += (NearestClumpCentreLocal.X - Position.X) * TypeData.PullToCentre;
+        Position.Y += (NearestClumpCentreLocal.Y - Position.Y) * TypeData.PullToCentre;
+
+        // 草叶属性
+        float Height = (TypeData.BaseHeight + (H(BladeHash_Height) * 2.0f - 1.0f) * TypeData.HeightRandom) * ClumpHeightScale;
+        float Width = (TypeData.BaseWidth + (H(BladeHash_Width) * 2.0f - 1.0f) * TypeData.WidthRandom) * ClumpWidthScale;
+        float Tilt = TypeData.BaseTilt + (H(BladeHash_Tilt) * 2.0f - 1.0f) * TypeData.TiltRandom;
+        float Bend = TypeData.BaseBend + (H(BladeHash_Bend) * 2.0f - 1.0f) * TypeData.BendRandom;
+        Height = FMath::Max(Height, 1.0f);
+        Width = FMath::Max(Width, 0.1f);
+        Tilt = FMath::Clamp(Tilt, 0.0f, 1.0f);
+        Bend = FMath::Clamp(Bend, 0.0f, 1.0f);
+
+        // 朝向
+        FVector2f IndividualDir(H(BladeHash_DirX) * 2.0f - 1.0f, H(BladeHash_DirY) * 2.0f - 1.0f);
+        const float IndividualDirLen = IndividualDir.Size();
+        if (IndividualDirLen > 0.001f)
+        {
+            IndividualDir /= IndividualDirLen;
+        }
+        FVector2f FacingDir = FMath::Lerp(IndividualDir, ClumpDirection, TypeData.PointInSameDirection);
+        const float FacingDirLen = FacingDir.Size();
+        if (FacingDirLen > 0.001f)
+        {
+            FacingDir /= FacingDirLen;
+        }
+
+        // Bezier 控制点偏移
+        const float P1Offset = H(BladeHash_P1Offset) * 0.3f;
+        const float P2Offset = H(BladeHash_P2Offset) * 0.5f;
+
+        FGrassInstance Instance;
+        Instance.Position = Position;
+        Instance.Height = Height;
+        Instance.Width = Width;
+        Instance.Tilt = Tilt;
+        Instance.Bend = Bend;
+        Instance.FacingDir = FacingDir;
+        Instance.P1Offset = P1Offset;
+        Instance.P2Offset = P2Offset;
+        Out.Instances[Index] = FGrassInstancePacking::Pack(Instance, Quantization);
+    }
+};
+
+// ============================================================================
+// FGrassCpuGenerator 实现
+// ============================================================================
+void FGrassCpuGenerator::GenerateClumps(int32 NumClumps, int32 NumClumpTypes, FGrassCpuClumpData& OutClumps)
+{
+    NumClumps = FMath::Max(NumClumps, 1);
+    NumClumpTypes = FMath::Max(NumClumpTypes, 1);
+
+    OutClumps.ClumpData0.SetNumUninitialized(NumClumps);
+    OutClumps.ClumpData1.SetNumUninitialized(NumClumps);
+
+    for (int32 ClumpIndex = 0; ClumpIndex < NumClumps; ++ClumpIndex)
+    {
+        const float Seed = (float)ClumpIndex;
+
+        const FVector2f Centre = GrassHash22(Seed + 1.0f, Seed + 1.0f);
+
+        FVector2f Direction = GrassRandom2D(ClumpIndex * 100.0f, ClumpIndex * 50.0f);
+        const float DirLen = Direction.Size();
+        Direction = (DirLen > 0.001f) ? Direction / DirLen : FVector2f(1.0f, 0.0f);
+
+        const float WindPhase = GrassHash(Seed + 50.0f, Seed + 60.0f) * 6.28318530718f;
+        const float TypeRandom = GrassHash(Seed + 70.0f, Seed + 80.0f);
+        const int32 ClumpTypeIndex = FMath::Clamp((int32)(TypeRandom * NumClumpTypes), 0, NumClumpTypes - 1);
+
+        OutClumps.ClumpData0[ClumpIndex] = FVector4f(Centre.X, Centre.Y, Direction.X, Direction.Y);
+        OutClumps.ClumpData1[ClumpIndex] = FVector4f(1.0f, 1.0f, WindPhase, (float)ClumpTypeIndex);
+    }
+}
+
+void FGrassCpuGenerator::GenerateInstances(const FGrassGenerationParams& Params, const FGrassCpuClumpData& Clumps,
+    FGrassCpuInstanceData& OutInstances, const FHeightSampler& HeightSampler, bool bUseSimd)
+{
+    const int32 GridSize = Params.GridSize;
+    const int32 NumTiles = Params.GetNumTiles();
+    const int32 Total = Params.GetInstanceCount();
+
+    OutInstances.Instances.SetNumUninitialized(Total);
+    OutInstances.Quantization = Params.GetQuantization();
+
+    if (GridSize < 2 || Clumps.ClumpData0.Num() == 0)
+    {
+        return;
+    }
+
+    const FGrassCpuGenContext Context(Params, Clumps, HeightSampler);
+
+    // 所有分块的所有行一起 ParallelFor
+    ParallelFor(NumTiles * GridSize, [&Context, &OutInstances, GridSize, bUseSimd](int32 Row)
+    {
+        const int32 TileIndex = Row / GridSize;
+        const int32 Y = Row % GridSize;
+        const FIntPoint SeedOffset = Context.Tiles[TileIndex].SeedOffset;
+
+        if (bUseSimd)
+        {
+            // 每次 4 个草叶，行尾不足 4 个时多出来的通道只计算不写入
+            const VectorRegister4Float FY = VectorSetFloat1((float)(Y + SeedOffset.Y));
+            float Hashes[BladeHash_Num][4];
+            for (int32 X0 = 0; X0 < GridSize; X0 += 4)
+            {
+                const int32 SeedX = X0 + SeedOffset.X;
+                ComputeBladeHashes(MakeVectorRegisterFloat((float)SeedX, (float)(SeedX + 1), (float)(SeedX + 2), (float)(SeedX + 3)), FY, Hashes);
+                const int32 NumLanes = FMath::Min(4, GridSize - X0);
+                for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+                {
+                    Context.GenerateBlade(TileIndex, X0 + Lane, Y, &Hashes[0][Lane], 4, OutInstances);
+                }
+            }
+        }
+        else
+        {
+            const VectorRegister4Float FY = VectorSetFloat1((float)(Y + SeedOffset.Y));
+            float Hashes[BladeHash_Num][4];
+            for (int32 X = 0; X < GridSize; ++X)
+            {
+                ComputeBladeHashes(VectorSetFloat1((float)(X + SeedOffset.X)), FY, Hashes);
+                Context.GenerateBlade(TileIndex, X, Y, &Hashes[0][0], 4, OutInstances);
+            }
+        }
+    });
+}
+
+void FGrassCpuGenerator::Generate(const FGrassGenerationParams& Params, FGrassCpuInstanceData& OutInstances,
+    const FHeightSampler& HeightSampler, bool bUseSimd)
+{
+    FGrassCpuClumpData Clumps;
+    GenerateClumps(Params.NumClumps, Params.NumClumpTypes, Clumps);
+    GenerateInstances(Params, Clumps, OutInstances, HeightSampler, bUseSimd);
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 测试：SIMD 与标量路径的输出逐位相同 (包括行尾不足 4 个草叶、Voronoi 查找和多个分块)；
+// 相同参数 (网格坐标 + 分块的 SeedOffset) 重复生成的结果相同，SeedOffset 不同时结果不同
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassCpuGeneratorTest, "UnrealGrass.CpuGenerator",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassCpuGeneratorTest::RunTest(const FString& Parameters)
+{
+    auto CountMismatches = [](const FGrassCpuInstanceData& A, const FGrassCpuInstanceData& B)
+    {
+        int32 NumMismatches = FMath::Abs(A.Num() - B.Num());
+        for (int32 Index = 0; Index < FMath::Min(A.Num(), B.Num()); ++Index)
+        {
+            NumMismatches += A.Instances[Index] != B.Instances[Index] ? 1 : 0;
+        }
+        return NumMismatches;
+    };
+
+    struct FCase
+    {
+        const TCHAR* Name;
+        int32 GridSize;
+        int32 VoronoiTextureSize;
+        int32 NumTiles;
+        int32 NumClumpTypes;
+    };
+    const FCase Cases[] = {
+        { TEXT("grid lookup, partial SIMD group at the row end"), 37, 0, 1, 1 },
+        { TEXT("Voronoi lookup"), 64, 64, 1, 1 },
+        { TEXT("two tiles, three clump types"), 30, 0, 2, 3 },
+    };
+
+    for (const FCase& Case : Cases)
+    {
+        FGrassGenerationParams Params;
+        Params.GridSize = Case.GridSize;
+        Params.NumClumps = 40;
+        Params.NumClumpTypes = Case.NumClumpTypes;
+        Params.VoronoiTextureSize = Case.VoronoiTextureSize;
+        Params.ClumpTypes.SetNum(Case.NumClumpTypes);
+        for (int32 TypeIndex = 0; TypeIndex < Case.NumClumpTypes; ++TypeIndex)
+        {
+            Params.ClumpTypes[TypeIndex].PullToCentre = 0.25f * TypeIndex;
+            Params.ClumpTypes[TypeIndex].PointInSameDirection = 0.3f * TypeIndex;
+        }
+        if (Case.NumTiles > 1)
+        {
+            // 相邻的分块使用连续的全局网格坐标作为哈希种子 (与 CollectLandscapeTiles 相同)
+            for (int32 TileIndex = 0; TileIndex < Case.NumTiles; ++TileIndex)
+            {
+                FGrassGenerationTile Tile = FGrassGenerationTile::MakeGridTile(Case.GridSize, Params.Spacing);
+                const float TileOffset = Case.GridSize * Params.Spacing * TileIndex;
+                Tile.SampleOrigin.X += TileOffset;
+                Tile.TileMin.X += TileOffset;
+                Tile.SeedOffset = FIntPoint(Case.GridSize * TileIndex, 0);
+                Params.Tiles.Add(Tile);
+            }
+        }
+
+        FGrassCpuClumpData Clumps, ClumpsRepeat;
+        FGrassCpuGenerator::GenerateClumps(Params.NumClumps, Params.NumClumpTypes, Clumps);
+        FGrassCpuGenerator::GenerateClumps(Params.NumClumps, Params.NumClumpTypes, ClumpsRepeat);
+        TestTrue(FString::Printf(TEXT("%s: clumps are deterministic"), Case.Name),
+            Clumps.ClumpData0 == ClumpsRepeat.ClumpData0 && Clumps.ClumpData1 == ClumpsRepeat.ClumpData1);
+
+        FGrassCpuInstanceData Simd, SimdRepeat, Scalar;
+        FGrassCpuGenerator::GenerateInstances(Params, Clumps, Simd, nullptr, true);
+        FGrassCpuGenerator::GenerateInstances(Params, Clumps, SimdRepeat, nullptr, true);
+        FGrassCpuGenerator::GenerateInstances(Params, Clumps, Scalar, nullptr, false);
+
+        TestEqual(FString::Printf(TEXT("%s: one instance per grid point"), Case.Name), Simd.Num(), Params.GetInstanceCount());
+        TestEqual(FString::Printf(TEXT("%s: SIMD instances differing from the scalar path"), Case.Name), CountMismatches(Simd, Scalar), 0);
+        TestEqual(FString::Printf(TEXT("%s: instances differing between two identical runs"), Case.Name), CountMismatches(Simd, SimdRepeat), 0);
+
+        // 不同的种子 (整体平移网格坐标) 得到不同的草地
+        for (FGrassGenerationTile& Tile : Params.Tiles)
+        {
+            Tile.SeedOffset.Y += 1000;
+        }
+        if (Params.Tiles.Num() == 0)
+        {
+            FGrassGenerationTile Tile = FGrassGenerationTile::MakeGridTile(Case.GridSize, Params.Spacing);
+            Tile.SeedOffset = FIntPoint(0, 1000);
+            Params.Tiles.Add(Tile);
+        }
+        FGrassCpuInstanceData Reseeded;
+        FGrassCpuGenerator::GenerateInstances(Params, Clumps, Reseeded, nullptr, true);
+        TestTrue(FString::Printf(TEXT("%s: a different seed offset changes the instances"), Case.Name),
+            CountMismatches(Simd, Reseeded) > Simd.Num() / 2);
+    }
+
+    return true;
+}
+
+// ============================================================================
+// 基准测试：GridSize 256 / 512 / 1024 下 SIMD 与标量路径的每核每秒实例数 (三次取最快)
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassCpuGeneratorBenchmark, "UnrealGrass.CpuGenerator.Benchmark",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGrassCpuGeneratorBenchmark::RunTest(const FString& Parameters)
+{
+    const int32 Iterations = 3;
+    const int32 NumCores = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+    FGrassGenerationParams Params;
+    Params.ClumpTypes.SetNum(1);
+
+    FGrassCpuClumpData Clumps;
+    FGrassCpuGenerator::GenerateClumps(Params.NumClumps, Params.NumClumpTypes, Clumps);
+
+    static const int32 GridSizes[] = { 256, 512, 1024 };
+    for (const int32 GridSize : GridSizes)
+    {
+        Params.GridSize = GridSize;
+        const int32 Total = GridSize * GridSize;
+
+        for (const bool bUseSimd : { true, false })
+        {
+            FGrassCpuInstanceData Instances;
+            double BestSeconds = DBL_MAX;
+            for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+            {
+                const double StartTime = FPlatformTime::Seconds();
+                FGrassCpuGenerator::GenerateInstances(Params, Clumps, Instances, nullptr, bUseSimd);
+                BestSeconds = FMath::Min(BestSeconds, FPlatformTime::Seconds() - StartTime);
+            }
+
+            const double InstancesPerSecond = (double)Total / FMath::Max(BestSeconds, 1e-9);
+            AddInfo(FString::Printf(TEXT("GridSize=%d (%d instances) %s: %.2f ms, %.2f M instances/s, %.2f M instances/s/core (%d cores)"),
+                GridSize, Total, bUseSimd ? TEXT("SIMD  ") : TEXT("Scalar"), BestSeconds * 1000.0,
+                InstancesPerSecond / 1e6, InstancesPerSecond / 1e6 / NumCores, NumCores));
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
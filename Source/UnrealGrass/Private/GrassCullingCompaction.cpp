@@ -0,0 +1,260 @@
+// GrassCullingCompaction.cpp
+// 可见列表压缩的 CPU 模型 (原子追加 + 稳定顺序) + 测试 (自动化测试 UnrealGrass.CullingCompaction，不需要 RHI)
+
+#include "GrassCullingCompaction.h"
+#include "Math/RandomStream.h"
+#include "Algo/IsSorted.h"
+
+template<typename T>
+static void ShuffleGrassArray(TArray<T>& Array, FRandomStream& Random)
+{
+    for (int32 i = Array.Num() - 1; i > 0; --i)
+    {
+        Array.Swap(i, Random.RandRange(0, i));
+    }
+}
+
+// ============================================================================
+// 模拟
+// ============================================================================
+void FGrassCullingCompaction::SimulateStable(TConstArrayView<EGrassCulledLOD> Instances, int32 GroupSize, FResult& OutResult)
+{
+    const int32 NumInstances = Instances.Num();
+    const int32 NumGroups = FMath::DivideAndRoundUp(NumInstances, GroupSize);
+
+    // Pass 1：每个线程组 (剔除块) 的可见数量 (线程组之间没有依赖，执行顺序不影响结果)
+    TArray<FUintVector2> GroupOffsets;
+    GroupOffsets.SetNumZeroed(NumGroups);
+    for (int32 InstanceIndex = 0; InstanceIndex < NumInstances; ++InstanceIndex)
+    {
+        FUintVector2& Count = GroupOffsets[InstanceIndex / GroupSize];
+        Count.X += Instances[InstanceIndex] == EGrassCulledLOD::LOD0 ? 1 : 0;
+        Count.Y += Instances[InstanceIndex] == EGrassCulledLOD::LOD1 ? 1 : 0;
+    }
+
+    // 扫描：计数 -> 排他前缀和 (ScanTileVisibleCountsCS)
+    FUintVector2 Total(0, 0);
+    for (FUintVector2& Offset : GroupOffsets)
+    {
+        const FUintVector2 Count = Offset;
+        Offset = Total;
+        Total.X += Count.X;
+        Total.Y += Count.Y;
+    }
+
+    // Pass 2：组内按线程顺序的前缀和 + 线程组的输出起点
+    OutResult.VisibleLOD0.Init(INDEX_NONE, Total.X);
+    OutResult.VisibleLOD1.Init(INDEX_NONE, Total.Y);
+    OutResult.NumGlobalAtomics = 0;
+    for (int32 Group = 0; Group < NumGroups; ++Group)
+    {
+        FUintVector2 Local(0, 0);
+        for (int32 InstanceIndex = Group * GroupSize; InstanceIndex < FMath::Min((Group + 1) * GroupSize, NumInstances); ++InstanceIndex)
+        {
+            if (Instances[InstanceIndex] == EGrassCulledLOD::LOD0)
+            {
+                OutResult.VisibleLOD0[GroupOffsets[Group].X + Local.X++] = InstanceIndex;
+            }
+            else if (Instances[InstanceIndex] == EGrassCulledLOD::LOD1)
+            {
+                OutResult.VisibleLOD1[GroupOffsets[Group].Y + Local.Y++] = InstanceIndex;
+            }
+        }
+    }
+}
+
+void FGrassCullingCompaction::Simulate(EGrassCullingCompaction Mode, TConstArrayView<EGrassCulledLOD> Instances, int32 GroupSize, int32 WaveSize,
+    FRandomStream& Random, FResult& OutResult)
+{
+    check(GroupSize > 0);
+    const int32 NumInstances = Instances.Num();
+    const int32 NumGroups = FMath::DivideAndRoundUp(NumInstances, GroupSize);
+
+    if (Mode == EGrassCullingCompaction::Stable)
+    {
+        SimulateStable(Instances, GroupSize, OutResult);
+        return;
+    }
+
+    const int32 UnitSize = Mode == EGrassCullingCompaction::Wave ? FMath::Clamp(WaveSize, 1, GroupSize) : GroupSize;
+    check(GroupSize % UnitSize == 0);
+    const int32 UnitsPerGroup = GroupSize / UnitSize;
+
+    // 全局原子操作的执行单位 (线程组或 Wave)，GPU 上它们的先后顺序不确定
+    TArray<int32> Units;
+    Units.SetNumUninitialized(NumGroups * UnitsPerGroup);
+    for (int32 i = 0; i < Units.Num(); ++i)
+    {
+        Units[i] = i;
+    }
+    ShuffleGrassArray(Units, Random);
+
+    OutResult.VisibleLOD0.Init(INDEX_NONE, NumInstances);
+    OutResult.VisibleLOD1.Init(INDEX_NONE, NumInstances);
+    OutResult.NumGlobalAtomics = 0;
+
+    uint32 GlobalCounter[2] = { 0, 0 };
+    TArray<int32> LaneOrder;
+    TArray<uint32> LocalIndex;
+    LaneOrder.SetNumUninitialized(UnitSize);
+    LocalIndex.SetNumUninitialized(UnitSize);
+
+    for (const int32 Unit : Units)
+    {
+        const int32 FirstInstance = Unit * UnitSize;
+
+        // 组内偏移：groupshared 原子操作的顺序不确定；WavePrefixCountBits 按 Lane 顺序
+        for (int32 Lane = 0; Lane < UnitSize; ++Lane)
+        {
+            LaneOrder[Lane] = Lane;
+        }
+        if (Mode == EGrassCullingCompaction::GroupShared)
+        {
+            ShuffleGrassArray(LaneOrder, Random);
+        }
+
+        uint32 UnitCount[2] = { 0, 0 };
+        for (const int32 Lane : LaneOrder)
+        {
+            const int32 InstanceIndex = FirstInstance + Lane;
+            const EGrassCulledLOD LOD = InstanceIndex < NumInstances ? Instances[InstanceIndex] : EGrassCulledLOD::Culled;
+            if (LOD != EGrassCulledLOD::Culled)
+            {
+                LocalIndex[Lane] = UnitCount[LOD == EGrassCulledLOD::LOD0 ? 0 : 1]++;
+            }
+        }
+
+        // 每个 LOD 一次全局原子操作
+        uint32 UnitBase[2] = { 0, 0 };
+        for (int32 LODIndex = 0; LODIndex < 2; ++LODIndex)
+        {
+            if (UnitCount[LODIndex] > 0)
+            {
+                UnitBase[LODIndex] = GlobalCounter[LODIndex];
+                GlobalCounter[LODIndex] += UnitCount[LODIndex];
+                ++OutResult.NumGlobalAtomics;
+            }
+        }
+
+        for (int32 Lane = 0; Lane < UnitSize; ++Lane)
+        {
+            const int32 InstanceIndex = FirstInstance + Lane;
+            if (InstanceIndex >= NumInstances || Instances[InstanceIndex] == EGrassCulledLOD::Culled)
+            {
+                continue;
+            }
+            const int32 LODIndex = Instances[InstanceIndex] == EGrassCulledLOD::LOD0 ? 0 : 1;
+            TArray<int32>& Visible = LODIndex == 0 ? OutResult.VisibleLOD0 : OutResult.VisibleLOD1;
+            Visible[UnitBase[LODIndex] + LocalIndex[Lane]] = InstanceIndex;
+        }
+    }
+
+    // 与 Indirect Args 中的 InstanceCount 一致
+    OutResult.VisibleLOD0.SetNum(GlobalCounter[0]);
+    OutResult.VisibleLOD1.SetNum(GlobalCounter[1]);
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 测试：随机可见性下输出数量、集合和原子操作次数
+// ============================================================================
+static bool CheckGrassCompactedList(TArray<int32> Visible, TConstArrayView<EGrassCulledLOD> Instances, EGrassCulledLOD LOD)
+{
+    // 没有空洞，排序后与期望的实例集合完全相同 (也就没有重复)
+    if (Visible.Contains(INDEX_NONE))
+    {
+        return false;
+    }
+    Visible.Sort();
+
+    int32 Next = 0;
+    for (int32 InstanceIndex = 0; InstanceIndex < Instances.Num(); ++InstanceIndex)
+    {
+        if (Instances[InstanceIndex] != LOD)
+        {
+            continue;
+        }
+        if (Next >= Visible.Num() || Visible[Next] != InstanceIndex)
+        {
+            return false;
+        }
+        ++Next;
+    }
+    return Next == Visible.Num();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassCullingCompactionTest, "UnrealGrass.CullingCompaction",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassCullingCompactionTest::RunTest(const FString& Parameters)
+{
+    const int32 NumInstances = 100000;
+    constexpr int32 GroupSize = 64;
+
+    struct FModeCase
+    {
+        const TCHAR* Name;
+        EGrassCullingCompaction Mode;
+        int32 WaveSize;
+    };
+    const FModeCase ModeCases[] = {
+        { TEXT("GroupShared"), EGrassCullingCompaction::GroupShared, GroupSize },
+        { TEXT("Wave32"), EGrassCullingCompaction::Wave, 32 },
+        { TEXT("Wave64"), EGrassCullingCompaction::Wave, 64 },
+        { TEXT("Stable"), EGrassCullingCompaction::Stable, GroupSize },
+    };
+    const float VisibleFractions[] = { 0.0f, 0.001f, 0.3f, 1.0f };
+
+    FRandomStream Random(0x6C7A);
+    TArray<EGrassCulledLOD> Instances;
+    FGrassCullingCompaction::FResult Result;
+
+    // 两种数量：整数个线程组 + 最后一组不满
+    for (const int32 Count : { FMath::Max(NumInstances / GroupSize, 1) * GroupSize, NumInstances + 37 })
+    {
+        for (const float VisibleFraction : VisibleFractions)
+        {
+            Instances.SetNumUninitialized(Count);
+            int32 NumVisible = 0;
+            for (EGrassCulledLOD& LOD : Instances)
+            {
+                LOD = Random.FRand() < VisibleFraction
+                    ? (Random.FRand() < 0.5f ? EGrassCulledLOD::LOD0 : EGrassCulledLOD::LOD1)
+                    : EGrassCulledLOD::Culled;
+                NumVisible += LOD != EGrassCulledLOD::Culled ? 1 : 0;
+            }
+
+            for (const FModeCase& Case : ModeCases)
+            {
+                FGrassCullingCompaction::Simulate(Case.Mode, Instances, GroupSize, Case.WaveSize, Random, Result);
+
+                // 每个线程组 / Wave 每个 LOD 最多一次；稳定顺序没有全局原子操作，输出与实例顺序相同 (两次执行结果一致)
+                const int32 NumUnits = FMath::DivideAndRoundUp(Count, GroupSize) * (GroupSize / Case.WaveSize);
+                bool bPassed = CheckGrassCompactedList(Result.VisibleLOD0, Instances, EGrassCulledLOD::LOD0)
+                    && CheckGrassCompactedList(Result.VisibleLOD1, Instances, EGrassCulledLOD::LOD1)
+                    && Result.NumGlobalAtomics <= NumUnits * 2;
+                if (Case.Mode == EGrassCullingCompaction::Stable)
+                {
+                    FGrassCullingCompaction::FResult Repeat;
+                    FGrassCullingCompaction::Simulate(Case.Mode, Instances, GroupSize, Case.WaveSize, Random, Repeat);
+                    bPassed &= Result.NumGlobalAtomics == 0
+                        && Algo::IsSorted(Result.VisibleLOD0)
+                        && Algo::IsSorted(Result.VisibleLOD1)
+                        && Repeat.VisibleLOD0 == Result.VisibleLOD0
+                        && Repeat.VisibleLOD1 == Result.VisibleLOD1;
+                }
+
+                TestTrue(FString::Printf(TEXT("%s, %d instances, %.1f%% visible: LOD0 %d, LOD1 %d, %d global atomics (per-instance atomics: %d)"),
+                    Case.Name, Count, VisibleFraction * 100.0f,
+                    Result.VisibleLOD0.Num(), Result.VisibleLOD1.Num(), Result.NumGlobalAtomics, NumVisible), bPassed);
+            }
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
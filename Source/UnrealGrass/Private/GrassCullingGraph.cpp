@@ -0,0 +1,147 @@
+// GrassCullingGraph.cpp
+// 剔除的 RDG 封装实现
+
+#include "GrassCullingGraph.h"
+#include "RenderGraphBuilder.h"
+#include "RenderResource.h"
+#include "RHICommandList.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarGrassCullingAsyncCompute(
+    TEXT("r.Grass.Culling.AsyncCompute"),
+    1,
+    TEXT("Run the grass culling passes at the start of the frame (primary view, per-view and stereo culling) on the async compute pipe so that they overlap the graphics passes recorded before them; they are joined with the graphics pipe before the depth prepass. Only used when the RHI supports efficient async compute. 0 = graphics pipe."),
+    ECVF_RenderThreadSafe
+);
+
+/**
+ * 外部 Buffer 的 RDG 包装：每个 RHI Buffer 一个 FRDGPooledBuffer，跨帧保留 (RDG 在包装中记录 Buffer 的状态)
+ * Buffer 池的页被多个组件共享，同一个页在一次 RDG 中只注册一次
+ */
+class FGrassRDGExternalBuffers : public FRenderResource
+{
+public:
+    TMap<FRHIBuffer*, TRefCountPtr<FRDGPooledBuffer>> PooledBuffers;
+
+    // 等待 PublishDrawnBuffers 的剔除输出和绘制时的状态
+    TArray<TPair<TRefCountPtr<FRDGPooledBuffer>, ERHIAccess>> PendingDrawn;
+
+    virtual void ReleaseRHI() override
+    {
+        PooledBuffers.Empty();
+        PendingDrawn.Empty();
+    }
+
+    virtual FString GetFriendlyName() const override { return TEXT("FGrassRDGExternalBuffers"); }
+};
+
+static TGlobalResource<FGrassRDGExternalBuffers> GGrassRDGExternalBuffers;
+
+static TRefCountPtr<FRDGPooledBuffer> FindOrCreateGrassPooledBuffer(FRHICommandListBase& RHICmdList, FRHIBuffer* Buffer, const TCHAR* Name)
+{
+    check(IsInRenderingThread());
+
+    TRefCountPtr<FRDGPooledBuffer>& PooledBuffer = GGrassRDGExternalBuffers.PooledBuffers.FindOrAdd(Buffer);
+    if (!PooledBuffer.IsValid())
+    {
+        // RDG 的描述从 RHI Buffer 得到 (Indirect Args 等非结构化 Buffer 按 uint 元素)
+        const FRHIBufferDesc& RHIDesc = Buffer->GetDesc();
+        FRDGBufferDesc Desc;
+        Desc.BytesPerElement = RHIDesc.Stride > 0 ? RHIDesc.Stride : sizeof(uint32);
+        Desc.NumElements = RHIDesc.Size / Desc.BytesPerElement;
+        Desc.Usage = RHIDesc.Usage;
+        PooledBuffer = new FRDGPooledBuffer(RHICmdList, Buffer, Desc, Desc.NumElements, Name);
+    }
+    return PooledBuffer;
+}
+
+FGrassCullingGraph::FGrassCullingGraph(FRDGBuilder& InGraphBuilder, bool bAllowAsyncCompute)
+    : GraphBuilder(InGraphBuilder)
+{
+    const bool bAsyncCompute = bAllowAsyncCompute && GSupportsEfficientAsyncCompute && CVarGrassCullingAsyncCompute.GetValueOnRenderThread() != 0;
+    PassFlags = ERDGPassFlags::NeverCull | (bAsyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute);
+}
+
+FRDGBufferRef FGrassCullingGraph::RegisterBuffer(FRHIBuffer* Buffer, const TCHAR* Name, ERHIAccess AccessFinal) const
+{
+    if (!Buffer)
+    {
+        return nullptr;
+    }
+
+    FRDGBufferRef RDGBuffer = GraphBuilder.RegisterExternalBuffer(FindOrCreateGrassPooledBuffer(GraphBuilder.RHICmdList, Buffer, Name));
+    GraphBuilder.SetBufferAccessFinal(RDGBuffer, AccessFinal);
+    return RDGBuffer;
+}
+
+FRDGBufferRef FGrassCullingGraph::RegisterDrawnBuffer(FRHIBuffer* Buffer, const TCHAR* Name, ERHIAccess DrawAccess) const
+{
+    FRDGBufferRef RDGBuffer = RegisterBuffer(Buffer, Name, DrawAccess);
+    if (RDGBuffer)
+    {
+        TRefCountPtr<FRDGPooledBuffer> PooledBuffer = GGrassRDGExternalBuffers.PooledBuffers.FindChecked(Buffer);
+        const bool bPending = GGrassRDGExternalBuffers.PendingDrawn.ContainsByPredicate([&PooledBuffer](const TPair<TRefCountPtr<FRDGPooledBuffer>, ERHIAccess>& Entry)
+        {
+            return Entry.Key == PooledBuffer;
+        });
+        if (!bPending)
+        {
+            GGrassRDGExternalBuffers.PendingDrawn.Emplace(MoveTemp(PooledBuffer), DrawAccess);
+        }
+    }
+    return RDGBuffer;
+}
+
+FGrassRDGPassAccess* FGrassCullingGraph::AllocPassAccess(FRDGTextureRef HiZTexture) const
+{
+    FGrassRDGPassAccess* PassAccess = GraphBuilder.AllocParameters<FGrassRDGPassAccess>();
+    PassAccess->HiZTexture = HiZTexture;
+    return PassAccess;
+}
+
+void FGrassCullingGraph::AddAccess(FGrassRDGPassAccess& PassAccess, FRDGBufferRef Buffer, ERHIAccess Access)
+{
+    if (Buffer)
+    {
+        PassAccess.Buffers.Emplace(Buffer, Access);
+    }
+}
+
+void FGrassCullingGraph::PublishDrawnBuffers(FRDGBuilder& GraphBuilder)
+{
+    check(IsInRenderingThread());
+
+    TArray<TPair<TRefCountPtr<FRDGPooledBuffer>, ERHIAccess>>& PendingDrawn = GGrassRDGExternalBuffers.PendingDrawn;
+    if (PendingDrawn.Num() == 0)
+    {
+        return;
+    }
+
+    FGrassRDGPassAccess* PassAccess = GraphBuilder.AllocParameters<FGrassRDGPassAccess>();
+    for (const TPair<TRefCountPtr<FRDGPooledBuffer>, ERHIAccess>& Entry : PendingDrawn)
+    {
+        AddAccess(*PassAccess, GraphBuilder.RegisterExternalBuffer(Entry.Key), Entry.Value);
+    }
+    PendingDrawn.Reset();
+
+    // 空 Pass：只有读取声明，RDG 在它之前等待异步计算并转换状态，之后的 Mesh 绘制 (RDG 不知道) 可以直接读取
+    GraphBuilder.AddPass(
+        RDG_EVENT_NAME("GrassPublishCullingOutputs"),
+        PassAccess,
+        ERDGPassFlags::Compute | ERDGPassFlags::NeverCull,
+        [](FRHIComputeCommandList& RHICmdList) {});
+}
+
+void FGrassCullingGraph::PruneExternalBuffers()
+{
+    check(IsInRenderingThread());
+
+    for (auto It = GGrassRDGExternalBuffers.PooledBuffers.CreateIterator(); It; ++It)
+    {
+        // 包装自己持有 RHI Buffer 的一个引用：没有其他引用时组件或槽位已经释放了这个 Buffer
+        if (It.Value()->GetRefCount() == 1 && It.Value()->GetRHI()->GetRefCount() == 1)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
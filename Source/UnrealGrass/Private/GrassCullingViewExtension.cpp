@@ -3,6 +3,8 @@
 
 #include "GrassCullingViewExtension.h"
 #include "GrassSceneProxy.h"
+#include "GrassStats.h"
+#include "GrassCullingGraph.h"
 #include "SceneView.h"
 #include "RenderGraphBuilder.h"
 #include "RHICommandList.h"
@@ -10,6 +12,9 @@
 #include "GlobalShader.h"
 #include "ShaderParameterStruct.h"
 #include "RenderGraphUtils.h"
+#include "SceneRenderTargetParameters.h"
+#include "RenderUtils.h"
+#include "StereoRendering.h"
 
 // Debug CVar to show culling stats
 static TAutoConsoleVariable<int32> CVarGrassCullingDebug(
@@ -26,6 +31,52 @@ static TAutoConsoleVariable<int32> CVarGrassHiZDebug(
     ECVF_RenderThreadSafe
 );
 
+static TAutoConsoleVariable<int32> CVarGrassHiZSinglePass(
+    TEXT("r.Grass.HiZSinglePass"),
+    1,
+    TEXT("Build the Hi-Z mip chain with BuildHiZMipChainCS (5 mips per dispatch reduced in group-shared memory, 2 dispatches for 10 mips); 0 = one dispatch per mip. Compare with stat GPU (GrassHiZSinglePass / GrassHiZPerMip)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingPerView(
+    TEXT("r.Grass.Culling.PerView"),
+    1,
+    TEXT("Cull every view separately: the first non-capture view of the frame (primary) uses Hi-Z / two-phase occlusion culling, other views (split-screen, other editor viewports, scene captures) get their own frustum / distance culled visible lists. 0 = all views draw the first view's culling output. An instanced stereo eye pair is always culled as a union either way (see r.Grass.Culling.StereoUnion)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingStereoUnion(
+    TEXT("r.Grass.Culling.StereoUnion"),
+    1,
+    TEXT("Stereo rendering: cull both eyes once against the union of the two eye frustums (LOD from the midpoint camera); the second eye draws the same visible list, instanced stereo draws both eyes in one indirect draw. Hi-Z occlusion is not used for the eye pair. 0 = cull each eye separately (requires r.Grass.Culling.PerView). Instanced stereo always uses the union (the primary eye's draw covers both eyes), regardless of this and r.Grass.Culling.PerView."),
+    ECVF_RenderThreadSafe
+);
+
+/** 场景捕获 / 反射捕获视图 (使用组件的捕获预算，不能作为主视图) */
+static bool IsGrassCaptureView(const FSceneView& View)
+{
+    return View.bIsSceneCapture || View.bIsReflectionCapture || View.bIsPlanarReflection;
+}
+
+/**
+ * 视图族中立体渲染的另一只眼睛 (bInstancedStereoOnly 时只在实例化立体渲染时返回)
+ * 实例化立体渲染只绘制主眼睛 (一次绘制两只眼睛，Vertex Factory 用 InstanceID 的低位选择眼睛)：剔除必须用两只眼睛的并集，实例数量乘 2
+ */
+static const FSceneView* FindGrassStereoPairView(const FSceneViewFamily& ViewFamily, bool bInstancedStereoOnly)
+{
+    for (const FSceneView* View : ViewFamily.Views)
+    {
+        if (View && IStereoRendering::IsASecondaryView(*View) && (!bInstancedStereoOnly || View->bIsInstancedStereoEnabled))
+        {
+            return View;
+        }
+    }
+    return nullptr;
+}
+
+DECLARE_GPU_STAT(GrassHiZSinglePass);
+DECLARE_GPU_STAT(GrassHiZPerMip);
+
 // ============================================================================
 // Hi-Z Build Compute Shader (从 Scene Depth 生成 Hi-Z Mip 0)
 // ============================================================================
@@ -36,9 +87,9 @@ public:
     SHADER_USE_PARAMETER_STRUCT(FGrassHiZBuildMip0CS, FGlobalShader);
 
     BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
-        SHADER_PARAMETER_TEXTURE(Texture2D, SrcDepthTexture)
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SrcDepthTexture)
         SHADER_PARAMETER_SAMPLER(SamplerState, SrcDepthSampler)
-        SHADER_PARAMETER_UAV(RWTexture2D<float>, DstHiZMip0)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, DstHiZMip0)
         SHADER_PARAMETER(FIntPoint, SrcSize)
         SHADER_PARAMETER(FIntPoint, DstSize)
         SHADER_PARAMETER(FVector2f, InvSrcSize)
@@ -62,8 +113,8 @@ public:
     SHADER_USE_PARAMETER_STRUCT(FGrassHiZDownsampleCS, FGlobalShader);
 
     BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
-        SHADER_PARAMETER_TEXTURE(Texture2D, SrcMipTexture)
-        SHADER_PARAMETER_UAV(RWTexture2D<float>, DstHiZMip0)
+        SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2D<float>, SrcMipTexture)    // 单个 Mip 的 SRV
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, DstHiZMip0)
         SHADER_PARAMETER(FIntPoint, SrcMipSize)
         SHADER_PARAMETER(FIntPoint, DstMipSize)
     END_SHADER_PARAMETER_STRUCT()
@@ -76,6 +127,51 @@ public:
 
 IMPLEMENT_GLOBAL_SHADER(FGrassHiZDownsampleCS, "/Plugin/UnrealGrass/Private/GrassHiZBuild.usf", "DownsampleMipCS", SF_Compute);
 
+// ============================================================================
+// Hi-Z Mip Chain Compute Shader (每次 Dispatch 在 LDS 中生成 5 级 Mip)
+// ============================================================================
+class FGrassHiZBuildMipChainCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassHiZBuildMipChainCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassHiZBuildMipChainCS, FGlobalShader);
+
+    /** 每次 Dispatch 生成的 Mip 数量，与 HIZ_CHAIN_MAX_MIPS 一致 */
+    static constexpr int32 MipsPerDispatch = 5;
+    /** 线程组大小，与 HIZ_CHAIN_GROUP_SIZE 一致 */
+    static constexpr int32 GroupSize = 16;
+
+    // 从 Scene Depth 生成 (第一次 Dispatch)，或从上一次 Dispatch 的最后一级 Mip 生成
+    class FFromMipDim : SHADER_PERMUTATION_BOOL("HIZ_CHAIN_FROM_MIP");
+    using FPermutationDomain = TShaderPermutationDomain<FFromMipDim>;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SrcDepthTexture)          // 只在第一次 Dispatch 绑定
+        SHADER_PARAMETER_RDG_TEXTURE_SRV(Texture2D<float>, SrcMipTexture)  // 只在之后的 Dispatch 绑定
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, DstHiZMip0)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, DstHiZMip1)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, DstHiZMip2)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, DstHiZMip3)
+        SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, DstHiZMip4)
+        SHADER_PARAMETER(FIntPoint, SrcSize)
+        SHADER_PARAMETER(FIntPoint, DstSize)
+        SHADER_PARAMETER(uint32, NumDstMips)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassHiZBuildMipChainCS, "/Plugin/UnrealGrass/Private/GrassHiZBuild.usf", "BuildHiZMipChainCS", SF_Compute);
+
+/** Hi-Z Mip 的尺寸 (与 RHI 的 Mip 尺寸一致) */
+static FIntPoint GetHiZMipSize(FIntPoint Mip0Size, int32 MipLevel)
+{
+    return FIntPoint(FMath::Max(Mip0Size.X >> MipLevel, 1), FMath::Max(Mip0Size.Y >> MipLevel, 1));
+}
+
 TSharedPtr<FGrassCullingViewExtension, ESPMode::ThreadSafe> FGrassCullingViewExtension::Instance = nullptr;
 
 FGrassCullingViewExtension::FGrassCullingViewExtension(const FAutoRegister& AutoRegister)
@@ -118,7 +214,7 @@ void FGrassCullingViewExtension::UnregisterGrassProxy(FGrassSceneProxy* Proxy)
     }
 }
 
-void FGrassCullingViewExtension::EnsureHiZTexture(FRHICommandListImmediate& RHICmdList, FIntPoint SceneDepthSize)
+void FGrassCullingViewExtension::EnsureHiZTexture(FIntPoint SceneDepthSize)
 {
     // Hi-Z Mip 0 的尺寸是 Scene Depth 的一半
     FIntPoint DesiredSize = FIntPoint(
@@ -136,122 +232,188 @@ void FGrassCullingViewExtension::EnsureHiZTexture(FRHICommandListImmediate& RHIC
         NumMips = FMath::Clamp(NumMips, 1, 10);  // 限制最大 Mip 级别
         
         // 创建 Hi-Z 纹理
+        LLM_SCOPE_BYTAG(Grass_HiZ);
         FRHITextureCreateDesc Desc = FRHITextureCreateDesc::Create2D(TEXT("GrassHiZTexture"))
             .SetExtent(HiZSize.X, HiZSize.Y)
             .SetFormat(PF_R32_FLOAT)
             .SetNumMips(NumMips)
-            .SetFlags(ETextureCreateFlags::ShaderResource | ETextureCreateFlags::UAV);
+            .SetFlags(ETextureCreateFlags::ShaderResource | ETextureCreateFlags::UAV)
+            .SetInitialState(ERHIAccess::SRVMask);
         
         HiZTexture = RHICreateTexture(Desc);
-        
-        // 创建 SRV (UE 5.6 使用 FRHIViewDesc 新 API)
-        HiZTextureSRV = RHICmdList.CreateShaderResourceView(
-            HiZTexture.GetReference(),
-            FRHIViewDesc::CreateTextureSRV()
-                .SetDimensionFromTexture(HiZTexture.GetReference())
-        );
-        
+        HiZNumMips = NumMips;
+
+        // RDG 包装只在这里创建一次，每帧注册到视图族的 RDG
+        HiZRenderTarget = CreateRenderTarget(HiZTexture, TEXT("GrassHiZTexture"));
+
         bHiZValid = false;  // 新创建的纹理还没有有效数据
+
+        // 所有 Mip 的大小 (R32F)
+        uint64 HiZBytes = 0;
+        for (int32 Mip = 0; Mip < NumMips; ++Mip)
+        {
+            HiZBytes += (uint64)FMath::Max(HiZSize.X >> Mip, 1) * FMath::Max(HiZSize.Y >> Mip, 1) * sizeof(float);
+        }
+        SET_MEMORY_STAT(STAT_GrassHiZMemory, HiZBytes);
         
         UE_LOG(LogTemp, Log, TEXT("Created Hi-Z texture: %dx%d, %d mips"), HiZSize.X, HiZSize.Y, NumMips);
     }
 }
 
+FRDGTextureRef FGrassCullingViewExtension::RegisterHiZTexture(FRDGBuilder& GraphBuilder) const
+{
+    if (!HiZRenderTarget.IsValid())
+    {
+        return nullptr;
+    }
+
+    FRDGTextureRef HiZ = GraphBuilder.RegisterExternalTexture(HiZRenderTarget);
+    GraphBuilder.SetTextureAccessFinal(HiZ, ERHIAccess::SRVMask);
+    return HiZ;
+}
+
 void FGrassCullingViewExtension::BuildHiZFromSceneDepth(
-    FRHICommandListImmediate& RHICmdList,
-    FRHITexture* SceneDepthTexture,
+    FRDGBuilder& GraphBuilder,
+    FRDGTextureRef SceneDepthTexture,
     FIntPoint DepthSize)
 {
-    if (!SceneDepthTexture || !HiZTexture.IsValid())
+    FRDGTextureRef HiZ = RegisterHiZTexture(GraphBuilder);
+    if (!SceneDepthTexture || !HiZ || HiZNumMips == 0)
     {
         return;
     }
+
+    // 两种方式分别计入 GPU Stat (stat GPU 中比较开销)
+    if (CVarGrassHiZSinglePass.GetValueOnRenderThread() != 0)
+    {
+        RDG_GPU_STAT_SCOPE(GraphBuilder, GrassHiZSinglePass);
+        BuildHiZMipChain(GraphBuilder, SceneDepthTexture, HiZ, DepthSize);
+    }
+    else
+    {
+        RDG_GPU_STAT_SCOPE(GraphBuilder, GrassHiZPerMip);
+        BuildHiZPerMip(GraphBuilder, SceneDepthTexture, HiZ, DepthSize);
+    }
+
+    bHiZValid = true;
     
+    if (CVarGrassHiZDebug.GetValueOnRenderThread() > 0)
+    {
+        static uint32 LastLogFrame = 0;
+        if (GFrameNumber - LastLogFrame > 60)
+        {
+            LastLogFrame = GFrameNumber;
+            UE_LOG(LogTemp, Log, TEXT("Hi-Z built: %dx%d, %d mips (%s)"), HiZSize.X, HiZSize.Y, HiZNumMips,
+                CVarGrassHiZSinglePass.GetValueOnRenderThread() != 0 ? TEXT("mip chain") : TEXT("per mip"));
+        }
+    }
+}
+
+void FGrassCullingViewExtension::BuildHiZMipChain(
+    FRDGBuilder& GraphBuilder,
+    FRDGTextureRef SceneDepthTexture,
+    FRDGTextureRef HiZ,
+    FIntPoint DepthSize)
+{
+    const int32 NumMips = HiZNumMips;
+    const int32 MipsPerDispatch = FGrassHiZBuildMipChainCS::MipsPerDispatch;
+
+    // 每次 Dispatch 是一个 Pass：RDG 按 Mip 转换状态 (写入的 Mip 为 UAV，上一次 Dispatch 的最后一级 Mip 为 SRV)
+    for (int32 FirstMip = 0; FirstMip < NumMips; FirstMip += MipsPerDispatch)
+    {
+        const int32 NumDstMips = FMath::Min(MipsPerDispatch, NumMips - FirstMip);
+        const bool bFromMip = FirstMip > 0;
+
+        FGrassHiZBuildMipChainCS::FPermutationDomain PermutationVector;
+        PermutationVector.Set<FGrassHiZBuildMipChainCS::FFromMipDim>(bFromMip);
+        TShaderMapRef<FGrassHiZBuildMipChainCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+
+        FGrassHiZBuildMipChainCS::FParameters* Params = GraphBuilder.AllocParameters<FGrassHiZBuildMipChainCS::FParameters>();
+        if (bFromMip)
+        {
+            Params->SrcMipTexture = GraphBuilder.CreateSRV(FRDGTextureSRVDesc::CreateForMipLevel(HiZ, FirstMip - 1));
+        }
+        else
+        {
+            Params->SrcDepthTexture = SceneDepthTexture;
+        }
+        // 不足 5 级时多余的 UAV 绑定第一级 (着色器不会写入)
+        FRDGTextureUAVRef DstMips[5];
+        for (int32 Level = 0; Level < MipsPerDispatch; ++Level)
+        {
+            DstMips[Level] = Level < NumDstMips ? GraphBuilder.CreateUAV(FRDGTextureUAVDesc(HiZ, (uint8)(FirstMip + Level))) : DstMips[0];
+        }
+        Params->DstHiZMip0 = DstMips[0];
+        Params->DstHiZMip1 = DstMips[1];
+        Params->DstHiZMip2 = DstMips[2];
+        Params->DstHiZMip3 = DstMips[3];
+        Params->DstHiZMip4 = DstMips[4];
+        Params->SrcSize = bFromMip ? GetHiZMipSize(HiZSize, FirstMip - 1) : DepthSize;
+        Params->DstSize = GetHiZMipSize(HiZSize, FirstMip);
+        Params->NumDstMips = NumDstMips;
+
+        const int32 GroupSize = FGrassHiZBuildMipChainCS::GroupSize;
+        FIntVector GroupCount = FIntVector(
+            FMath::DivideAndRoundUp(Params->DstSize.X, GroupSize),
+            FMath::DivideAndRoundUp(Params->DstSize.Y, GroupSize),
+            1
+        );
+
+        FComputeShaderUtils::AddPass(
+            GraphBuilder,
+            RDG_EVENT_NAME("GrassHiZMipChain(Mips %d-%d)", FirstMip, FirstMip + NumDstMips - 1),
+            ComputeShader,
+            Params,
+            GroupCount);
+    }
+}
+
+void FGrassCullingViewExtension::BuildHiZPerMip(
+    FRDGBuilder& GraphBuilder,
+    FRDGTextureRef SceneDepthTexture,
+    FRDGTextureRef HiZ,
+    FIntPoint DepthSize)
+{
     // -------- Mip 0: 从 Scene Depth 降采样 --------
     {
         TShaderMapRef<FGrassHiZBuildMip0CS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
-        FGrassHiZBuildMip0CS::FParameters Params;
+        FGrassHiZBuildMip0CS::FParameters* Params = GraphBuilder.AllocParameters<FGrassHiZBuildMip0CS::FParameters>();
         
-        Params.SrcDepthTexture = SceneDepthTexture;
-        Params.SrcDepthSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
-        
-        // UE 5.6: 使用新的 FRHIViewDesc API 创建 UAV
-        Params.DstHiZMip0 = RHICmdList.CreateUnorderedAccessView(
-            HiZTexture.GetReference(),
-            FRHIViewDesc::CreateTextureUAV()
-                .SetDimensionFromTexture(HiZTexture.GetReference())
-                .SetMipLevel(0)
-        );
-        
-        Params.SrcSize = DepthSize;
-        Params.DstSize = HiZSize;
-        Params.InvSrcSize = FVector2f(1.0f / DepthSize.X, 1.0f / DepthSize.Y);
+        Params->SrcDepthTexture = SceneDepthTexture;
+        Params->SrcDepthSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+        Params->DstHiZMip0 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(HiZ, 0));
+        Params->SrcSize = DepthSize;
+        Params->DstSize = HiZSize;
+        Params->InvSrcSize = FVector2f(1.0f, 1.0f) / FVector2f(DepthSize);
         
         FIntVector GroupCount = FIntVector(
             FMath::DivideAndRoundUp(HiZSize.X, 8),
             FMath::DivideAndRoundUp(HiZSize.Y, 8),
             1
         );
-        
-        FComputeShaderUtils::Dispatch(RHICmdList, ComputeShader, Params, GroupCount);
+
+        FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("GrassHiZBuildMip0"), ComputeShader, Params, GroupCount);
     }
     
-    // 同步 UAV
-    RHICmdList.Transition(FRHITransitionInfo(HiZTexture, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    
-    // -------- 生成更高级别的 Mip --------
-    int32 NumMips = HiZTexture->GetNumMips();
-    FIntPoint CurrentSize = HiZSize;
-    
-    for (int32 MipLevel = 1; MipLevel < NumMips && CurrentSize.X > 1 && CurrentSize.Y > 1; ++MipLevel)
+    // -------- 生成更高级别的 Mip (每级一次 Dispatch，前一级作为 SRV，RDG 只转换读写的 Mip) --------
+    const int32 NumMips = HiZNumMips;
+    for (int32 MipLevel = 1; MipLevel < NumMips; ++MipLevel)
     {
-        FIntPoint SrcSize = CurrentSize;
-        CurrentSize = FIntPoint(
-            FMath::Max(1, CurrentSize.X / 2),
-            FMath::Max(1, CurrentSize.Y / 2)
-        );
-        
         TShaderMapRef<FGrassHiZDownsampleCS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
-        FGrassHiZDownsampleCS::FParameters Params;
-        
-        Params.SrcMipTexture = HiZTexture;
-        
-        // UE 5.6: 使用新的 FRHIViewDesc API 创建 UAV
-        Params.DstHiZMip0 = RHICmdList.CreateUnorderedAccessView(
-            HiZTexture.GetReference(),
-            FRHIViewDesc::CreateTextureUAV()
-                .SetDimensionFromTexture(HiZTexture.GetReference())
-                .SetMipLevel((uint8)MipLevel)
-        );
+        FGrassHiZDownsampleCS::FParameters* Params = GraphBuilder.AllocParameters<FGrassHiZDownsampleCS::FParameters>();
         
-        Params.SrcMipSize = SrcSize;
-        Params.DstMipSize = CurrentSize;
-        
-        // 转换到 UAV 状态
-        RHICmdList.Transition(FRHITransitionInfo(HiZTexture, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
+        Params->SrcMipTexture = GraphBuilder.CreateSRV(FRDGTextureSRVDesc::CreateForMipLevel(HiZ, MipLevel - 1));
+        Params->DstHiZMip0 = GraphBuilder.CreateUAV(FRDGTextureUAVDesc(HiZ, (uint8)MipLevel));
+        Params->SrcMipSize = GetHiZMipSize(HiZSize, MipLevel - 1);
+        Params->DstMipSize = GetHiZMipSize(HiZSize, MipLevel);
         
         FIntVector GroupCount = FIntVector(
-            FMath::DivideAndRoundUp(CurrentSize.X, 8),
-            FMath::DivideAndRoundUp(CurrentSize.Y, 8),
+            FMath::DivideAndRoundUp(Params->DstMipSize.X, 8),
+            FMath::DivideAndRoundUp(Params->DstMipSize.Y, 8),
             1
         );
-        
-        FComputeShaderUtils::Dispatch(RHICmdList, ComputeShader, Params, GroupCount);
-        
-        // 转换回 SRV 状态
-        RHICmdList.Transition(FRHITransitionInfo(HiZTexture, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    }
-    
-    bHiZValid = true;
-    
-    if (CVarGrassHiZDebug.GetValueOnRenderThread() > 0)
-    {
-        static uint32 LastLogFrame = 0;
-        if (GFrameNumber - LastLogFrame > 60)
-        {
-            LastLogFrame = GFrameNumber;
-            UE_LOG(LogTemp, Log, TEXT("Hi-Z built: %dx%d, %d mips"), HiZSize.X, HiZSize.Y, NumMips);
-        }
+
+        FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("GrassHiZDownsample(Mip %d)", MipLevel), ComputeShader, Params, GroupCount);
     }
 }
 
@@ -268,6 +430,10 @@ void FGrassCullingViewExtension::PostRenderBasePassDeferred_RenderThread(
     {
         return;
     }
+
+    // 阴影收集已经完成：剔除本视图族领取的阴影级联 (同一视图族的其他视图再调用时没有新的级联)，阴影深度之前发布
+    PerformShadowCulling(GraphBuilder);
+    FGrassCullingGraph::PublishDrawnBuffers(GraphBuilder);
     
     // 检查是否需要遮挡剔除
     bool bNeedOcclusionCulling = false;
@@ -288,11 +454,20 @@ void FGrassCullingViewExtension::PostRenderBasePassDeferred_RenderThread(
         return;
     }
     
-    // 避免同一帧多次构建
+    // 避免同一帧多次构建；每视图剔除时只有主视图的深度用于 Hi-Z (下一帧主视图的遮挡剔除)
     if (LastFrameNumberHiZBuilt == GFrameNumber)
     {
         return;
     }
+    // 本帧立体渲染的两只眼睛用并集剔除 (没有主视图)：Hi-Z 只有一只眼睛的深度，不生成，后 Pass 也不执行
+    if (!CulledView && CulledViewFrameNumber == GFrameNumber)
+    {
+        return;
+    }
+    if (CVarGrassCullingPerView.GetValueOnRenderThread() != 0 && (&InView != CulledView || CulledViewFrameNumber != GFrameNumber))
+    {
+        return;
+    }
     LastFrameNumberHiZBuilt = GFrameNumber;
     
     // 保存当前帧的视图投影矩阵 (供下一帧使用)
@@ -306,8 +481,7 @@ void FGrassCullingViewExtension::PostRenderBasePassDeferred_RenderThread(
     }
     
     // 确保 Hi-Z 纹理存在
-    FRHICommandListImmediate& RHICmdList = GraphBuilder.RHICmdList;
-    EnsureHiZTexture(RHICmdList, DepthSize);
+    EnsureHiZTexture(DepthSize);
     
     if (!HiZTexture.IsValid())
     {
@@ -315,16 +489,16 @@ void FGrassCullingViewExtension::PostRenderBasePassDeferred_RenderThread(
     }
     
     // 获取深度 Render Target
-    FRHITexture* DepthTexture = nullptr;
-    if (RenderTargets.DepthStencil.GetTexture())
-    {
-        DepthTexture = RenderTargets.DepthStencil.GetTexture()->GetRHI();
-    }
+    FRDGTextureRef DepthTexture = RenderTargets.DepthStencil.GetTexture();
     
     if (DepthTexture)
     {
         // 构建 Hi-Z
-        BuildHiZFromSceneDepth(RHICmdList, DepthTexture, DepthSize);
+        BuildHiZFromSceneDepth(GraphBuilder, DepthTexture, DepthSize);
+
+        // 没有深度预 Pass 时两阶段遮挡剔除的后 Pass 在这里执行：Base Pass 已经绘制，新可见的实例只更新可见位，下一帧由主 Pass 绘制
+        PerformPostPassCulling(GraphBuilder, &InView, LastViewProjectionMatrix);
+        FGrassCullingGraph::PublishDrawnBuffers(GraphBuilder);
     }
     else if (CVarGrassHiZDebug.GetValueOnRenderThread() > 0)
     {
@@ -332,53 +506,267 @@ void FGrassCullingViewExtension::PostRenderBasePassDeferred_RenderThread(
     }
 }
 
-void FGrassCullingViewExtension::PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily)
+bool FGrassCullingViewExtension::AnyProxyUsesTwoPhaseOcclusion()
 {
-    check(IsInRenderingThread());
-    
-    if (RegisteredProxies.Num() == 0)
+    FScopeLock Lock(&ProxiesLock);
+    for (FGrassSceneProxy* Proxy : RegisteredProxies)
     {
-        return;
+        if (Proxy && Proxy->UsesTwoPhaseOcclusion())
+        {
+            return true;
+        }
     }
+    return false;
+}
 
-    // Get the primary view for culling
-    const FSceneView* PrimaryView = nullptr;
-    for (int32 ViewIndex = 0; ViewIndex < InViewFamily.Views.Num(); ++ViewIndex)
+void FGrassCullingViewExtension::PerformShadowCulling(FRDGBuilder& GraphBuilder)
+{
+    // 阴影深度紧跟在后面，级联的剔除留在图形管线
+    const FGrassCullingGraph Graph(GraphBuilder, false);
+
+    FScopeLock Lock(&ProxiesLock);
+    for (FGrassSceneProxy* Proxy : RegisteredProxies)
     {
-        if (InViewFamily.Views[ViewIndex])
+        if (Proxy)
         {
-            PrimaryView = InViewFamily.Views[ViewIndex];
-            break;
+            Proxy->PerformShadowCulling_RenderThread(Graph);
         }
     }
+}
+
+void FGrassCullingViewExtension::PerformPostPassCulling(FRDGBuilder& GraphBuilder, const FSceneView* View, const FMatrix& ViewProjectionMatrix)
+{
+    // 后 Pass 读取刚刚在图形管线上生成的 Hi-Z，输出马上被绘制，留在图形管线
+    const FGrassCullingGraph Graph(GraphBuilder, false);
+    FRDGTextureRef HiZ = bHiZValid ? RegisterHiZTexture(GraphBuilder) : nullptr;
 
-    if (!PrimaryView)
+    FScopeLock Lock(&ProxiesLock);
+    for (FGrassSceneProxy* Proxy : RegisteredProxies)
+    {
+        if (Proxy)
+        {
+            Proxy->PerformGPUCullingPostPass(
+                Graph,
+                View,
+                HiZ,
+                HiZSize,
+                ViewProjectionMatrix
+            );
+        }
+    }
+}
+
+void FGrassCullingViewExtension::PreRenderBasePass_RenderThread(FRDGBuilder& GraphBuilder, bool bDepthBufferIsPopulated)
+{
+    check(IsInRenderingThread());
+
+    // 没有深度预 Pass 时 Hi-Z 和后 Pass 留到 Base Pass 之后 (PostRenderBasePassDeferred)
+    if (!bDepthBufferIsPopulated || RegisteredProxies.Num() == 0 || !CulledView || CulledViewFrameNumber != GFrameNumber || LastFrameNumberHiZBuilt == GFrameNumber)
     {
         return;
     }
 
-    // Execute GPU Culling for all registered proxies
-    FScopeLock Lock(&ProxiesLock);
+    if (!AnyProxyUsesTwoPhaseOcclusion())
+    {
+        return;
+    }
+
+    const FIntPoint DepthSize = CulledView->UnscaledViewRect.Size();
+    if (DepthSize.X <= 0 || DepthSize.Y <= 0)
+    {
+        return;
+    }
+
+    EnsureHiZTexture(DepthSize);
+    if (!HiZTexture.IsValid())
+    {
+        return;
+    }
+
+    TRDGUniformBufferRef<FSceneTextureUniformParameters> SceneTextures = CreateSceneTextureUniformBuffer(GraphBuilder, *CulledView, ESceneTextureSetupMode::SceneDepth);
+    FRDGTextureRef SceneDepth = SceneTextures->GetParameters()->SceneDepthTexture;
+    if (!SceneDepth)
+    {
+        return;
+    }
+
+    RDG_EVENT_SCOPE(GraphBuilder, "GrassTwoPhaseOcclusion");
+    PerformTwoPhaseOcclusion(GraphBuilder, SceneDepth, DepthSize);
+}
+
+void FGrassCullingViewExtension::PerformTwoPhaseOcclusion(FRDGBuilder& GraphBuilder, FRDGTextureRef SceneDepth, FIntPoint DepthSize)
+{
+    // 当前帧的 Hi-Z 同时作为下一帧主 Pass 的 Hi-Z，Base Pass 之后不再重建
+    LastFrameNumberHiZBuilt = GFrameNumber;
+    const FMatrix ViewProjectionMatrix = CulledView->ViewMatrices.GetViewProjectionMatrix();
+    LastViewProjectionMatrix = ViewProjectionMatrix;
+
+    // Hi-Z 的生成和后 Pass 都是 RDG Pass，深度的状态转换由 RDG 处理
+    BuildHiZFromSceneDepth(GraphBuilder, SceneDepth, DepthSize);
+    PerformPostPassCulling(GraphBuilder, CulledView, ViewProjectionMatrix);
+
+    // 后 Pass 的输出由 Base Pass 绘制
+    FGrassCullingGraph::PublishDrawnBuffers(GraphBuilder);
+}
+
+void FGrassCullingViewExtension::PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily)
+{
+    check(IsInRenderingThread());
     
+    if (RegisteredProxies.Num() == 0)
+    {
+        return;
+    }
+
+    // 组件和视图槽位已经释放的 Buffer 不再保留 RDG 包装
+    FGrassCullingGraph::PruneExternalBuffers();
+
     FRHICommandListImmediate& RHICmdList = GraphBuilder.RHICmdList;
-    
     int32 TotalProxiesCulled = 0;
-    for (FGrassSceneProxy* Proxy : RegisteredProxies)
+
+    // 阴影级联的槽位在阴影收集之前准备好 (收集时不能创建资源)
     {
-        if (Proxy)
+        FScopeLock Lock(&ProxiesLock);
+        for (FGrassSceneProxy* Proxy : RegisteredProxies)
         {
-            // 传递 Hi-Z 信息给 Proxy 进行遮挡剔除
-            // 注意：使用上一帧的 Hi-Z 进行遮挡剔除（时序正确）
-            Proxy->PerformGPUCullingWithHiZ(
-                RHICmdList,
-                PrimaryView,
-                bHiZValid ? HiZTexture.GetReference() : nullptr,
-                HiZSize,
-                LastViewProjectionMatrix
-            );
-            TotalProxiesCulled++;
+            if (Proxy)
+            {
+                Proxy->BeginShadowCulling_RenderThread(RHICmdList);
+            }
+        }
+    }
+
+    // 这里的剔除输出在深度预 Pass 之前不会被绘制，可以在异步计算管线上执行 (与图中已经记录的图形 Pass 重叠)
+    const FGrassCullingGraph Graph(GraphBuilder, true);
+    RDG_EVENT_SCOPE(GraphBuilder, "GrassCulling");
+    FRDGTextureRef HiZ = bHiZValid ? RegisterHiZTexture(GraphBuilder) : nullptr;
+
+    if (CVarGrassCullingPerView.GetValueOnRenderThread() != 0)
+    {
+        FScopeLock Lock(&ProxiesLock);
+
+        // 立体渲染的另一只眼睛 (与主眼睛一起用并集视锥剔除，绘制主眼睛的可见列表；实例化立体渲染总是如此)
+        const FSceneView* StereoPairView = FindGrassStereoPairView(InViewFamily, CVarGrassCullingStereoUnion.GetValueOnRenderThread() == 0);
+        bool bStereoPairCulled = false;
+
+        for (const FSceneView* View : InViewFamily.Views)
+        {
+            if (!View || (View == StereoPairView && bStereoPairCulled))
+            {
+                continue;
+            }
+
+            const bool bCaptureView = IsGrassCaptureView(*View);
+            if (!bCaptureView && CulledViewFrameNumber != GFrameNumber && StereoPairView && IStereoRendering::IsStereoEyeView(*View))
+            {
+                // 主眼睛：两只眼睛的并集视锥剔除一次；Hi-Z 只有一只眼睛的深度，对另一只眼睛不保守，不生成也不使用
+                CulledView = nullptr;
+                CulledViewFrameNumber = GFrameNumber;
+                bHiZValid = false;
+                bStereoPairCulled = true;
+
+                for (FGrassSceneProxy* Proxy : RegisteredProxies)
+                {
+                    if (Proxy)
+                    {
+                        Proxy->PerformGPUCullingWithHiZ(Graph, View, nullptr, HiZSize, LastViewProjectionMatrix, StereoPairView);
+                        TotalProxiesCulled++;
+                    }
+                }
+                continue;
+            }
+
+            if (!bCaptureView && CulledViewFrameNumber != GFrameNumber)
+            {
+                // 本帧第一个非捕获视图是主视图：Hi-Z / 两阶段遮挡剔除，结果写入代理的共享可见列表
+                CulledView = View;
+                CulledViewFrameNumber = GFrameNumber;
+
+                for (FGrassSceneProxy* Proxy : RegisteredProxies)
+                {
+                    if (Proxy)
+                    {
+                        Proxy->PerformGPUCullingWithHiZ(
+                            Graph,
+                            View,
+                            HiZ,
+                            HiZSize,
+                            LastViewProjectionMatrix
+                        );
+                        TotalProxiesCulled++;
+                    }
+                }
+                continue;
+            }
+
+            // 其他视图 (分屏、其他视口、场景捕获) 剔除到自己的可见列表
+            // 本帧的主视图已经剔除过时 (同一帧的另一个视图族) 实例化立体渲染的眼睛也在槽位中用并集剔除
+            const FSceneView* SlotStereoPairView = StereoPairView && View != StereoPairView && !bCaptureView && View->bIsInstancedStereoEnabled && IStereoRendering::IsStereoEyeView(*View)
+                ? StereoPairView : nullptr;
+            bStereoPairCulled |= SlotStereoPairView != nullptr;
+            for (FGrassSceneProxy* Proxy : RegisteredProxies)
+            {
+                if (Proxy)
+                {
+                    Proxy->PerformGPUCullingForView(Graph, View, bCaptureView, SlotStereoPairView);
+                    TotalProxiesCulled++;
+                }
+            }
+        }
+    }
+    else
+    {
+        // Get the primary view for culling
+        const FSceneView* PrimaryView = nullptr;
+        for (int32 ViewIndex = 0; ViewIndex < InViewFamily.Views.Num(); ++ViewIndex)
+        {
+            if (InViewFamily.Views[ViewIndex])
+            {
+                PrimaryView = InViewFamily.Views[ViewIndex];
+                break;
+            }
+        }
+
+        if (!PrimaryView)
+        {
+            return;
+        }
+
+        // 实例化立体渲染：所有视图绘制主眼睛的输出，两只眼睛用并集剔除 (与每视图剔除相同，不生成也不使用 Hi-Z，不执行后 Pass)
+        const FSceneView* StereoPairView = IStereoRendering::IsStereoEyeView(*PrimaryView) ? FindGrassStereoPairView(InViewFamily, true) : nullptr;
+        if (StereoPairView)
+        {
+            HiZ = nullptr;
+            bHiZValid = false;
+        }
+
+        CulledView = StereoPairView ? nullptr : PrimaryView;
+        CulledViewFrameNumber = GFrameNumber;
+
+        // Execute GPU Culling for all registered proxies
+        FScopeLock Lock(&ProxiesLock);
+
+        for (FGrassSceneProxy* Proxy : RegisteredProxies)
+        {
+            if (Proxy)
+            {
+                // 传递 Hi-Z 信息给 Proxy 进行遮挡剔除
+                // 注意：使用上一帧的 Hi-Z 进行遮挡剔除（时序正确）
+                Proxy->PerformGPUCullingWithHiZ(
+                    Graph,
+                    PrimaryView,
+                    HiZ,
+                    HiZSize,
+                    LastViewProjectionMatrix,
+                    StereoPairView
+                );
+                TotalProxiesCulled++;
+            }
         }
     }
+
+    // 草地在深度预 Pass 中绘制：在这里等待剔除输出 (异步计算时也在这里汇合)
+    FGrassCullingGraph::PublishDrawnBuffers(GraphBuilder);
     
     // Debug output
     if (CVarGrassCullingDebug.GetValueOnRenderThread() > 0)
@@ -0,0 +1,524 @@
+// GrassFrustum.cpp
+// 视锥平面提取 + 立体并集视锥 + 阴影剔除体转换 + 标量参照测试
+
+#include "GrassFrustum.h"
+
+FGrassFrustum FGrassFrustum::FromViewProjection(const FMatrix& ViewProjectionMatrix)
+{
+    const FMatrix& M = ViewProjectionMatrix;
+    FPlane RawPlanes[6] = {
+        // Left
+        FPlane(M.M[0][3] + M.M[0][0], M.M[1][3] + M.M[1][0], M.M[2][3] + M.M[2][0], M.M[3][3] + M.M[3][0]),
+        // Right
+        FPlane(M.M[0][3] - M.M[0][0], M.M[1][3] - M.M[1][0], M.M[2][3] - M.M[2][0], M.M[3][3] - M.M[3][0]),
+        // Bottom
+        FPlane(M.M[0][3] + M.M[0][1], M.M[1][3] + M.M[1][1], M.M[2][3] + M.M[2][1], M.M[3][3] + M.M[3][1]),
+        // Top
+        FPlane(M.M[0][3] - M.M[0][1], M.M[1][3] - M.M[1][1], M.M[2][3] - M.M[2][1], M.M[3][3] - M.M[3][1]),
+        // Near (反向 Z: z >= 0)
+        FPlane(M.M[0][2], M.M[1][2], M.M[2][2], M.M[3][2]),
+        // Far
+        FPlane(M.M[0][3] - M.M[0][2], M.M[1][3] - M.M[1][2], M.M[2][3] - M.M[2][2], M.M[3][3] - M.M[3][2]),
+    };
+    return FromPlanes(RawPlanes);
+}
+
+/** 视锥的角点和 4 条棱的方向 (裁剪空间 x, y = ±1 的近平面 z = 1 / 远平面 z = 0 反投影) */
+struct FGrassFrustumCorners
+{
+    TArray<FVector, TInlineAllocator<8>> Points;            // 有限的角点 (近平面，以及有限远的远平面)
+    TArray<FVector, TInlineAllocator<4>> InfiniteDirections; // 反向 Z 无限远平面上的角点 (单位方向)
+    TArray<FVector, TInlineAllocator<4>> EdgeDirections;     // 从近平面指向远平面的棱 (单位方向)
+};
+
+static void GetFrustumCorners(const FMatrix& ViewProjectionMatrix, FGrassFrustumCorners& Out)
+{
+    const FMatrix InvViewProjection = ViewProjectionMatrix.Inverse();
+    auto Unproject = [&InvViewProjection](double ClipX, double ClipY, double ClipZ)
+    {
+        return InvViewProjection.TransformFVector4(FVector4(ClipX, ClipY, ClipZ, 1.0));
+    };
+
+    for (int32 Y = 0; Y < 2; ++Y)
+    {
+        for (int32 X = 0; X < 2; ++X)
+        {
+            const double ClipX = X ? 1.0 : -1.0;
+            const double ClipY = Y ? 1.0 : -1.0;
+            const FVector4 Near = Unproject(ClipX, ClipY, 1.0);
+            const FVector NearPoint = FVector(Near) / Near.W;
+            Out.Points.Add(NearPoint);
+
+            FVector4 Far = Unproject(ClipX, ClipY, 0.0);
+            if (Far.W < 0.0)
+            {
+                Far = -Far;
+            }
+            if (Far.W > FVector(Far).Size() * 1e-9)
+            {
+                const FVector FarPoint = FVector(Far) / Far.W;
+                Out.Points.Add(FarPoint);
+                Out.EdgeDirections.Add((FarPoint - NearPoint).GetSafeNormal());
+            }
+            else
+            {
+                // 无限远的角点：齐次坐标的符号不确定，用近平面到中间深度的点确定方向
+                const FVector4 Middle = Unproject(ClipX, ClipY, 0.5);
+                const FVector Direction = (FVector(Middle) / Middle.W - NearPoint).GetSafeNormal();
+                Out.InfiniteDirections.Add(Direction);
+                Out.EdgeDirections.Add(Direction);
+            }
+        }
+    }
+}
+
+FGrassFrustum FGrassFrustum::FromViewProjectionUnion(const FMatrix& ViewProjectionA, const FMatrix& ViewProjectionB)
+{
+    // 方向与平面法线的点积允许的误差 (自己的棱在自己的平面上，点积只有舍入误差)
+    const double DirectionTolerance = 1e-6;
+
+    const FGrassFrustum Frustums[2] = { FromViewProjection(ViewProjectionA), FromViewProjection(ViewProjectionB) };
+    FGrassFrustumCorners Corners;
+    GetFrustumCorners(ViewProjectionA, Corners);
+    GetFrustumCorners(ViewProjectionB, Corners);
+
+    // 两个视锥的中心方向 (倾斜法线时使用，与所有棱的夹角都小于 90 度)
+    FVector Forward = FVector::ZeroVector;
+    for (const FVector& Direction : Corners.EdgeDirections)
+    {
+        Forward += Direction;
+    }
+    Forward = Forward.GetSafeNormal();
+
+    FPlane RawPlanes[6];
+    for (int32 i = 0; i < 6; ++i)
+    {
+        // 侧平面必须包含所有棱的方向 (近平面角点在内侧时远平面角点也在内侧)；近 / 远平面只需要包含无限远的方向
+        const TConstArrayView<FVector> Directions = i < 4 ? TConstArrayView<FVector>(Corners.EdgeDirections) : TConstArrayView<FVector>(Corners.InfiniteDirections);
+
+        // 法线能包含所有方向时，平面外推到包含所有有限角点，返回 w
+        auto FitPlane = [&](const FVector& Normal, double& OutW)
+        {
+            for (const FVector& Direction : Directions)
+            {
+                if ((Normal | Direction) < -DirectionTolerance)
+                {
+                    return false;
+                }
+            }
+            double MinDistance = TNumericLimits<double>::Max();
+            for (const FVector& Point : Corners.Points)
+            {
+                MinDistance = FMath::Min(MinDistance, Normal | Point);
+            }
+            OutW = -MinDistance;
+            return true;
+        };
+
+        // 两只眼睛自己的法线中，外推距离最小的一个 (另一个视锥超出这个平面最少)
+        bool bFound = false;
+        double BestPush = 0.0;
+        for (const FGrassFrustum& Frustum : Frustums)
+        {
+            const FVector4f& Plane = Frustum.Planes[i];
+            const FVector Normal(Plane.X, Plane.Y, Plane.Z);
+            double W = 0.0;
+            if (Normal.IsNormalized() && FitPlane(Normal, W) && (!bFound || W - Plane.W < BestPush))
+            {
+                bFound = true;
+                BestPush = W - Plane.W;
+                RawPlanes[i] = FPlane(Normal.X, Normal.Y, Normal.Z, W);
+            }
+        }
+
+        // 两个法线都不能包含另一个视锥的方向 (两眼有夹角时的上下平面)：取两者之和，向中心方向倾斜到包含所有方向
+        if (!bFound)
+        {
+            const FVector4f& PlaneA = Frustums[0].Planes[i];
+            const FVector4f& PlaneB = Frustums[1].Planes[i];
+            FVector Normal = FVector(PlaneA.X + PlaneB.X, PlaneA.Y + PlaneB.Y, PlaneA.Z + PlaneB.Z).GetSafeNormal();
+            double Tilt = 0.0;
+            for (const FVector& Direction : Directions)
+            {
+                Tilt = FMath::Max(Tilt, -(Normal | Direction) / FMath::Max(Forward | Direction, UE_SMALL_NUMBER));
+            }
+            Normal = (Normal + Forward * Tilt).GetSafeNormal();
+
+            double W = 0.0;
+            bFound = Normal.IsNormalized() && FitPlane(Normal, W);
+            RawPlanes[i] = bFound ? FPlane(Normal.X, Normal.Y, Normal.Z, W) : FPlane(0.0, 0.0, 0.0, 1.0);
+        }
+    }
+    return FromPlanes(RawPlanes);
+}
+
+FGrassFrustum FGrassFrustum::FromConvexPlanes(TConstArrayView<FPlane> OutwardPlanes, const FVector& PlaneTranslation)
+{
+    // 在平移后的空间中 dot(N, P + T) - W <= 0 表示在内侧：翻转法线，W 换算回世界空间
+    FPlane RawPlanes[6];
+    for (int32 i = 0; i < 6; ++i)
+    {
+        if (i < OutwardPlanes.Num())
+        {
+            const FPlane& Plane = OutwardPlanes[i];
+            const FVector Normal(Plane.X, Plane.Y, Plane.Z);
+            RawPlanes[i] = FPlane(-Normal.X, -Normal.Y, -Normal.Z, Plane.W - FVector::DotProduct(Normal, PlaneTranslation));
+        }
+        else
+        {
+            RawPlanes[i] = FPlane(0.0, 0.0, 0.0, 1.0);
+        }
+    }
+    return FromPlanes(RawPlanes);
+}
+
+FGrassFrustum FGrassFrustum::TransformBy(const FMatrix& LocalToWorld) const
+{
+    // 本地点 x 的世界坐标是 x * M：dot(N, x * M) + W = dot(M 的 3x3 部分 * N, x) + dot(N, M 的平移) + W
+    const FMatrix& M = LocalToWorld;
+    FPlane RawPlanes[6];
+    for (int32 i = 0; i < 6; ++i)
+    {
+        const FVector4f& P = Planes[i];
+        RawPlanes[i] = FPlane(
+            M.M[0][0] * P.X + M.M[0][1] * P.Y + M.M[0][2] * P.Z,
+            M.M[1][0] * P.X + M.M[1][1] * P.Y + M.M[1][2] * P.Z,
+            M.M[2][0] * P.X + M.M[2][1] * P.Y + M.M[2][2] * P.Z,
+            M.M[3][0] * P.X + M.M[3][1] * P.Y + M.M[3][2] * P.Z + P.W);
+    }
+    return FromPlanes(RawPlanes);
+}
+
+FGrassFrustum FGrassFrustum::FromPlanes(FPlane (&RawPlanes)[6])
+{
+    FGrassFrustum Frustum;
+    for (int32 i = 0; i < 6; ++i)
+    {
+        FPlane& Plane = RawPlanes[i];
+        const double Length = FMath::Sqrt(Plane.X * Plane.X + Plane.Y * Plane.Y + Plane.Z * Plane.Z);
+        if (Length > SMALL_NUMBER)
+        {
+            Plane.X /= Length;
+            Plane.Y /= Length;
+            Plane.Z /= Length;
+            Plane.W /= Length;
+        }
+        Frustum.Planes[i] = FVector4f(Plane.X, Plane.Y, Plane.Z, Plane.W);
+    }
+
+    // SoA：第二组的后两项重复平面 4-5
+    static const int32 GroupPlanes[2][4] = { { 0, 1, 2, 3 }, { 4, 5, 4, 5 } };
+    for (int32 Group = 0; Group < 2; ++Group)
+    {
+        const FVector4f& P0 = Frustum.Planes[GroupPlanes[Group][0]];
+        const FVector4f& P1 = Frustum.Planes[GroupPlanes[Group][1]];
+        const FVector4f& P2 = Frustum.Planes[GroupPlanes[Group][2]];
+        const FVector4f& P3 = Frustum.Planes[GroupPlanes[Group][3]];
+        Frustum.PlaneX[Group] = MakeVectorRegisterFloat(P0.X, P1.X, P2.X, P3.X);
+        Frustum.PlaneY[Group] = MakeVectorRegisterFloat(P0.Y, P1.Y, P2.Y, P3.Y);
+        Frustum.PlaneZ[Group] = MakeVectorRegisterFloat(P0.Z, P1.Z, P2.Z, P3.Z);
+        Frustum.PlaneW[Group] = MakeVectorRegisterFloat(P0.W, P1.W, P2.W, P3.W);
+        Frustum.AbsPlaneX[Group] = VectorAbs(Frustum.PlaneX[Group]);
+        Frustum.AbsPlaneY[Group] = VectorAbs(Frustum.PlaneY[Group]);
+        Frustum.AbsPlaneZ[Group] = VectorAbs(Frustum.PlaneZ[Group]);
+    }
+    return Frustum;
+}
+
+// 运算顺序与 SIMD 版本相同 (VectorMultiplyAdd 不融合时结果逐位一致)
+bool FGrassFrustum::IntersectsSphereScalar(const FVector3f& Center, float Radius) const
+{
+    for (const FVector4f& Plane : Planes)
+    {
+        if (Plane.X * Center.X + (Plane.Y * Center.Y + (Plane.Z * Center.Z + Plane.W)) < -Radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+EGrassFrustumTest FGrassFrustum::TestBoxScalar(const FVector3f& Center, const FVector3f& Extent) const
+{
+    bool bIntersects = false;
+    for (const FVector4f& Plane : Planes)
+    {
+        const float Distance = Plane.X * Center.X + (Plane.Y * Center.Y + (Plane.Z * Center.Z + Plane.W));
+        const float Radius = FMath::Abs(Plane.X) * Extent.X + (FMath::Abs(Plane.Y) * Extent.Y + FMath::Abs(Plane.Z) * Extent.Z);
+        if (Distance < -Radius)
+        {
+            return EGrassFrustumTest::Outside;
+        }
+        bIntersects |= Distance < Radius;
+    }
+    return bIntersects ? EGrassFrustumTest::Intersects : EGrassFrustumTest::Inside;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 测试：不对称投影 / 有夹角的两只眼睛：并集包含两个视锥内的所有点，拒绝两个视锥都看不到的方向
+// ============================================================================
+
+/** 一只眼睛的离轴投影 (四个方向的视野半角正切)，反向 Z；FarZ <= 0 时远平面在无限远 */
+struct FGrassTestEye
+{
+    FMatrix ViewMatrix;
+    FMatrix ViewProjectionMatrix;
+    float TanLeft, TanRight, TanDown, TanUp;
+    float NearZ;
+};
+
+static FGrassTestEye MakeTestEye(const FVector& HeadOrigin, const FRotator& HeadRotation, float EyeOffset, float CantDegrees,
+    float TanLeft, float TanRight, float TanDown, float TanUp, float NearZ, float FarZ)
+{
+    FGrassTestEye Eye;
+    Eye.TanLeft = TanLeft;
+    Eye.TanRight = TanRight;
+    Eye.TanDown = TanDown;
+    Eye.TanUp = TanUp;
+    Eye.NearZ = NearZ;
+
+    const FQuat EyeRotation = FQuat(HeadRotation) * FQuat(FRotator(0.0f, CantDegrees, 0.0f));
+    const FVector EyeOrigin = HeadOrigin + HeadRotation.RotateVector(FVector(0.0, EyeOffset, 0.0));
+    Eye.ViewMatrix = FTranslationMatrix(-EyeOrigin) * FInverseRotationMatrix(EyeRotation.Rotator()) * FMatrix(
+        FPlane(0, 0, 1, 0),
+        FPlane(1, 0, 0, 0),
+        FPlane(0, 1, 0, 0),
+        FPlane(0, 0, 0, 1));
+
+    // x_clip = 2 / (L + R) * x + (L - R) / (L + R) * z，y 同理，w = z
+    FMatrix Projection(EForceInit::ForceInitToZero);
+    Projection.M[0][0] = 2.0 / (TanLeft + TanRight);
+    Projection.M[1][1] = 2.0 / (TanDown + TanUp);
+    Projection.M[2][0] = (TanLeft - TanRight) / (TanLeft + TanRight);
+    Projection.M[2][1] = (TanDown - TanUp) / (TanDown + TanUp);
+    Projection.M[2][3] = 1.0;
+    Projection.M[2][2] = FarZ > NearZ ? NearZ / (NearZ - FarZ) : 0.0;
+    Projection.M[3][2] = FarZ > NearZ ? -FarZ * NearZ / (NearZ - FarZ) : NearZ;
+    Eye.ViewProjectionMatrix = Eye.ViewMatrix * Projection;
+    return Eye;
+}
+
+/** 视锥内的随机点 (视图空间 x 右 y 上 z 前，转换到世界空间) */
+static FVector3f RandomPointInEye(const FGrassTestEye& Eye, float MaxZ, FRandomStream& Random)
+{
+    const float Z = Random.FRandRange(Eye.NearZ * 1.01f, MaxZ);
+    const float X = Z * FMath::Lerp(-Eye.TanLeft, Eye.TanRight, Random.FRand());
+    const float Y = Z * FMath::Lerp(-Eye.TanDown, Eye.TanUp, Random.FRand());
+    return FVector3f(Eye.ViewMatrix.InverseFast().TransformPosition(FVector(X, Y, Z)));
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassStereoFrustumTest, "UnrealGrass.Frustum.StereoUnion",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassStereoFrustumTest::RunTest(const FString& Parameters)
+{
+    const int32 NumViews = 256;
+    const int32 NumSamples = 256;
+    const float MaxSampleZ = 20000.0f;
+    // 平面以 float 保存，世界坐标约 2 万时的舍入误差
+    const float Tolerance = 0.1f;
+
+    // 左眼视野偏左、右眼偏右 (头显常见的不对称投影)，可选向外的夹角
+    struct FEyeSetup
+    {
+        float Ipd;
+        float CantDegrees;
+        float TanInner, TanOuter, TanDown, TanUp;
+    };
+    const FEyeSetup Setups[] = {
+        { 6.4f, 0.0f, 1.0f,  1.0f, 1.0f, 1.0f },     // 对称
+        { 6.4f, 0.0f, 0.84f, 1.0f, 1.2f, 0.95f },    // 不对称
+        { 6.8f, 5.0f, 0.9f,  1.3f, 1.1f, 1.0f },     // 向外 5 度夹角
+        { 20.0f, 0.0f, 0.84f, 1.0f, 1.2f, 0.95f },   // 很宽的瞳距
+    };
+    const int32 NumSetups = UE_ARRAY_COUNT(Setups);
+
+    FRandomStream Random(2468);
+    int32 NumMissed = 0;
+    int32 NumSimdMismatches = 0;
+    int32 NumFalseAccepts = 0;
+    int64 OtherEyeCulledByOneEye = 0;
+    int64 OtherEyeSamples = 0;
+    for (int32 ViewIndex = 0; ViewIndex < NumViews; ++ViewIndex)
+    {
+        const FEyeSetup& Setup = Setups[ViewIndex % NumSetups];
+        const float FarZ = (ViewIndex / NumSetups) % 2 ? 30000.0f : 0.0f;
+        const FVector HeadOrigin(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(100.0f, 500.0f));
+        const FRotator HeadRotation(Random.FRandRange(-60.0f, 30.0f), Random.FRandRange(0.0f, 360.0f), Random.FRandRange(-20.0f, 20.0f));
+
+        const FGrassTestEye Left = MakeTestEye(HeadOrigin, HeadRotation, -Setup.Ipd * 0.5f, -Setup.CantDegrees,
+            Setup.TanOuter, Setup.TanInner, Setup.TanDown, Setup.TanUp, 10.0f, FarZ);
+        const FGrassTestEye Right = MakeTestEye(HeadOrigin, HeadRotation, Setup.Ipd * 0.5f, Setup.CantDegrees,
+            Setup.TanInner, Setup.TanOuter, Setup.TanDown, Setup.TanUp, 10.0f, FarZ);
+        const FGrassFrustum LeftFrustum = FGrassFrustum::FromViewProjection(Left.ViewProjectionMatrix);
+        const FGrassFrustum Union = FGrassFrustum::FromViewProjectionUnion(Left.ViewProjectionMatrix, Right.ViewProjectionMatrix);
+        const float SampleZ = FarZ > 0.0f ? FMath::Min(MaxSampleZ, FarZ * 0.99f) : MaxSampleZ;
+
+        // 任意一只眼睛视锥内的点都在并集内
+        for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+        {
+            const bool bRightEye = Sample % 2 != 0;
+            const FVector3f Point = RandomPointInEye(bRightEye ? Right : Left, SampleZ, Random);
+            const bool bInUnion = Union.IntersectsSphereScalar(Point, Tolerance);
+            NumMissed += bInUnion ? 0 : 1;
+            NumSimdMismatches += Union.IntersectsSphere(Point, Tolerance) != bInUnion ? 1 : 0;
+
+            // 只用左眼剔除时右眼看到的点有多少被错误剔除 (只统计，说明为什么需要并集)
+            if (bRightEye)
+            {
+                ++OtherEyeSamples;
+                OtherEyeCulledByOneEye += LeftFrustum.IntersectsSphereScalar(Point, 0.0f) ? 0 : 1;
+            }
+        }
+
+        // 两只眼睛都看不到的方向被拒绝：头部后方，以及比两只眼睛外侧视野更宽的方向
+        const FMatrix HeadToWorld = FRotationTranslationMatrix(HeadRotation, HeadOrigin);
+        const float OutsideTan = Setup.TanOuter + 0.6f;
+        const FVector3f Behind(HeadToWorld.TransformPosition(FVector(-1000.0, 0.0, 0.0)));
+        const FVector3f FarLeft(HeadToWorld.TransformPosition(FVector(1000.0, -1000.0 * OutsideTan - Setup.Ipd, 0.0)));
+        const FVector3f FarRight(HeadToWorld.TransformPosition(FVector(1000.0, 1000.0 * OutsideTan + Setup.Ipd, 0.0)));
+        const FVector3f FarUp(HeadToWorld.TransformPosition(FVector(1000.0, 0.0, 1000.0 * (Setup.TanUp + 0.6f))));
+        NumFalseAccepts += Union.IntersectsSphereScalar(Behind, 0.0f) ? 1 : 0;
+        NumFalseAccepts += Union.IntersectsSphereScalar(FarLeft, 0.0f) ? 1 : 0;
+        NumFalseAccepts += Union.IntersectsSphereScalar(FarRight, 0.0f) ? 1 : 0;
+        NumFalseAccepts += Union.IntersectsSphereScalar(FarUp, 0.0f) ? 1 : 0;
+        if (FarZ > 0.0f)
+        {
+            // 有夹角时另一只眼睛的远平面角点在这只眼睛的前方方向上更远，并集的远平面向外移动
+            NumFalseAccepts += Union.IntersectsSphereScalar(FVector3f(HeadToWorld.TransformPosition(FVector(FarZ * 1.5, 0.0, 0.0))), 0.0f) ? 1 : 0;
+        }
+    }
+    TestTrue(TEXT("every point inside either eye frustum is inside the union"), NumMissed == 0);
+    TestTrue(TEXT("SIMD sphere test on the union matches the scalar reference"), NumSimdMismatches == 0);
+    TestTrue(TEXT("directions neither eye can see (behind, beyond the outer FOV, beyond the far plane) are rejected"), NumFalseAccepts == 0);
+
+    // ======== 同一只眼睛：并集与原视锥相同 ========
+    {
+        const FGrassTestEye Eye = MakeTestEye(FVector(100.0, 200.0, 300.0), FRotator(-10.0f, 30.0f, 0.0f), 0.0f, 0.0f, 0.84f, 1.0f, 1.2f, 0.95f, 10.0f, 0.0f);
+        const FGrassFrustum Single = FGrassFrustum::FromViewProjection(Eye.ViewProjectionMatrix);
+        const FGrassFrustum Union = FGrassFrustum::FromViewProjectionUnion(Eye.ViewProjectionMatrix, Eye.ViewProjectionMatrix);
+        bool bSame = true;
+        for (int32 i = 0; i < 6; ++i)
+        {
+            // 反向 Z 无限远投影退化的平面 (法线为零) 两者都不剔除
+            const bool bDegenerate = FVector3f(Single.Planes[i]).IsNearlyZero();
+            bSame &= bDegenerate ? FVector3f(Union.Planes[i]).IsNearlyZero() : Union.Planes[i].Equals(Single.Planes[i], 1e-3f);
+        }
+        TestTrue(TEXT("the union of a frustum with itself is the same frustum"), bSame);
+    }
+
+    AddInfo(FString::Printf(TEXT("%d eye pairs, %.2f%% of the right eye's samples would be culled by left-eye-only culling"),
+        NumViews, OtherEyeCulledByOneEye * 100.0 / FMath::Max<int64>(OtherEyeSamples, 1)));
+    return true;
+}
+
+// ============================================================================
+// 测试：FConvexVolume 平面 (法线向外、平移后的空间) 的转换与盒子的内外判断一致；少于 6 个平面时偏保守；
+// 变换到本地空间 (TransformBy) 后与世界空间的判断一致
+// ============================================================================
+static float GetMinPlaneDistance(const FGrassFrustum& Frustum, const FVector3f& Point)
+{
+    float MinDistance = MAX_flt;
+    for (int32 i = 0; i < 6; ++i)
+    {
+        const FVector4f& Plane = Frustum.Planes[i];
+        MinDistance = FMath::Min(MinDistance, Plane.X * Point.X + Plane.Y * Point.Y + Plane.Z * Point.Z + Plane.W);
+    }
+    return MinDistance;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassShadowFrustumTest, "UnrealGrass.Frustum.ShadowVolume",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassShadowFrustumTest::RunTest(const FString& Parameters)
+{
+    const int32 NumVolumes = 256;
+    const int32 NumSamples = 256;
+    // 离表面太近的点不判断 (平面以 float 保存，世界坐标约 10 万)
+    const float Tolerance = 1.0f;
+
+    FRandomStream Random(1357);
+    int32 NumBoxMismatches = 0;
+    int32 NumPartialMissed = 0;
+    int32 NumSimdMismatches = 0;
+    int32 NumLocalMismatches = 0;
+    int64 NumTested = 0;
+    for (int32 VolumeIndex = 0; VolumeIndex < NumVolumes; ++VolumeIndex)
+    {
+        // ======== 级联的正交剔除体：任意朝向的盒子，平面在 P + PreShadowTranslation 空间 ========
+        const FVector Center(Random.FRandRange(-100000.0f, 100000.0f), Random.FRandRange(-100000.0f, 100000.0f), Random.FRandRange(-1000.0f, 5000.0f));
+        const FVector Extent(Random.FRandRange(500.0f, 20000.0f), Random.FRandRange(500.0f, 20000.0f), Random.FRandRange(500.0f, 50000.0f));
+        const FMatrix Rotation = FRotationMatrix(FRotator(Random.FRandRange(-90.0f, 90.0f), Random.FRandRange(0.0f, 360.0f), Random.FRandRange(-180.0f, 180.0f)));
+        const FVector PreShadowTranslation = -(Center + Random.VRand() * Random.FRandRange(0.0f, 5000.0f));
+
+        TArray<FPlane, TInlineAllocator<6>> OutwardPlanes;
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            const FVector Direction = Rotation.GetUnitAxis((EAxis::Type)(Axis + 1));
+            const double CenterDistance = FVector::DotProduct(Direction, Center + PreShadowTranslation);
+            OutwardPlanes.Add(FPlane(Direction.X, Direction.Y, Direction.Z, CenterDistance + Extent[Axis]));
+            OutwardPlanes.Add(FPlane(-Direction.X, -Direction.Y, -Direction.Z, -CenterDistance + Extent[Axis]));
+        }
+
+        const FGrassFrustum Box = FGrassFrustum::FromConvexPlanes(OutwardPlanes, PreShadowTranslation);
+        // 只有前 4 个平面 (Z 方向不限)：盒子之外 Z 方向的点也必须接受
+        const FGrassFrustum Partial = FGrassFrustum::FromConvexPlanes(MakeArrayView(OutwardPlanes.GetData(), 4), PreShadowTranslation);
+
+        for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+        {
+            const FVector Local(Random.FRandRange(-1.5f, 1.5f) * Extent.X, Random.FRandRange(-1.5f, 1.5f) * Extent.Y, Random.FRandRange(-1.5f, 1.5f) * Extent.Z);
+            const FVector3f Point(Center + Rotation.TransformVector(Local));
+            const FVector Margin = Extent - Local.GetAbs();
+            if (Margin.GetAbs().GetMin() < Tolerance)
+            {
+                continue;
+            }
+            ++NumTested;
+
+            const bool bExpected = Margin.GetMin() > 0.0;
+            const bool bInBox = Box.IntersectsSphereScalar(Point, 0.0f);
+            NumBoxMismatches += bInBox != bExpected ? 1 : 0;
+            NumSimdMismatches += Box.IntersectsSphere(Point, 0.0f) != bInBox ? 1 : 0;
+            NumPartialMissed += (FMath::Min(Margin.X, Margin.Y) > 0.0 && !Partial.IntersectsSphereScalar(Point, 0.0f)) ? 1 : 0;
+        }
+
+        // ======== 本地空间：任意旋转 / 非均匀缩放 / 平移的组件 ========
+        const FMatrix LocalToWorld = FScaleRotationTranslationMatrix(
+            FVector(Random.FRandRange(0.5f, 3.0f), Random.FRandRange(0.5f, 3.0f), Random.FRandRange(0.5f, 3.0f)),
+            FRotator(Random.FRandRange(-30.0f, 30.0f), Random.FRandRange(0.0f, 360.0f), Random.FRandRange(-30.0f, 30.0f)),
+            Center + Random.VRand() * Random.FRandRange(0.0f, 10000.0f));
+        const FGrassFrustum LocalBox = Box.TransformBy(LocalToWorld);
+        const FMatrix WorldToLocal = LocalToWorld.Inverse();
+        for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+        {
+            const FVector3f WorldPoint(Center + Rotation.TransformVector(FVector(
+                Random.FRandRange(-1.5f, 1.5f) * Extent.X, Random.FRandRange(-1.5f, 1.5f) * Extent.Y, Random.FRandRange(-1.5f, 1.5f) * Extent.Z)));
+            const float WorldDistance = GetMinPlaneDistance(Box, WorldPoint);
+            if (FMath::Abs(WorldDistance) < Tolerance)
+            {
+                continue;
+            }
+            const FVector3f LocalPoint(WorldToLocal.TransformPosition(FVector(WorldPoint)));
+            NumLocalMismatches += LocalBox.IntersectsSphereScalar(LocalPoint, 0.0f) != (WorldDistance >= 0.0f) ? 1 : 0;
+        }
+    }
+    TestTrue(TEXT("the converted convex volume classifies points like the box it was built from"), NumBoxMismatches == 0);
+    TestTrue(TEXT("SIMD sphere test matches the scalar reference"), NumSimdMismatches == 0);
+    TestTrue(TEXT("fewer than 6 planes never rejects a point inside the given planes"), NumPartialMissed == 0);
+    TestTrue(TEXT("TransformBy gives the same inside / outside result in component local space"), NumLocalMismatches == 0);
+
+    // ======== 没有平面 (点光源等没有剔除体的阴影)：不剔除 ========
+    {
+        const FGrassFrustum Empty = FGrassFrustum::FromConvexPlanes(TConstArrayView<FPlane>(), FVector(1000.0, 2000.0, 3000.0));
+        TestTrue(TEXT("an empty convex volume accepts everything"), Empty.TestBoxScalar(FVector3f(1.0e6f), FVector3f(1.0f)) == EGrassFrustumTest::Inside);
+    }
+
+    AddInfo(FString::Printf(TEXT("%d volumes, %lld points"), NumVolumes, NumTested));
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
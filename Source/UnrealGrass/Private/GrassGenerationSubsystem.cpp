@@ -0,0 +1,492 @@
+// GrassGenerationSubsystem.cpp
+// 世界级的草地生成调度器
+
+#include "GrassGenerationSubsystem.h"
+#include "GrassStats.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_STAT(STAT_GrassGenerationQueueDepth);
+DEFINE_STAT(STAT_GrassGenerationRequestsIssued);
+DEFINE_STAT(STAT_GrassGenerationInstancesIssued);
+DEFINE_STAT(STAT_GrassGenerationSchedulerTime);
+DEFINE_STAT(STAT_GrassResidentBytes);
+DEFINE_STAT(STAT_GrassMemoryBudget);
+DEFINE_STAT(STAT_GrassEvictedComponents);
+DEFINE_STAT(STAT_GrassEvictions);
+DEFINE_STAT(STAT_GrassReloads);
+DEFINE_STAT(STAT_GrassMemoryBudgetTime);
+
+static TAutoConsoleVariable<int32> CVarGrassGenerationScheduler(
+    TEXT("r.Grass.Generation.Scheduler"),
+    1,
+    TEXT("Queue grass generation requests and issue them under a per-frame budget (0 = generate immediately)"),
+    ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarGrassGenerationBudgetMs(
+    TEXT("r.Grass.Generation.BudgetMs"),
+    2.0f,
+    TEXT("Game thread milliseconds per frame spent issuing queued grass generation (at least one request is issued per frame)"),
+    ECVF_Default
+);
+
+static TAutoConsoleVariable<int32> CVarGrassGenerationMaxInstancesPerFrame(
+    TEXT("r.Grass.Generation.MaxInstancesPerFrame"),
+    1000000,
+    TEXT("Maximum grass instances whose generation is issued per frame (0 = unlimited)"),
+    ECVF_Default
+);
+
+static TAutoConsoleVariable<int32> CVarGrassMemoryBudgetMB(
+    TEXT("r.Grass.MemoryBudgetMB"),
+    1024,
+    TEXT("GPU memory budget in MB for grass instance data of all components in a world. Over budget, the farthest / least recently visible components are evicted and reloaded when they come back in range (0 = unlimited)"),
+    ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarGrassMemoryBudgetMinResidentSeconds(
+    TEXT("r.Grass.MemoryBudget.MinResidentSeconds"),
+    5.0f,
+    TEXT("A grass component stays resident at least this long after (re)generation before it can be evicted"),
+    ECVF_Default
+);
+
+static TAutoConsoleVariable<float> CVarGrassMemoryBudgetReloadHysteresis(
+    TEXT("r.Grass.MemoryBudget.ReloadHysteresis"),
+    0.1f,
+    TEXT("Evicted grass components must be this fraction closer than resident ones to be reloaded in their place (avoids evict / reload ping-pong at the budget edge)"),
+    ECVF_Default
+);
+
+bool UGrassGenerationSubsystem::IsEnabled()
+{
+    return CVarGrassGenerationScheduler.GetValueOnGameThread() != 0;
+}
+
+// ============================================================================
+// 队列
+// ============================================================================
+void UGrassGenerationSubsystem::RequestGeneration(UGrassComponent* Component, EGrassGenerationStage Stages)
+{
+    check(IsInGameThread());
+
+    if (!Component || Stages == EGrassGenerationStage::None)
+    {
+        return;
+    }
+
+    for (FGenerationRequest& Request : Queue)
+    {
+        if (Request.Component.Get() == Component)
+        {
+            Request.Stages |= Stages;
+            return;
+        }
+    }
+
+    FGenerationRequest& Request = Queue.AddDefaulted_GetRef();
+    Request.Component = Component;
+    Request.Stages = Stages;
+    Request.RequestTime = FPlatformTime::Seconds();
+    SET_DWORD_STAT(STAT_GrassGenerationQueueDepth, Queue.Num());
+}
+
+void UGrassGenerationSubsystem::CancelGeneration(UGrassComponent* Component)
+{
+    Queue.RemoveAll([Component](const FGenerationRequest& Request)
+    {
+        return Request.Component.Get() == Component;
+    });
+    SET_DWORD_STAT(STAT_GrassGenerationQueueDepth, Queue.Num());
+}
+
+bool UGrassGenerationSubsystem::FlushGeneration(UGrassComponent* Component)
+{
+    const int32 Index = Queue.IndexOfByPredicate([Component](const FGenerationRequest& Request)
+    {
+        return Request.Component.Get() == Component;
+    });
+    if (Index == INDEX_NONE)
+    {
+        return false;
+    }
+
+    const EGrassGenerationStage Stages = Queue[Index].Stages;
+    Queue.RemoveAt(Index);
+    SET_DWORD_STAT(STAT_GrassGenerationQueueDepth, Queue.Num());
+
+    Component->RegenerateStages(Stages);
+    return true;
+}
+
+bool UGrassGenerationSubsystem::IsQueued(const UGrassComponent* Component) const
+{
+    return Queue.ContainsByPredicate([Component](const FGenerationRequest& Request)
+    {
+        return Request.Component.Get() == Component;
+    });
+}
+
+void UGrassGenerationSubsystem::RegisterComponent(UGrassComponent* Component)
+{
+    check(IsInGameThread());
+    if (Component)
+    {
+        ManagedComponents.AddUnique(Component);
+    }
+}
+
+void UGrassGenerationSubsystem::UnregisterComponent(UGrassComponent* Component)
+{
+    ManagedComponents.RemoveAll([Component](const TWeakObjectPtr<UGrassComponent>& Managed)
+    {
+        return !Managed.IsValid() || Managed.Get() == Component;
+    });
+}
+
+uint64 UGrassGenerationSubsystem::GetResidentBytes() const
+{
+    uint64 ResidentBytes = 0;
+    for (const TWeakObjectPtr<UGrassComponent>& Component : ManagedComponents)
+    {
+        if (const UGrassComponent* Managed = Component.Get())
+        {
+            ResidentBytes += Managed->GetResidentGpuBytes();
+        }
+    }
+    return ResidentBytes;
+}
+
+void UGrassGenerationSubsystem::Deinitialize()
+{
+    Queue.Reset();
+    ManagedComponents.Reset();
+    SET_DWORD_STAT(STAT_GrassGenerationQueueDepth, 0);
+    Super::Deinitialize();
+}
+
+// ============================================================================
+// 每帧调度
+// ============================================================================
+void UGrassGenerationSubsystem::GatherViewLocations(TArray<FVector>& OutViewLocations) const
+{
+    const UWorld* World = GetWorld();
+    if (!World)
+    {
+        return;
+    }
+
+    // 上一帧渲染的所有视图 (编辑器视口、分屏、场景捕获)
+    OutViewLocations = World->ViewLocationsRenderedLastFrame;
+    if (OutViewLocations.Num() > 0)
+    {
+        return;
+    }
+
+    // 第一帧还没有渲染过：使用玩家视点
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (const APlayerController* PlayerController = It->Get())
+        {
+            FVector ViewLocation;
+            FRotator ViewRotation;
+            PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+            OutViewLocations.Add(ViewLocation);
+        }
+    }
+}
+
+static double ComputeViewDistanceSquared(const UGrassComponent* Component, const TArray<FVector>& ViewLocations)
+{
+    // 到包围盒的距离：相机在草地内部时优先级最高；没有相机时所有组件同等对待
+    if (ViewLocations.Num() == 0)
+    {
+        return 0.0;
+    }
+
+    const FBox Box = Component->Bounds.GetBox();
+    double MinDistSq = TNumericLimits<double>::Max();
+    for (const FVector& ViewLocation : ViewLocations)
+    {
+        MinDistSq = FMath::Min(MinDistSq, Box.ComputeSquaredDistanceToPoint(ViewLocation));
+    }
+    return MinDistSq;
+}
+
+void UGrassGenerationSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // 移除已经销毁的组件
+    Queue.RemoveAll([](const FGenerationRequest& Request)
+    {
+        return !Request.Component.IsValid();
+    });
+    ManagedComponents.RemoveAll([](const TWeakObjectPtr<UGrassComponent>& Component)
+    {
+        return !Component.IsValid();
+    });
+    SET_DWORD_STAT(STAT_GrassGenerationQueueDepth, Queue.Num());
+
+    TArray<FVector> ViewLocations;
+    GatherViewLocations(ViewLocations);
+
+    // 先更新显存预算：本帧需要重新加载的组件进入队列，和其他请求一起按距离排序
+    UpdateMemoryBudget(ViewLocations);
+
+    if (Queue.Num() > 0)
+    {
+        IssueQueuedGeneration(ViewLocations);
+    }
+}
+
+void UGrassGenerationSubsystem::IssueQueuedGeneration(const TArray<FVector>& ViewLocations)
+{
+    SCOPE_CYCLE_COUNTER(STAT_GrassGenerationSchedulerTime);
+
+    // 离最近的相机越近越先生成 (没有相机时按请求顺序)
+    if (ViewLocations.Num() > 0)
+    {
+        TArray<double> Priorities;
+        Priorities.SetNumUninitialized(Queue.Num());
+        for (int32 i = 0; i < Queue.Num(); ++i)
+        {
+            Priorities[i] = ComputeViewDistanceSquared(Queue[i].Component.Get(), ViewLocations);
+        }
+
+        TArray<int32> Order;
+        Order.SetNumUninitialized(Queue.Num());
+        for (int32 i = 0; i < Order.Num(); ++i)
+        {
+            Order[i] = i;
+        }
+        Order.StableSort([&Priorities](int32 A, int32 B) { return Priorities[A] < Priorities[B]; });
+
+        TArray<FGenerationRequest> SortedQueue;
+        SortedQueue.Reserve(Queue.Num());
+        for (int32 i : Order)
+        {
+            SortedQueue.Add(MoveTemp(Queue[i]));
+        }
+        Queue = MoveTemp(SortedQueue);
+    }
+
+    // 至少发起一个请求，之后超出时间或实例预算就留到下一帧
+    const double BudgetSeconds = FMath::Max(CVarGrassGenerationBudgetMs.GetValueOnGameThread(), 0.0f) / 1000.0;
+    const int32 MaxInstances = CVarGrassGenerationMaxInstancesPerFrame.GetValueOnGameThread();
+    const double StartTime = FPlatformTime::Seconds();
+    int32 NumIssued = 0;
+    int64 InstancesIssued = 0;
+
+    while (Queue.Num() > 0)
+    {
+        UGrassComponent* Component = Queue[0].Component.Get();
+        if (NumIssued > 0)
+        {
+            // 地形分块数量在生成时才确定，这里用一个分块的网格数量估算
+            const int64 EstimatedInstances = (int64)Component->GridSize * Component->GridSize;
+            if (MaxInstances > 0 && InstancesIssued + EstimatedInstances > MaxInstances)
+            {
+                break;
+            }
+            if (FPlatformTime::Seconds() - StartTime >= BudgetSeconds)
+            {
+                break;
+            }
+        }
+
+        const EGrassGenerationStage Stages = Queue[0].Stages;
+        Queue.RemoveAt(0);
+        Component->RegenerateStages(Stages);
+
+        ++NumIssued;
+        InstancesIssued += Component->InstanceCount;
+    }
+
+    SET_DWORD_STAT(STAT_GrassGenerationQueueDepth, Queue.Num());
+    INC_DWORD_STAT_BY(STAT_GrassGenerationRequestsIssued, NumIssued);
+    INC_DWORD_STAT_BY(STAT_GrassGenerationInstancesIssued, InstancesIssued);
+
+    UE_LOG(LogTemp, Verbose, TEXT("GrassGenerationSubsystem: issued %d request(s), %lld instances in %.2f ms, %d queued"),
+        NumIssued, InstancesIssued, (FPlatformTime::Seconds() - StartTime) * 1000.0, Queue.Num());
+}
+
+// ============================================================================
+// 显存预算
+// ============================================================================
+void UGrassGenerationSubsystem::UpdateMemoryBudget(const TArray<FVector>& ViewLocations)
+{
+    SCOPE_CYCLE_COUNTER(STAT_GrassMemoryBudgetTime);
+
+    const uint64 BudgetBytes = (uint64)FMath::Max(CVarGrassMemoryBudgetMB.GetValueOnGameThread(), 0) * 1024 * 1024;
+    SET_MEMORY_STAT(STAT_GrassMemoryBudget, BudgetBytes);
+
+    struct FBudgetEntry
+    {
+        UGrassComponent* Component = nullptr;
+        double Priority = 0.0;          // 到最近相机的距离平方 (被释放的组件带回滞系数)
+        uint64 Bytes = 0;               // 常驻字节数；被释放的组件是释放前的字节数
+        bool bEvicted = false;
+        bool bReloading = false;        // 已被释放，重新加载的请求在队列中或正在生成
+        bool bWanted = false;           // 按距离排序后落在预算内
+    };
+
+    const double Hysteresis = 1.0 + FMath::Max(CVarGrassMemoryBudgetReloadHysteresis.GetValueOnGameThread(), 0.0f);
+    TArray<FBudgetEntry> Entries;
+    Entries.Reserve(ManagedComponents.Num());
+    uint64 ResidentBytes = 0;
+    int32 NumEvicted = 0;
+
+    for (const TWeakObjectPtr<UGrassComponent>& Managed : ManagedComponents)
+    {
+        UGrassComponent* Component = Managed.Get();
+        if (!Component || !Component->IsRegistered())
+        {
+            continue;
+        }
+
+        FBudgetEntry Entry;
+        Entry.Component = Component;
+        Entry.bEvicted = Component->IsInstanceDataEvicted();
+        Entry.bReloading = Entry.bEvicted && (Component->IsGenerationInFlight() || IsQueued(Component));
+        Entry.Bytes = Entry.bEvicted ? Component->GetEvictedGpuBytes() : Component->GetResidentGpuBytes();
+        if (Entry.Bytes == 0)
+        {
+            // 还没有生成过的组件不参与预算，第一次生成完成后再纳入
+            continue;
+        }
+
+        Entry.Priority = ComputeViewDistanceSquared(Component, ViewLocations);
+        if (Entry.bEvicted)
+        {
+            // 被释放的组件要比常驻组件近一截才会换回来，预算边缘的组件不会每帧来回释放和加载
+            Entry.Priority *= Hysteresis * Hysteresis;
+            NumEvicted += Entry.bReloading ? 0 : 1;
+        }
+
+        // 正在重新加载的组件提前占用预算
+        if (!Entry.bEvicted || Entry.bReloading)
+        {
+            ResidentBytes += Entry.Bytes;
+        }
+        Entries.Add(Entry);
+    }
+
+    int32 NumEvictions = 0;
+    int32 NumReloads = 0;
+
+    if (BudgetBytes == 0)
+    {
+        // 不限制：重新加载所有被释放的组件 (例如运行时把预算改成 0)
+        for (FBudgetEntry& Entry : Entries)
+        {
+            if (Entry.bEvicted && !Entry.bReloading)
+            {
+                Entry.Component->ReloadInstanceData();
+                ResidentBytes += Entry.Bytes;
+                ++NumReloads;
+            }
+        }
+        NumEvicted = 0;
+    }
+    else
+    {
+        // 由近到远累加，直到第一个放不下的组件为止，之前的都应该常驻
+        Entries.StableSort([](const FBudgetEntry& A, const FBudgetEntry& B) { return A.Priority < B.Priority; });
+        uint64 WantedBytes = 0;
+        for (FBudgetEntry& Entry : Entries)
+        {
+            if (WantedBytes + Entry.Bytes > BudgetBytes)
+            {
+                break;
+            }
+            WantedBytes += Entry.Bytes;
+            Entry.bWanted = true;
+        }
+
+        // 可释放的组件：不在预算内、没有进行中的生成、常驻时间超过 MinResidentSeconds
+        // 最近没有被看到的优先，其次离相机最远的优先
+        const double Now = FPlatformTime::Seconds();
+        const double MinResidentSeconds = FMath::Max(CVarGrassMemoryBudgetMinResidentSeconds.GetValueOnGameThread(), 0.0f);
+        TArray<FBudgetEntry*> Candidates;
+        for (FBudgetEntry& Entry : Entries)
+        {
+            if (!Entry.bWanted && !Entry.bEvicted && !Entry.Component->IsGenerationInFlight()
+                && Now - Entry.Component->GetResidentSinceTime() >= MinResidentSeconds)
+            {
+                Candidates.Add(&Entry);
+            }
+        }
+        Candidates.StableSort([](const FBudgetEntry& A, const FBudgetEntry& B)
+        {
+            const bool bRecentA = A.Component->WasRecentlyRendered();
+            const bool bRecentB = B.Component->WasRecentlyRendered();
+            if (bRecentA != bRecentB)
+            {
+                return !bRecentA;
+            }
+            return A.Priority > B.Priority;
+        });
+
+        int32 NextCandidate = 0;
+        auto EvictNext = [&]() -> bool
+        {
+            while (NextCandidate < Candidates.Num())
+            {
+                FBudgetEntry& Entry = *Candidates[NextCandidate++];
+                if (Entry.Component->EvictInstanceData())
+                {
+                    ResidentBytes -= Entry.Bytes;
+                    ++NumEvictions;
+                    ++NumEvicted;
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // 由近到远重新加载回到范围内的组件，必要时先释放更远的组件腾出空间
+        for (FBudgetEntry& Entry : Entries)
+        {
+            if (!Entry.bWanted || !Entry.bEvicted || Entry.bReloading)
+            {
+                continue;
+            }
+            while (ResidentBytes + Entry.Bytes > BudgetBytes && EvictNext())
+            {
+            }
+            if (ResidentBytes + Entry.Bytes > BudgetBytes)
+            {
+                // 剩下的组件都还没到 MinResidentSeconds，下一帧再试
+                break;
+            }
+            Entry.Component->ReloadInstanceData();
+            ResidentBytes += Entry.Bytes;
+            ++NumReloads;
+            --NumEvicted;
+        }
+
+        // 仍然超出预算 (例如新生成的组件)：继续释放
+        while (ResidentBytes > BudgetBytes && EvictNext())
+        {
+        }
+    }
+
+    SET_MEMORY_STAT(STAT_GrassResidentBytes, ResidentBytes);
+    SET_DWORD_STAT(STAT_GrassEvictedComponents, NumEvicted);
+    INC_DWORD_STAT_BY(STAT_GrassEvictions, NumEvictions);
+    INC_DWORD_STAT_BY(STAT_GrassReloads, NumReloads);
+
+    if (NumEvictions > 0 || NumReloads > 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("GrassGenerationSubsystem: memory budget %.1f / %.1f MB, evicted %d, reloading %d, %d component(s) evicted"),
+            ResidentBytes / (1024.0 * 1024.0), BudgetBytes / (1024.0 * 1024.0), NumEvictions, NumReloads, NumEvicted);
+    }
+}
+
+TStatId UGrassGenerationSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGrassGenerationSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,351 @@
+// GrassInstanceCache.cpp
+// 草地实例数据的磁盘缓存
+
+#include "GrassInstanceCache.h"
+#include "GrassComponent.h"
+#include "GrassInstanceBuffers.h"
+#include "GrassStats.h"
+#include "Async/Async.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "RHICommandList.h"
+#include "RHIGPUReadback.h"
+
+DEFINE_STAT(STAT_GrassInstanceCacheHits);
+DEFINE_STAT(STAT_GrassInstanceCacheMisses);
+DEFINE_STAT(STAT_GrassInstanceCacheBytesLoaded);
+
+// 缓存文件头 Magic ('GRSC')
+static constexpr uint32 GrassCacheMagic = 0x43535247;
+
+static TAutoConsoleVariable<int32> CVarGrassInstanceCache(
+    TEXT("r.Grass.InstanceCache"),
+    1,
+    TEXT("Load generated grass instances from Saved/GrassCache when the generation inputs match (0 = always generate)"),
+    ECVF_Default
+);
+
+// ============================================================================
+// 缓存 Key
+// ============================================================================
+template<typename T>
+static FORCEINLINE void HashValue(FSHA1& Sha, const T& Value)
+{
+    Sha.Update(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+}
+
+FString FGrassInstanceCache::ComputeKey(const FGrassGenerationParams& Params)
+{
+    FSHA1 Sha;
+    HashValue(Sha, CacheVersion);
+
+    // 基础网格参数
+    HashValue(Sha, Params.GridSize);
+    HashValue(Sha, Params.Spacing);
+    HashValue(Sha, Params.JitterStrength);
+
+    // Clump 参数
+    HashValue(Sha, Params.NumClumps);
+    HashValue(Sha, Params.NumClumpTypes);
+    HashValue(Sha, Params.VoronoiTextureSize);
+    for (int32 i = 0; i < Params.NumClumpTypes && i < Params.ClumpTypes.Num(); ++i)
+    {
+        const FClumpTypeParameters& Type = Params.ClumpTypes[i];
+        HashValue(Sha, Type.PullToCentre);
+        HashValue(Sha, Type.PointInSameDirection);
+        HashValue(Sha, Type.BaseHeight);
+        HashValue(Sha, Type.HeightRandom);
+        HashValue(Sha, Type.BaseWidth);
+        HashValue(Sha, Type.WidthRandom);
+        HashValue(Sha, Type.BaseTilt);
+        HashValue(Sha, Type.TiltRandom);
+        HashValue(Sha, Type.BaseBend);
+        HashValue(Sha, Type.BendRandom);
+    }
+
+    // 密度遮罩
+    HashValue(Sha, Params.DensityMaskContentHash);
+    const uint8 bInvertDensityLayer = Params.bInvertDensityLayer ? 1 : 0;
+    HashValue(Sha, bInvertDensityLayer);
+
+    // 生成分块
+    HashValue(Sha, Params.GetNumTiles());
+    for (const FGrassGenerationTile& Tile : Params.Tiles)
+    {
+        HashValue(Sha, Tile.SampleOrigin);
+        HashValue(Sha, Tile.CellSize);
+        HashValue(Sha, Tile.TileMin);
+        HashValue(Sha, Tile.TileSize);
+        HashValue(Sha, Tile.SeedOffset);
+    }
+
+    // Landscape 高度图参数和内容
+    const uint8 bUseLandscapeHeightmap = Params.bUseLandscapeHeightmap ? 1 : 0;
+    HashValue(Sha, bUseLandscapeHeightmap);
+    if (Params.bUseLandscapeHeightmap)
+    {
+        HashValue(Sha, Params.LandscapeScale);
+        HashValue(Sha, Params.LandscapeLocation);
+        HashValue(Sha, Params.ComponentLocation.Z);
+        for (const FGrassGenerationTile& Tile : Params.Tiles)
+        {
+            HashValue(Sha, Tile.HeightmapScaleBias);
+            HashValue(Sha, Tile.HeightmapContentHash);
+            HashValue(Sha, Tile.WeightmapScaleBias);
+            HashValue(Sha, Tile.WeightmapChannelMask);
+            HashValue(Sha, Tile.WeightmapContentHash);
+        }
+    }
+
+    Sha.Final();
+    uint8 Hash[FSHA1::DigestSize];
+    Sha.GetHash(Hash);
+    return BytesToHex(Hash, FSHA1::DigestSize);
+}
+
+uint32 FGrassInstanceCache::HashTexture(const UTexture2D* Texture)
+{
+    if (!Texture)
+    {
+        return 0;
+    }
+
+#if WITH_EDITORONLY_DATA
+    // 源数据 Id 在地形编辑 / 重新导入后会重新生成
+    return GetTypeHash(Texture->Source.GetId());
+#else
+    // Cooked 版本中纹理不会变化
+    return HashCombine(GetTypeHash(Texture->GetPathName()), GetTypeHash(Texture->GetLightingGuid()));
+#endif
+}
+
+bool FGrassInstanceCache::IsEnabled()
+{
+    return CVarGrassInstanceCache.GetValueOnGameThread() != 0;
+}
+
+FString FGrassInstanceCache::GetCacheFilePath(const FString& Key)
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("GrassCache"), Key + TEXT(".grass"));
+}
+
+bool FGrassInstanceCache::Contains(const FString& Key)
+{
+    return IFileManager::Get().FileSize(*GetCacheFilePath(Key)) > 0;
+}
+
+// ============================================================================
+// 读写
+// 文件布局: Magic, Version, InstanceCount, QuantizationMin, QuantizationSize, Instances[N] (16 字节压缩格式)
+// ============================================================================
+FGrassCpuInstanceDataPtr FGrassInstanceCache::Load(const FString& Key, int32 MaxInstanceCount)
+{
+    TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*GetCacheFilePath(Key)));
+    if (!Ar)
+    {
+        return nullptr;
+    }
+
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    int32 InstanceCount = 0;
+    *Ar << Magic << Version << InstanceCount;
+    if (Magic != GrassCacheMagic || Version != CacheVersion || InstanceCount < 0 || InstanceCount > MaxInstanceCount)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("GrassInstanceCache: Ignoring stale cache file %s (Version=%u, Instances=%d, Max=%d)"),
+            *Key, Version, InstanceCount, MaxInstanceCount);
+        return nullptr;
+    }
+
+    const int64 ExpectedSize = Ar->Tell() + sizeof(FVector3f) * 2 + (int64)InstanceCount * FGrassInstancePacking::PackedStride;
+    if (Ar->TotalSize() != ExpectedSize)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("GrassInstanceCache: Truncated cache file %s"), *Key);
+        return nullptr;
+    }
+
+    FGrassCpuInstanceDataPtr Data = MakeShared<FGrassCpuInstanceData, ESPMode::ThreadSafe>();
+    *Ar << Data->Quantization.Min << Data->Quantization.Size;
+    Data->Instances.SetNumUninitialized(InstanceCount);
+    Ar->Serialize(Data->Instances.GetData(), InstanceCount * FGrassInstancePacking::PackedStride);
+
+    if (!Ar->Close())
+    {
+        return nullptr;
+    }
+    return Data;
+}
+
+bool FGrassInstanceCache::Save(const FString& Key, const FGrassCpuInstanceData& Data)
+{
+    const FString FinalPath = GetCacheFilePath(Key);
+    const FString TempPath = FinalPath + TEXT(".tmp");
+
+    {
+        TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*TempPath));
+        if (!Ar)
+        {
+            return false;
+        }
+
+        uint32 Magic = GrassCacheMagic;
+        uint32 Version = CacheVersion;
+        int32 InstanceCount = Data.Num();
+        FGrassInstanceQuantization Quantization = Data.Quantization;
+        *Ar << Magic << Version << InstanceCount;
+        *Ar << Quantization.Min << Quantization.Size;
+        Ar->Serialize(const_cast<FUintVector4*>(Data.Instances.GetData()), InstanceCount * FGrassInstancePacking::PackedStride);
+
+        if (!Ar->Close())
+        {
+            IFileManager::Get().Delete(*TempPath);
+            return false;
+        }
+    }
+
+    // 写完后再改名，避免读到写了一半的文件
+    return IFileManager::Get().Move(*FinalPath, *TempPath, true, true);
+}
+
+TFuture<FGrassCpuInstanceDataPtr> FGrassInstanceCache::LoadAsync(const FString& Key, int32 MaxInstanceCount)
+{
+    return Async(EAsyncExecution::ThreadPool, [Key, MaxInstanceCount]()
+    {
+        return Load(Key, MaxInstanceCount);
+    });
+}
+
+void FGrassInstanceCache::SaveAsync(const FString& Key, FGrassCpuInstanceDataPtr Data)
+{
+    Async(EAsyncExecution::ThreadPool, [Key, Data]()
+    {
+        if (Save(Key, *Data))
+        {
+            UE_LOG(LogTemp, Log, TEXT("GrassInstanceCache: Saved %d instances to %s"), Data->Num(), *Key);
+        }
+        else
+        {
+            UE_LOG(LogTemp, Warning, TEXT("GrassInstanceCache: Failed to write %s"), *GetCacheFilePath(Key));
+        }
+    });
+}
+
+// ============================================================================
+// 统计
+// ============================================================================
+struct FGrassInstanceCacheStats
+{
+    FCriticalSection Lock;
+    int32 Hits = 0;
+    int32 Misses = 0;
+    int64 BytesLoaded = 0;
+    double HitSeconds = 0.0;
+    double MissSeconds = 0.0;
+};
+
+static FGrassInstanceCacheStats GGrassInstanceCacheStats;
+
+void FGrassInstanceCache::RecordHit(int64 BytesLoaded, double LoadSeconds)
+{
+    INC_DWORD_STAT(STAT_GrassInstanceCacheHits);
+    INC_MEMORY_STAT_BY(STAT_GrassInstanceCacheBytesLoaded, BytesLoaded);
+
+    FScopeLock ScopeLock(&GGrassInstanceCacheStats.Lock);
+    GGrassInstanceCacheStats.Hits++;
+    GGrassInstanceCacheStats.BytesLoaded += BytesLoaded;
+    GGrassInstanceCacheStats.HitSeconds += LoadSeconds;
+}
+
+void FGrassInstanceCache::RecordMiss(double GenerateSeconds)
+{
+    INC_DWORD_STAT(STAT_GrassInstanceCacheMisses);
+
+    FScopeLock ScopeLock(&GGrassInstanceCacheStats.Lock);
+    GGrassInstanceCacheStats.Misses++;
+    GGrassInstanceCacheStats.MissSeconds += GenerateSeconds;
+}
+
+void FGrassInstanceCache::LogStats()
+{
+    FScopeLock ScopeLock(&GGrassInstanceCacheStats.Lock);
+    const FGrassInstanceCacheStats& Stats = GGrassInstanceCacheStats;
+    UE_LOG(LogTemp, Display, TEXT("GrassInstanceCache: %d hits (%.2f MB, avg %.2f ms), %d misses (avg %.2f ms generate)"),
+        Stats.Hits, Stats.BytesLoaded / (1024.0 * 1024.0),
+        Stats.Hits > 0 ? Stats.HitSeconds * 1000.0 / Stats.Hits : 0.0,
+        Stats.Misses,
+        Stats.Misses > 0 ? Stats.MissSeconds * 1000.0 / Stats.Misses : 0.0);
+}
+
+static FAutoConsoleCommand GGrassCacheStatsCommand(
+    TEXT("grass.CacheStats"),
+    TEXT("Print grass instance cache hit/miss statistics"),
+    FConsoleCommandDelegate::CreateStatic(&FGrassInstanceCache::LogStats)
+);
+
+// ============================================================================
+// FGrassCacheReadback 实现
+// ============================================================================
+FGrassCacheReadback::FGrassCacheReadback(const FString& InKey)
+    : Key(InKey)
+{
+    InstanceReadback = MakeUnique<FRHIGPUBufferReadback>(TEXT("GrassCacheInstanceReadback"));
+}
+
+FGrassCacheReadback::~FGrassCacheReadback() = default;
+
+void FGrassCacheReadback::EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassInstanceBuffers& Buffers)
+{
+    InstanceCount = Buffers.InstanceCount;
+    Quantization = Buffers.Quantization;
+
+    // 密度遮罩剔除了所有草叶：没有 Buffer 可拷贝，直接写入空的缓存文件
+    if (!Buffers.IsValid())
+    {
+        InstanceCount = 0;
+        FGrassInstanceCache::SaveAsync(Key, MakeShared<FGrassCpuInstanceData, ESPMode::ThreadSafe>());
+        bComplete = true;
+        return;
+    }
+
+    // 实例是 Buffer 池页中的一段区间，Readback 只能从 Buffer 开头拷贝，先拷贝到临时 Buffer
+    const uint32 NumBytes = InstanceCount * FGrassInstancePacking::PackedStride;
+    FRHIBufferCreateDesc CopyDesc = FRHIBufferCreateDesc::CreateStructured(TEXT("GrassInstanceCacheCopy"), NumBytes, FGrassInstancePacking::PackedStride)
+        .AddUsage(EBufferUsageFlags::SourceCopy)
+        .SetInitialState(ERHIAccess::CopyDest);
+    FBufferRHIRef CopyBuffer = RHICmdList.CreateBuffer(CopyDesc);
+
+    RHICmdList.Transition(FRHITransitionInfo(Buffers.InstanceBuffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
+    RHICmdList.CopyBufferRegion(CopyBuffer, 0, Buffers.InstanceBuffer, Buffers.InstanceOffset * FGrassInstancePacking::PackedStride, NumBytes);
+    RHICmdList.Transition({
+        FRHITransitionInfo(Buffers.InstanceBuffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask),
+        FRHITransitionInfo(CopyBuffer, ERHIAccess::CopyDest, ERHIAccess::CopySrc) });
+    InstanceReadback->EnqueueCopy(RHICmdList, CopyBuffer, NumBytes);
+}
+
+bool FGrassCacheReadback::Poll_RenderThread()
+{
+    check(IsInRenderingThread());
+
+    if (bComplete)
+    {
+        return true;
+    }
+    if (!InstanceReadback->IsReady())
+    {
+        return false;
+    }
+
+    FGrassCpuInstanceDataPtr Data = MakeShared<FGrassCpuInstanceData, ESPMode::ThreadSafe>();
+    Data->Quantization = Quantization;
+    const uint32 NumBytes = InstanceCount * FGrassInstancePacking::PackedStride;
+    Data->Instances.SetNumUninitialized(InstanceCount);
+    FMemory::Memcpy(Data->Instances.GetData(), InstanceReadback->Lock(NumBytes), NumBytes);
+    InstanceReadback->Unlock();
+
+    FGrassInstanceCache::SaveAsync(Key, Data);
+    bComplete = true;
+    return true;
+}
@@ -0,0 +1,210 @@
+// GrassInstancePacking.cpp
+// 草叶实例 16 字节压缩格式的 CPU 编解码 + 往返误差测试 (自动化测试 UnrealGrass.InstancePacking.RoundTrip)
+
+#include "GrassInstancePacking.h"
+#include "Math/Float16.h"
+#include "Math/RandomStream.h"
+
+static constexpr float GrassPositionXYMax = (float)((1u << FGrassInstancePacking::PositionXYBits) - 1);
+static constexpr float GrassPositionZMax = (float)((1u << FGrassInstancePacking::PositionZBits) - 1);
+
+static FORCEINLINE uint32 PackGrassUnorm8(float Value)
+{
+    return (uint32)(FMath::Clamp(Value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static FORCEINLINE float UnpackGrassUnorm8(uint32 Packed)
+{
+    return (float)(Packed & 0xFF) / 255.0f;
+}
+
+static FORCEINLINE uint32 PackGrassHalf(float Value)
+{
+    return FFloat16(Value).Encoded;
+}
+
+static FORCEINLINE float UnpackGrassHalf(uint32 Packed)
+{
+    FFloat16 Half;
+    Half.Encoded = (uint16)(Packed & 0xFFFF);
+    return Half.GetFloat();
+}
+
+// ============================================================================
+// 编解码 (与 GrassInstancePacking.ush 一致)
+// ============================================================================
+FUintVector4 FGrassInstancePacking::Pack(const FGrassInstance& Instance, const FGrassInstanceQuantization& Quantization)
+{
+    const FVector3f Normalized = ((Instance.Position - Quantization.Min) / Quantization.Size.ComponentMax(FVector3f(1e-4f)))
+        .BoundToBox(FVector3f::ZeroVector, FVector3f::OneVector);
+    const uint32 PosX = (uint32)(Normalized.X * GrassPositionXYMax + 0.5f);
+    const uint32 PosY = (uint32)(Normalized.Y * GrassPositionXYMax + 0.5f);
+    const uint32 PosZ = (uint32)(Normalized.Z * GrassPositionZMax + 0.5f);
+
+    // 朝向角 [0, 2π) 256 等分
+    const float Angle = FMath::Atan2(Instance.FacingDir.Y, Instance.FacingDir.X);
+    const float Turns = Angle / UE_TWO_PI + 1.0f;
+    const uint32 Facing = (uint32)((Turns - FMath::FloorToFloat(Turns)) * FacingSteps + 0.5f) & 0xFF;
+
+    FUintVector4 Packed;
+    Packed.X = PosX | (PosY << 20);
+    Packed.Y = (PosY >> 12) | (PosZ << 8) | (Facing << 24);
+    Packed.Z = PackGrassHalf(Instance.Height) | (PackGrassHalf(Instance.Width) << 16);
+    Packed.W = PackGrassUnorm8(Instance.Tilt)
+        | (PackGrassUnorm8(Instance.Bend) << 8)
+        | (PackGrassUnorm8(Instance.P1Offset) << 16)
+        | (PackGrassUnorm8(Instance.P2Offset) << 24);
+    return Packed;
+}
+
+FVector3f FGrassInstancePacking::UnpackPosition(const FUintVector4& Packed, const FGrassInstanceQuantization& Quantization)
+{
+    const uint32 PosX = Packed.X & 0xFFFFF;
+    const uint32 PosY = (Packed.X >> 20) | ((Packed.Y & 0xFF) << 12);
+    const uint32 PosZ = (Packed.Y >> 8) & 0xFFFF;
+    const FVector3f Normalized(
+        (float)PosX / GrassPositionXYMax,
+        (float)PosY / GrassPositionXYMax,
+        (float)PosZ / GrassPositionZMax);
+    return Quantization.Min + Normalized * Quantization.Size;
+}
+
+FGrassInstance FGrassInstancePacking::Unpack(const FUintVector4& Packed, const FGrassInstanceQuantization& Quantization)
+{
+    FGrassInstance Instance;
+    Instance.Position = UnpackPosition(Packed, Quantization);
+    Instance.Height = UnpackGrassHalf(Packed.Z);
+    Instance.Width = UnpackGrassHalf(Packed.Z >> 16);
+    Instance.Tilt = UnpackGrassUnorm8(Packed.W);
+    Instance.Bend = UnpackGrassUnorm8(Packed.W >> 8);
+    Instance.P1Offset = UnpackGrassUnorm8(Packed.W >> 16);
+    Instance.P2Offset = UnpackGrassUnorm8(Packed.W >> 24);
+
+    const float Angle = (float)(Packed.Y >> 24) * (UE_TWO_PI / FacingSteps);
+    Instance.FacingDir = FVector2f(FMath::Cos(Angle), FMath::Sin(Angle));
+    return Instance;
+}
+
+FVector3f FGrassInstancePacking::GetMaxPositionError(const FGrassInstanceQuantization& Quantization)
+{
+    return FVector3f(
+        Quantization.Size.X / GrassPositionXYMax,
+        Quantization.Size.Y / GrassPositionXYMax,
+        Quantization.Size.Z / GrassPositionZMax) * 0.5f;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 往返误差测试
+// 在几种典型的量化范围内随机生成实例，编码再解码，检查每个字段的最大误差不超过格式的理论上限，
+// 并且解码结果重新编码后与原编码完全一致 (磁盘缓存和紧凑拷贝不会累积误差)
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassInstancePackingRoundTripTest, "UnrealGrass.InstancePacking.RoundTrip",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassInstancePackingRoundTripTest::RunTest(const FString& Parameters)
+{
+    const int32 NumSamples = 100000;
+
+    struct FTestRange
+    {
+        const TCHAR* Name;
+        FBox3f Box;
+    };
+    const FTestRange Ranges[] = {
+        { TEXT("Grid 10m"),            FBox3f(FVector3f(-500.0f, -500.0f, -1.0f), FVector3f(500.0f, 500.0f, 1.0f)) },
+        { TEXT("Landscape 1km"),       FBox3f(FVector3f(-50000.0f, -50000.0f, -25600.0f), FVector3f(50000.0f, 50000.0f, 25600.0f)) },
+        { TEXT("Landscape 8km offset"), FBox3f(FVector3f(100000.0f, -400000.0f, -30000.0f), FVector3f(900000.0f, 400000.0f, 21200.0f)) },
+    };
+
+    // half 有 10 bit 尾数，舍入误差不超过 2^-11 的相对误差
+    const float HalfRelativeTolerance = 1.0f / 2048.0f;
+    const float Unorm8Tolerance = 0.5f / 255.0f + KINDA_SMALL_NUMBER;
+    const float FacingTolerance = UE_PI / FGrassInstancePacking::FacingSteps + KINDA_SMALL_NUMBER;
+
+    for (const FTestRange& Range : Ranges)
+    {
+        const FGrassInstanceQuantization Quantization = FGrassInstanceQuantization::FromBox(Range.Box);
+        // 浮点运算本身的误差 (Min + t * Size 在坐标很大时有几个 ulp)
+        const float FloatSlack = Range.Box.Min.GetAbsMax() + Range.Box.Max.GetAbsMax();
+        const FVector3f PositionTolerance = FGrassInstancePacking::GetMaxPositionError(Quantization)
+            + FVector3f(FloatSlack * 4.0f * FLT_EPSILON);
+
+        FRandomStream Random(1234);
+        FVector3f MaxPositionError = FVector3f::ZeroVector;
+        float MaxHeightError = 0.0f;
+        float MaxWidthError = 0.0f;
+        float MaxUnormError = 0.0f;
+        float MaxFacingError = 0.0f;
+        int32 NumReencodeMismatches = 0;
+
+        for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+        {
+            FGrassInstance Instance;
+            Instance.Position = FVector3f(
+                Random.FRandRange(Range.Box.Min.X, Range.Box.Max.X),
+                Random.FRandRange(Range.Box.Min.Y, Range.Box.Max.Y),
+                Random.FRandRange(Range.Box.Min.Z, Range.Box.Max.Z));
+            Instance.Height = Random.FRandRange(1.0f, 300.0f);
+            Instance.Width = Random.FRandRange(0.1f, 20.0f);
+            Instance.Tilt = Random.FRand();
+            Instance.Bend = Random.FRand();
+            const float Angle = Random.FRandRange(-UE_PI, UE_PI);
+            Instance.FacingDir = FVector2f(FMath::Cos(Angle), FMath::Sin(Angle));
+            Instance.P1Offset = Random.FRand() * 0.3f;
+            Instance.P2Offset = Random.FRand() * 0.5f;
+
+            const FUintVector4 Packed = FGrassInstancePacking::Pack(Instance, Quantization);
+            const FGrassInstance Decoded = FGrassInstancePacking::Unpack(Packed, Quantization);
+
+            MaxPositionError = MaxPositionError.ComponentMax((Decoded.Position - Instance.Position).GetAbs());
+            MaxHeightError = FMath::Max(MaxHeightError, FMath::Abs(Decoded.Height - Instance.Height) / Instance.Height);
+            MaxWidthError = FMath::Max(MaxWidthError, FMath::Abs(Decoded.Width - Instance.Width) / Instance.Width);
+            MaxUnormError = FMath::Max(MaxUnormError, FMath::Abs(Decoded.Tilt - Instance.Tilt));
+            MaxUnormError = FMath::Max(MaxUnormError, FMath::Abs(Decoded.Bend - Instance.Bend));
+            MaxUnormError = FMath::Max(MaxUnormError, FMath::Abs(Decoded.P1Offset - Instance.P1Offset));
+            MaxUnormError = FMath::Max(MaxUnormError, FMath::Abs(Decoded.P2Offset - Instance.P2Offset));
+
+            const float DecodedAngle = FMath::Atan2(Decoded.FacingDir.Y, Decoded.FacingDir.X);
+            MaxFacingError = FMath::Max(MaxFacingError, FMath::Abs(FMath::UnwindRadians(DecodedAngle - Angle)));
+
+            if (FGrassInstancePacking::Pack(Decoded, Quantization) != Packed)
+            {
+                ++NumReencodeMismatches;
+            }
+        }
+
+        const bool bPassed = MaxPositionError.X <= PositionTolerance.X
+            && MaxPositionError.Y <= PositionTolerance.Y
+            && MaxPositionError.Z <= PositionTolerance.Z
+            && MaxHeightError <= HalfRelativeTolerance
+            && MaxWidthError <= HalfRelativeTolerance
+            && MaxUnormError <= Unorm8Tolerance
+            && MaxFacingError <= FacingTolerance
+            && NumReencodeMismatches == 0;
+
+        const FString Summary = FString::Printf(TEXT("Grass instance packing [%s] %s: Position error (%.4f, %.4f, %.4f) cm (limit %.4f, %.4f, %.4f), Height %.5f, Width %.5f (limit %.5f relative), Unorm8 %.5f (limit %.5f), Facing %.3f deg (limit %.3f), Re-encode mismatches %d/%d"),
+            Range.Name, bPassed ? TEXT("PASSED") : TEXT("FAILED"),
+            MaxPositionError.X, MaxPositionError.Y, MaxPositionError.Z,
+            PositionTolerance.X, PositionTolerance.Y, PositionTolerance.Z,
+            MaxHeightError, MaxWidthError, HalfRelativeTolerance,
+            MaxUnormError, Unorm8Tolerance,
+            FMath::RadiansToDegrees(MaxFacingError), FMath::RadiansToDegrees(FacingTolerance),
+            NumReencodeMismatches, NumSamples);
+        if (bPassed)
+        {
+            AddInfo(Summary);
+        }
+        else
+        {
+            AddError(Summary);
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
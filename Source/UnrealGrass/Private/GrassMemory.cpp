@@ -0,0 +1,238 @@
+// GrassMemory.cpp
+// 草地 GPU 内存统计实现 + grass.MemReport + 测试 (自动化测试 UnrealGrass.MemoryAccounting，不需要 RHI)
+
+#include "GrassMemory.h"
+#include "GrassStats.h"
+#include "GrassComponent.h"
+#include "GrassBufferArena.h"
+#include "RenderingThread.h"
+#include "UObject/UObjectIterator.h"
+#include "HAL/IConsoleManager.h"
+
+LLM_DEFINE_TAG(Grass);
+LLM_DEFINE_TAG(Grass_Instances, TEXT("Instances"), TEXT("Grass"));
+LLM_DEFINE_TAG(Grass_VisibleBuffers, TEXT("VisibleBuffers"), TEXT("Grass"));
+LLM_DEFINE_TAG(Grass_IndirectArgs, TEXT("IndirectArgs"), TEXT("Grass"));
+LLM_DEFINE_TAG(Grass_CullTiles, TEXT("CullTiles"), TEXT("Grass"));
+LLM_DEFINE_TAG(Grass_Clumps, TEXT("Clumps"), TEXT("Grass"));
+LLM_DEFINE_TAG(Grass_HiZ, TEXT("HiZ"), TEXT("Grass"));
+
+DEFINE_STAT(STAT_GrassInstanceBufferMemory);
+DEFINE_STAT(STAT_GrassVisibleBufferMemory);
+DEFINE_STAT(STAT_GrassIndirectArgsMemory);
+DEFINE_STAT(STAT_GrassCullTileMemory);
+DEFINE_STAT(STAT_GrassClumpMemory);
+DEFINE_STAT(STAT_GrassBufferArenaMemory);
+DEFINE_STAT(STAT_GrassHiZMemory);
+DEFINE_STAT(STAT_GrassViewCullingMemory);
+DEFINE_STAT(STAT_GrassShadowCullingMemory);
+
+uint64 FGrassMemoryFootprint::ComputeClumpBytes(int32 NumClumps, int32 ClumpGridDim, int32 VoronoiTextureSize, int32 NumClumpTypes)
+{
+    const uint64 NumCells = (uint64)ClumpGridDim * ClumpGridDim;
+
+    uint64 Bytes = 0;
+    Bytes += (uint64)NumClumps * sizeof(FVector4f) * 2;                 // ClumpData0 + ClumpData1
+    Bytes += (NumCells + 1) * sizeof(uint32);                           // 网格单元格起始偏移 (计数 Buffer 是临时的)
+    Bytes += (uint64)NumClumps * sizeof(uint32);                        // 按单元格排序的 Clump 索引
+    Bytes += (uint64)VoronoiTextureSize * VoronoiTextureSize * sizeof(FVector4f);   // Voronoi 查找纹理 (RGBA32F)
+    Bytes += (uint64)NumClumpTypes * 3 * sizeof(FVector4f);             // ClumpType 参数
+    return Bytes;
+}
+
+void FGrassMemoryFootprint::UpdateStats(const FGrassMemoryFootprint& Old, const FGrassMemoryFootprint& New)
+{
+    // 先加后减，计数器不会短暂变成负数
+    INC_MEMORY_STAT_BY(STAT_GrassInstanceBufferMemory, New.InstanceBytes);
+    INC_MEMORY_STAT_BY(STAT_GrassVisibleBufferMemory, New.VisibleBytes);
+    INC_MEMORY_STAT_BY(STAT_GrassIndirectArgsMemory, New.IndirectArgsBytes);
+    INC_MEMORY_STAT_BY(STAT_GrassCullTileMemory, New.CullTileBytes);
+    INC_MEMORY_STAT_BY(STAT_GrassClumpMemory, New.ClumpBytes);
+    DEC_MEMORY_STAT_BY(STAT_GrassInstanceBufferMemory, Old.InstanceBytes);
+    DEC_MEMORY_STAT_BY(STAT_GrassVisibleBufferMemory, Old.VisibleBytes);
+    DEC_MEMORY_STAT_BY(STAT_GrassIndirectArgsMemory, Old.IndirectArgsBytes);
+    DEC_MEMORY_STAT_BY(STAT_GrassCullTileMemory, Old.CullTileBytes);
+    DEC_MEMORY_STAT_BY(STAT_GrassClumpMemory, Old.ClumpBytes);
+}
+
+// ============================================================================
+// grass.MemReport：每个组件的 Buffer 大小、实例数量、每实例字节数和总计
+// ============================================================================
+static double ToKB(uint64 Bytes)
+{
+    return Bytes / 1024.0;
+}
+
+static void RunGrassMemReport()
+{
+    check(IsInGameThread());
+
+    UE_LOG(LogTemp, Display, TEXT("Grass memory report (KB):"));
+    UE_LOG(LogTemp, Display, TEXT("  %-60s %10s %10s %10s %8s %8s %10s %10s %8s"),
+        TEXT("Component"), TEXT("Instances"), TEXT("Instance"), TEXT("Visible"), TEXT("Args"), TEXT("Tiles"), TEXT("Clumps"), TEXT("Total"), TEXT("B/Inst"));
+
+    FGrassMemoryFootprint Total;
+    int64 TotalInstances = 0;
+    int32 NumComponents = 0;
+    int32 NumEvicted = 0;
+
+    for (TObjectIterator<UGrassComponent> It; It; ++It)
+    {
+        const UGrassComponent* Component = *It;
+        if (!Component->IsRegistered() || Component->IsTemplate())
+        {
+            continue;
+        }
+
+        const FGrassMemoryFootprint Footprint = Component->GetGpuMemoryFootprint();
+        const int32 NumInstances = Component->IsInstanceDataEvicted() ? 0 : Component->InstanceCount;
+        UE_LOG(LogTemp, Display, TEXT("  %-60s %10d %10.1f %10.1f %8.2f %8.1f %10.1f %10.1f %8.1f%s"),
+            *Component->GetPathName(),
+            NumInstances,
+            ToKB(Footprint.InstanceBytes),
+            ToKB(Footprint.VisibleBytes),
+            ToKB(Footprint.IndirectArgsBytes),
+            ToKB(Footprint.CullTileBytes),
+            ToKB(Footprint.ClumpBytes),
+            ToKB(Footprint.GetTotalBytes()),
+            NumInstances > 0 ? (double)Footprint.GetInstanceDataBytes() / NumInstances : 0.0,
+            Component->IsInstanceDataEvicted() ? TEXT(" (evicted)") : TEXT(""));
+
+        Total += Footprint;
+        TotalInstances += NumInstances;
+        ++NumComponents;
+        NumEvicted += Component->IsInstanceDataEvicted() ? 1 : 0;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("  %-60s %10lld %10.1f %10.1f %8.2f %8.1f %10.1f %10.1f %8.1f"),
+        *FString::Printf(TEXT("Total (%d components, %d evicted)"), NumComponents, NumEvicted),
+        TotalInstances,
+        ToKB(Total.InstanceBytes),
+        ToKB(Total.VisibleBytes),
+        ToKB(Total.IndirectArgsBytes),
+        ToKB(Total.CullTileBytes),
+        ToKB(Total.ClumpBytes),
+        ToKB(Total.GetTotalBytes()),
+        TotalInstances > 0 ? (double)Total.GetInstanceDataBytes() / TotalInstances : 0.0);
+
+    // Buffer 池页的状态只能在渲染线程读取；已用和容量之差是页中的空闲区间
+    ENQUEUE_RENDER_COMMAND(GrassMemReportArena)(
+        [](FRHICommandListImmediate&)
+        {
+            static const TCHAR* PoolNames[] = { TEXT("Instances"), TEXT("VisibleIndices"), TEXT("VisibleInstances") };
+            static_assert(UE_ARRAY_COUNT(PoolNames) == (int32)EGrassBufferPool::Num, "PoolNames must match EGrassBufferPool");
+
+            for (int32 Pool = 0; Pool < (int32)EGrassBufferPool::Num; ++Pool)
+            {
+                const FGrassBufferArena::FStats Stats = FGrassBufferArena::Get().GetStats((EGrassBufferPool)Pool);
+                UE_LOG(LogTemp, Display, TEXT("  Arena %-16s %3d page(s), %5d allocation(s), %10.1f / %10.1f KB used, largest free %10.1f KB"),
+                    PoolNames[Pool], Stats.NumPages, Stats.NumAllocations, ToKB(Stats.UsedBytes), ToKB(Stats.CapacityBytes), ToKB(Stats.LargestFreeBytes));
+            }
+        });
+}
+
+static FAutoConsoleCommand GGrassMemReportCommand(
+    TEXT("grass.MemReport"),
+    TEXT("List the GPU memory of every registered grass component (instance, visible, indirect args, cull tile and clump buffers), bytes per instance, totals and buffer arena usage"),
+    FConsoleCommandDelegate::CreateStatic(&RunGrassMemReport)
+);
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 测试：用不占用 GPU 内存的区间 (没有页) 搭出一次生成的 Buffer 布局，检查统计出的大小与按格式手算的结果一致
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassMemoryAccountingTest, "UnrealGrass.MemoryAccounting",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassMemoryAccountingTest::RunTest(const FString& Parameters)
+{
+    const int32 GridSize = 256;
+    const uint64 NumInstances = (uint64)GridSize * GridSize;
+
+    auto MakeRange = [](uint64 Count)
+    {
+        FGrassBufferAllocationRef Allocation = MakeShared<FGrassBufferAllocation, ESPMode::ThreadSafe>();
+        Allocation->Count = (uint32)Count;
+        return Allocation;
+    };
+
+    // ======== 生成 + 剔除 (索引列表)：16 字节实例 + 两个 LOD 各 4 字节索引 ========
+    {
+        FGrassInstanceBuffers Buffers;
+        Buffers.InstanceCount = (int32)NumInstances;
+        Buffers.bVisibleIndexLists = true;
+        Buffers.InstanceAllocation = MakeRange(NumInstances);
+        Buffers.VisibleInstanceAllocation = MakeRange(NumInstances);
+        Buffers.VisibleInstanceLOD1Allocation = MakeRange(NumInstances);
+
+        const FGrassMemoryFootprint Footprint = Buffers.GetMemoryFootprint();
+        TestEqual(TEXT("instance bytes are 16 per instance"), (uint64)Footprint.InstanceBytes, (uint64)(NumInstances * 16));
+        TestEqual(TEXT("visible index lists are 4 bytes per instance per LOD"), (uint64)Footprint.VisibleBytes, (uint64)(NumInstances * 4 * 2));
+        TestEqual(TEXT("index lists cost 24 bytes per instance"), (uint64)(Footprint.GetInstanceDataBytes() / NumInstances), (uint64)24);
+        TestEqual(TEXT("resident bytes match the footprint"), (uint64)Buffers.GetResidentBytes(), (uint64)Footprint.GetInstanceDataBytes());
+    }
+
+    // ======== 生成 + 剔除 (完整拷贝，r.Grass.Culling.VisibleIndexLists=0) ========
+    {
+        FGrassInstanceBuffers Buffers;
+        Buffers.InstanceCount = (int32)NumInstances;
+        Buffers.bVisibleIndexLists = false;
+        Buffers.InstanceAllocation = MakeRange(NumInstances);
+        Buffers.VisibleInstanceAllocation = MakeRange(NumInstances);
+        Buffers.VisibleInstanceLOD1Allocation = MakeRange(NumInstances);
+
+        const FGrassMemoryFootprint Footprint = Buffers.GetMemoryFootprint();
+        TestEqual(TEXT("visible copies are 16 bytes per instance per LOD"), (uint64)Footprint.VisibleBytes, (uint64)(NumInstances * 16 * 2));
+        TestEqual(TEXT("visible copies cost 48 bytes per instance"), (uint64)(Footprint.GetInstanceDataBytes() / NumInstances), (uint64)48);
+    }
+
+    // ======== 没有剔除：只有实例 ========
+    {
+        FGrassInstanceBuffers Buffers;
+        Buffers.InstanceCount = (int32)NumInstances;
+        Buffers.InstanceAllocation = MakeRange(NumInstances);
+
+        const FGrassMemoryFootprint Footprint = Buffers.GetMemoryFootprint();
+        TestEqual(TEXT("without culling only the instances are resident"), (uint64)Footprint.GetInstanceDataBytes(), (uint64)(NumInstances * 16));
+        TestEqual(TEXT("no indirect args without indirect draw"), (uint64)Footprint.IndirectArgsBytes, (uint64)0);
+        TestEqual(TEXT("no cull tiles without culling"), (uint64)Footprint.CullTileBytes, (uint64)0);
+    }
+
+    // ======== 剔除块：每 64 个实例 32 字节包围盒 + 4 字节存活块索引 + 8 字节可见计数 + 8 字节可见位，加 16 字节 Dispatch 参数 ========
+    {
+        FGrassInstanceBuffers Buffers;
+        Buffers.InstanceCount = (int32)NumInstances;
+        Buffers.NumCullTiles = FGrassInstanceBuffers::GetNumCullTiles((int32)NumInstances);
+
+        TestEqual(TEXT("one cull tile per 64 instances"), (uint64)Buffers.NumCullTiles, (uint64)((NumInstances + 63) / 64));
+        TestEqual(TEXT("cull tiles are only counted once the buffer exists"), (uint64)(Buffers.GetMemoryFootprint().CullTileBytes), (uint64)0);
+        TestEqual(TEXT("a partial last tile gets its own cull tile"), (uint64)(FGrassInstanceBuffers::GetNumCullTiles(65)), (uint64)2);
+    }
+
+    // ======== Clump 资源 (50 个 Clump，8x8 网格，1 种类型) ========
+    TestEqual(TEXT("clump data, grid and type params"), (uint64)(FGrassMemoryFootprint::ComputeClumpBytes(50, 8, 0, 1)), (uint64)(50 * 32 + 65 * 4 + 50 * 4 + 48));
+    TestEqual(TEXT("Voronoi texture is RGBA32F"),
+        (uint64)(FGrassMemoryFootprint::ComputeClumpBytes(50, 8, 1024, 1) - FGrassMemoryFootprint::ComputeClumpBytes(50, 8, 0, 1)), (uint64)(1024 * 1024 * 16));
+
+    // ======== 汇总 ========
+    {
+        FGrassMemoryFootprint A;
+        A.InstanceBytes = 1;
+        A.VisibleBytes = 2;
+        A.IndirectArgsBytes = 4;
+        A.ClumpBytes = 8;
+        A.CullTileBytes = 16;
+        FGrassMemoryFootprint Sum;
+        Sum += A;
+        Sum += A;
+        TestEqual(TEXT("footprints accumulate per category"), (uint64)Sum.GetTotalBytes(), (uint64)62);
+        TestEqual(TEXT("clump data is not counted as instance data"), (uint64)Sum.GetInstanceDataBytes(), (uint64)46);
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
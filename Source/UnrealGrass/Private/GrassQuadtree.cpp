@@ -0,0 +1,453 @@
+// GrassQuadtree.cpp
+// 剔除块 CPU 四叉树实现 + 包围盒回读 + 测试 (自动化测试 UnrealGrass.Quadtree) + 基准测试 (grass.BenchmarkQuadtree，都不需要 RHI)
+
+#include "GrassQuadtree.h"
+#include "RHIGPUReadback.h"
+#include "HAL/IConsoleManager.h"
+
+// ============================================================================
+// 构建
+// ============================================================================
+void FGrassQuadtree::Reset()
+{
+    Nodes.Reset();
+    NumTiles = 0;
+    TileSize = 0;
+    NumInstances = 0;
+}
+
+void FGrassQuadtree::Build(TConstArrayView<FGrassQuadtreeTile> Tiles, int32 InTileSize)
+{
+    Reset();
+    if (Tiles.Num() == 0 || InTileSize <= 0)
+    {
+        return;
+    }
+
+    NumTiles = Tiles.Num();
+    TileSize = InTileSize;
+
+    // 叶子 + 所有上层节点不超过 NumTiles * 4 / 3 + 层数
+    Nodes.Reserve(NumTiles + NumTiles / (Fanout - 1) + 32);
+
+    for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+    {
+        const FGrassQuadtreeTile& Tile = Tiles[TileIndex];
+        FNode& Leaf = Nodes.AddDefaulted_GetRef();
+        Leaf.Center = (Tile.BoundsMin + Tile.BoundsMax) * 0.5f;
+        Leaf.Extent = ((Tile.BoundsMax - Tile.BoundsMin) * 0.5f).ComponentMax(FVector3f::ZeroVector);
+        Leaf.FirstTile = (uint32)TileIndex;
+        Leaf.NumTiles = 1;
+        NumInstances += Tile.NumInstances;
+    }
+
+    // 每 Fanout 个相邻节点合并为一个父节点，直到只剩根节点
+    int32 LevelStart = 0;
+    int32 LevelCount = NumTiles;
+    while (LevelCount > 1)
+    {
+        const int32 NextLevelStart = Nodes.Num();
+        for (int32 First = 0; First < LevelCount; First += Fanout)
+        {
+            const int32 NumChildren = FMath::Min(Fanout, LevelCount - First);
+
+            FVector3f BoundsMin(MAX_flt);
+            FVector3f BoundsMax(-MAX_flt);
+            uint32 ChildTiles = 0;
+            for (int32 Child = 0; Child < NumChildren; ++Child)
+            {
+                const FNode& ChildNode = Nodes[LevelStart + First + Child];
+                BoundsMin = BoundsMin.ComponentMin(ChildNode.Center - ChildNode.Extent);
+                BoundsMax = BoundsMax.ComponentMax(ChildNode.Center + ChildNode.Extent);
+                ChildTiles += ChildNode.NumTiles;
+            }
+
+            FNode Parent;
+            Parent.Center = (BoundsMin + BoundsMax) * 0.5f;
+            Parent.Extent = (BoundsMax - BoundsMin) * 0.5f;
+            Parent.FirstTile = Nodes[LevelStart + First].FirstTile;
+            Parent.NumTiles = ChildTiles;
+            Parent.FirstChild = LevelStart + First;
+            Parent.NumChildren = NumChildren;
+            Nodes.Add(Parent);
+        }
+        LevelStart = NextLevelStart;
+        LevelCount = Nodes.Num() - NextLevelStart;
+    }
+}
+
+// ============================================================================
+// 查询
+// ============================================================================
+void FGrassQuadtree::Query(const FGrassFrustum& Frustum, const FVector3f& ViewOrigin, float MaxDistance, float BoundsExpand, int32 MaxRanges,
+    TArray<FGrassInstanceRange>& OutRanges, FQueryStats* OutStats) const
+{
+    OutRanges.Reset();
+    if (!IsValid())
+    {
+        return;
+    }
+
+    const bool bDistanceCulling = MaxDistance > 0.0f;
+    const float MaxDistanceSq = FMath::Square(MaxDistance);
+    const FVector3f Expand(FMath::Max(BoundsExpand, 0.0f));
+
+    FQueryStats Stats;
+
+    // 接受的块按深度优先顺序到达，起点递增，与上一段相接时直接延长
+    uint32 RangeFirstTile = 0;
+    uint32 RangeEndTile = 0;
+    auto AcceptTiles = [&](uint32 FirstTile, uint32 Count)
+    {
+        if (RangeEndTile > RangeFirstTile && FirstTile == RangeEndTile)
+        {
+            RangeEndTile += Count;
+            return;
+        }
+        if (RangeEndTile > RangeFirstTile)
+        {
+            const uint32 First = RangeFirstTile * TileSize;
+            OutRanges.Add({ First, FMath::Min((RangeEndTile - RangeFirstTile) * TileSize, NumInstances - First) });
+        }
+        RangeFirstTile = FirstTile;
+        RangeEndTile = FirstTile + Count;
+    };
+
+    // 子节点逆序入栈，出栈顺序就是实例顺序
+    TArray<int32, TInlineAllocator<64>> Stack;
+    Stack.Add(Nodes.Num() - 1);
+    while (Stack.Num() > 0)
+    {
+        const FNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+        ++Stats.NodesTested;
+
+        const FVector3f Extent = Node.Extent + Expand;
+
+        bool bFullyInRange = true;
+        if (bDistanceCulling)
+        {
+            const FVector3f Delta = (ViewOrigin - Node.Center).GetAbs();
+            const FVector3f Closest = (Delta - Extent).ComponentMax(FVector3f::ZeroVector);
+            if (Closest.SizeSquared() > MaxDistanceSq)
+            {
+                continue;
+            }
+            bFullyInRange = (Delta + Extent).SizeSquared() <= MaxDistanceSq;
+        }
+
+        const EGrassFrustumTest Test = Frustum.TestBox(Node.Center, Extent);
+        if (Test == EGrassFrustumTest::Outside)
+        {
+            continue;
+        }
+
+        if ((Test == EGrassFrustumTest::Inside && bFullyInRange) || Node.NumChildren == 0)
+        {
+            ++Stats.NodesAccepted;
+            AcceptTiles(Node.FirstTile, Node.NumTiles);
+            continue;
+        }
+
+        for (int32 Child = Node.NumChildren - 1; Child >= 0; --Child)
+        {
+            Stack.Add(Node.FirstChild + Child);
+        }
+    }
+    AcceptTiles(0, 0);
+
+    // 区间太多时合并间隔最小的相邻区间 (多剔除几个实例比多一次 Dispatch 便宜)
+    while (MaxRanges > 0 && OutRanges.Num() > MaxRanges)
+    {
+        int32 BestIndex = 0;
+        uint32 BestGap = MAX_uint32;
+        for (int32 i = 0; i + 1 < OutRanges.Num(); ++i)
+        {
+            const uint32 Gap = OutRanges[i + 1].FirstInstance - (OutRanges[i].FirstInstance + OutRanges[i].NumInstances);
+            if (Gap < BestGap)
+            {
+                BestGap = Gap;
+                BestIndex = i;
+            }
+        }
+        FGrassInstanceRange& Range = OutRanges[BestIndex];
+        const FGrassInstanceRange& Next = OutRanges[BestIndex + 1];
+        Range.NumInstances = Next.FirstInstance + Next.NumInstances - Range.FirstInstance;
+        OutRanges.RemoveAt(BestIndex + 1, 1, EAllowShrinking::No);
+    }
+
+    if (OutStats)
+    {
+        *OutStats = Stats;
+    }
+}
+
+// ============================================================================
+// FGrassCullTileHierarchy：剔除块包围盒回读
+// ============================================================================
+FGrassCullTileHierarchy::FGrassCullTileHierarchy() = default;
+
+FGrassCullTileHierarchy::~FGrassCullTileHierarchy() = default;
+
+void FGrassCullTileHierarchy::EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, FRHIBuffer* CullTileBuffer, int32 InNumTiles, int32 InTileSize)
+{
+    NumTiles = InNumTiles;
+    TileSize = InTileSize;
+    Quadtree.Reset();
+
+    // 剔除块 Buffer 是独立的 (不在 Buffer 池页中)，可以直接从开头回读
+    const uint32 NumBytes = NumTiles * sizeof(FGrassQuadtreeTile);
+    Readback = MakeUnique<FRHIGPUBufferReadback>(TEXT("GrassCullTileReadback"));
+    RHICmdList.Transition(FRHITransitionInfo(CullTileBuffer, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
+    Readback->EnqueueCopy(RHICmdList, CullTileBuffer, NumBytes);
+    RHICmdList.Transition(FRHITransitionInfo(CullTileBuffer, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
+}
+
+bool FGrassCullTileHierarchy::Poll_RenderThread()
+{
+    check(IsInRenderingThread());
+
+    if (Quadtree.IsValid())
+    {
+        return true;
+    }
+    if (!Readback.IsValid() || !Readback->IsReady())
+    {
+        return false;
+    }
+
+    const uint32 NumBytes = NumTiles * sizeof(FGrassQuadtreeTile);
+    const FGrassQuadtreeTile* Tiles = static_cast<const FGrassQuadtreeTile*>(Readback->Lock(NumBytes));
+    if (Tiles)
+    {
+        Quadtree.Build(MakeArrayView(Tiles, NumTiles), TileSize);
+    }
+    Readback->Unlock();
+    Readback.Reset();
+    return Quadtree.IsValid();
+}
+
+#if WITH_DEV_AUTOMATION_TESTS || !UE_BUILD_SHIPPING
+
+// ============================================================================
+// 测试公用：随机地形上按行排列的草地块 (与 GPU 生成的行优先顺序相同)
+// ============================================================================
+static void BuildTestTiles(int32 GridTiles, float TileWorldSize, int32 TileSize, FRandomStream& Random, TArray<FGrassQuadtreeTile>& OutTiles)
+{
+    OutTiles.SetNum(GridTiles * GridTiles);
+    for (int32 Y = 0; Y < GridTiles; ++Y)
+    {
+        for (int32 X = 0; X < GridTiles; ++X)
+        {
+            FGrassQuadtreeTile& Tile = OutTiles[Y * GridTiles + X];
+            const float Height = Random.FRandRange(-200.0f, 200.0f);
+            Tile.BoundsMin = FVector3f(X * TileWorldSize, Y * TileWorldSize, Height);
+            Tile.BoundsMax = FVector3f((X + 1) * TileWorldSize, (Y + 1) * TileWorldSize, Height + Random.FRandRange(20.0f, 80.0f));
+            Tile.NumInstances = TileSize;
+        }
+    }
+}
+
+static FGrassFrustum MakeTestFrustum(const FVector& Origin, const FRotator& Rotation, float FOVDegrees)
+{
+    const FMatrix ViewMatrix = FInverseRotationMatrix(Rotation) * FMatrix(
+        FPlane(0, 0, 1, 0),
+        FPlane(1, 0, 0, 0),
+        FPlane(0, 1, 0, 0),
+        FPlane(0, 0, 0, 1));
+    const FMatrix ProjectionMatrix = FReversedZPerspectiveMatrix(FMath::DegreesToRadians(FOVDegrees * 0.5f), 16.0f, 9.0f, 10.0f);
+    return FGrassFrustum::FromViewProjection(FTranslationMatrix(-Origin) * ViewMatrix * ProjectionMatrix);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS || !UE_BUILD_SHIPPING
+
+#if !UE_BUILD_SHIPPING
+
+// ============================================================================
+// 基准测试：grass.BenchmarkQuadtree [GridTiles] [NumViews]
+// 输出四叉树查询的每微秒测试节点数、每次查询耗时，以及逐块 SIMD / 标量测试的对照
+// ============================================================================
+static void RunGrassQuadtreeBenchmark(const TArray<FString>& Args)
+{
+    const int32 GridTiles = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 256;
+    const int32 NumViews = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+    const int32 TileSize = 64;
+    const float TileWorldSize = 400.0f;
+
+    FRandomStream Random(5678);
+    TArray<FGrassQuadtreeTile> Tiles;
+    BuildTestTiles(GridTiles, TileWorldSize, TileSize, Random, Tiles);
+
+    const double BuildStart = FPlatformTime::Seconds();
+    FGrassQuadtree Quadtree;
+    Quadtree.Build(Tiles, TileSize);
+    const double BuildSeconds = FPlatformTime::Seconds() - BuildStart;
+
+    TArray<FGrassFrustum> Frustums;
+    TArray<FVector3f> Origins;
+    for (int32 ViewIndex = 0; ViewIndex < NumViews; ++ViewIndex)
+    {
+        const FVector Origin(Random.FRandRange(0.0f, GridTiles * TileWorldSize), Random.FRandRange(0.0f, GridTiles * TileWorldSize), Random.FRandRange(100.0f, 1000.0f));
+        Frustums.Add(MakeTestFrustum(Origin, FRotator(Random.FRandRange(-30.0f, 0.0f), Random.FRandRange(0.0f, 360.0f), 0.0f), 90.0f));
+        Origins.Add(FVector3f(Origin));
+    }
+
+    // 四叉树查询
+    TArray<FGrassInstanceRange> Ranges;
+    int64 NodesTested = 0;
+    int64 VisibleInstances = 0;
+    const double QueryStart = FPlatformTime::Seconds();
+    for (int32 ViewIndex = 0; ViewIndex < NumViews; ++ViewIndex)
+    {
+        FGrassQuadtree::FQueryStats Stats;
+        Quadtree.Query(Frustums[ViewIndex], Origins[ViewIndex], 20000.0f, 50.0f, 16, Ranges, &Stats);
+        NodesTested += Stats.NodesTested;
+        for (const FGrassInstanceRange& Range : Ranges)
+        {
+            VisibleInstances += Range.NumInstances;
+        }
+    }
+    const double QuerySeconds = FMath::Max(FPlatformTime::Seconds() - QueryStart, 1e-9);
+
+    // 逐块测试 (不使用层次)
+    auto RunFlat = [&](bool bUseSimd)
+    {
+        int64 NumVisible = 0;
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 ViewIndex = 0; ViewIndex < NumViews; ++ViewIndex)
+        {
+            const FGrassFrustum& Frustum = Frustums[ViewIndex];
+            for (const FGrassQuadtreeTile& Tile : Tiles)
+            {
+                const FVector3f Center = (Tile.BoundsMin + Tile.BoundsMax) * 0.5f;
+                const FVector3f Extent = (Tile.BoundsMax - Tile.BoundsMin) * 0.5f + FVector3f(50.0f);
+                const EGrassFrustumTest Test = bUseSimd ? Frustum.TestBox(Center, Extent) : Frustum.TestBoxScalar(Center, Extent);
+                NumVisible += Test != EGrassFrustumTest::Outside ? 1 : 0;
+            }
+        }
+        const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 1e-9);
+        UE_LOG(LogTemp, Display, TEXT("  Flat %s: %.2f us/view, %.1f tiles/us (%lld visible)"),
+            bUseSimd ? TEXT("SIMD  ") : TEXT("Scalar"), Seconds * 1e6 / NumViews, (double)Tiles.Num() * NumViews / (Seconds * 1e6), NumVisible);
+    };
+
+    UE_LOG(LogTemp, Display, TEXT("Grass quadtree benchmark: %d tiles (%d instances), %d nodes, built in %.2f ms, %d views"),
+        Tiles.Num(), Tiles.Num() * TileSize, Quadtree.GetNumNodes(), BuildSeconds * 1000.0, NumViews);
+    UE_LOG(LogTemp, Display, TEXT("  Quadtree: %.2f us/view, %.1f nodes tested/view, %.1f nodes/us, %.1f%% of instances dispatched"),
+        QuerySeconds * 1e6 / NumViews, (double)NodesTested / NumViews, NodesTested / (QuerySeconds * 1e6),
+        VisibleInstances * 100.0 / ((double)Tiles.Num() * TileSize * NumViews));
+    RunFlat(true);
+    RunFlat(false);
+}
+
+static FAutoConsoleCommand GGrassBenchmarkQuadtreeCommand(
+    TEXT("grass.BenchmarkQuadtree"),
+    TEXT("Benchmark the grass CPU quadtree pre-culling (nodes tested per microsecond) against flat per-tile SIMD / scalar tests. Usage: grass.BenchmarkQuadtree [GridTiles] [NumViews]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&RunGrassQuadtreeBenchmark)
+);
+
+#endif // !UE_BUILD_SHIPPING
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 测试：SIMD 与标量测试结果一致；四叉树查询的区间覆盖所有逐块测试可见的块
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassQuadtreeTest, "UnrealGrass.Quadtree",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassQuadtreeTest::RunTest(const FString& Parameters)
+{
+    const int32 NumViews = 256;
+
+    FRandomStream Random(1234);
+    const int32 TileSize = 64;
+    const int32 GridTiles = 96;
+    const float TileWorldSize = 400.0f;
+    const float BoundsExpand = 50.0f;
+    const float MaxDistance = 15000.0f;
+    TArray<FGrassQuadtreeTile> Tiles;
+    BuildTestTiles(GridTiles, TileWorldSize, TileSize, Random, Tiles);
+    // 最后一块不满
+    Tiles.Last().NumInstances = TileSize / 2;
+    const uint32 TotalInstances = (Tiles.Num() - 1) * TileSize + TileSize / 2;
+
+    FGrassQuadtree Quadtree;
+    Quadtree.Build(Tiles, TileSize);
+    TestTrue(TEXT("quadtree covers every tile and instance"), Quadtree.GetNumTiles() == Tiles.Num() && Quadtree.GetNumInstances() == TotalInstances);
+
+    // ======== 全部可见：一个覆盖所有实例的区间 ========
+    {
+        const FGrassFrustum Frustum = MakeTestFrustum(FVector(GridTiles * TileWorldSize * 0.5f, GridTiles * TileWorldSize * 0.5f, 100000.0f), FRotator(-90.0f, 0.0f, 0.0f), 90.0f);
+        TArray<FGrassInstanceRange> Ranges;
+        Quadtree.Query(Frustum, FVector3f(0.0f), 0.0f, BoundsExpand, 16, Ranges);
+        TestTrue(TEXT("a view looking down on the whole field returns a single full range"), Ranges.Num() == 1 && Ranges[0].FirstInstance == 0 && Ranges[0].NumInstances == TotalInstances);
+    }
+
+    // ======== 随机视图：SIMD 与标量一致，区间覆盖所有可见块，区间有序不重叠 ========
+    int32 NumSimdMismatches = 0;
+    int32 NumMissedTiles = 0;
+    int32 NumBadRanges = 0;
+    int64 TotalVisibleTiles = 0;
+    int64 TotalRangeTiles = 0;
+    for (int32 ViewIndex = 0; ViewIndex < NumViews; ++ViewIndex)
+    {
+        const FVector Origin(Random.FRandRange(-2000.0f, GridTiles * TileWorldSize + 2000.0f), Random.FRandRange(-2000.0f, GridTiles * TileWorldSize + 2000.0f), Random.FRandRange(100.0f, 3000.0f));
+        const FRotator Rotation(Random.FRandRange(-60.0f, 10.0f), Random.FRandRange(0.0f, 360.0f), 0.0f);
+        const FGrassFrustum Frustum = MakeTestFrustum(Origin, Rotation, Random.FRandRange(40.0f, 110.0f));
+        const int32 MaxRanges = ViewIndex % 2 ? 8 : 0;
+
+        TArray<FGrassInstanceRange> Ranges;
+        Quadtree.Query(Frustum, FVector3f(Origin), MaxDistance, BoundsExpand, MaxRanges, Ranges);
+
+        TBitArray<> Covered(false, Tiles.Num());
+        uint32 PrevEnd = 0;
+        for (int32 i = 0; i < Ranges.Num(); ++i)
+        {
+            const FGrassInstanceRange& Range = Ranges[i];
+            NumBadRanges += (Range.NumInstances == 0 || (i > 0 && Range.FirstInstance <= PrevEnd) || Range.FirstInstance + Range.NumInstances > TotalInstances) ? 1 : 0;
+            PrevEnd = Range.FirstInstance + Range.NumInstances;
+            for (uint32 Tile = Range.FirstInstance / TileSize; Tile < (uint32)FMath::DivideAndRoundUp(PrevEnd, (uint32)TileSize); ++Tile)
+            {
+                Covered[Tile] = true;
+                ++TotalRangeTiles;
+            }
+        }
+        NumBadRanges += (MaxRanges > 0 && Ranges.Num() > MaxRanges) ? 1 : 0;
+
+        for (int32 TileIndex = 0; TileIndex < Tiles.Num(); ++TileIndex)
+        {
+            const FGrassQuadtreeTile& Tile = Tiles[TileIndex];
+            const FVector3f Center = (Tile.BoundsMin + Tile.BoundsMax) * 0.5f;
+            const FVector3f Extent = (Tile.BoundsMax - Tile.BoundsMin) * 0.5f + FVector3f(BoundsExpand);
+            const EGrassFrustumTest Scalar = Frustum.TestBoxScalar(Center, Extent);
+            NumSimdMismatches += Frustum.TestBox(Center, Extent) != Scalar ? 1 : 0;
+            NumSimdMismatches += Frustum.IntersectsSphere(Center, Extent.Size()) != Frustum.IntersectsSphereScalar(Center, Extent.Size()) ? 1 : 0;
+
+            const FVector3f Closest = ((FVector3f(Origin) - Center).GetAbs() - Extent).ComponentMax(FVector3f::ZeroVector);
+            if (Scalar != EGrassFrustumTest::Outside && Closest.SizeSquared() <= FMath::Square(MaxDistance))
+            {
+                ++TotalVisibleTiles;
+                NumMissedTiles += Covered[TileIndex] ? 0 : 1;
+            }
+        }
+    }
+    TestTrue(TEXT("SIMD box / sphere tests match the scalar reference"), NumSimdMismatches == 0);
+    TestTrue(TEXT("query ranges cover every tile that passes the per-tile test"), NumMissedTiles == 0);
+    TestTrue(TEXT("query ranges are sorted, disjoint, non-empty, in bounds and within MaxRanges"), NumBadRanges == 0);
+
+    // ======== 空树 ========
+    {
+        FGrassQuadtree Empty;
+        Empty.Build(TConstArrayView<FGrassQuadtreeTile>(), TileSize);
+        TArray<FGrassInstanceRange> Ranges;
+        Empty.Query(MakeTestFrustum(FVector::ZeroVector, FRotator::ZeroRotator, 90.0f), FVector3f::ZeroVector, 0.0f, 0.0f, 0, Ranges);
+        TestTrue(TEXT("an empty quadtree returns no ranges"), !Empty.IsValid() && Ranges.Num() == 0);
+    }
+
+    AddInfo(FString::Printf(TEXT("%d views, %d tiles, ranges cover %.1f tiles per view for %.1f visible"),
+        NumViews, Tiles.Num(), (double)TotalRangeTiles / NumViews, (double)TotalVisibleTiles / NumViews));
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
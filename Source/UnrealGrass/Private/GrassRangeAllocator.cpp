@@ -0,0 +1,287 @@
+// GrassRangeAllocator.cpp
+// 一维区间分配器实现 + 测试 (自动化测试 UnrealGrass.RangeAllocator，不需要 RHI)
+
+#include "GrassRangeAllocator.h"
+#include "Algo/BinarySearch.h"
+#include "Math/RandomStream.h"
+
+void FGrassRangeAllocator::Reset(uint32 InCapacity)
+{
+    Capacity = InCapacity;
+    UsedSize = 0;
+    Allocations.Reset();
+    FreeRanges.Reset();
+    if (Capacity > 0)
+    {
+        FreeRanges.Add({ 0, Capacity });
+    }
+}
+
+uint32 FGrassRangeAllocator::Allocate(uint32 Size)
+{
+    if (Size == 0)
+    {
+        return InvalidOffset;
+    }
+
+    // Best-Fit：选择能容纳的最小空闲区间，尽量保留大的连续空间给大组件
+    int32 BestIndex = INDEX_NONE;
+    for (int32 i = 0; i < FreeRanges.Num(); ++i)
+    {
+        if (FreeRanges[i].Size >= Size && (BestIndex == INDEX_NONE || FreeRanges[i].Size < FreeRanges[BestIndex].Size))
+        {
+            BestIndex = i;
+            if (FreeRanges[i].Size == Size)
+            {
+                break;
+            }
+        }
+    }
+    if (BestIndex == INDEX_NONE)
+    {
+        return InvalidOffset;
+    }
+
+    FRange& Range = FreeRanges[BestIndex];
+    const uint32 Offset = Range.Offset;
+    if (Range.Size == Size)
+    {
+        FreeRanges.RemoveAt(BestIndex);
+    }
+    else
+    {
+        Range.Offset += Size;
+        Range.Size -= Size;
+    }
+
+    Allocations.Add(Offset, Size);
+    UsedSize += Size;
+    return Offset;
+}
+
+void FGrassRangeAllocator::Free(uint32 Offset)
+{
+    uint32 Size = 0;
+    if (!Allocations.RemoveAndCopyValue(Offset, Size))
+    {
+        checkf(false, TEXT("FGrassRangeAllocator::Free: offset %u was not allocated"), Offset);
+        return;
+    }
+    UsedSize -= Size;
+
+    // 插入位置：第一个 Offset 大于释放区间的空闲区间
+    const int32 Index = Algo::UpperBoundBy(FreeRanges, Offset, &FRange::Offset);
+    const bool bMergePrev = Index > 0 && FreeRanges[Index - 1].Offset + FreeRanges[Index - 1].Size == Offset;
+    const bool bMergeNext = Index < FreeRanges.Num() && Offset + Size == FreeRanges[Index].Offset;
+
+    if (bMergePrev && bMergeNext)
+    {
+        FreeRanges[Index - 1].Size += Size + FreeRanges[Index].Size;
+        FreeRanges.RemoveAt(Index);
+    }
+    else if (bMergePrev)
+    {
+        FreeRanges[Index - 1].Size += Size;
+    }
+    else if (bMergeNext)
+    {
+        FreeRanges[Index].Offset = Offset;
+        FreeRanges[Index].Size += Size;
+    }
+    else
+    {
+        FreeRanges.Insert({ Offset, Size }, Index);
+    }
+}
+
+uint32 FGrassRangeAllocator::GetAllocationSize(uint32 Offset) const
+{
+    const uint32* Size = Allocations.Find(Offset);
+    return Size ? *Size : 0;
+}
+
+uint32 FGrassRangeAllocator::GetLargestFreeRange() const
+{
+    uint32 Largest = 0;
+    for (const FRange& Range : FreeRanges)
+    {
+        Largest = FMath::Max(Largest, Range.Size);
+    }
+    return Largest;
+}
+
+bool FGrassRangeAllocator::Validate() const
+{
+    uint64 FreeTotal = 0;
+    for (int32 i = 0; i < FreeRanges.Num(); ++i)
+    {
+        const FRange& Range = FreeRanges[i];
+        if (Range.Size == 0 || (uint64)Range.Offset + Range.Size > Capacity)
+        {
+            return false;
+        }
+        // 有序且相邻区间之间至少隔着一个分配 (否则应该已经合并)
+        if (i > 0 && FreeRanges[i - 1].Offset + FreeRanges[i - 1].Size >= Range.Offset)
+        {
+            return false;
+        }
+        FreeTotal += Range.Size;
+    }
+
+    uint64 AllocatedTotal = 0;
+    for (const TPair<uint32, uint32>& Allocation : Allocations)
+    {
+        if (Allocation.Value == 0 || (uint64)Allocation.Key + Allocation.Value > Capacity)
+        {
+            return false;
+        }
+        // 分配不能与任何空闲区间重叠
+        const int32 Index = Algo::UpperBoundBy(FreeRanges, Allocation.Key, &FRange::Offset);
+        if (Index > 0 && FreeRanges[Index - 1].Offset + FreeRanges[Index - 1].Size > Allocation.Key)
+        {
+            return false;
+        }
+        if (Index < FreeRanges.Num() && Allocation.Key + Allocation.Value > FreeRanges[Index].Offset)
+        {
+            return false;
+        }
+        AllocatedTotal += Allocation.Value;
+    }
+
+    return AllocatedTotal == UsedSize && FreeTotal + AllocatedTotal == Capacity;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 测试：固定用例覆盖合并的各种情况，随机用例与逐元素占用表对照，检查分配不重叠、释放后能完全合并
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassRangeAllocatorTest, "UnrealGrass.RangeAllocator",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassRangeAllocatorTest::RunTest(const FString& Parameters)
+{
+    const int32 NumOperations = 20000;
+
+    // ======== 固定用例 ========
+    {
+        FGrassRangeAllocator Allocator(100);
+        const uint32 A = Allocator.Allocate(10);
+        const uint32 B = Allocator.Allocate(20);
+        const uint32 C = Allocator.Allocate(30);
+        TestTrue(TEXT("sequential allocations are packed from offset 0"), A == 0 && B == 10 && C == 30);
+        TestTrue(TEXT("allocation larger than the remaining space fails"), Allocator.Allocate(41) == FGrassRangeAllocator::InvalidOffset);
+        TestTrue(TEXT("zero sized allocation fails"), Allocator.Allocate(0) == FGrassRangeAllocator::InvalidOffset);
+
+        // 释放中间的区间后，正好大小的请求落进空洞
+        Allocator.Free(B);
+        TestTrue(TEXT("freeing a middle range leaves a hole"), Allocator.GetNumFreeRanges() == 2);
+        TestTrue(TEXT("exact fit reuses the hole"), Allocator.Allocate(20) == B);
+
+        // 向前合并 / 向后合并 / 两侧合并
+        Allocator.Free(C);
+        TestTrue(TEXT("freeing next to the tail merges forward"), Allocator.GetNumFreeRanges() == 1 && Allocator.GetLargestFreeRange() == 70);
+        Allocator.Free(A);
+        TestTrue(TEXT("freeing the head does not merge with the tail"), Allocator.GetNumFreeRanges() == 2);
+        Allocator.Free(B);
+        TestTrue(TEXT("freeing between two holes merges both sides"), Allocator.GetNumFreeRanges() == 1 && Allocator.GetLargestFreeRange() == 100 && Allocator.IsEmpty());
+        TestTrue(TEXT("allocator is consistent after merges"), Allocator.Validate());
+    }
+    {
+        // Best-Fit：小请求使用小空洞，大空洞留给大请求
+        FGrassRangeAllocator Allocator(100);
+        const uint32 A = Allocator.Allocate(10);
+        Allocator.Allocate(5);
+        const uint32 C = Allocator.Allocate(40);
+        Allocator.Allocate(5);
+        Allocator.Free(A);   // 空洞 [0, 10)
+        Allocator.Free(C);   // 空洞 [15, 55)
+        TestTrue(TEXT("best fit picks the smallest hole"), Allocator.Allocate(8) == 0);
+        TestTrue(TEXT("large hole is kept for the large request"), Allocator.Allocate(40) == 15);
+        TestTrue(TEXT("allocator is consistent after best fit"), Allocator.Validate());
+    }
+
+    // ======== 随机用例 (与占用表对照) ========
+    const uint32 Capacity = 4096;
+    FGrassRangeAllocator Allocator(Capacity);
+    TArray<uint8> Occupied;
+    Occupied.SetNumZeroed(Capacity);
+    TArray<uint32> Live;
+    FRandomStream Random(4321);
+    int32 NumAllocFailures = 0;
+    int32 NumOverlaps = 0;
+
+    for (int32 Op = 0; Op < NumOperations; ++Op)
+    {
+        const bool bAllocate = Live.Num() == 0 || Random.FRand() < 0.55f;
+        if (bAllocate)
+        {
+            // 大小分布偏向小区间，偶尔有大区间，模拟很多小组件和少数大组件
+            const uint32 Size = Random.FRand() < 0.9f ? (uint32)Random.RandRange(1, 64) : (uint32)Random.RandRange(256, 1024);
+            const uint32 Offset = Allocator.Allocate(Size);
+            if (Offset == FGrassRangeAllocator::InvalidOffset)
+            {
+                // 只有真的没有足够大的连续空闲区间时才允许失败
+                uint32 Run = 0;
+                uint32 LongestRun = 0;
+                for (uint32 i = 0; i < Capacity; ++i)
+                {
+                    Run = Occupied[i] ? 0 : Run + 1;
+                    LongestRun = FMath::Max(LongestRun, Run);
+                }
+                if (LongestRun >= Size)
+                {
+                    ++NumAllocFailures;
+                }
+                continue;
+            }
+            for (uint32 i = Offset; i < Offset + Size; ++i)
+            {
+                NumOverlaps += Occupied[i] ? 1 : 0;
+                Occupied[i] = 1;
+            }
+            Live.Add(Offset);
+        }
+        else
+        {
+            const int32 Index = Random.RandRange(0, Live.Num() - 1);
+            const uint32 Offset = Live[Index];
+            const uint32 Size = Allocator.GetAllocationSize(Offset);
+            for (uint32 i = Offset; i < Offset + Size; ++i)
+            {
+                Occupied[i] = 0;
+            }
+            Allocator.Free(Offset);
+            Live.RemoveAtSwap(Index);
+        }
+
+        if ((Op & 255) == 0 && !Allocator.Validate())
+        {
+            AddError(TEXT("allocator is inconsistent during random operations"));
+            break;
+        }
+    }
+
+    uint32 OccupiedCount = 0;
+    for (uint8 Value : Occupied)
+    {
+        OccupiedCount += Value;
+    }
+    TestTrue(TEXT("random allocations never overlap"), NumOverlaps == 0);
+    TestTrue(TEXT("random allocations only fail when no free range is large enough"), NumAllocFailures == 0);
+    TestTrue(TEXT("used size matches the occupancy table"), OccupiedCount == Allocator.GetUsedSize());
+
+    for (uint32 Offset : Live)
+    {
+        Allocator.Free(Offset);
+    }
+    TestTrue(TEXT("freeing everything merges back into a single range"),
+        Allocator.IsEmpty() && Allocator.GetNumFreeRanges() == 1 && Allocator.GetLargestFreeRange() == Capacity);
+    TestTrue(TEXT("allocator is consistent after freeing everything"), Allocator.Validate());
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
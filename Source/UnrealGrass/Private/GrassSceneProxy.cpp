@@ -4,6 +4,7 @@
 #include "GrassSceneProxy.h"
 #include "GrassComponent.h"
 #include "GrassCullingViewExtension.h"
+#include "GrassCullingGraph.h"
 #include "Materials/Material.h"
 #include "MaterialDomain.h"
 #include "SceneManagement.h"
@@ -15,6 +16,139 @@
 #include "RHICommandList.h"
 #include "RenderTargetPool.h"  // For GBlackTexture
 #include "Engine/Texture2D.h"
+#include "HAL/IConsoleManager.h"
+#include "GrassFrustum.h"
+#include "GrassStats.h"
+#include "ProfilingDebugging/RealtimeGPUProfiler.h"
+
+DEFINE_STAT(STAT_GrassQuadtreeDispatchedInstances);
+DEFINE_STAT(STAT_GrassQuadtreeSkippedInstances);
+DEFINE_STAT(STAT_GrassQuadtreeRanges);
+DEFINE_STAT(STAT_GrassQuadtreeQueryTime);
+DEFINE_STAT(STAT_GrassCullingReusedViews);
+DEFINE_STAT(STAT_GrassCullingFullViews);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingTiles(
+    TEXT("r.Grass.Culling.Tiles"),
+    1,
+    TEXT("Tile-hierarchical GPU culling: test 64-instance tile bounds against the frustum, distance and Hi-Z first, then cull only the instances of surviving tiles through an indirect dispatch (0 = test every instance)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingCpuQuadtree(
+    TEXT("r.Grass.Culling.CpuQuadtree"),
+    1,
+    TEXT("Pre-cull the cull tiles on the CPU with a 4-ary hierarchy of their bounds (read back once after generation) and only dispatch GPU culling over the surviving instance ranges (0 = always dispatch over every instance)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingCpuQuadtreeMaxRanges(
+    TEXT("r.Grass.Culling.CpuQuadtree.MaxRanges"),
+    8,
+    TEXT("Maximum number of instance ranges (one dispatch each) per component and view; closer ranges are merged beyond this."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingWaveOps(
+    TEXT("r.Grass.Culling.WaveOps"),
+    1,
+    TEXT("Compact the visible lists with wave intrinsics (one global atomic per wave and LOD) when the RHI supports them; 0 = group-shared compaction (one global atomic per thread group and LOD)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingStableOrder(
+    TEXT("r.Grass.Culling.StableOrder"),
+    -1,
+    TEXT("Order-stable visible lists (count, scan, scatter): -1 = per component (bStableVisibleOrder), 0 = force atomic append, 1 = force stable. Compare the cost with stat GPU (GrassCullingAtomic / GrassCullingStable)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingTwoPhaseOcclusion(
+    TEXT("r.Grass.Culling.TwoPhaseOcclusion"),
+    -1,
+    TEXT("Two-phase Hi-Z occlusion culling: draw the instances visible last frame first, rebuild the Hi-Z from the depth prepass and test the rest against it before the base pass. -1 = per component (bTwoPhaseOcclusion), 0 = force off (single pass against last frame's Hi-Z), 1 = force on."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingMaxViewSlots(
+    TEXT("r.Grass.Culling.MaxViewSlots"),
+    4,
+    TEXT("Per-view culling: maximum number of secondary views (split-screen, other viewports, scene captures) with their own visible lists per grass component. Views beyond this draw the primary view's culling output."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingCaptureBudget(
+    TEXT("r.Grass.Culling.CaptureBudget"),
+    1,
+    TEXT("Apply the component's capture budget (CaptureMaxDistanceScale / CaptureLOD0DistanceScale / CaptureDensity) to scene capture and reflection capture views. 0 = captures cull like any other view."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassShadows(
+    TEXT("r.Grass.Shadows"),
+    1,
+    TEXT("Grass shadow casting for components with bCastGrassShadows: every shadow view (each CSM cascade, other shadow-casting lights) culls the grass against its own cull volume, capped at ShadowMaxDistance and thinned to ShadowDensity, and draws the LOD 1 blade with its own indirect args. 0 = grass casts no shadows."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassShadowMaxCascades(
+    TEXT("r.Grass.Shadow.MaxCascades"),
+    4,
+    TEXT("Maximum number of shadow views (CSM cascades and other shadow-casting lights) per view family that get grass; each has its own visible list sized to the component's instance count. Shadow views beyond this do not draw grass."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingTemporalReuse(
+    TEXT("r.Grass.Culling.TemporalReuse"),
+    1,
+    TEXT("Skip culling a view when its view-projection (without TAA jitter), camera position, the component transform and the culling settings match the last full cull, and draw last frame's visible lists and indirect args again. With Hi-Z one more full cull runs after the camera stops. Counted in stat Grass (Culling Reused Views / Culling Full Views)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingTemporalReuseMaxFrames(
+    TEXT("r.Grass.Culling.TemporalReuse.MaxFrames"),
+    30,
+    TEXT("Run a full cull at least this often while a view is being reused, so that moving occluders are picked up by the Hi-Z test (0 = no limit)."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<float> CVarGrassCullingTemporalReuseMatrixTolerance(
+    TEXT("r.Grass.Culling.TemporalReuse.MatrixTolerance"),
+    1e-5f,
+    TEXT("Largest per-element difference of the view-projection and component transform matrices still treated as unchanged."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<float> CVarGrassCullingTemporalReusePositionTolerance(
+    TEXT("r.Grass.Culling.TemporalReuse.PositionTolerance"),
+    0.1f,
+    TEXT("Largest camera movement (cm) still treated as unchanged."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<int32> CVarGrassCullingAmortizeFrames(
+    TEXT("r.Grass.Culling.Amortize.Frames"),
+    0,
+    TEXT("Amortized occlusion culling for the primary view (single-pass Hi-Z): instances farther than r.Grass.Culling.Amortize.Distance repeat the Hi-Z test only every N frames (1/N of the cull tiles per frame) and keep their last result in the visibility bits in between. Frustum, distance and density tests still run every frame. 0 or 1 = off."),
+    ECVF_RenderThreadSafe
+);
+
+static TAutoConsoleVariable<float> CVarGrassCullingAmortizeDistance(
+    TEXT("r.Grass.Culling.Amortize.Distance"),
+    3000.0f,
+    TEXT("Distance (cm) beyond which the amortized occlusion culling applies."),
+    ECVF_RenderThreadSafe
+);
+
+DECLARE_GPU_STAT(GrassShadowCulling);
+DECLARE_GPU_STAT(GrassCullingAtomic);
+DECLARE_GPU_STAT(GrassCullingStable);
+
+/** 可见列表压缩是否使用 Wave 指令 (FWaveOpsDim) */
+static bool UseGrassCullingWaveOps()
+{
+    return GRHISupportsWaveOperations && CVarGrassCullingWaveOps.GetValueOnRenderThread() != 0;
+}
 
 // ============================================================================
 // GPU Frustum Culling Compute Shader (支持 LOD)
@@ -25,22 +159,29 @@ public:
     DECLARE_GLOBAL_SHADER(FGrassFrustumCullingCS);
     SHADER_USE_PARAMETER_STRUCT(FGrassFrustumCullingCS, FGlobalShader);
 
+    // 可见列表只保存实例索引 (uint)，否则拷贝完整的压缩实例 (uint4)
+    class FVisibleIndexListsDim : SHADER_PERMUTATION_BOOL("GRASS_VISIBLE_INDEX_LISTS");
+    // 可见列表压缩使用 Wave 指令，否则使用 groupshared 计数器
+    class FWaveOpsDim : SHADER_PERMUTATION_BOOL("GRASS_USE_WAVE_OPS");
+    // 可见列表压缩的 Pass (EGrassCompactionPass)：原子追加，或稳定顺序的计数 / 分散
+    class FCompactionPassDim : SHADER_PERMUTATION_INT("GRASS_COMPACTION_PASS", 3);
+    // 两阶段遮挡剔除的阶段 (EGrassOcclusionPhase)
+    class FOcclusionPhaseDim : SHADER_PERMUTATION_INT("GRASS_OCCLUSION_PHASE", 4);
+    using FPermutationDomain = TShaderPermutationDomain<FVisibleIndexListsDim, FWaveOpsDim, FCompactionPassDim, FOcclusionPhaseDim>;
+
     BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
-        SHADER_PARAMETER_SRV(StructuredBuffer<FVector3f>, InPositions)
-        SHADER_PARAMETER_SRV(StructuredBuffer<FVector4f>, InGrassData0)
-        SHADER_PARAMETER_SRV(StructuredBuffer<FVector4f>, InGrassData1)
-        SHADER_PARAMETER_SRV(StructuredBuffer<float>, InGrassData2)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector3f>, OutVisiblePositions)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector4f>, OutVisibleGrassData0)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector4f>, OutVisibleGrassData1)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<float>, OutVisibleGrassData2)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector3f>, OutVisiblePositionsLOD1)  // LOD 1 独立输出
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector4f>, OutVisibleGrassData0LOD1)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<FVector4f>, OutVisibleGrassData1LOD1)
-        SHADER_PARAMETER_UAV(RWStructuredBuffer<float>, OutVisibleGrassData2LOD1)
+        SHADER_PARAMETER_SRV(StructuredBuffer<FUintVector4>, InInstances)           // 16 字节压缩实例
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, OutVisibleInstances)         // uint 索引或 uint4 实例 (见 FVisibleIndexListsDim)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, OutVisibleInstancesLOD1)     // LOD 1 独立输出
+        SHADER_PARAMETER(uint32, InstanceBaseOffset)         // 各区间在 Buffer 池页中的起始元素
+        SHADER_PARAMETER(uint32, VisibleBaseOffset)
+        SHADER_PARAMETER(uint32, VisibleBaseOffsetLOD1)
+        SHADER_PARAMETER(FVector3f, QuantizationMin)         // 位置量化范围 (本地坐标)
+        SHADER_PARAMETER(FVector3f, QuantizationSize)
         SHADER_PARAMETER_UAV(RWBuffer<uint>, OutIndirectArgs)
         SHADER_PARAMETER_UAV(RWBuffer<uint>, OutIndirectArgsLOD1)  // LOD 1 的 Indirect Args
         SHADER_PARAMETER(uint32, TotalInstanceCount)
+        SHADER_PARAMETER(uint32, InstanceRangeStart)         // 本次 Dispatch 的第一个实例 (CPU 四叉树区间)
         SHADER_PARAMETER(uint32, IndexCountPerInstance)
         SHADER_PARAMETER(uint32, IndexCountPerInstanceLOD1)  // LOD 1 的索引数量
         SHADER_PARAMETER_ARRAY(FVector4f, FrustumPlanes, [6])
@@ -49,22 +190,65 @@ public:
         SHADER_PARAMETER(float, MaxVisibleDistance)
         SHADER_PARAMETER(float, LOD0Distance)  // LOD 切换距离
         SHADER_PARAMETER(FVector3f, CameraPosition)
+        SHADER_PARAMETER(float, DensityScale)  // 保留的实例比例 (次要视图的预算)
         // Hi-Z 遮挡剔除参数
         SHADER_PARAMETER_TEXTURE(Texture2D, HiZTexture)
         SHADER_PARAMETER_SAMPLER(SamplerState, HiZSampler)
         SHADER_PARAMETER(uint32, bEnableOcclusionCulling)
         SHADER_PARAMETER(FVector2f, HiZSize)
         SHADER_PARAMETER(FMatrix44f, ViewProjectionMatrix)
+        // 稳定顺序：每个块的可见数量 (计数 Pass 写入) / 输出起点 (分散 Pass 读取)，同一个 Buffer
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<FUintVector2>, OutTileVisibleCounts)
+        SHADER_PARAMETER_SRV(StructuredBuffer<FUintVector2>, InTileVisibleOffsets)
+        // 两阶段遮挡剔除：每个实例一位，记录上一帧是否绘制 (分摊的单 Pass：最近一次 Hi-Z 测试是否没有被遮挡)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, VisibilityBits)
+        // 分摊的单 Pass：远处实例的 Hi-Z 测试按剔除块轮换
+        SHADER_PARAMETER(uint32, AmortizeFrames)
+        SHADER_PARAMETER(uint32, AmortizeFrameIndex)
+        SHADER_PARAMETER(float, AmortizeDistance)
     END_SHADER_PARAMETER_STRUCT()
 
     static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
     {
+        FPermutationDomain PermutationVector(Parameters.PermutationId);
+        // Wave 指令只用于原子追加，计数 / 分散 Pass 使用 groupshared
+        if (PermutationVector.Get<FWaveOpsDim>() && (!RHISupportsWaveOperations(Parameters.Platform) || PermutationVector.Get<FCompactionPassDim>() != 0))
+        {
+            return false;
+        }
         return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
     }
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+        if (FPermutationDomain(Parameters.PermutationId).Get<FWaveOpsDim>())
+        {
+            OutEnvironment.CompilerFlags.Add(CFLAG_WaveOperations);
+        }
+    }
 };
 
 IMPLEMENT_GLOBAL_SHADER(FGrassFrustumCullingCS, "/Plugin/UnrealGrass/Private/GrassFrustumCulling.usf", "MainCS", SF_Compute);
 
+/** 与 GRASS_COMPACTION_PASS 对应 */
+enum class EGrassCompactionPass : int32
+{
+    Atomic = 0,     // 原子追加 (每个 Wave / 线程组一次全局原子操作)
+    Count = 1,      // 稳定顺序：统计每个块的可见数量
+    Scatter = 2,    // 稳定顺序：按块的输出起点写入
+};
+
+static TShaderMapRef<FGrassFrustumCullingCS> GetGrassFrustumCullingCS(const FGrassInstanceBuffers& Buffers, EGrassCompactionPass Pass, EGrassOcclusionPhase Phase)
+{
+    FGrassFrustumCullingCS::FPermutationDomain PermutationVector;
+    PermutationVector.Set<FGrassFrustumCullingCS::FVisibleIndexListsDim>(Buffers.bVisibleIndexLists);
+    PermutationVector.Set<FGrassFrustumCullingCS::FWaveOpsDim>(Pass == EGrassCompactionPass::Atomic && UseGrassCullingWaveOps());
+    PermutationVector.Set<FGrassFrustumCullingCS::FCompactionPassDim>((int32)Pass);
+    PermutationVector.Set<FGrassFrustumCullingCS::FOcclusionPhaseDim>((int32)Phase);
+    return TShaderMapRef<FGrassFrustumCullingCS>(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+}
+
 // 重置 Indirect Args 的 Compute Shader (支持 LOD)
 class FGrassResetIndirectArgsCS : public FGlobalShader
 {
@@ -88,6 +272,533 @@ public:
 
 IMPLEMENT_GLOBAL_SHADER(FGrassResetIndirectArgsCS, "/Plugin/UnrealGrass/Private/GrassFrustumCulling.usf", "ResetIndirectArgsCS", SF_Compute);
 
+// 实例化立体渲染：剔除之后把 Indirect Args 的实例数量乘以实例倍数 (每只眼睛绘制一次)
+class FGrassApplyInstanceFactorCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassApplyInstanceFactorCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassApplyInstanceFactorCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_UAV(RWBuffer<uint>, OutIndirectArgs)
+        SHADER_PARAMETER_UAV(RWBuffer<uint>, OutIndirectArgsLOD1)
+        SHADER_PARAMETER(uint32, InstanceFactor)
+        SHADER_PARAMETER(uint32, bScaleInstanceCountLOD1)  // LOD 1 有独立的 Indirect Args
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassApplyInstanceFactorCS, "/Plugin/UnrealGrass/Private/GrassFrustumCulling.usf", "ApplyInstanceFactorCS", SF_Compute);
+
+// ============================================================================
+// 分块层次剔除 Compute Shaders (r.Grass.Culling.Tiles)
+// ============================================================================
+// 剔除块测试：视锥 / 距离 / Hi-Z 参数与逐实例剔除相同，存活的块追加到 OutVisibleTiles
+class FGrassCullTilesCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassCullTilesCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassCullTilesCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_STRUCT_INCLUDE(FGrassFrustumCullingCS::FParameters, Culling)
+        SHADER_PARAMETER_SRV(StructuredBuffer<FGrassCullTile>, InCullTiles)
+        SHADER_PARAMETER(uint32, TileRangeStart)    // 本次 Dispatch 的剔除块区间 [TileRangeStart, TileRangeEnd)
+        SHADER_PARAMETER(uint32, TileRangeEnd)
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<uint>, OutVisibleTiles)
+        SHADER_PARAMETER_UAV(RWBuffer<uint>, OutTileDispatchArgs)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassCullTilesCS, "/Plugin/UnrealGrass/Private/GrassFrustumCulling.usf", "CullTilesCS", SF_Compute);
+
+// 存活块数量 -> 间接 Dispatch 参数
+class FGrassBuildTileDispatchArgsCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassBuildTileDispatchArgsCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassBuildTileDispatchArgsCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_UAV(RWBuffer<uint>, OutTileDispatchArgs)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassBuildTileDispatchArgsCS, "/Plugin/UnrealGrass/Private/GrassFrustumCulling.usf", "BuildTileDispatchArgsCS", SF_Compute);
+
+// 存活块中的逐实例剔除，输出与 FGrassFrustumCullingCS 完全相同
+class FGrassCullTileInstancesCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassCullTileInstancesCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassCullTileInstancesCS, FGlobalShader);
+
+    using FPermutationDomain = TShaderPermutationDomain<FGrassFrustumCullingCS::FVisibleIndexListsDim, FGrassFrustumCullingCS::FWaveOpsDim, FGrassFrustumCullingCS::FCompactionPassDim,
+        FGrassFrustumCullingCS::FOcclusionPhaseDim>;
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_STRUCT_INCLUDE(FGrassFrustumCullingCS::FParameters, Culling)
+        SHADER_PARAMETER_SRV(StructuredBuffer<uint>, InVisibleTiles)
+        SHADER_PARAMETER_SRV(Buffer<uint>, InTileDispatchArgs)
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        FPermutationDomain PermutationVector(Parameters.PermutationId);
+        if (PermutationVector.Get<FGrassFrustumCullingCS::FWaveOpsDim>()
+            && (!RHISupportsWaveOperations(Parameters.Platform) || PermutationVector.Get<FGrassFrustumCullingCS::FCompactionPassDim>() != 0))
+        {
+            return false;
+        }
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+
+    static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+    {
+        FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+        if (FPermutationDomain(Parameters.PermutationId).Get<FGrassFrustumCullingCS::FWaveOpsDim>())
+        {
+            OutEnvironment.CompilerFlags.Add(CFLAG_WaveOperations);
+        }
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassCullTileInstancesCS, "/Plugin/UnrealGrass/Private/GrassFrustumCulling.usf", "CullTileInstancesCS", SF_Compute);
+
+static TShaderMapRef<FGrassCullTileInstancesCS> GetGrassCullTileInstancesCS(const FGrassInstanceBuffers& Buffers, EGrassCompactionPass Pass, EGrassOcclusionPhase Phase)
+{
+    FGrassCullTileInstancesCS::FPermutationDomain PermutationVector;
+    PermutationVector.Set<FGrassFrustumCullingCS::FVisibleIndexListsDim>(Buffers.bVisibleIndexLists);
+    PermutationVector.Set<FGrassFrustumCullingCS::FWaveOpsDim>(Pass == EGrassCompactionPass::Atomic && UseGrassCullingWaveOps());
+    PermutationVector.Set<FGrassFrustumCullingCS::FCompactionPassDim>((int32)Pass);
+    PermutationVector.Set<FGrassFrustumCullingCS::FOcclusionPhaseDim>((int32)Phase);
+    return TShaderMapRef<FGrassCullTileInstancesCS>(GetGlobalShaderMap(GMaxRHIFeatureLevel), PermutationVector);
+}
+
+// ============================================================================
+// 稳定顺序剔除：每个块的可见数量 -> 输出起点 (单个线程组)
+// ============================================================================
+class FGrassScanTileVisibleCountsCS : public FGlobalShader
+{
+public:
+    DECLARE_GLOBAL_SHADER(FGrassScanTileVisibleCountsCS);
+    SHADER_USE_PARAMETER_STRUCT(FGrassScanTileVisibleCountsCS, FGlobalShader);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+        SHADER_PARAMETER_UAV(RWStructuredBuffer<FUintVector2>, OutTileVisibleCounts)
+        SHADER_PARAMETER_UAV(RWBuffer<uint>, OutIndirectArgs)
+        SHADER_PARAMETER_UAV(RWBuffer<uint>, OutIndirectArgsLOD1)
+        SHADER_PARAMETER(uint32, NumScanTiles)
+        SHADER_PARAMETER(uint32, bAppendToIndirectArgs)    // 两阶段遮挡剔除的后 Pass 从已有的可见数量开始
+    END_SHADER_PARAMETER_STRUCT()
+
+    static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+    {
+        return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+    }
+};
+
+IMPLEMENT_GLOBAL_SHADER(FGrassScanTileVisibleCountsCS, "/Plugin/UnrealGrass/Private/GrassFrustumCulling.usf", "ScanTileVisibleCountsCS", SF_Compute);
+
+/**
+ * CPU 四叉树预剔除：返回需要 GPU 剔除的实例区间 (按剔除块对齐)
+ * 四叉树不可用 (关闭、没有剔除块或回读还没完成) 时返回全部实例
+ */
+static void QueryGrassInstanceRanges(
+    const FGrassInstanceBuffers& Buffers,
+    const FGrassFrustum& Frustum,
+    const FMatrix& LocalToWorld,
+    const FGrassFrustumCullingCS::FParameters& CullingParams,
+    TArray<FGrassInstanceRange>& OutRanges)
+{
+    const uint32 TotalInstanceCount = CullingParams.TotalInstanceCount;
+    if (CVarGrassCullingCpuQuadtree.GetValueOnRenderThread() == 0
+        || !Buffers.CullTileHierarchy.IsValid()
+        || !Buffers.CullTileHierarchy->Poll_RenderThread()
+        || Buffers.CullTileHierarchy->GetQuadtree().GetNumInstances() != TotalInstanceCount)
+    {
+        OutRanges.Reset();
+        OutRanges.Add({ 0, TotalInstanceCount });
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_GrassQuadtreeQueryTime);
+
+    // 四叉树在组件本地空间：世界空间的剔除体 (视锥、立体并集或阴影级联) 变换到本地；距离按最小轴缩放换算 (非均匀缩放时偏保守)
+    const FGrassFrustum LocalFrustum = Frustum.TransformBy(LocalToWorld);
+    const FVector3f LocalViewOrigin = FVector3f(LocalToWorld.InverseTransformPosition(FVector(CullingParams.CameraPosition)));
+    const float MinScale = FMath::Max((float)LocalToWorld.GetScaleVector().GetMin(), UE_SMALL_NUMBER);
+
+    Buffers.CullTileHierarchy->GetQuadtree().Query(
+        LocalFrustum,
+        LocalViewOrigin,
+        CullingParams.MaxVisibleDistance / MinScale,
+        CullingParams.BoundingRadius / MinScale,
+        CVarGrassCullingCpuQuadtreeMaxRanges.GetValueOnRenderThread(),
+        OutRanges);
+
+    uint32 DispatchedInstances = 0;
+    for (const FGrassInstanceRange& Range : OutRanges)
+    {
+        DispatchedInstances += Range.NumInstances;
+    }
+    INC_DWORD_STAT_BY(STAT_GrassQuadtreeDispatchedInstances, DispatchedInstances);
+    INC_DWORD_STAT_BY(STAT_GrassQuadtreeSkippedInstances, TotalInstanceCount - DispatchedInstances);
+    INC_DWORD_STAT_BY(STAT_GrassQuadtreeRanges, OutRanges.Num());
+}
+
+/** 两阶段遮挡剔除是否启用 (r.Grass.Culling.TwoPhaseOcclusion 可以强制覆盖组件设置，需要遮挡剔除和可见位 Buffer) */
+static bool UseGrassTwoPhaseOcclusion(const FGrassInstanceBuffers& Buffers, bool bOcclusionCulling, bool bComponentTwoPhase)
+{
+    const int32 Override = CVarGrassCullingTwoPhaseOcclusion.GetValueOnRenderThread();
+    const bool bTwoPhase = Override >= 0 ? Override > 0 : bComponentTwoPhase;
+    return bTwoPhase && bOcclusionCulling && Buffers.HasVisibilityBits();
+}
+
+/** 稳定顺序剔除是否启用 (r.Grass.Culling.StableOrder 可以强制覆盖组件设置) */
+static bool UseGrassStableVisibleOrder(const FGrassInstanceBuffers& Buffers, bool bComponentStableOrder)
+{
+    const int32 Override = CVarGrassCullingStableOrder.GetValueOnRenderThread();
+    const bool bStable = Override >= 0 ? Override > 0 : bComponentStableOrder;
+    return bStable && Buffers.HasStableCompaction();
+}
+
+/**
+ * 一组剔除 Buffer 在 RDG 中的注册 (主视图的 InstanceBuffers、次要视图槽位或阴影级联的 Buffers)
+ * 可见列表和 Indirect Args 是剔除输出 (RegisterDrawnBuffer)；LOD 1 没有独立输出或与 LOD 0 在同一个页中时为空，同一个 Buffer 只声明一次
+ */
+struct FGrassCullingRDGBuffers
+{
+    FRDGBufferRef Instances = nullptr;
+    FRDGBufferRef Visible = nullptr;
+    FRDGBufferRef VisibleLOD1 = nullptr;
+    FRDGBufferRef IndirectArgs = nullptr;
+    FRDGBufferRef IndirectArgsLOD1 = nullptr;
+    FRDGBufferRef CullTiles = nullptr;
+    FRDGBufferRef VisibleTiles = nullptr;
+    FRDGBufferRef TileDispatchArgs = nullptr;
+    FRDGBufferRef TileVisibleCounts = nullptr;
+    FRDGBufferRef VisibilityBits = nullptr;
+
+    FGrassCullingRDGBuffers(const FGrassCullingGraph& Graph, const FGrassInstanceBuffers& Buffers, bool bLODFullyEnabled)
+    {
+        Instances = Graph.RegisterBuffer(Buffers.InstanceBuffer, TEXT("GrassInstances"), ERHIAccess::SRVMask);
+        Visible = Graph.RegisterDrawnBuffer(Buffers.VisibleInstanceBuffer, TEXT("GrassVisibleInstances"), ERHIAccess::SRVMask);
+        IndirectArgs = Graph.RegisterDrawnBuffer(Buffers.IndirectArgsBuffer, TEXT("GrassIndirectArgs"), ERHIAccess::IndirectArgs);
+        if (bLODFullyEnabled)
+        {
+            IndirectArgsLOD1 = Graph.RegisterDrawnBuffer(Buffers.IndirectArgsBufferLOD1, TEXT("GrassIndirectArgsLOD1"), ERHIAccess::IndirectArgs);
+            if (Buffers.VisibleInstanceBufferLOD1 != Buffers.VisibleInstanceBuffer)
+            {
+                VisibleLOD1 = Graph.RegisterDrawnBuffer(Buffers.VisibleInstanceBufferLOD1, TEXT("GrassVisibleInstancesLOD1"), ERHIAccess::SRVMask);
+            }
+        }
+
+        CullTiles = Graph.RegisterBuffer(Buffers.CullTileBuffer, TEXT("GrassCullTiles"), ERHIAccess::SRVMask);
+        VisibleTiles = Graph.RegisterBuffer(Buffers.VisibleTileBuffer, TEXT("GrassVisibleTiles"), ERHIAccess::SRVMask);
+        TileDispatchArgs = Graph.RegisterBuffer(Buffers.TileDispatchArgsBuffer, TEXT("GrassTileDispatchArgs"), ERHIAccess::IndirectArgs);
+        TileVisibleCounts = Graph.RegisterBuffer(Buffers.TileVisibleCountBuffer, TEXT("GrassTileVisibleCounts"), ERHIAccess::SRVMask);
+        VisibilityBits = Graph.RegisterBuffer(Buffers.VisibilityBitsBuffer, TEXT("GrassVisibilityBits"), ERHIAccess::UAVCompute);
+    }
+
+    /** 剔除输出 (可见列表 + Indirect Args) 的写入 */
+    void AddOutputAccess(FGrassRDGPassAccess& PassAccess) const
+    {
+        FGrassCullingGraph::AddAccess(PassAccess, Visible, ERHIAccess::UAVCompute);
+        FGrassCullingGraph::AddAccess(PassAccess, VisibleLOD1, ERHIAccess::UAVCompute);
+        FGrassCullingGraph::AddAccess(PassAccess, IndirectArgs, ERHIAccess::UAVCompute);
+        FGrassCullingGraph::AddAccess(PassAccess, IndirectArgsLOD1, ERHIAccess::UAVCompute);
+    }
+};
+
+/** 重置 Indirect Args (实例数量清零，写入索引数量和 LOD 1 的 StartInstanceLocation) */
+static void AddGrassResetIndirectArgsPass(const FGrassCullingGraph& Graph, const FGrassCullingRDGBuffers& RDGBuffers, const FGrassResetIndirectArgsCS::FParameters& ResetParams)
+{
+    FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess();
+    FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.IndirectArgs, ERHIAccess::UAVCompute);
+    FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.IndirectArgsLOD1, ERHIAccess::UAVCompute);
+
+    TShaderMapRef<FGrassResetIndirectArgsCS> ResetCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    Graph.AddPass(
+        RDG_EVENT_NAME("GrassResetIndirectArgs"),
+        PassAccess,
+        [ResetCS, ResetParams](FRHIComputeCommandList& RHICmdList)
+        {
+            FComputeShaderUtils::Dispatch(RHICmdList, ResetCS, ResetParams, FIntVector(1, 1, 1));
+        });
+}
+
+/**
+ * 执行逐实例剔除 (三个 PerformGPUCulling* 共用，每一步是一个 RDG Pass，Pass 声明访问的 Buffer，状态转换和 UAV 屏障由 RDG 插入)
+ * 先由 CPU 四叉树得到可能可见的实例区间，每个区间一次 Dispatch (区间为空时不 Dispatch，Indirect Args 保持清零)
+ * 有剔除块且 r.Grass.Culling.Tiles 开启时先剔除区间中的块，再通过间接 Dispatch 只处理存活块中的实例；否则对区间中的所有实例 Dispatch
+ * bStableOrder 时逐实例 Pass 执行两次 (计数 / 分散)，中间扫描每个块的计数，可见列表保持实例顺序
+ * 两阶段遮挡剔除的主 Pass 不用上一帧的 Hi-Z 剔除块：块被剔除时其中实例的可见位不会清零，后 Pass 会把它们当成已经绘制
+ * HiZTexture 为空时绑定占位纹理；否则在 Pass 执行时绑定 (CullingParams 的其他 Hi-Z 参数已经设置)
+ */
+static void DispatchGrassInstanceCullingPasses(
+    const FGrassCullingGraph& Graph,
+    const FGrassInstanceBuffers& Buffers,
+    const FGrassCullingRDGBuffers& RDGBuffers,
+    FGrassFrustumCullingCS::FParameters& CullingParams,
+    FRDGTextureRef HiZTexture,
+    const FGrassFrustum& Frustum,
+    const FMatrix& LocalToWorld,
+    bool bStableOrder,
+    EGrassOcclusionPhase Phase)
+{
+    // 没有传入 Hi-Z 时绑定占位纹理 (着色器中的 Hi-Z 分支不会执行)
+    if (!HiZTexture)
+    {
+        CullingParams.bEnableOcclusionCulling = 0;
+        CullingParams.HiZTexture = GBlackTexture->TextureRHI.GetReference();
+        CullingParams.HiZSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+        CullingParams.HiZSize = FVector2f(1.0f, 1.0f);
+    }
+
+    const bool bUseTiles = Buffers.HasCullTiles() && CVarGrassCullingTiles.GetValueOnRenderThread() != 0;
+
+    // 区间在 Pass 执行时读取，分配在 RDG 中
+    TArray<FGrassInstanceRange>& Ranges = *Graph.GraphBuilder.AllocObject<TArray<FGrassInstanceRange>>();
+    QueryGrassInstanceRanges(Buffers, Frustum, LocalToWorld, CullingParams, Ranges);
+    const TArray<FGrassInstanceRange>* RangesPtr = &Ranges;
+
+    CullingParams.InstanceRangeStart = 0;
+    CullingParams.OutTileVisibleCounts = Buffers.TileVisibleCountBufferUAV;
+    CullingParams.InTileVisibleOffsets = Buffers.TileVisibleCountBufferSRV;
+    CullingParams.VisibilityBits = Buffers.VisibilityBitsBufferUAV;
+
+    // 只有使用可见位的阶段声明可见位 (两阶段遮挡剔除 / 分摊的单 Pass)
+    FRDGBufferRef VisibilityBits = Phase != EGrassOcclusionPhase::Single ? RDGBuffers.VisibilityBits : nullptr;
+
+    if (bUseTiles)
+    {
+        // ========== Tile Step 1: 清空存活块计数，剔除块 ==========
+        {
+            FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess();
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileDispatchArgs, ERHIAccess::UAVCompute);
+
+            FRHIUnorderedAccessView* TileDispatchArgsUAV = Buffers.TileDispatchArgsBufferUAV;
+            Graph.AddPass(
+                RDG_EVENT_NAME("GrassClearTileDispatchArgs"),
+                PassAccess,
+                [TileDispatchArgsUAV](FRHIComputeCommandList& RHICmdList)
+                {
+                    RHICmdList.ClearUAVUint(TileDispatchArgsUAV, FUintVector4(0, 0, 0, 0));
+                });
+        }
+
+        {
+            // 参数较大，分配在 RDG 中 (Pass 执行时绑定 Hi-Z、设置区间)
+            FGrassCullTilesCS::FParameters* TileParams = Graph.GraphBuilder.AllocObject<FGrassCullTilesCS::FParameters>();
+            TileParams->Culling = CullingParams;
+            TileParams->InCullTiles = Buffers.CullTileBufferSRV;
+            TileParams->OutVisibleTiles = Buffers.VisibleTileBufferUAV;
+            TileParams->OutTileDispatchArgs = Buffers.TileDispatchArgsBufferUAV;
+            if (Phase == EGrassOcclusionPhase::Main)
+            {
+                TileParams->Culling.bEnableOcclusionCulling = 0;
+            }
+
+            FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess(HiZTexture);
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.Instances, ERHIAccess::SRVCompute);
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.CullTiles, ERHIAccess::SRVCompute);
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.VisibleTiles, ERHIAccess::UAVCompute);
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileDispatchArgs, ERHIAccess::UAVCompute);
+
+            TShaderMapRef<FGrassCullTilesCS> CullTilesCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+            Graph.AddPass(
+                RDG_EVENT_NAME("GrassCullTiles"),
+                PassAccess,
+                [CullTilesCS, TileParams, RangesPtr, HiZTexture](FRHIComputeCommandList& RHICmdList)
+                {
+                    if (HiZTexture)
+                    {
+                        TileParams->Culling.HiZTexture = HiZTexture->GetRHI();
+                    }
+
+                    // 各区间的块互不重叠，存活块通过原子计数追加，Dispatch 之间不需要 UAV 屏障
+                    for (const FGrassInstanceRange& Range : *RangesPtr)
+                    {
+                        const uint32 FirstTile = Range.FirstInstance / FGrassInstanceBuffers::CullTileSize;
+                        const uint32 NumTiles = FGrassInstanceBuffers::GetNumCullTiles(Range.NumInstances);
+                        TileParams->TileRangeStart = FirstTile;
+                        TileParams->TileRangeEnd = FirstTile + NumTiles;
+                        FComputeShaderUtils::Dispatch(RHICmdList, CullTilesCS, *TileParams, FIntVector(FMath::DivideAndRoundUp((int32)NumTiles, 64), 1, 1));
+                    }
+                });
+        }
+
+        // ========== Tile Step 2: 存活块数量 -> 间接 Dispatch 参数 ==========
+        {
+            FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess();
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileDispatchArgs, ERHIAccess::UAVCompute);
+
+            TShaderMapRef<FGrassBuildTileDispatchArgsCS> BuildArgsCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+            FGrassBuildTileDispatchArgsCS::FParameters BuildArgsParams;
+            BuildArgsParams.OutTileDispatchArgs = Buffers.TileDispatchArgsBufferUAV;
+            Graph.AddPass(
+                RDG_EVENT_NAME("GrassBuildTileDispatchArgs"),
+                PassAccess,
+                [BuildArgsCS, BuildArgsParams](FRHIComputeCommandList& RHICmdList)
+                {
+                    FComputeShaderUtils::Dispatch(RHICmdList, BuildArgsCS, BuildArgsParams, FIntVector(1, 1, 1));
+                });
+        }
+    }
+
+    // 逐实例 Pass：存活块中的实例 (间接 Dispatch) 或区间中的所有实例 (区间起点按剔除块对齐，线程组不会跨区间)
+    // 计数 Pass 写入每个块的可见数量，分散 Pass 读取扫描后的输出起点
+    auto AddInstancePass = [&](EGrassCompactionPass Pass, FRDGEventName&& PassName)
+    {
+        FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess(HiZTexture);
+        FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.Instances, ERHIAccess::SRVCompute);
+        RDGBuffers.AddOutputAccess(*PassAccess);
+        FGrassCullingGraph::AddAccess(*PassAccess, VisibilityBits, ERHIAccess::UAVCompute);
+        if (Pass == EGrassCompactionPass::Count)
+        {
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileVisibleCounts, ERHIAccess::UAVCompute);
+        }
+        else if (Pass == EGrassCompactionPass::Scatter)
+        {
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileVisibleCounts, ERHIAccess::SRVCompute);
+        }
+
+        if (bUseTiles)
+        {
+            // Dispatch 参数同时作为 SRV 读取存活块数量 (折叠到 Y 维度时最后一行线程组不满)
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.VisibleTiles, ERHIAccess::SRVCompute);
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileDispatchArgs, ERHIAccess::IndirectArgs | ERHIAccess::SRVCompute);
+
+            TShaderMapRef<FGrassCullTileInstancesCS> CullInstancesCS = GetGrassCullTileInstancesCS(Buffers, Pass, Phase);
+            FGrassCullTileInstancesCS::FParameters* InstanceParams = Graph.GraphBuilder.AllocObject<FGrassCullTileInstancesCS::FParameters>();
+            InstanceParams->Culling = CullingParams;
+            InstanceParams->InVisibleTiles = Buffers.VisibleTileBufferSRV;
+            InstanceParams->InTileDispatchArgs = Buffers.TileDispatchArgsBufferSRV;
+            FRHIBuffer* TileDispatchArgsBuffer = Buffers.TileDispatchArgsBuffer;
+            Graph.AddPass(
+                MoveTemp(PassName),
+                PassAccess,
+                [CullInstancesCS, InstanceParams, TileDispatchArgsBuffer, HiZTexture](FRHIComputeCommandList& RHICmdList)
+                {
+                    if (HiZTexture)
+                    {
+                        InstanceParams->Culling.HiZTexture = HiZTexture->GetRHI();
+                    }
+                    FComputeShaderUtils::DispatchIndirect(RHICmdList, CullInstancesCS, *InstanceParams, TileDispatchArgsBuffer, 0);
+                });
+        }
+        else
+        {
+            TShaderMapRef<FGrassFrustumCullingCS> CullingCS = GetGrassFrustumCullingCS(Buffers, Pass, Phase);
+            FGrassFrustumCullingCS::FParameters* PassParams = Graph.GraphBuilder.AllocObject<FGrassFrustumCullingCS::FParameters>(CullingParams);
+            Graph.AddPass(
+                MoveTemp(PassName),
+                PassAccess,
+                [CullingCS, PassParams, RangesPtr, HiZTexture](FRHIComputeCommandList& RHICmdList)
+                {
+                    if (HiZTexture)
+                    {
+                        PassParams->HiZTexture = HiZTexture->GetRHI();
+                    }
+                    for (const FGrassInstanceRange& Range : *RangesPtr)
+                    {
+                        PassParams->InstanceRangeStart = Range.FirstInstance;
+                        int32 NumGroups = FMath::DivideAndRoundUp((int32)Range.NumInstances, 64);
+                        FComputeShaderUtils::Dispatch(RHICmdList, CullingCS, *PassParams, FIntVector(NumGroups, 1, 1));
+                    }
+                });
+        }
+    };
+
+    if (!bStableOrder)
+    {
+        AddInstancePass(EGrassCompactionPass::Atomic, RDG_EVENT_NAME("GrassCullInstances"));
+    }
+    else
+    {
+        // ========== Stable Step 1: 每个块的可见数量 (没有处理的块保持 0) ==========
+        {
+            FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess();
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileVisibleCounts, ERHIAccess::UAVCompute);
+
+            FRHIUnorderedAccessView* TileVisibleCountsUAV = Buffers.TileVisibleCountBufferUAV;
+            Graph.AddPass(
+                RDG_EVENT_NAME("GrassClearTileVisibleCounts"),
+                PassAccess,
+                [TileVisibleCountsUAV](FRHIComputeCommandList& RHICmdList)
+                {
+                    RHICmdList.ClearUAVUint(TileVisibleCountsUAV, FUintVector4(0, 0, 0, 0));
+                });
+        }
+        AddInstancePass(EGrassCompactionPass::Count, RDG_EVENT_NAME("GrassCullInstances(Count)"));
+
+        // ========== Stable Step 2: 计数 -> 每个块的输出起点，总数写入 Indirect Args ==========
+        {
+            FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess();
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.TileVisibleCounts, ERHIAccess::UAVCompute);
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.IndirectArgs, ERHIAccess::UAVCompute);
+            FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.IndirectArgsLOD1, ERHIAccess::UAVCompute);
+
+            TShaderMapRef<FGrassScanTileVisibleCountsCS> ScanCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+            FGrassScanTileVisibleCountsCS::FParameters ScanParams;
+            ScanParams.OutTileVisibleCounts = Buffers.TileVisibleCountBufferUAV;
+            ScanParams.OutIndirectArgs = CullingParams.OutIndirectArgs;
+            ScanParams.OutIndirectArgsLOD1 = CullingParams.OutIndirectArgsLOD1;
+            ScanParams.NumScanTiles = Buffers.NumCullTiles;
+            ScanParams.bAppendToIndirectArgs = Phase == EGrassOcclusionPhase::Post ? 1 : 0;
+            Graph.AddPass(
+                RDG_EVENT_NAME("GrassScanTileVisibleCounts"),
+                PassAccess,
+                [ScanCS, ScanParams](FRHIComputeCommandList& RHICmdList)
+                {
+                    FComputeShaderUtils::Dispatch(RHICmdList, ScanCS, ScanParams, FIntVector(1, 1, 1));
+                });
+        }
+
+        // ========== Stable Step 3: 按输出起点分散写入 ==========
+        AddInstancePass(EGrassCompactionPass::Scatter, RDG_EVENT_NAME("GrassCullInstances(Scatter)"));
+    }
+}
+
+/** 执行逐实例剔除，两种压缩方式分别计入 GPU Stat (stat GPU 中比较开销) */
+static void DispatchGrassInstanceCulling(
+    const FGrassCullingGraph& Graph,
+    const FGrassInstanceBuffers& Buffers,
+    const FGrassCullingRDGBuffers& RDGBuffers,
+    FGrassFrustumCullingCS::FParameters& CullingParams,
+    FRDGTextureRef HiZTexture,
+    const FGrassFrustum& Frustum,
+    const FMatrix& LocalToWorld,
+    bool bComponentStableOrder,
+    EGrassOcclusionPhase Phase = EGrassOcclusionPhase::Single)
+{
+    if (UseGrassStableVisibleOrder(Buffers, bComponentStableOrder))
+    {
+        RDG_GPU_STAT_SCOPE(Graph.GraphBuilder, GrassCullingStable);
+        DispatchGrassInstanceCullingPasses(Graph, Buffers, RDGBuffers, CullingParams, HiZTexture, Frustum, LocalToWorld, true, Phase);
+    }
+    else
+    {
+        RDG_GPU_STAT_SCOPE(Graph.GraphBuilder, GrassCullingAtomic);
+        DispatchGrassInstanceCullingPasses(Graph, Buffers, RDGBuffers, CullingParams, HiZTexture, Frustum, LocalToWorld, false, Phase);
+    }
+}
+
 // ============================================================================
 // FGrassSceneProxy 实现
 // ============================================================================
@@ -96,44 +807,14 @@ FGrassSceneProxy::FGrassSceneProxy(UGrassComponent* Component)
 : FPrimitiveSceneProxy(Component)
 , VertexFactory(GetScene().GetFeatureLevel(), "GrassVertexFactory")
 , VertexFactoryLOD1(GetScene().GetFeatureLevel(), "GrassVertexFactoryLOD1")  // LOD 1 Vertex Factory
-, PositionBuffer(Component->PositionBuffer)
-, PositionBufferSRV(Component->PositionBufferSRV)
-, TotalInstanceCount(Component->InstanceCount)
-, GrassData0SRV(Component->GrassDataBufferSRV)
-, GrassData1SRV(Component->GrassData1BufferSRV)
-, GrassData2SRV(Component->GrassData2BufferSRV)
-, VisiblePositionBuffer(Component->VisiblePositionBuffer)
-, VisiblePositionBufferSRV(Component->VisiblePositionBufferSRV)
-, VisiblePositionBufferUAV(Component->VisiblePositionBufferUAV)
-, VisibleGrassData0Buffer(Component->VisibleGrassData0Buffer)
-, VisibleGrassData0SRV(Component->VisibleGrassData0BufferSRV)
-, VisibleGrassData0UAV(Component->VisibleGrassData0BufferUAV)
-, VisibleGrassData1Buffer(Component->VisibleGrassData1Buffer)
-, VisibleGrassData1SRV(Component->VisibleGrassData1BufferSRV)
-, VisibleGrassData1UAV(Component->VisibleGrassData1BufferUAV)
-, VisibleGrassData2Buffer(Component->VisibleGrassData2Buffer)
-, VisibleGrassData2SRV(Component->VisibleGrassData2BufferSRV)
-, VisibleGrassData2UAV(Component->VisibleGrassData2BufferUAV)
+, InstanceBuffers(Component->InstanceBuffers)
+, TotalInstanceCount(Component->InstanceBuffers.InstanceCount)
 , bUseIndirectDraw(Component->bUseIndirectDraw)
-, IndirectArgsBuffer(Component->IndirectArgsBuffer)
-, IndirectArgsBufferUAV(Component->IndirectArgsBufferUAV)
-, IndirectArgsBufferLOD1(Component->IndirectArgsBufferLOD1)  // LOD 1 Indirect Args
-, IndirectArgsBufferLOD1UAV(Component->IndirectArgsBufferLOD1UAV)
-, VisiblePositionBufferLOD1(Component->VisiblePositionBufferLOD1)  // LOD 1 独立 Visible Buffers
-, VisiblePositionBufferLOD1SRV(Component->VisiblePositionBufferLOD1SRV)
-, VisiblePositionBufferLOD1UAV(Component->VisiblePositionBufferLOD1UAV)
-, VisibleGrassData0BufferLOD1(Component->VisibleGrassData0BufferLOD1)
-, VisibleGrassData0BufferLOD1SRV(Component->VisibleGrassData0BufferLOD1SRV)
-, VisibleGrassData0BufferLOD1UAV(Component->VisibleGrassData0BufferLOD1UAV)
-, VisibleGrassData1BufferLOD1(Component->VisibleGrassData1BufferLOD1)
-, VisibleGrassData1BufferLOD1SRV(Component->VisibleGrassData1BufferLOD1SRV)
-, VisibleGrassData1BufferLOD1UAV(Component->VisibleGrassData1BufferLOD1UAV)
-, VisibleGrassData2BufferLOD1(Component->VisibleGrassData2BufferLOD1)
-, VisibleGrassData2BufferLOD1SRV(Component->VisibleGrassData2BufferLOD1SRV)
-, VisibleGrassData2BufferLOD1UAV(Component->VisibleGrassData2BufferLOD1UAV)
 , bEnableFrustumCulling(Component->bEnableFrustumCulling)
 , bEnableDistanceCulling(Component->bEnableDistanceCulling)
 , bEnableOcclusionCulling(Component->bEnableOcclusionCulling)
+, bStableVisibleOrder(Component->bStableVisibleOrder)
+, bTwoPhaseOcclusion(Component->bTwoPhaseOcclusion)
 , MaxVisibleDistance(Component->MaxVisibleDistance)
 , GrassBoundingRadius(Component->GrassBoundingRadius)
 , bEnableLOD(Component->bEnableLOD)  // LOD 参数
@@ -144,6 +825,15 @@ FGrassSceneProxy::FGrassSceneProxy(UGrassComponent* Component)
 {
     bVerifyUsedMaterials = false;
 
+    CaptureBudget.MaxDistanceScale = Component->CaptureMaxDistanceScale;
+    CaptureBudget.LOD0DistanceScale = Component->CaptureLOD0DistanceScale;
+    CaptureBudget.DensityScale = Component->CaptureDensity;
+
+    bCastGrassShadows = Component->bCastGrassShadows;
+    ShadowMaxDistance = Component->ShadowMaxDistance;
+    ShadowDensity = Component->ShadowDensity;
+    bShadowUseLOD1 = Component->bShadowUseLOD1;
+
     if (!Material)
     {
         Material = UMaterial::GetDefaultMaterial(MD_Surface);
@@ -166,37 +856,11 @@ FGrassSceneProxy::FGrassSceneProxy(UGrassComponent* Component)
     const float WindPushTipForward = Component->WindPushTipForward;
     const float LocalWindRotateAmount = Component->LocalWindRotateAmount;
 
-    // IMPORTANT: GPU Culling is not yet fully implemented
-    // Always use PositionBufferSRV (all instances) for now
-    // When GPU Culling is properly implemented, switch to VisiblePositionBufferSRV
-    if (bEnableFrustumCulling && bUseIndirectDraw && VisiblePositionBufferSRV.IsValid())
-    {
-        // GPU Culling enabled: use Visible buffers (will be filled by culling shader)
-        VertexFactory.SetInstancePositionSRV(VisiblePositionBufferSRV.GetReference(), TotalInstanceCount);
-        
-        // 使用可见属性 Buffer（与位置同步的属性数据）
-        VertexFactory.SetGrassDataSRV(
-            VisibleGrassData0SRV.IsValid() ? VisibleGrassData0SRV.GetReference() : nullptr,
-            VisibleGrassData1SRV.IsValid() ? VisibleGrassData1SRV.GetReference() : nullptr,
-            VisibleGrassData2SRV.IsValid() ? VisibleGrassData2SRV.GetReference() : nullptr
-        );
-        UE_LOG(LogTemp, Log, TEXT("Using Visible Buffers for rendering (GPU Culling enabled, %d max instances)"), TotalInstanceCount);
-    }
-    else
-    {
-        // No GPU Culling: use all positions and original grass data
-        VertexFactory.SetInstancePositionSRV(PositionBufferSRV.GetReference(), TotalInstanceCount);
-        
-        // Set grass blade data SRVs for Bezier deformation
-        VertexFactory.SetGrassDataSRV(
-            GrassData0SRV.IsValid() ? GrassData0SRV.GetReference() : nullptr,
-            GrassData1SRV.IsValid() ? GrassData1SRV.GetReference() : nullptr,
-            GrassData2SRV.IsValid() ? GrassData2SRV.GetReference() : nullptr
-        );
-        UE_LOG(LogTemp, Log, TEXT("Using original Buffers for rendering (%d instances)"), TotalInstanceCount);
-    }
-    UE_LOG(LogTemp, Log, TEXT("Grass data SRVs set: Data0=%d, Data1=%d, Data2=%d"), 
-        GrassData0SRV.IsValid() ? 1 : 0, GrassData1SRV.IsValid() ? 1 : 0, GrassData2SRV.IsValid() ? 1 : 0);
+    // 草叶收尖程度 (全局参数，不写入实例数据)
+    const float TaperAmount = Component->RenderParameters.TaperAmount;
+
+    // 为 LOD 0 / LOD 1 Vertex Factory 设置实例 SRV
+    UpdateVertexFactoryBuffers();
 
     // 初始化 LOD 0 Mesh 数据
     if (Component->GrassMesh && Component->GrassMesh->GetRenderData() && 
@@ -218,30 +882,11 @@ FGrassSceneProxy::FGrassSceneProxy(UGrassComponent* Component)
     VertexFactory.SetWindNoiseParameters(WindNoiseTextureRHI, WindNoiseScale, WindNoiseStrength, WindNoiseSpeed);
     VertexFactory.SetWindWaveParameters(WindWaveSpeed, WindWaveAmplitude, WindSinOffsetRange, WindPushTipForward);
     VertexFactory.SetLocalWindRotateAmount(LocalWindRotateAmount);
+    VertexFactory.SetTaperAmount(TaperAmount);
 
     // 初始化 LOD 1 Mesh 数据 (7 顶点简化版)
     InitLOD1GrassBlade();
     
-    // 为 LOD 1 Vertex Factory 设置 SRV (使用 LOD 1 独立的 Visible Buffers)
-    if (bEnableFrustumCulling && bUseIndirectDraw && VisiblePositionBufferLOD1SRV.IsValid())
-    {
-        VertexFactoryLOD1.SetInstancePositionSRV(VisiblePositionBufferLOD1SRV.GetReference(), TotalInstanceCount);
-        VertexFactoryLOD1.SetGrassDataSRV(
-            VisibleGrassData0BufferLOD1SRV.IsValid() ? VisibleGrassData0BufferLOD1SRV.GetReference() : nullptr,
-            VisibleGrassData1BufferLOD1SRV.IsValid() ? VisibleGrassData1BufferLOD1SRV.GetReference() : nullptr,
-            VisibleGrassData2BufferLOD1SRV.IsValid() ? VisibleGrassData2BufferLOD1SRV.GetReference() : nullptr
-        );
-    }
-    else
-    {
-        VertexFactoryLOD1.SetInstancePositionSRV(PositionBufferSRV.GetReference(), TotalInstanceCount);
-        VertexFactoryLOD1.SetGrassDataSRV(
-            GrassData0SRV.IsValid() ? GrassData0SRV.GetReference() : nullptr,
-            GrassData1SRV.IsValid() ? GrassData1SRV.GetReference() : nullptr,
-            GrassData2SRV.IsValid() ? GrassData2SRV.GetReference() : nullptr
-        );
-    }
-    
     // 设置 LOD 1 的 LOD 级别
     VertexFactoryLOD1.SetLODLevel(1);
     // 设置弯曲法线程度 (LOD 1 使用相同的值)
@@ -251,6 +896,7 @@ FGrassSceneProxy::FGrassSceneProxy(UGrassComponent* Component)
     VertexFactoryLOD1.SetWindNoiseParameters(WindNoiseTextureRHI, WindNoiseScale, WindNoiseStrength, WindNoiseSpeed);
     VertexFactoryLOD1.SetWindWaveParameters(WindWaveSpeed, WindWaveAmplitude, WindSinOffsetRange, WindPushTipForward);
     VertexFactoryLOD1.SetLocalWindRotateAmount(LocalWindRotateAmount);
+    VertexFactoryLOD1.SetTaperAmount(TaperAmount);
 
     // 初始化渲染资源 (LOD 0)
     FStaticMeshVertexBuffers* VertexBuffersPtr = &VertexBuffers;
@@ -313,6 +959,78 @@ FGrassSceneProxy::FGrassSceneProxy(UGrassComponent* Component)
         bUseIndirectDraw ? 1 : 0, bEnableFrustumCulling ? 1 : 0, bEnableLOD ? 1 : 0, LOD0Distance);
 }
 
+void FGrassSceneProxy::UpdateVertexFactoryBuffers()
+{
+    const FGrassInstanceBuffers& B = InstanceBuffers;
+
+    // GPU Culling 开启时使用剔除输出的 Visible Buffers，否则直接使用所有实例
+    // 可见索引列表模式下 Vertex Factory 仍然读取完整的实例 Buffer，通过可见索引间接访问
+    // 所有 Buffer 都是 Buffer 池页中的区间，同时传入区间的起始元素
+    auto BindVisibleBuffer = [&B, this](FGrassVertexFactory& VF, const FShaderResourceViewRHIRef& VisibleSRV, uint32 VisibleOffset)
+    {
+        if (bEnableFrustumCulling && bUseIndirectDraw && VisibleSRV.IsValid())
+        {
+            if (B.bVisibleIndexLists)
+            {
+                VF.SetInstanceSRV(B.InstanceBufferSRV.GetReference(), TotalInstanceCount, B.InstanceOffset);
+                VF.SetVisibleIndexSRV(VisibleSRV.GetReference(), VisibleOffset);
+            }
+            else
+            {
+                VF.SetInstanceSRV(VisibleSRV.GetReference(), TotalInstanceCount, VisibleOffset);
+                VF.SetVisibleIndexSRV(nullptr, 0);
+            }
+            return true;
+        }
+        VF.SetInstanceSRV(B.InstanceBufferSRV.GetReference(), TotalInstanceCount, B.InstanceOffset);
+        VF.SetVisibleIndexSRV(nullptr, 0);
+        return false;
+    };
+
+    if (BindVisibleBuffer(VertexFactory, B.VisibleInstanceBufferSRV, B.VisibleInstanceOffset))
+    {
+        UE_LOG(LogTemp, Log, TEXT("Using Visible Buffers for rendering (GPU Culling enabled, %d max instances, IndexLists=%d)"), TotalInstanceCount, B.bVisibleIndexLists ? 1 : 0);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Log, TEXT("Using original Buffers for rendering (%d instances)"), TotalInstanceCount);
+    }
+
+    // LOD 1 使用独立的 Visible Buffer
+    BindVisibleBuffer(VertexFactoryLOD1, B.VisibleInstanceBufferLOD1SRV, B.VisibleInstanceLOD1Offset);
+
+    // 剔除输出与实例 Buffer 使用相同的量化范围
+    VertexFactory.SetQuantization(B.Quantization);
+    VertexFactoryLOD1.SetQuantization(B.Quantization);
+}
+
+void FGrassSceneProxy::SwapInstanceBuffers_RenderThread(const FGrassInstanceBuffers& NewBuffers)
+{
+    check(IsInRenderingThread());
+
+    // 旧 Buffer 的引用在这里释放，GPU 上仍在使用的资源由 RHI 延迟删除
+    InstanceBuffers = NewBuffers;
+    TotalInstanceCount = NewBuffers.InstanceCount;
+    if (!NewBuffers.IsValid())
+    {
+        // 密度遮罩剔除了所有草叶：不再绘制，也没有 Buffer 可以绑定
+        TotalInstanceCount = 0;
+        UE_LOG(LogTemp, Log, TEXT("FGrassSceneProxy: regenerated grass has no instances"));
+        return;
+    }
+    UpdateVertexFactoryBuffers();
+
+    // 次要视图和阴影级联的可见列表按旧的实例数量分配，下次剔除 / 下个视图族开始时重新分配
+    ViewCullingPool.Reset();
+    ShadowCascadePool.Reset();
+
+    // 新 Buffer 还没有被剔除过，允许本帧重新执行剔除
+    bCullingPerformedThisFrame = false;
+    PrimaryCullingHistory.Invalidate();
+
+    UE_LOG(LogTemp, Log, TEXT("FGrassSceneProxy: swapped in %d regenerated instances"), TotalInstanceCount);
+}
+
 void FGrassSceneProxy::InitFromStaticMesh(UStaticMesh* StaticMesh)
 {
     const FStaticMeshLODResources& LOD = StaticMesh->GetRenderData()->LODResources[0];
@@ -564,7 +1282,7 @@ void FGrassSceneProxy::InitLOD1GrassBlade()
 
 void FGrassSceneProxy::PerformGPUCullingRenderThread(FRHICommandListImmediate& RHICmdList, const FMatrix& ViewProjectionMatrix, const FVector& ViewOrigin, const FMatrix& LocalToWorldMatrix) const
 {
-    if (!bEnableFrustumCulling || !VisiblePositionBufferUAV.IsValid() || !IndirectArgsBufferUAV.IsValid())
+    if (!bEnableFrustumCulling || !InstanceBuffers.VisibleInstanceBufferUAV.IsValid() || !InstanceBuffers.IndirectArgsBufferUAV.IsValid())
     {
         return;
     }
@@ -577,6 +1295,9 @@ void FGrassSceneProxy::PerformGPUCullingRenderThread(FRHICommandListImmediate& R
     }
     bCullingPerformedThisFrame = true;
     LastFrameNumber = CurrentFrameNumber;
+    // 不经过签名检查，下一次带 Hi-Z 的剔除必须完整执行
+    PrimaryCullingHistory.Invalidate();
+    bPrimaryCullingReused = false;
 
     // 计算距离淡出参数，传递给剔除着色器
     float FadeAtten = 1.0f;
@@ -599,64 +1320,43 @@ void FGrassSceneProxy::PerformGPUCullingRenderThread(FRHICommandListImmediate& R
 
     // 检查 LOD 功能是否完全可用（需要所有必要的 buffer）
     const bool bLODFullyEnabled = bEnableLOD && 
-        IndirectArgsBufferLOD1.IsValid() && 
-        IndirectArgsBufferLOD1UAV.IsValid() &&
-        VisiblePositionBufferLOD1.IsValid() &&
-        VisiblePositionBufferLOD1UAV.IsValid();
+        InstanceBuffers.IndirectArgsBufferLOD1.IsValid() && 
+        InstanceBuffers.IndirectArgsBufferLOD1UAV.IsValid() &&
+        InstanceBuffers.VisibleInstanceBufferLOD1.IsValid() &&
+        InstanceBuffers.VisibleInstanceBufferLOD1UAV.IsValid();
+
+    // 不在场景渲染中：剔除在本地的 RDG 中执行 (图形管线)，执行完时输出已经处于绘制需要的状态
+    FRDGBuilder GraphBuilder(RHICmdList, RDG_EVENT_NAME("GrassCulling"));
+    const FGrassCullingGraph Graph(GraphBuilder, false);
+    const FGrassCullingRDGBuffers RDGBuffers(Graph, InstanceBuffers, bLODFullyEnabled);
 
     // ========== Step 1: Reset Indirect Args Buffer (LOD 0 and LOD 1) ==========
     {
-        RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::IndirectArgs, ERHIAccess::UAVCompute));
-        if (bLODFullyEnabled)
-        {
-            RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::IndirectArgs, ERHIAccess::UAVCompute));
-        }
-
-        TShaderMapRef<FGrassResetIndirectArgsCS> ResetCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
         FGrassResetIndirectArgsCS::FParameters ResetParams;
-        ResetParams.OutIndirectArgs = IndirectArgsBufferUAV;
-        ResetParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? IndirectArgsBufferLOD1UAV : IndirectArgsBufferUAV;
+        ResetParams.OutIndirectArgs = InstanceBuffers.IndirectArgsBufferUAV;
+        ResetParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? InstanceBuffers.IndirectArgsBufferLOD1UAV : InstanceBuffers.IndirectArgsBufferUAV;
         ResetParams.IndexCountPerInstance = NumIndices;
         ResetParams.IndexCountPerInstanceLOD1 = bLODFullyEnabled ? NumIndicesLOD1 : NumIndices;
         ResetParams.TotalInstanceCount = TotalInstanceCount;
-        
-        FComputeShaderUtils::Dispatch(RHICmdList, ResetCS, ResetParams, FIntVector(1, 1, 1));
+
+        AddGrassResetIndirectArgsPass(Graph, RDGBuffers, ResetParams);
     }
 
     // ========== Step 2: Execute Frustum Culling ==========
     {
-        RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBuffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        
-        // LOD 1 独立 Buffer 状态转换
-        if (bLODFullyEnabled)
-        {
-            RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        }
-
-        TShaderMapRef<FGrassFrustumCullingCS> CullingCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
         FGrassFrustumCullingCS::FParameters CullingParams;
         
-        CullingParams.InPositions = PositionBufferSRV;
-        CullingParams.InGrassData0 = GrassData0SRV;
-        CullingParams.InGrassData1 = GrassData1SRV;
-        CullingParams.InGrassData2 = GrassData2SRV;
-        CullingParams.OutVisiblePositions = VisiblePositionBufferUAV;
-        CullingParams.OutVisibleGrassData0 = VisibleGrassData0UAV;
-        CullingParams.OutVisibleGrassData1 = VisibleGrassData1UAV;
-        CullingParams.OutVisibleGrassData2 = VisibleGrassData2UAV;
+        CullingParams.InInstances = InstanceBuffers.InstanceBufferSRV;
+        CullingParams.QuantizationMin = InstanceBuffers.Quantization.Min;
+        CullingParams.QuantizationSize = InstanceBuffers.Quantization.Size;
+        CullingParams.OutVisibleInstances = InstanceBuffers.VisibleInstanceBufferUAV;
         // LOD 1 独立输出 Buffers - 只有当 LOD 完全启用时才使用独立 buffer
-        CullingParams.OutVisiblePositionsLOD1 = bLODFullyEnabled ? VisiblePositionBufferLOD1UAV : VisiblePositionBufferUAV;
-        CullingParams.OutVisibleGrassData0LOD1 = bLODFullyEnabled ? VisibleGrassData0BufferLOD1UAV : VisibleGrassData0UAV;
-        CullingParams.OutVisibleGrassData1LOD1 = bLODFullyEnabled ? VisibleGrassData1BufferLOD1UAV : VisibleGrassData1UAV;
-        CullingParams.OutVisibleGrassData2LOD1 = bLODFullyEnabled ? VisibleGrassData2BufferLOD1UAV : VisibleGrassData2UAV;
-        CullingParams.OutIndirectArgs = IndirectArgsBufferUAV;
-        CullingParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? IndirectArgsBufferLOD1UAV : IndirectArgsBufferUAV;
+        CullingParams.OutVisibleInstancesLOD1 = bLODFullyEnabled ? InstanceBuffers.VisibleInstanceBufferLOD1UAV : InstanceBuffers.VisibleInstanceBufferUAV;
+        CullingParams.InstanceBaseOffset = InstanceBuffers.InstanceOffset;
+        CullingParams.VisibleBaseOffset = InstanceBuffers.VisibleInstanceOffset;
+        CullingParams.VisibleBaseOffsetLOD1 = bLODFullyEnabled ? InstanceBuffers.VisibleInstanceLOD1Offset : InstanceBuffers.VisibleInstanceOffset;
+        CullingParams.OutIndirectArgs = InstanceBuffers.IndirectArgsBufferUAV;
+        CullingParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? InstanceBuffers.IndirectArgsBufferLOD1UAV : InstanceBuffers.IndirectArgsBufferUAV;
         CullingParams.TotalInstanceCount = TotalInstanceCount;
         CullingParams.IndexCountPerInstance = NumIndices;
         CullingParams.IndexCountPerInstanceLOD1 = bLODFullyEnabled ? NumIndicesLOD1 : NumIndices;
@@ -664,61 +1364,10 @@ void FGrassSceneProxy::PerformGPUCullingRenderThread(FRHICommandListImmediate& R
         CullingParams.LOD0Distance = bLODFullyEnabled ? LOD0Distance : 0.0f;
         
         // Extract frustum planes from ViewProjectionMatrix
-        FPlane FrustumPlanes[6];
-        
-        // Left
-        FrustumPlanes[0] = FPlane(
-            ViewProjectionMatrix.M[0][3] + ViewProjectionMatrix.M[0][0],
-            ViewProjectionMatrix.M[1][3] + ViewProjectionMatrix.M[1][0],
-            ViewProjectionMatrix.M[2][3] + ViewProjectionMatrix.M[2][0],
-            ViewProjectionMatrix.M[3][3] + ViewProjectionMatrix.M[3][0]);
-        // Right
-        FrustumPlanes[1] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][0],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][0],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][0],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][0]);
-        // Bottom
-        FrustumPlanes[2] = FPlane(
-            ViewProjectionMatrix.M[0][3] + ViewProjectionMatrix.M[0][1],
-            ViewProjectionMatrix.M[1][3] + ViewProjectionMatrix.M[1][1],
-            ViewProjectionMatrix.M[2][3] + ViewProjectionMatrix.M[2][1],
-            ViewProjectionMatrix.M[3][3] + ViewProjectionMatrix.M[3][1]);
-        // Top
-        FrustumPlanes[3] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][1],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][1],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][1],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][1]);
-        // Near
-        FrustumPlanes[4] = FPlane(
-            ViewProjectionMatrix.M[0][2],
-            ViewProjectionMatrix.M[1][2],
-            ViewProjectionMatrix.M[2][2],
-            ViewProjectionMatrix.M[3][2]);
-        // Far
-        FrustumPlanes[5] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][2],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][2],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][2],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][2]);
-
-        // Normalize planes and pass to shader
-        for (int i = 0; i < 6; i++)
+        const FGrassFrustum Frustum = FGrassFrustum::FromViewProjection(ViewProjectionMatrix);
+        for (int32 i = 0; i < 6; i++)
         {
-            float Length = FMath::Sqrt(
-                FrustumPlanes[i].X * FrustumPlanes[i].X + 
-                FrustumPlanes[i].Y * FrustumPlanes[i].Y + 
-                FrustumPlanes[i].Z * FrustumPlanes[i].Z);
-            if (Length > SMALL_NUMBER)
-            {
-                FrustumPlanes[i].X /= Length;
-                FrustumPlanes[i].Y /= Length;
-                FrustumPlanes[i].Z /= Length;
-                FrustumPlanes[i].W /= Length;
-            }
-            CullingParams.FrustumPlanes[i] = FVector4f(
-                FrustumPlanes[i].X, FrustumPlanes[i].Y, FrustumPlanes[i].Z, FrustumPlanes[i].W);
+            CullingParams.FrustumPlanes[i] = Frustum.Planes[i];
         }
         
         // LocalToWorld transform matrix
@@ -728,32 +1377,20 @@ void FGrassSceneProxy::PerformGPUCullingRenderThread(FRHICommandListImmediate& R
         CullingParams.BoundingRadius = GrassBoundingRadius;
         CullingParams.MaxVisibleDistance = bEnableDistanceCulling ? MaxVisibleDistance : 0.0f;
         CullingParams.CameraPosition = FVector3f(ViewOrigin);
+        CullingParams.DensityScale = 1.0f;
 
-        // Dispatch
-        int32 NumGroups = FMath::DivideAndRoundUp((int32)TotalInstanceCount, 64);
-        FComputeShaderUtils::Dispatch(RHICmdList, CullingCS, CullingParams, FIntVector(NumGroups, 1, 1));
+        // Dispatch (分块层次剔除或逐实例)
+        DispatchGrassInstanceCulling(Graph, InstanceBuffers, RDGBuffers, CullingParams, nullptr, Frustum, LocalToWorldMatrix, bStableVisibleOrder);
     }
 
-    // ========== Step 3: Transition resource states ==========
-    RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::UAVCompute, ERHIAccess::IndirectArgs));
-    if (bLODFullyEnabled)
-    {
-        RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::IndirectArgs));
-        // LOD 1 独立 Buffer 状态转换
-        RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    }
+    // ========== Step 3: Transition to draw states and execute ==========
+    FGrassCullingGraph::PublishDrawnBuffers(GraphBuilder);
+    GraphBuilder.Execute();
 }
 
 void FGrassSceneProxy::PerformGPUCulling(FRHICommandListImmediate& RHICmdList, const FSceneView* View) const
 {
-    if (!bEnableFrustumCulling || !VisiblePositionBufferUAV.IsValid() || !IndirectArgsBufferUAV.IsValid())
+    if (!bEnableFrustumCulling || !InstanceBuffers.VisibleInstanceBufferUAV.IsValid() || !InstanceBuffers.IndirectArgsBufferUAV.IsValid())
     {
         return;
     }
@@ -766,67 +1403,49 @@ void FGrassSceneProxy::PerformGPUCulling(FRHICommandListImmediate& RHICmdList, c
     }
     bCullingPerformedThisFrame = true;
     LastFrameNumber = CurrentFrameNumber;
+    // 不经过签名检查，下一次带 Hi-Z 的剔除必须完整执行
+    PrimaryCullingHistory.Invalidate();
+    bPrimaryCullingReused = false;
 
     // 检查 LOD 功能是否完全可用（需要所有必要的 buffer）
     const bool bLODFullyEnabled = bEnableLOD && 
-        IndirectArgsBufferLOD1.IsValid() && 
-        IndirectArgsBufferLOD1UAV.IsValid() &&
-        VisiblePositionBufferLOD1.IsValid() &&
-        VisiblePositionBufferLOD1UAV.IsValid();
+        InstanceBuffers.IndirectArgsBufferLOD1.IsValid() && 
+        InstanceBuffers.IndirectArgsBufferLOD1UAV.IsValid() &&
+        InstanceBuffers.VisibleInstanceBufferLOD1.IsValid() &&
+        InstanceBuffers.VisibleInstanceBufferLOD1UAV.IsValid();
+
+    // 不在场景渲染中：剔除在本地的 RDG 中执行 (图形管线)，执行完时输出已经处于绘制需要的状态
+    FRDGBuilder GraphBuilder(RHICmdList, RDG_EVENT_NAME("GrassCulling"));
+    const FGrassCullingGraph Graph(GraphBuilder, false);
+    const FGrassCullingRDGBuffers RDGBuffers(Graph, InstanceBuffers, bLODFullyEnabled);
 
     // ========== Step 1: 重置 Indirect Args Buffer (LOD 0 和 LOD 1) ==========
     {
-        RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::IndirectArgs, ERHIAccess::UAVCompute));
-        if (bLODFullyEnabled)
-        {
-            RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::IndirectArgs, ERHIAccess::UAVCompute));
-        }
-
-        TShaderMapRef<FGrassResetIndirectArgsCS> ResetCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
         FGrassResetIndirectArgsCS::FParameters ResetParams;
-        ResetParams.OutIndirectArgs = IndirectArgsBufferUAV;
-        ResetParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? IndirectArgsBufferLOD1UAV : IndirectArgsBufferUAV;
+        ResetParams.OutIndirectArgs = InstanceBuffers.IndirectArgsBufferUAV;
+        ResetParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? InstanceBuffers.IndirectArgsBufferLOD1UAV : InstanceBuffers.IndirectArgsBufferUAV;
         ResetParams.IndexCountPerInstance = NumIndices;
         ResetParams.IndexCountPerInstanceLOD1 = bLODFullyEnabled ? NumIndicesLOD1 : NumIndices;
         ResetParams.TotalInstanceCount = TotalInstanceCount;
-        
-        FComputeShaderUtils::Dispatch(RHICmdList, ResetCS, ResetParams, FIntVector(1, 1, 1));
+
+        AddGrassResetIndirectArgsPass(Graph, RDGBuffers, ResetParams);
     }
 
     // ========== Step 2: 执行 Frustum Culling ==========
     {
-        RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBuffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        
-        // LOD 1 独立 Buffer 状态转换
-        if (bLODFullyEnabled)
-        {
-            RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        }
-
-        TShaderMapRef<FGrassFrustumCullingCS> CullingCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
         FGrassFrustumCullingCS::FParameters CullingParams;
         
-        CullingParams.InPositions = PositionBufferSRV;
-        CullingParams.InGrassData0 = GrassData0SRV;
-        CullingParams.InGrassData1 = GrassData1SRV;
-        CullingParams.InGrassData2 = GrassData2SRV;
-        CullingParams.OutVisiblePositions = VisiblePositionBufferUAV;
-        CullingParams.OutVisibleGrassData0 = VisibleGrassData0UAV;
-        CullingParams.OutVisibleGrassData1 = VisibleGrassData1UAV;
-        CullingParams.OutVisibleGrassData2 = VisibleGrassData2UAV;
+        CullingParams.InInstances = InstanceBuffers.InstanceBufferSRV;
+        CullingParams.QuantizationMin = InstanceBuffers.Quantization.Min;
+        CullingParams.QuantizationSize = InstanceBuffers.Quantization.Size;
+        CullingParams.OutVisibleInstances = InstanceBuffers.VisibleInstanceBufferUAV;
         // LOD 1 独立输出 Buffers - 只有当 LOD 完全启用时才使用独立 buffer
-        CullingParams.OutVisiblePositionsLOD1 = bLODFullyEnabled ? VisiblePositionBufferLOD1UAV : VisiblePositionBufferUAV;
-        CullingParams.OutVisibleGrassData0LOD1 = bLODFullyEnabled ? VisibleGrassData0BufferLOD1UAV : VisibleGrassData0UAV;
-        CullingParams.OutVisibleGrassData1LOD1 = bLODFullyEnabled ? VisibleGrassData1BufferLOD1UAV : VisibleGrassData1UAV;
-        CullingParams.OutVisibleGrassData2LOD1 = bLODFullyEnabled ? VisibleGrassData2BufferLOD1UAV : VisibleGrassData2UAV;
-        CullingParams.OutIndirectArgs = IndirectArgsBufferUAV;
-        CullingParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? IndirectArgsBufferLOD1UAV : IndirectArgsBufferUAV;
+        CullingParams.OutVisibleInstancesLOD1 = bLODFullyEnabled ? InstanceBuffers.VisibleInstanceBufferLOD1UAV : InstanceBuffers.VisibleInstanceBufferUAV;
+        CullingParams.InstanceBaseOffset = InstanceBuffers.InstanceOffset;
+        CullingParams.VisibleBaseOffset = InstanceBuffers.VisibleInstanceOffset;
+        CullingParams.VisibleBaseOffsetLOD1 = bLODFullyEnabled ? InstanceBuffers.VisibleInstanceLOD1Offset : InstanceBuffers.VisibleInstanceOffset;
+        CullingParams.OutIndirectArgs = InstanceBuffers.IndirectArgsBufferUAV;
+        CullingParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? InstanceBuffers.IndirectArgsBufferLOD1UAV : InstanceBuffers.IndirectArgsBufferUAV;
         CullingParams.TotalInstanceCount = TotalInstanceCount;
         CullingParams.IndexCountPerInstance = NumIndices;
         CullingParams.IndexCountPerInstanceLOD1 = bLODFullyEnabled ? NumIndicesLOD1 : NumIndices;
@@ -835,62 +1454,10 @@ void FGrassSceneProxy::PerformGPUCulling(FRHICommandListImmediate& RHICmdList, c
         
         // 提取视锥平面
         const FMatrix ViewProjectionMatrix = View->ViewMatrices.GetViewProjectionMatrix();
-        FPlane FrustumPlanes[6];
-        
-        // 提取视锥的 6 个平面
-        // Left
-        FrustumPlanes[0] = FPlane(
-            ViewProjectionMatrix.M[0][3] + ViewProjectionMatrix.M[0][0],
-            ViewProjectionMatrix.M[1][3] + ViewProjectionMatrix.M[1][0],
-            ViewProjectionMatrix.M[2][3] + ViewProjectionMatrix.M[2][0],
-            ViewProjectionMatrix.M[3][3] + ViewProjectionMatrix.M[3][0]);
-        // Right
-        FrustumPlanes[1] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][0],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][0],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][0],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][0]);
-        // Bottom
-        FrustumPlanes[2] = FPlane(
-            ViewProjectionMatrix.M[0][3] + ViewProjectionMatrix.M[0][1],
-            ViewProjectionMatrix.M[1][3] + ViewProjectionMatrix.M[1][1],
-            ViewProjectionMatrix.M[2][3] + ViewProjectionMatrix.M[2][1],
-            ViewProjectionMatrix.M[3][3] + ViewProjectionMatrix.M[3][1]);
-        // Top
-        FrustumPlanes[3] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][1],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][1],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][1],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][1]);
-        // Near
-        FrustumPlanes[4] = FPlane(
-            ViewProjectionMatrix.M[0][2],
-            ViewProjectionMatrix.M[1][2],
-            ViewProjectionMatrix.M[2][2],
-            ViewProjectionMatrix.M[3][2]);
-        // Far
-        FrustumPlanes[5] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][2],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][2],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][2],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][2]);
-
-        // 归一化平面并传递给 shader
-        for (int i = 0; i < 6; i++)
+        const FGrassFrustum Frustum = FGrassFrustum::FromViewProjection(ViewProjectionMatrix);
+        for (int32 i = 0; i < 6; i++)
         {
-            float Length = FMath::Sqrt(
-                FrustumPlanes[i].X * FrustumPlanes[i].X + 
-                FrustumPlanes[i].Y * FrustumPlanes[i].Y + 
-                FrustumPlanes[i].Z * FrustumPlanes[i].Z);
-            if (Length > SMALL_NUMBER)
-            {
-                FrustumPlanes[i].X /= Length;
-                FrustumPlanes[i].Y /= Length;
-                FrustumPlanes[i].Z /= Length;
-                FrustumPlanes[i].W /= Length;
-            }
-            CullingParams.FrustumPlanes[i] = FVector4f(
-                FrustumPlanes[i].X, FrustumPlanes[i].Y, FrustumPlanes[i].Z, FrustumPlanes[i].W);
+            CullingParams.FrustumPlanes[i] = Frustum.Planes[i];
         }
         
         // LocalToWorld 变换矩阵
@@ -900,36 +1467,31 @@ void FGrassSceneProxy::PerformGPUCulling(FRHICommandListImmediate& RHICmdList, c
         CullingParams.BoundingRadius = GrassBoundingRadius;
         CullingParams.MaxVisibleDistance = bEnableDistanceCulling ? MaxVisibleDistance : 0.0f;
         CullingParams.CameraPosition = FVector3f(View->ViewMatrices.GetViewOrigin());
+        CullingParams.DensityScale = 1.0f;
 
-        // Dispatch
-        int32 NumGroups = FMath::DivideAndRoundUp((int32)TotalInstanceCount, 64);
-        FComputeShaderUtils::Dispatch(RHICmdList, CullingCS, CullingParams, FIntVector(NumGroups, 1, 1));
+        // Dispatch (分块层次剔除或逐实例)
+        DispatchGrassInstanceCulling(Graph, InstanceBuffers, RDGBuffers, CullingParams, nullptr, Frustum, GetLocalToWorld(), bStableVisibleOrder);
     }
 
-    // ========== Step 3: 转换资源状态 ==========
-    RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::UAVCompute, ERHIAccess::IndirectArgs));
-    if (bLODFullyEnabled)
-    {
-        RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::IndirectArgs));
-        RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    }
+    // ========== Step 3: 转换为绘制需要的状态并执行 ==========
+    FGrassCullingGraph::PublishDrawnBuffers(GraphBuilder);
+    GraphBuilder.Execute();
+}
+
+bool FGrassSceneProxy::UsesTwoPhaseOcclusion() const
+{
+    return UseGrassTwoPhaseOcclusion(InstanceBuffers, bEnableOcclusionCulling, bTwoPhaseOcclusion);
 }
 
 void FGrassSceneProxy::PerformGPUCullingWithHiZ(
-    FRHICommandListImmediate& RHICmdList,
+    const FGrassCullingGraph& Graph,
     const FSceneView* View,
-    FRHITexture* HiZTexture,
+    FRDGTextureRef HiZTexture,
     FIntPoint HiZSize,
-    const FMatrix& HiZViewProjectionMatrix) const
+    const FMatrix& HiZViewProjectionMatrix,
+    const FSceneView* StereoPairView) const
 {
-    if (!bEnableFrustumCulling || !VisiblePositionBufferUAV.IsValid() || !IndirectArgsBufferUAV.IsValid())
+    if (!bEnableFrustumCulling || !InstanceBuffers.VisibleInstanceBufferUAV.IsValid() || !InstanceBuffers.IndirectArgsBufferUAV.IsValid())
     {
         return;
     }
@@ -943,170 +1505,369 @@ void FGrassSceneProxy::PerformGPUCullingWithHiZ(
     bCullingPerformedThisFrame = true;
     LastFrameNumber = CurrentFrameNumber;
 
-    // 检查 LOD 功能是否完全可用
-    const bool bLODFullyEnabled = bEnableLOD && 
-        IndirectArgsBufferLOD1.IsValid() && 
-        IndirectArgsBufferLOD1UAV.IsValid() &&
-        VisiblePositionBufferLOD1.IsValid() &&
-        VisiblePositionBufferLOD1UAV.IsValid();
+    // 立体渲染的两只眼睛只做视锥 / 距离剔除 (Hi-Z 只有一只眼睛的深度)，不执行后 Pass
+    FRDGTextureRef CullHiZTexture = StereoPairView ? nullptr : HiZTexture;
+    const bool bUseHiZ = bEnableOcclusionCulling && CullHiZTexture != nullptr && HiZSize.X > 0 && HiZSize.Y > 0;
+    EGrassOcclusionPhase Phase = UsesTwoPhaseOcclusion() && !StereoPairView ? EGrassOcclusionPhase::Main : EGrassOcclusionPhase::Single;
 
-    // ========== Step 1: 重置 Indirect Args Buffer ==========
+    // 单 Pass 的远处实例可以分摊 Hi-Z 测试 (可见位保存每个实例最近一次的测试结果)
+    const bool bAmortize = Phase == EGrassOcclusionPhase::Single && bUseHiZ && InstanceBuffers.HasVisibilityBits()
+        && CVarGrassCullingAmortizeFrames.GetValueOnRenderThread() > 1;
+    if (bAmortize)
     {
-        RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::IndirectArgs, ERHIAccess::UAVCompute));
-        if (bLODFullyEnabled)
+        Phase = EGrassOcclusionPhase::Amortized;
+        if (AmortizedVisibilityBits != InstanceBuffers.VisibilityBitsBuffer)
         {
-            RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::IndirectArgs, ERHIAccess::UAVCompute));
+            // 开始分摊 (或实例 Buffer 已经交换)：所有实例先视为没有被遮挡，两阶段遮挡剔除留下的位含义不同
+            FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess();
+            FGrassCullingGraph::AddAccess(*PassAccess, Graph.RegisterBuffer(InstanceBuffers.VisibilityBitsBuffer, TEXT("GrassVisibilityBits"), ERHIAccess::UAVCompute), ERHIAccess::UAVCompute);
+
+            FRHIUnorderedAccessView* VisibilityBitsUAV = InstanceBuffers.VisibilityBitsBufferUAV;
+            Graph.AddPass(
+                RDG_EVENT_NAME("GrassResetVisibilityBits"),
+                PassAccess,
+                [VisibilityBitsUAV](FRHIComputeCommandList& RHICmdList)
+                {
+                    RHICmdList.ClearUAVUint(VisibilityBitsUAV, FUintVector4(~0u, ~0u, ~0u, ~0u));
+                });
+            AmortizedVisibilityBits = InstanceBuffers.VisibilityBitsBuffer;
+            PrimaryCullingHistory.Invalidate();
         }
+    }
+    else
+    {
+        AmortizedVisibilityBits = nullptr;
+    }
+
+    // 相机、变换和设置都没有变化：沿用上一次的可见列表和 Indirect Args (两阶段遮挡剔除的后 Pass 随之跳过)
+    bPrimaryCullingReused = ShouldReuseCulling(PrimaryCullingHistory, *View, StereoPairView, InstanceBuffers, bUseHiZ, Phase, FGrassViewCullingBudget());
+    if (bPrimaryCullingReused)
+    {
+        return;
+    }
 
-        TShaderMapRef<FGrassResetIndirectArgsCS> ResetCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+    CullWithHiZ_RenderThread(Graph, InstanceBuffers, View, CullHiZTexture, HiZSize, HiZViewProjectionMatrix, Phase,
+        FGrassViewCullingBudget(), StereoPairView);
+}
+
+void FGrassSceneProxy::PerformGPUCullingPostPass(
+    const FGrassCullingGraph& Graph,
+    const FSceneView* View,
+    FRDGTextureRef HiZTexture,
+    FIntPoint HiZSize,
+    const FMatrix& HiZViewProjectionMatrix) const
+{
+    // 只接在本帧的主 Pass 之后 (可见列表和可见位都来自主 Pass)
+    const uint32 CurrentFrameNumber = GFrameNumber;
+    if (!bCullingPerformedThisFrame || LastFrameNumber != CurrentFrameNumber || LastPostPassFrameNumber == CurrentFrameNumber || !UsesTwoPhaseOcclusion()
+        || bPrimaryCullingReused)
+    {
+        return;
+    }
+    LastPostPassFrameNumber = CurrentFrameNumber;
+
+    CullWithHiZ_RenderThread(Graph, InstanceBuffers, View, HiZTexture, HiZSize, HiZViewProjectionMatrix, EGrassOcclusionPhase::Post);
+}
+
+void FGrassSceneProxy::PerformGPUCullingForView(const FGrassCullingGraph& Graph, const FSceneView* View, bool bCaptureView,
+    const FSceneView* StereoPairView) const
+{
+    if (!View || !bEnableFrustumCulling || !bUseIndirectDraw || !InstanceBuffers.IsValid()
+        || !InstanceBuffers.VisibleInstanceBufferUAV.IsValid() || !InstanceBuffers.IndirectArgsBufferUAV.IsValid())
+    {
+        return;
+    }
+
+    // 同一个视图在一帧中只剔除一次
+    const uint32 FrameNumber = View->Family->FrameNumber;
+    if (ViewCullingPool.Find(*View, FrameNumber))
+    {
+        return;
+    }
+
+    FGrassViewCullingSlot* Slot = ViewCullingPool.Acquire(Graph.GraphBuilder.RHICmdList, *View, InstanceBuffers, FMath::Max(CVarGrassCullingMaxViewSlots.GetValueOnRenderThread(), 0), FrameNumber);
+    if (!Slot)
+    {
+        return;
+    }
+
+    // 主视图的 Hi-Z 不能用于其他视图，次要视图只做视锥 / 距离剔除
+    const bool bApplyBudget = bCaptureView && CVarGrassCullingCaptureBudget.GetValueOnRenderThread() != 0;
+    const FGrassViewCullingBudget& Budget = bApplyBudget ? CaptureBudget : FGrassViewCullingBudget();
+    if (ShouldReuseCulling(Slot->History, *View, StereoPairView, Slot->Buffers, false, EGrassOcclusionPhase::Single, Budget))
+    {
+        return;
+    }
+
+    CullWithHiZ_RenderThread(Graph, Slot->Buffers, View, nullptr, FIntPoint::ZeroValue, FMatrix::Identity, EGrassOcclusionPhase::Single, Budget, StereoPairView);
+}
+
+bool FGrassSceneProxy::ShouldReuseCulling(
+    FGrassCullingHistory& History,
+    const FSceneView& View,
+    const FSceneView* StereoPairView,
+    const FGrassInstanceBuffers& Buffers,
+    bool bUsesHiZ,
+    EGrassOcclusionPhase Phase,
+    const FGrassViewCullingBudget& Budget) const
+{
+    if (CVarGrassCullingTemporalReuse.GetValueOnRenderThread() == 0)
+    {
+        History.Invalidate();
+        INC_DWORD_STAT(STAT_GrassCullingFullViews);
+        return false;
+    }
+
+    FGrassCullingSignature Signature;
+    Signature.ViewProjection = View.ViewMatrices.GetViewMatrix() * View.ViewMatrices.GetProjectionNoAAMatrix();
+    if (StereoPairView)
+    {
+        Signature.StereoViewProjection = StereoPairView->ViewMatrices.GetViewMatrix() * StereoPairView->ViewMatrices.GetProjectionNoAAMatrix();
+    }
+    Signature.LocalToWorld = GetLocalToWorld();
+    Signature.ViewOrigin = View.ViewMatrices.GetViewOrigin();
+    Signature.OutputKey = Buffers.IndirectArgsBuffer.GetReference();
+    Signature.InstanceKey = Buffers.InstanceAllocation.Get();
+
+    // 改变剔除输出的设置 (组件属性改变时代理重建，History 随之重置)
+    uint32 SettingsHash = GetTypeHash((int32)Phase);
+    SettingsHash = HashCombineFast(SettingsHash, GetTypeHash(bUsesHiZ));
+    SettingsHash = HashCombineFast(SettingsHash, GetTypeHash(Budget.MaxDistanceScale));
+    SettingsHash = HashCombineFast(SettingsHash, GetTypeHash(Budget.LOD0DistanceScale));
+    SettingsHash = HashCombineFast(SettingsHash, GetTypeHash(Budget.DensityScale));
+    SettingsHash = HashCombineFast(SettingsHash, GetTypeHash(StereoPairView && View.bIsInstancedStereoEnabled));
+    SettingsHash = HashCombineFast(SettingsHash, GetTypeHash(UseGrassStableVisibleOrder(Buffers, bStableVisibleOrder)));
+    Signature.SettingsHash = SettingsHash;
+
+    const bool bReuse = History.ShouldReuse(
+        Signature,
+        bUsesHiZ,
+        View.Family->FrameNumber,
+        (uint32)FMath::Max(CVarGrassCullingTemporalReuseMaxFrames.GetValueOnRenderThread(), 0),
+        CVarGrassCullingTemporalReuseMatrixTolerance.GetValueOnRenderThread(),
+        CVarGrassCullingTemporalReusePositionTolerance.GetValueOnRenderThread());
+
+    if (bReuse)
+    {
+        INC_DWORD_STAT(STAT_GrassCullingReusedViews);
+    }
+    else
+    {
+        INC_DWORD_STAT(STAT_GrassCullingFullViews);
+    }
+    return bReuse;
+}
+
+bool FGrassSceneProxy::CastsGrassShadows() const
+{
+    // GetViewRelevance / 阴影收集可能在渲染线程的任务中调用
+    return bCastGrassShadows && bUseIndirectDraw && bEnableFrustumCulling && CVarGrassShadows.GetValueOnAnyThread() != 0;
+}
+
+void FGrassSceneProxy::BeginShadowCulling_RenderThread(FRHICommandListImmediate& RHICmdList) const
+{
+    const bool bShadows = CastsGrassShadows() && InstanceBuffers.IsValid() && TotalInstanceCount > 0;
+    ShadowCascadePool.Begin(RHICmdList, InstanceBuffers, bShadows ? FMath::Max(CVarGrassShadowMaxCascades.GetValueOnRenderThread(), 0) : 0);
+}
+
+void FGrassSceneProxy::PerformShadowCulling_RenderThread(const FGrassCullingGraph& Graph) const
+{
+    TArray<const FGrassShadowCascade*, TInlineAllocator<8>> Cascades;
+    ShadowCascadePool.TakePendingCascades(Cascades);
+    if (Cascades.Num() == 0)
+    {
+        return;
+    }
+
+    RDG_GPU_STAT_SCOPE(Graph.GraphBuilder, GrassShadowCulling);
+    for (const FGrassShadowCascade* Cascade : Cascades)
+    {
+        CullShadowCascade_RenderThread(Graph, *Cascade);
+    }
+}
+
+void FGrassSceneProxy::CullShadowCascade_RenderThread(const FGrassCullingGraph& Graph, const FGrassShadowCascade& Cascade) const
+{
+    const FGrassInstanceBuffers& Buffers = Cascade.Buffers;
+    const int32 ShadowNumIndices = UsesLOD1ForShadow() ? NumIndicesLOD1 : NumIndices;
+    const FGrassCullingRDGBuffers RDGBuffers(Graph, Buffers, false);
+
+    // ========== Step 1: 重置 Indirect Args (LOD 1 的参数写到同一个 Buffer) ==========
+    {
         FGrassResetIndirectArgsCS::FParameters ResetParams;
-        ResetParams.OutIndirectArgs = IndirectArgsBufferUAV;
-        ResetParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? IndirectArgsBufferLOD1UAV : IndirectArgsBufferUAV;
-        ResetParams.IndexCountPerInstance = NumIndices;
-        ResetParams.IndexCountPerInstanceLOD1 = bLODFullyEnabled ? NumIndicesLOD1 : NumIndices;
+        ResetParams.OutIndirectArgs = Buffers.IndirectArgsBufferUAV;
+        ResetParams.OutIndirectArgsLOD1 = Buffers.IndirectArgsBufferUAV;
+        ResetParams.IndexCountPerInstance = ShadowNumIndices;
+        ResetParams.IndexCountPerInstanceLOD1 = ShadowNumIndices;
         ResetParams.TotalInstanceCount = TotalInstanceCount;
-        
-        FComputeShaderUtils::Dispatch(RHICmdList, ResetCS, ResetParams, FIntVector(1, 1, 1));
+        AddGrassResetIndirectArgsPass(Graph, RDGBuffers, ResetParams);
     }
 
-    // ========== Step 2: 执行 Frustum + Hi-Z Occlusion Culling ==========
+    // ========== Step 2: 级联剔除体 + 阴影距离 + 阴影密度 (LOD0Distance = 0，所有可见实例写入同一个列表) ==========
     {
-        RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBuffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2Buffer, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-        
-        if (bLODFullyEnabled)
+        FGrassFrustumCullingCS::FParameters CullingParams;
+        CullingParams.InInstances = Buffers.InstanceBufferSRV;
+        CullingParams.QuantizationMin = Buffers.Quantization.Min;
+        CullingParams.QuantizationSize = Buffers.Quantization.Size;
+        CullingParams.OutVisibleInstances = Buffers.VisibleInstanceBufferUAV;
+        CullingParams.OutVisibleInstancesLOD1 = Buffers.VisibleInstanceBufferUAV;
+        CullingParams.InstanceBaseOffset = Buffers.InstanceOffset;
+        CullingParams.VisibleBaseOffset = Buffers.VisibleInstanceOffset;
+        CullingParams.VisibleBaseOffsetLOD1 = Buffers.VisibleInstanceOffset;
+        CullingParams.OutIndirectArgs = Buffers.IndirectArgsBufferUAV;
+        CullingParams.OutIndirectArgsLOD1 = Buffers.IndirectArgsBufferUAV;
+
+        CullingParams.TotalInstanceCount = TotalInstanceCount;
+        CullingParams.IndexCountPerInstance = ShadowNumIndices;
+        CullingParams.IndexCountPerInstanceLOD1 = ShadowNumIndices;
+        CullingParams.LOD0Distance = 0.0f;
+
+        for (int32 i = 0; i < 6; i++)
         {
-            RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
-            RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2BufferLOD1, ERHIAccess::SRVMask, ERHIAccess::UAVCompute));
+            CullingParams.FrustumPlanes[i] = Cascade.Frustum.Planes[i];
         }
 
-        TShaderMapRef<FGrassFrustumCullingCS> CullingCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        // 阴影距离不超过可见距离 (看不到的草不需要投射阴影)
+        const float ShadowDistance = bEnableDistanceCulling ? FMath::Min(ShadowMaxDistance, MaxVisibleDistance) : ShadowMaxDistance;
+        CullingParams.LocalToWorld = FMatrix44f(GetLocalToWorld());
+        CullingParams.BoundingRadius = GrassBoundingRadius;
+        CullingParams.MaxVisibleDistance = ShadowDistance;
+        CullingParams.CameraPosition = FVector3f(Cascade.ViewOrigin);
+        CullingParams.DensityScale = ShadowDensity;
+
+        // 阴影视图没有 Hi-Z (DispatchGrassInstanceCullingPasses 绑定占位纹理)
+        CullingParams.HiZTexture = nullptr;
+        CullingParams.ViewProjectionMatrix = FMatrix44f::Identity;
+
+        DispatchGrassInstanceCulling(Graph, Buffers, RDGBuffers, CullingParams, nullptr, Cascade.Frustum, GetLocalToWorld(), bStableVisibleOrder);
+    }
+}
+
+void FGrassSceneProxy::CullWithHiZ_RenderThread(
+    const FGrassCullingGraph& Graph,
+    const FGrassInstanceBuffers& Buffers,
+    const FSceneView* View,
+    FRDGTextureRef HiZTexture,
+    FIntPoint HiZSize,
+    const FMatrix& HiZViewProjectionMatrix,
+    EGrassOcclusionPhase Phase,
+    const FGrassViewCullingBudget& Budget,
+    const FSceneView* StereoPairView) const
+{
+    // 检查 LOD 功能是否完全可用
+    const bool bLODFullyEnabled = bEnableLOD && 
+        Buffers.IndirectArgsBufferLOD1.IsValid() && 
+        Buffers.IndirectArgsBufferLOD1UAV.IsValid() &&
+        Buffers.VisibleInstanceBufferLOD1.IsValid() &&
+        Buffers.VisibleInstanceBufferLOD1UAV.IsValid();
+    const FGrassCullingRDGBuffers RDGBuffers(Graph, Buffers, bLODFullyEnabled);
+
+    // ========== Step 1: 重置 Indirect Args Buffer (后 Pass 追加在主 Pass 之后，不重置) ==========
+    if (Phase != EGrassOcclusionPhase::Post)
+    {
+        FGrassResetIndirectArgsCS::FParameters ResetParams;
+        ResetParams.OutIndirectArgs = Buffers.IndirectArgsBufferUAV;
+        ResetParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? Buffers.IndirectArgsBufferLOD1UAV : Buffers.IndirectArgsBufferUAV;
+        ResetParams.IndexCountPerInstance = NumIndices;
+        ResetParams.IndexCountPerInstanceLOD1 = bLODFullyEnabled ? NumIndicesLOD1 : NumIndices;
+        ResetParams.TotalInstanceCount = TotalInstanceCount;
+
+        AddGrassResetIndirectArgsPass(Graph, RDGBuffers, ResetParams);
+    }
+
+    // ========== Step 2: 执行 Frustum + Hi-Z Occlusion Culling ==========
+    {
         FGrassFrustumCullingCS::FParameters CullingParams;
         
         // Input buffers
-        CullingParams.InPositions = PositionBufferSRV;
-        CullingParams.InGrassData0 = GrassData0SRV;
-        CullingParams.InGrassData1 = GrassData1SRV;
-        CullingParams.InGrassData2 = GrassData2SRV;
+        CullingParams.InInstances = Buffers.InstanceBufferSRV;
+        CullingParams.QuantizationMin = Buffers.Quantization.Min;
+        CullingParams.QuantizationSize = Buffers.Quantization.Size;
         
         // Output buffers (LOD 0)
-        CullingParams.OutVisiblePositions = VisiblePositionBufferUAV;
-        CullingParams.OutVisibleGrassData0 = VisibleGrassData0UAV;
-        CullingParams.OutVisibleGrassData1 = VisibleGrassData1UAV;
-        CullingParams.OutVisibleGrassData2 = VisibleGrassData2UAV;
+        CullingParams.OutVisibleInstances = Buffers.VisibleInstanceBufferUAV;
         
         // Output buffers (LOD 1)
-        CullingParams.OutVisiblePositionsLOD1 = bLODFullyEnabled ? VisiblePositionBufferLOD1UAV : VisiblePositionBufferUAV;
-        CullingParams.OutVisibleGrassData0LOD1 = bLODFullyEnabled ? VisibleGrassData0BufferLOD1UAV : VisibleGrassData0UAV;
-        CullingParams.OutVisibleGrassData1LOD1 = bLODFullyEnabled ? VisibleGrassData1BufferLOD1UAV : VisibleGrassData1UAV;
-        CullingParams.OutVisibleGrassData2LOD1 = bLODFullyEnabled ? VisibleGrassData2BufferLOD1UAV : VisibleGrassData2UAV;
+        CullingParams.OutVisibleInstancesLOD1 = bLODFullyEnabled ? Buffers.VisibleInstanceBufferLOD1UAV : Buffers.VisibleInstanceBufferUAV;
+        CullingParams.InstanceBaseOffset = Buffers.InstanceOffset;
+        CullingParams.VisibleBaseOffset = Buffers.VisibleInstanceOffset;
+        CullingParams.VisibleBaseOffsetLOD1 = bLODFullyEnabled ? Buffers.VisibleInstanceLOD1Offset : Buffers.VisibleInstanceOffset;
         
-        CullingParams.OutIndirectArgs = IndirectArgsBufferUAV;
-        CullingParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? IndirectArgsBufferLOD1UAV : IndirectArgsBufferUAV;
+        CullingParams.OutIndirectArgs = Buffers.IndirectArgsBufferUAV;
+        CullingParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? Buffers.IndirectArgsBufferLOD1UAV : Buffers.IndirectArgsBufferUAV;
         
         // Instance params
         CullingParams.TotalInstanceCount = TotalInstanceCount;
         CullingParams.IndexCountPerInstance = NumIndices;
         CullingParams.IndexCountPerInstanceLOD1 = bLODFullyEnabled ? NumIndicesLOD1 : NumIndices;
-        CullingParams.LOD0Distance = bLODFullyEnabled ? LOD0Distance : 0.0f;
-        
-        // 提取视锥平面
-        const FMatrix ViewProjectionMatrix = View->ViewMatrices.GetViewProjectionMatrix();
-        FPlane FrustumPlanes[6];
+        CullingParams.LOD0Distance = bLODFullyEnabled ? LOD0Distance * Budget.LOD0DistanceScale : 0.0f;
         
-        // Left
-        FrustumPlanes[0] = FPlane(
-            ViewProjectionMatrix.M[0][3] + ViewProjectionMatrix.M[0][0],
-            ViewProjectionMatrix.M[1][3] + ViewProjectionMatrix.M[1][0],
-            ViewProjectionMatrix.M[2][3] + ViewProjectionMatrix.M[2][0],
-            ViewProjectionMatrix.M[3][3] + ViewProjectionMatrix.M[3][0]);
-        // Right
-        FrustumPlanes[1] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][0],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][0],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][0],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][0]);
-        // Bottom
-        FrustumPlanes[2] = FPlane(
-            ViewProjectionMatrix.M[0][3] + ViewProjectionMatrix.M[0][1],
-            ViewProjectionMatrix.M[1][3] + ViewProjectionMatrix.M[1][1],
-            ViewProjectionMatrix.M[2][3] + ViewProjectionMatrix.M[2][1],
-            ViewProjectionMatrix.M[3][3] + ViewProjectionMatrix.M[3][1]);
-        // Top
-        FrustumPlanes[3] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][1],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][1],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][1],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][1]);
-        // Near
-        FrustumPlanes[4] = FPlane(
-            ViewProjectionMatrix.M[0][2],
-            ViewProjectionMatrix.M[1][2],
-            ViewProjectionMatrix.M[2][2],
-            ViewProjectionMatrix.M[3][2]);
-        // Far
-        FrustumPlanes[5] = FPlane(
-            ViewProjectionMatrix.M[0][3] - ViewProjectionMatrix.M[0][2],
-            ViewProjectionMatrix.M[1][3] - ViewProjectionMatrix.M[1][2],
-            ViewProjectionMatrix.M[2][3] - ViewProjectionMatrix.M[2][2],
-            ViewProjectionMatrix.M[3][3] - ViewProjectionMatrix.M[3][2]);
-
-        // 归一化平面
-        for (int i = 0; i < 6; i++)
+        // 提取视锥平面 (立体渲染时是两只眼睛视锥的保守并集，距离和 LOD 从两眼的中点计算，两只眼睛看到相同的 LOD)
+        FVector CameraPosition = View->ViewMatrices.GetViewOrigin();
+        if (StereoPairView)
         {
-            float Length = FMath::Sqrt(
-                FrustumPlanes[i].X * FrustumPlanes[i].X + 
-                FrustumPlanes[i].Y * FrustumPlanes[i].Y + 
-                FrustumPlanes[i].Z * FrustumPlanes[i].Z);
-            if (Length > SMALL_NUMBER)
-            {
-                FrustumPlanes[i].X /= Length;
-                FrustumPlanes[i].Y /= Length;
-                FrustumPlanes[i].Z /= Length;
-                FrustumPlanes[i].W /= Length;
-            }
-            CullingParams.FrustumPlanes[i] = FVector4f(
-                FrustumPlanes[i].X, FrustumPlanes[i].Y, FrustumPlanes[i].Z, FrustumPlanes[i].W);
+            CameraPosition = (CameraPosition + StereoPairView->ViewMatrices.GetViewOrigin()) * 0.5;
+        }
+        const FGrassFrustum Frustum = StereoPairView
+            ? FGrassFrustum::FromViewProjectionUnion(View->ViewMatrices.GetViewProjectionMatrix(), StereoPairView->ViewMatrices.GetViewProjectionMatrix())
+            : FGrassFrustum::FromViewProjection(View->ViewMatrices.GetViewProjectionMatrix());
+        for (int32 i = 0; i < 6; i++)
+        {
+            CullingParams.FrustumPlanes[i] = Frustum.Planes[i];
         }
         
         CullingParams.LocalToWorld = FMatrix44f(GetLocalToWorld());
         CullingParams.BoundingRadius = GrassBoundingRadius;
-        CullingParams.MaxVisibleDistance = bEnableDistanceCulling ? MaxVisibleDistance : 0.0f;
-        CullingParams.CameraPosition = FVector3f(View->ViewMatrices.GetViewOrigin());
+        CullingParams.MaxVisibleDistance = bEnableDistanceCulling ? MaxVisibleDistance * Budget.MaxDistanceScale : 0.0f;
+        CullingParams.CameraPosition = FVector3f(CameraPosition);
+        CullingParams.DensityScale = Budget.DensityScale;
         
         // ========== Hi-Z 遮挡剔除参数 ==========
         const bool bUseHiZ = bEnableOcclusionCulling && HiZTexture != nullptr && HiZSize.X > 0 && HiZSize.Y > 0;
         
+        // Hi-Z 纹理在 Pass 执行时绑定 (DispatchGrassInstanceCullingPasses)
         CullingParams.bEnableOcclusionCulling = bUseHiZ ? 1 : 0;
-        CullingParams.HiZTexture = bUseHiZ ? HiZTexture : GBlackTexture->TextureRHI.GetReference();
         CullingParams.HiZSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
         CullingParams.HiZSize = bUseHiZ ? FVector2f(HiZSize.X, HiZSize.Y) : FVector2f(1.0f, 1.0f);
-        // 使用上一帧的 ViewProjectionMatrix 进行遮挡测试（因为 Hi-Z 是上一帧生成的）
+        // 使用生成 Hi-Z 时的 ViewProjectionMatrix 进行遮挡测试 (主 Pass / 单 Pass 是上一帧的，后 Pass 是当前帧的)
         CullingParams.ViewProjectionMatrix = FMatrix44f(HiZViewProjectionMatrix);
 
-        // Dispatch
-        int32 NumGroups = FMath::DivideAndRoundUp((int32)TotalInstanceCount, 64);
-        FComputeShaderUtils::Dispatch(RHICmdList, CullingCS, CullingParams, FIntVector(NumGroups, 1, 1));
+        // 分摊的单 Pass：每帧测试 1 / AmortizeFrames 的远处剔除块
+        if (Phase == EGrassOcclusionPhase::Amortized)
+        {
+            const uint32 AmortizeFrames = (uint32)FMath::Max(CVarGrassCullingAmortizeFrames.GetValueOnRenderThread(), 1);
+            CullingParams.AmortizeFrames = AmortizeFrames;
+            CullingParams.AmortizeFrameIndex = View->Family->FrameNumber % AmortizeFrames;
+            CullingParams.AmortizeDistance = FMath::Max(CVarGrassCullingAmortizeDistance.GetValueOnRenderThread(), 0.0f);
+        }
+
+        // Dispatch (分块层次剔除或逐实例)
+        DispatchGrassInstanceCulling(Graph, Buffers, RDGBuffers, CullingParams, bUseHiZ ? HiZTexture : nullptr, Frustum, GetLocalToWorld(), bStableVisibleOrder, Phase);
     }
 
-    // ========== Step 3: 转换资源状态 ==========
-    RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBuffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2Buffer, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-    RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBuffer, ERHIAccess::UAVCompute, ERHIAccess::IndirectArgs));
-    if (bLODFullyEnabled)
+    // ========== 实例化立体渲染：每个可见实例绘制两次 (Vertex Factory 用 InstanceID 的低位选择眼睛) ==========
+    if (StereoPairView && View->bIsInstancedStereoEnabled)
     {
-        RHICmdList.Transition(FRHITransitionInfo(IndirectArgsBufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::IndirectArgs));
-        RHICmdList.Transition(FRHITransitionInfo(VisiblePositionBufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData0BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData1BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
-        RHICmdList.Transition(FRHITransitionInfo(VisibleGrassData2BufferLOD1, ERHIAccess::UAVCompute, ERHIAccess::SRVMask));
+        FGrassRDGPassAccess* PassAccess = Graph.AllocPassAccess();
+        FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.IndirectArgs, ERHIAccess::UAVCompute);
+        FGrassCullingGraph::AddAccess(*PassAccess, RDGBuffers.IndirectArgsLOD1, ERHIAccess::UAVCompute);
+
+        TShaderMapRef<FGrassApplyInstanceFactorCS> InstanceFactorCS(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        FGrassApplyInstanceFactorCS::FParameters InstanceFactorParams;
+        InstanceFactorParams.OutIndirectArgs = Buffers.IndirectArgsBufferUAV;
+        InstanceFactorParams.OutIndirectArgsLOD1 = bLODFullyEnabled ? Buffers.IndirectArgsBufferLOD1UAV : Buffers.IndirectArgsBufferUAV;
+        InstanceFactorParams.InstanceFactor = 2;
+        InstanceFactorParams.bScaleInstanceCountLOD1 = bLODFullyEnabled ? 1 : 0;
+        Graph.AddPass(
+            RDG_EVENT_NAME("GrassApplyStereoInstanceFactor"),
+            PassAccess,
+            [InstanceFactorCS, InstanceFactorParams](FRHIComputeCommandList& RHICmdList)
+            {
+                FComputeShaderUtils::Dispatch(RHICmdList, InstanceFactorCS, InstanceFactorParams, FIntVector(1, 1, 1));
+            });
     }
+
+    // 可见列表和 Indirect Args 在下一次 PublishDrawnBuffers 时转换为绘制需要的状态
 }
 
 FGrassSceneProxy::~FGrassSceneProxy()
@@ -1143,7 +1904,22 @@ SIZE_T FGrassSceneProxy::GetTypeHash() const
 
 uint32 FGrassSceneProxy::GetMemoryFootprint() const
 {
-    return sizeof(*this);
+    // 草叶 Mesh (LOD 0 + LOD 1) + Proxy 持有的实例 / 可见 / Indirect Args Buffer
+    auto MeshBytes = [](const FStaticMeshVertexBuffers& Buffers, const FRawStaticIndexBuffer& Indices) -> uint64
+    {
+        return (uint64)Buffers.PositionVertexBuffer.GetNumVertices() * Buffers.PositionVertexBuffer.GetStride()
+            + Buffers.StaticMeshVertexBuffer.GetResourceSize()
+            + (uint64)Buffers.ColorVertexBuffer.GetNumVertices() * Buffers.ColorVertexBuffer.GetStride()
+            + Indices.GetIndexDataSize();
+    };
+
+    const uint64 Bytes = sizeof(*this) + GetAllocatedSize()
+        + MeshBytes(VertexBuffers, IndexBuffer)
+        + MeshBytes(VertexBuffersLOD1, IndexBufferLOD1)
+        + InstanceBuffers.GetMemoryFootprint().GetInstanceDataBytes()
+        + ViewCullingPool.GetAllocatedBytes()
+        + ShadowCascadePool.GetAllocatedBytes();
+    return (uint32)FMath::Min<uint64>(Bytes, MAX_uint32);
 }
 
 FPrimitiveViewRelevance FGrassSceneProxy::GetViewRelevance(const FSceneView* View) const
@@ -1162,8 +1938,8 @@ FPrimitiveViewRelevance FGrassSceneProxy::GetViewRelevance(const FSceneView* Vie
     // 支持光照贴图
     Result.bStaticRelevance = false; // 不使用静态光照
     
-    // 支持阴影
-    Result.bShadowRelevance = IsShadowCast(View);
+    // 支持阴影 (只有投射草叶阴影时参与阴影收集)
+    Result.bShadowRelevance = IsShadowCast(View) && CastsGrassShadows();
     
     // 设置材质相关标志
     Result.bUsesSingleLayerWaterMaterial = false;
@@ -1222,6 +1998,46 @@ void FGrassSceneProxy::GetDynamicMeshElements(
             continue;
         }
 
+        // ========== 阴影深度：每个阴影视图领取一个级联槽位，只绘制一个 Mesh (剔除在收集之后由 PerformShadowCulling_RenderThread 执行) ==========
+        if (const FConvexVolume* ShadowCullVolume = Views[ViewIndex]->GetDynamicMeshElementsShadowCullFrustum())
+        {
+            const FGrassShadowCascade* Cascade = CastsGrassShadows()
+                ? ShadowCascadePool.Claim(*ShadowCullVolume, Views[ViewIndex]->GetPreShadowTranslation(), Views[ViewIndex]->ViewMatrices.GetViewOrigin())
+                : nullptr;
+            if (Cascade)
+            {
+                const bool bShadowLOD1 = UsesLOD1ForShadow();
+
+                FMeshBatch& ShadowMesh = Collector.AllocateMesh();
+                ShadowMesh.VertexFactory = bShadowLOD1 ? &VertexFactoryLOD1 : &VertexFactory;
+                ShadowMesh.MaterialRenderProxy = MaterialProxy;
+                ShadowMesh.Type = PT_TriangleList;
+                ShadowMesh.DepthPriorityGroup = SDPG_World;
+                ShadowMesh.ReverseCulling = false;
+                ShadowMesh.CastShadow = true;
+                ShadowMesh.bDisableBackfaceCulling = true;
+
+                FMeshBatchElement& ShadowElement = ShadowMesh.Elements[0];
+                ShadowElement.IndexBuffer = bShadowLOD1 ? &IndexBufferLOD1 : &IndexBuffer;
+                ShadowElement.FirstIndex = 0;
+                ShadowElement.MinVertexIndex = 0;
+                ShadowElement.MaxVertexIndex = (bShadowLOD1 ? NumVerticesLOD1 : NumVertices) - 1;
+                ShadowElement.PrimitiveUniformBuffer = GetUniformBuffer();
+                ShadowElement.NumPrimitives = 0;
+                ShadowElement.NumInstances = 0;
+                ShadowElement.IndirectArgsBuffer = Cascade->Buffers.IndirectArgsBuffer;
+                ShadowElement.IndirectArgsOffset = 0;
+                ShadowElement.UserData = &Cascade->Binding;
+
+                Collector.AddMesh(ViewIndex, ShadowMesh);
+            }
+            continue;
+        }
+
+        // 本帧单独剔除过的视图绘制自己的可见列表，其余视图绘制主视图的剔除输出
+        const FGrassViewCullingSlot* ViewSlot = bUseIndirectDraw ? ViewCullingPool.Find(*Views[ViewIndex], Views[ViewIndex]->Family->FrameNumber) : nullptr;
+        const FGrassInstanceBuffers& DrawBuffers = ViewSlot ? ViewSlot->Buffers : InstanceBuffers;
+
         // ========== LOD 0: 高质量草叶 (15 顶点) ==========
         {
             FMeshBatch& Mesh = Collector.AllocateMesh();
@@ -1241,13 +2057,14 @@ void FGrassSceneProxy::GetDynamicMeshElements(
             Element.MaxVertexIndex = NumVertices - 1;
             Element.PrimitiveUniformBuffer = GetUniformBuffer();
 
-            if (bUseIndirectDraw && IndirectArgsBuffer.IsValid())
+            if (bUseIndirectDraw && DrawBuffers.IndirectArgsBuffer.IsValid())
             {
                 // Indirect Draw: GPU driven draw call
                 Element.NumPrimitives = 0;
                 Element.NumInstances = 0;
-                Element.IndirectArgsBuffer = IndirectArgsBuffer;
+                Element.IndirectArgsBuffer = DrawBuffers.IndirectArgsBuffer;
                 Element.IndirectArgsOffset = 0;
+                Element.UserData = ViewSlot ? &ViewSlot->BindingLOD0 : nullptr;
             }
             else
             {
@@ -1260,7 +2077,7 @@ void FGrassSceneProxy::GetDynamicMeshElements(
         }
 
         // ========== LOD 1: 简化草叶 (7 顶点) ==========
-        if (bEnableLOD && VertexFactoryLOD1.IsInitialized() && bUseIndirectDraw && IndirectArgsBufferLOD1.IsValid())
+        if (bEnableLOD && VertexFactoryLOD1.IsInitialized() && bUseIndirectDraw && DrawBuffers.IndirectArgsBufferLOD1.IsValid())
         {
             FMeshBatch& MeshLOD1 = Collector.AllocateMesh();
             MeshLOD1.VertexFactory = &VertexFactoryLOD1;
@@ -1282,8 +2099,9 @@ void FGrassSceneProxy::GetDynamicMeshElements(
             // LOD 1 uses its own IndirectArgsBuffer
             ElementLOD1.NumPrimitives = 0;
             ElementLOD1.NumInstances = 0;
-            ElementLOD1.IndirectArgsBuffer = IndirectArgsBufferLOD1;
+            ElementLOD1.IndirectArgsBuffer = DrawBuffers.IndirectArgsBufferLOD1;
             ElementLOD1.IndirectArgsOffset = 0;
+            ElementLOD1.UserData = ViewSlot ? &ViewSlot->BindingLOD1 : nullptr;
 
             Collector.AddMesh(ViewIndex, MeshLOD1);
         }
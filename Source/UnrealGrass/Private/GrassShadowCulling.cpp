@@ -0,0 +1,101 @@
+// GrassShadowCulling.cpp
+// 阴影级联槽位池实现
+
+#include "GrassShadowCulling.h"
+#include "GrassViewCulling.h"
+#include "GrassStats.h"
+#include "ConvexVolume.h"
+#include "RHICommandList.h"
+
+FGrassShadowCascadePool::~FGrassShadowCascadePool()
+{
+    Reset();
+}
+
+void FGrassShadowCascadePool::Begin(FRHICommandListImmediate& RHICmdList, const FGrassInstanceBuffers& Shared, int32 NumCascades)
+{
+    check(IsInRenderingThread());
+
+    FScopeLock Lock(&ClaimLock);
+
+    NumCascades = FMath::Max(NumCascades, 0);
+    while (Cascades.Num() > NumCascades)
+    {
+        const uint64 Bytes = GetGrassCullingOutputBytes(Cascades.Last()->Buffers);
+        AllocatedBytes -= Bytes;
+        DEC_MEMORY_STAT_BY(STAT_GrassShadowCullingMemory, Bytes);
+        Cascades.Pop(EAllowShrinking::No);
+    }
+    while (Cascades.Num() < NumCascades)
+    {
+        Cascades.Add(MakeUnique<FGrassShadowCascade>());
+    }
+
+    for (const TUniquePtr<FGrassShadowCascade>& Cascade : Cascades)
+    {
+        // 新槽位，或实例 Buffer 已经重新生成：阴影只需要一个可见列表
+        FGrassInstanceBuffers& B = Cascade->Buffers;
+        if (B.InstanceAllocation != Shared.InstanceAllocation
+            || B.InstanceCount != Shared.InstanceCount
+            || B.bVisibleIndexLists != Shared.bVisibleIndexLists
+            || !B.IndirectArgsBuffer.IsValid())
+        {
+            const uint64 OldBytes = GetGrassCullingOutputBytes(B);
+            CreateGrassCullingOutput(RHICmdList, Shared, false, TEXT("GrassShadowIndirectArgs"), B);
+            const uint64 NewBytes = GetGrassCullingOutputBytes(B);
+
+            AllocatedBytes += NewBytes - OldBytes;
+            DEC_MEMORY_STAT_BY(STAT_GrassShadowCullingMemory, OldBytes);
+            INC_MEMORY_STAT_BY(STAT_GrassShadowCullingMemory, NewBytes);
+
+            Cascade->Binding = { B.VisibleInstanceBufferSRV.GetReference(), B.VisibleInstanceOffset };
+        }
+
+        Cascade->bClaimed = false;
+        Cascade->bCulled = false;
+    }
+}
+
+const FGrassShadowCascade* FGrassShadowCascadePool::Claim(const FConvexVolume& ShadowCullVolume, const FVector& PreShadowTranslation, const FVector& ViewOrigin)
+{
+    FScopeLock Lock(&ClaimLock);
+
+    for (const TUniquePtr<FGrassShadowCascade>& Cascade : Cascades)
+    {
+        if (!Cascade->bClaimed)
+        {
+            Cascade->bClaimed = true;
+            Cascade->bCulled = false;
+            Cascade->Frustum = FGrassFrustum::FromConvexPlanes(ShadowCullVolume.Planes, PreShadowTranslation);
+            Cascade->ViewOrigin = ViewOrigin;
+            return Cascade.Get();
+        }
+    }
+    return nullptr;
+}
+
+void FGrassShadowCascadePool::TakePendingCascades(TArray<const FGrassShadowCascade*, TInlineAllocator<8>>& OutCascades)
+{
+    check(IsInRenderingThread());
+
+    FScopeLock Lock(&ClaimLock);
+
+    OutCascades.Reset();
+    for (const TUniquePtr<FGrassShadowCascade>& Cascade : Cascades)
+    {
+        if (Cascade->bClaimed && !Cascade->bCulled)
+        {
+            Cascade->bCulled = true;
+            OutCascades.Add(Cascade.Get());
+        }
+    }
+}
+
+void FGrassShadowCascadePool::Reset()
+{
+    FScopeLock Lock(&ClaimLock);
+
+    DEC_MEMORY_STAT_BY(STAT_GrassShadowCullingMemory, AllocatedBytes);
+    AllocatedBytes = 0;
+    Cascades.Reset();
+}
@@ -27,17 +27,11 @@ FGrassVertexFactory::FGrassVertexFactory(ERHIFeatureLevel::Type InFeatureLevel,
 {
 }
 
-void FGrassVertexFactory::SetInstancePositionSRV(FRHIShaderResourceView* InSRV, uint32 InNumInstances)
+void FGrassVertexFactory::SetInstanceSRV(FRHIShaderResourceView* InSRV, uint32 InNumInstances, uint32 InBaseOffset)
 {
-    InstancePositionSRV = InSRV;
+    InstanceSRV = InSRV;
     NumInstances = InNumInstances;
-}
-
-void FGrassVertexFactory::SetGrassDataSRV(FRHIShaderResourceView* InData0SRV, FRHIShaderResourceView* InData1SRV, FRHIShaderResourceView* InData2SRV)
-{
-    GrassData0SRV = InData0SRV;
-    GrassData1SRV = InData1SRV;
-    GrassData2SRV = InData2SRV;
+    InstanceBaseOffset = InBaseOffset;
 }
 
 bool FGrassVertexFactory::ShouldCompilePermutation(const FVertexFactoryShaderPermutationParameters& Parameters)
@@ -63,10 +57,14 @@ IMPLEMENT_TYPE_LAYOUT(FGrassVertexFactoryShaderParameters);
 void FGrassVertexFactoryShaderParameters::Bind(const FShaderParameterMap& ParameterMap)
 {
     // 绑定 Shader 中的参数
-    InstancePositionBuffer.Bind(ParameterMap, TEXT("GrassInstancePositions"));
-    GrassData0Buffer.Bind(ParameterMap, TEXT("GrassData0"));
-    GrassData1Buffer.Bind(ParameterMap, TEXT("GrassData1"));
-    GrassData2Buffer.Bind(ParameterMap, TEXT("GrassData2"));
+    InstanceBuffer.Bind(ParameterMap, TEXT("GrassInstances"));
+    VisibleIndexBuffer.Bind(ParameterMap, TEXT("GrassVisibleIndices"));
+    GrassUseVisibleIndices.Bind(ParameterMap, TEXT("GrassUseVisibleIndices"));
+    GrassInstanceBaseOffset.Bind(ParameterMap, TEXT("GrassInstanceBaseOffset"));
+    GrassVisibleIndexBaseOffset.Bind(ParameterMap, TEXT("GrassVisibleIndexBaseOffset"));
+    GrassQuantizationMin.Bind(ParameterMap, TEXT("GrassQuantizationMin"));
+    GrassQuantizationSize.Bind(ParameterMap, TEXT("GrassQuantizationSize"));
+    GrassTaperAmount.Bind(ParameterMap, TEXT("GrassTaperAmount"));
     GrassLODLevel.Bind(ParameterMap, TEXT("GrassLODLevel"));
     GrassCurvedNormalAmount.Bind(ParameterMap, TEXT("GrassCurvedNormalAmount"));
     GrassViewRotationAmount.Bind(ParameterMap, TEXT("GrassViewRotationAmount"));
@@ -99,42 +97,70 @@ void FGrassVertexFactoryShaderParameters::GetElementShaderBindings(
 {
     const FGrassVertexFactory* GrassVF = static_cast<const FGrassVertexFactory*>(VertexFactory);
 
-    // 将实例位置缓冲区 SRV 绑定到 Shader
-    if (InstancePositionBuffer.IsBound())
+    // 可见列表：默认是 Vertex Factory 上的 (主视图的剔除输出)，次要视图通过 UserData 传入自己的剔除输出
+    FRHIShaderResourceView* InstanceSRV = GrassVF->GetInstanceSRV();
+    uint32 InstanceBaseOffset = GrassVF->GetInstanceBaseOffset();
+    FRHIShaderResourceView* VisibleIndexSRV = GrassVF->GetVisibleIndexSRV();
+    uint32 VisibleIndexBaseOffset = GrassVF->GetVisibleIndexBaseOffset();
+    if (const FGrassVisibleListBinding* ViewBinding = static_cast<const FGrassVisibleListBinding*>(BatchElement.UserData))
     {
-        FRHIShaderResourceView* SRV = GrassVF->GetInstancePositionSRV();
-        if (SRV)
+        if (VisibleIndexSRV)
         {
-            ShaderBindings.Add(InstancePositionBuffer, SRV);
+            VisibleIndexSRV = ViewBinding->SRV;
+            VisibleIndexBaseOffset = ViewBinding->BaseOffset;
         }
-    }
-    
-    // 绑定草叶数据缓冲区
-    if (GrassData0Buffer.IsBound())
-    {
-        FRHIShaderResourceView* SRV = GrassVF->GetGrassData0SRV();
-        if (SRV)
+        else
         {
-            ShaderBindings.Add(GrassData0Buffer, SRV);
+            InstanceSRV = ViewBinding->SRV;
+            InstanceBaseOffset = ViewBinding->BaseOffset;
         }
     }
-    
-    if (GrassData1Buffer.IsBound())
+
+    // 将实例缓冲区 SRV 绑定到 Shader
+    if (InstanceBuffer.IsBound())
     {
-        FRHIShaderResourceView* SRV = GrassVF->GetGrassData1SRV();
-        if (SRV)
+        if (InstanceSRV)
         {
-            ShaderBindings.Add(GrassData1Buffer, SRV);
+            ShaderBindings.Add(InstanceBuffer, InstanceSRV);
         }
     }
-    
-    if (GrassData2Buffer.IsBound())
+
+    // 可见实例索引列表 (没有时绑定空 Buffer，Shader 中不会读取)
+    if (VisibleIndexBuffer.IsBound())
     {
-        FRHIShaderResourceView* SRV = GrassVF->GetGrassData2SRV();
-        if (SRV)
-        {
-            ShaderBindings.Add(GrassData2Buffer, SRV);
-        }
+        ShaderBindings.Add(VisibleIndexBuffer, VisibleIndexSRV ? VisibleIndexSRV : GEmptyStructuredBufferWithUAV->ShaderResourceViewRHI.GetReference());
+    }
+
+    if (GrassUseVisibleIndices.IsBound())
+    {
+        ShaderBindings.Add(GrassUseVisibleIndices, VisibleIndexSRV ? 1u : 0u);
+    }
+
+    // 实例 / 可见索引区间在 Buffer 池页中的起始元素
+    if (GrassInstanceBaseOffset.IsBound())
+    {
+        ShaderBindings.Add(GrassInstanceBaseOffset, InstanceBaseOffset);
+    }
+
+    if (GrassVisibleIndexBaseOffset.IsBound())
+    {
+        ShaderBindings.Add(GrassVisibleIndexBaseOffset, VisibleIndexBaseOffset);
+    }
+
+    // 位置量化范围 (解码实例位置)
+    if (GrassQuantizationMin.IsBound())
+    {
+        ShaderBindings.Add(GrassQuantizationMin, GrassVF->GetQuantization().Min);
+    }
+
+    if (GrassQuantizationSize.IsBound())
+    {
+        ShaderBindings.Add(GrassQuantizationSize, GrassVF->GetQuantization().Size);
+    }
+
+    if (GrassTaperAmount.IsBound())
+    {
+        ShaderBindings.Add(GrassTaperAmount, GrassVF->GetTaperAmount());
     }
     
     // 传递 LOD 级别参数到 Shader
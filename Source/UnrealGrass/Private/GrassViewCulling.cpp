@@ -0,0 +1,378 @@
+// GrassViewCulling.cpp
+// 每视图剔除的槽位池实现 + 剔除结果的时间复用 + 测试 (自动化测试 UnrealGrass.CullingReuse，不需要 RHI)
+
+#include "GrassViewCulling.h"
+#include "GrassBufferArena.h"
+#include "GrassStats.h"
+#include "SceneView.h"
+#include "SceneInterface.h"
+#include "RHICommandList.h"
+
+static constexpr uint32 GrassIndirectArgsBytes = 5 * sizeof(uint32);
+
+bool FGrassCullingSignature::Matches(const FGrassCullingSignature& Other, double MatrixTolerance, double PositionTolerance) const
+{
+    return OutputKey == Other.OutputKey
+        && InstanceKey == Other.InstanceKey
+        && SettingsHash == Other.SettingsHash
+        && ViewOrigin.Equals(Other.ViewOrigin, PositionTolerance)
+        && ViewProjection.Equals(Other.ViewProjection, MatrixTolerance)
+        && StereoViewProjection.Equals(Other.StereoViewProjection, MatrixTolerance)
+        && LocalToWorld.Equals(Other.LocalToWorld, MatrixTolerance);
+}
+
+bool FGrassCullingHistory::ShouldReuse(const FGrassCullingSignature& Current, bool bUsesHiZ, uint32 FrameNumber, uint32 MaxReuseFrames, double MatrixTolerance, double PositionTolerance)
+{
+    if (bValid && Signature.Matches(Current, MatrixTolerance, PositionTolerance))
+    {
+        if (bSettled && (MaxReuseFrames == 0 || FrameNumber - LastCullFrame < MaxReuseFrames))
+        {
+            return true;
+        }
+        // 相机刚刚静止 (这次使用的 Hi-Z 来自相同的相机) 或复用太久
+        bSettled = true;
+    }
+    else
+    {
+        // 不使用 Hi-Z 时剔除结果只取决于签名，下一帧就可以复用
+        bSettled = !bUsesHiZ;
+    }
+
+    Signature = Current;
+    LastCullFrame = FrameNumber;
+    bValid = true;
+    return false;
+}
+
+uint64 GetGrassCullingOutputBytes(const FGrassInstanceBuffers& Buffers)
+{
+    const uint64 VisibleStride = Buffers.bVisibleIndexLists ? sizeof(uint32) : FGrassInstancePacking::PackedStride;
+    return (Buffers.VisibleInstanceAllocation.IsValid() ? (uint64)Buffers.VisibleInstanceAllocation->Count * VisibleStride : 0)
+        + (Buffers.VisibleInstanceLOD1Allocation.IsValid() ? (uint64)Buffers.VisibleInstanceLOD1Allocation->Count * VisibleStride : 0)
+        + (Buffers.IndirectArgsBuffer.IsValid() ? GrassIndirectArgsBytes : 0)
+        + (Buffers.IndirectArgsBufferLOD1.IsValid() ? GrassIndirectArgsBytes : 0);
+}
+
+FGrassViewCullingPool::~FGrassViewCullingPool()
+{
+    Reset();
+}
+
+uint64 FGrassViewCullingPool::GetViewKey(const FSceneView& View, bool& bOutTransient)
+{
+    bOutTransient = View.State == nullptr;
+    return bOutTransient ? (uint64)(UPTRINT)&View : (uint64)View.State->GetViewKey();
+}
+
+/** 剔除输出的 Indirect Args (内容由剔除前的 ResetIndirectArgsCS 写入，只在本帧剔除之后绘制) */
+static void CreateCullingIndirectArgs(FRHICommandListImmediate& RHICmdList, const TCHAR* Name, FBufferRHIRef& OutBuffer, FUnorderedAccessViewRHIRef& OutUAV)
+{
+    LLM_SCOPE_BYTAG(Grass_IndirectArgs);
+    FRHIBufferCreateDesc Desc = FRHIBufferCreateDesc::Create(
+        Name,
+        GrassIndirectArgsBytes,
+        sizeof(uint32),
+        EBufferUsageFlags::DrawIndirect | EBufferUsageFlags::UnorderedAccess | EBufferUsageFlags::ShaderResource)
+        .SetInitialState(ERHIAccess::IndirectArgs);
+    OutBuffer = RHICmdList.CreateBuffer(Desc);
+    OutUAV = RHICmdList.CreateUnorderedAccessView(OutBuffer, FRHIViewDesc::CreateBufferUAV().SetType(FRHIViewDesc::EBufferType::Raw));
+}
+
+void CreateGrassCullingOutput(FRHICommandListImmediate& RHICmdList, const FGrassInstanceBuffers& Shared, bool bWithLOD1, const TCHAR* DebugName, FGrassInstanceBuffers& OutBuffers)
+{
+    // 先拷贝共享部分，再换成自己的剔除输出 (旧的区间和 Buffer 在这里释放)
+    OutBuffers = Shared;
+    OutBuffers.VisibilityBitsBuffer = nullptr;
+    OutBuffers.VisibilityBitsBufferUAV = nullptr;
+
+    const EGrassBufferPool Pool = Shared.bVisibleIndexLists ? EGrassBufferPool::VisibleIndices : EGrassBufferPool::VisibleInstances;
+    auto AllocateVisible = [&](FGrassBufferAllocationRef& OutAllocation, FBufferRHIRef& OutBuffer, FShaderResourceViewRHIRef& OutSRV, FUnorderedAccessViewRHIRef& OutUAV, uint32& OutOffset)
+    {
+        LLM_SCOPE_BYTAG(Grass_VisibleBuffers);
+        OutAllocation = FGrassBufferArena::Get().Allocate(RHICmdList, Pool, Shared.InstanceCount);
+        OutBuffer = OutAllocation->Buffer;
+        OutSRV = OutAllocation->SRV;
+        OutUAV = OutAllocation->UAV;
+        OutOffset = OutAllocation->Offset;
+    };
+
+    FGrassInstanceBuffers& B = OutBuffers;
+    AllocateVisible(B.VisibleInstanceAllocation, B.VisibleInstanceBuffer, B.VisibleInstanceBufferSRV, B.VisibleInstanceBufferUAV, B.VisibleInstanceOffset);
+    CreateCullingIndirectArgs(RHICmdList, DebugName, B.IndirectArgsBuffer, B.IndirectArgsBufferUAV);
+
+    if (bWithLOD1 && Shared.VisibleInstanceBufferLOD1.IsValid() && Shared.IndirectArgsBufferLOD1.IsValid())
+    {
+        AllocateVisible(B.VisibleInstanceLOD1Allocation, B.VisibleInstanceBufferLOD1, B.VisibleInstanceBufferLOD1SRV, B.VisibleInstanceBufferLOD1UAV, B.VisibleInstanceLOD1Offset);
+        CreateCullingIndirectArgs(RHICmdList, *(FString(DebugName) + TEXT("LOD1")), B.IndirectArgsBufferLOD1, B.IndirectArgsBufferLOD1UAV);
+    }
+    else
+    {
+        B.VisibleInstanceLOD1Allocation = nullptr;
+        B.VisibleInstanceBufferLOD1 = nullptr;
+        B.VisibleInstanceBufferLOD1SRV = nullptr;
+        B.VisibleInstanceBufferLOD1UAV = nullptr;
+        B.VisibleInstanceLOD1Offset = 0;
+        B.IndirectArgsBufferLOD1 = nullptr;
+        B.IndirectArgsBufferLOD1UAV = nullptr;
+    }
+}
+
+void FGrassViewCullingPool::InitSlotBuffers(FRHICommandListImmediate& RHICmdList, FGrassViewCullingSlot& Slot, const FGrassInstanceBuffers& Shared)
+{
+    DEC_MEMORY_STAT_BY(STAT_GrassViewCullingMemory, Slot.GetAllocatedBytes());
+    AllocatedBytes -= Slot.GetAllocatedBytes();
+
+    CreateGrassCullingOutput(RHICmdList, Shared, true, TEXT("GrassViewIndirectArgs"), Slot.Buffers);
+
+    Slot.History.Invalidate();
+
+    const FGrassInstanceBuffers& B = Slot.Buffers;
+    Slot.BindingLOD0 = { B.VisibleInstanceBufferSRV.GetReference(), B.VisibleInstanceOffset };
+    Slot.BindingLOD1 = { B.VisibleInstanceBufferLOD1SRV.GetReference(), B.VisibleInstanceLOD1Offset };
+
+    AllocatedBytes += Slot.GetAllocatedBytes();
+    INC_MEMORY_STAT_BY(STAT_GrassViewCullingMemory, Slot.GetAllocatedBytes());
+}
+
+void FGrassViewCullingPool::ReleaseSlot(int32 Index)
+{
+    const uint64 Bytes = Slots[Index]->GetAllocatedBytes();
+    AllocatedBytes -= Bytes;
+    DEC_MEMORY_STAT_BY(STAT_GrassViewCullingMemory, Bytes);
+    Slots.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+FGrassViewCullingSlot* FGrassViewCullingPool::Acquire(FRHICommandListImmediate& RHICmdList, const FSceneView& View, const FGrassInstanceBuffers& Shared, int32 MaxSlots, uint32 FrameNumber)
+{
+    check(IsInRenderingThread());
+
+    bool bTransient = false;
+    const uint64 ViewKey = GetViewKey(View, bTransient);
+
+    // 长时间没有使用的槽位 (关闭的视口、停止更新的捕获) 释放
+    for (int32 Index = Slots.Num() - 1; Index >= 0; --Index)
+    {
+        if (FrameNumber - Slots[Index]->LastUsedFrame > MaxIdleFrames)
+        {
+            ReleaseSlot(Index);
+        }
+    }
+
+    FGrassViewCullingSlot* Slot = nullptr;
+    for (const TUniquePtr<FGrassViewCullingSlot>& Candidate : Slots)
+    {
+        // 临时键是视图指针，只在同一帧内比较
+        if (Candidate->ViewKey == ViewKey && Candidate->bTransientKey == bTransient && (!bTransient || Candidate->LastUsedFrame == FrameNumber))
+        {
+            Slot = Candidate.Get();
+            break;
+        }
+    }
+
+    if (!Slot)
+    {
+        // 复用本帧没有使用的槽位：优先临时槽位；池满时取最久没有使用的
+        FGrassViewCullingSlot* Reusable = nullptr;
+        for (const TUniquePtr<FGrassViewCullingSlot>& Candidate : Slots)
+        {
+            if (Candidate->LastUsedFrame == FrameNumber)
+            {
+                continue;
+            }
+            if (!Reusable
+                || (Candidate->bTransientKey && !Reusable->bTransientKey)
+                || (Candidate->bTransientKey == Reusable->bTransientKey && FrameNumber - Candidate->LastUsedFrame > FrameNumber - Reusable->LastUsedFrame))
+            {
+                Reusable = Candidate.Get();
+            }
+        }
+
+        if (Reusable && (Reusable->bTransientKey || Slots.Num() >= MaxSlots))
+        {
+            Slot = Reusable;
+        }
+        else if (Slots.Num() < MaxSlots)
+        {
+            Slot = Slots.Add_GetRef(MakeUnique<FGrassViewCullingSlot>()).Get();
+        }
+        else
+        {
+            return nullptr;
+        }
+
+        Slot->ViewKey = ViewKey;
+        Slot->bTransientKey = bTransient;
+        Slot->History.Invalidate();
+    }
+
+    // 新槽位，或实例 Buffer 已经重新生成
+    if (Slot->Buffers.InstanceAllocation != Shared.InstanceAllocation
+        || Slot->Buffers.InstanceCount != Shared.InstanceCount
+        || Slot->Buffers.bVisibleIndexLists != Shared.bVisibleIndexLists
+        || !Slot->Buffers.IndirectArgsBuffer.IsValid())
+    {
+        InitSlotBuffers(RHICmdList, *Slot, Shared);
+    }
+
+    Slot->LastUsedFrame = FrameNumber;
+    return Slot;
+}
+
+const FGrassViewCullingSlot* FGrassViewCullingPool::Find(const FSceneView& View, uint32 FrameNumber) const
+{
+    bool bTransient = false;
+    const uint64 ViewKey = GetViewKey(View, bTransient);
+    for (const TUniquePtr<FGrassViewCullingSlot>& Slot : Slots)
+    {
+        if (Slot->ViewKey == ViewKey && Slot->bTransientKey == bTransient && Slot->LastUsedFrame == FrameNumber)
+        {
+            return Slot.Get();
+        }
+    }
+    return nullptr;
+}
+
+void FGrassViewCullingPool::Reset()
+{
+    DEC_MEMORY_STAT_BY(STAT_GrassViewCullingMemory, AllocatedBytes);
+    AllocatedBytes = 0;
+    Slots.Reset();
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/AutomationTest.h"
+
+// ============================================================================
+// 测试：静止的相机在 Hi-Z 稳定之后复用剔除结果，任何输入变化 (相机、变换、设置、输出 Buffer) 或复用超过上限时完整剔除
+// ============================================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGrassCullingReuseTest, "UnrealGrass.CullingReuse",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGrassCullingReuseTest::RunTest(const FString& Parameters)
+{
+    const double MatrixTolerance = 1.0e-5;
+    const double PositionTolerance = 0.1;
+    const uint32 MaxReuseFrames = 30;
+    static const int32 OutputBuffer = 0;
+    static const int32 InstanceBuffer = 0;
+
+    FGrassCullingSignature Base;
+    Base.ViewProjection = FTranslationMatrix(FVector(-1000.0, -2000.0, -300.0)) * FReversedZPerspectiveMatrix(FMath::DegreesToRadians(45.0f), 16.0f, 9.0f, 10.0f);
+    Base.LocalToWorld = FTranslationMatrix(FVector(500.0, 0.0, 0.0));
+    Base.ViewOrigin = FVector(1000.0, 2000.0, 300.0);
+    Base.OutputKey = &OutputBuffer;
+    Base.InstanceKey = &InstanceBuffer;
+    Base.SettingsHash = 7;
+
+    // 按帧模拟：返回沿用的帧数
+    auto Run = [&](FGrassCullingHistory& History, uint32 FirstFrame, uint32 NumFrames, bool bUsesHiZ, TFunctionRef<FGrassCullingSignature(uint32)> MakeSignature, TArray<bool>* OutReused = nullptr)
+    {
+        int32 NumReused = 0;
+        for (uint32 Frame = FirstFrame; Frame < FirstFrame + NumFrames; ++Frame)
+        {
+            const bool bReused = History.ShouldReuse(MakeSignature(Frame), bUsesHiZ, Frame, MaxReuseFrames, MatrixTolerance, PositionTolerance);
+            NumReused += bReused ? 1 : 0;
+            if (OutReused)
+            {
+                OutReused->Add(bReused);
+            }
+        }
+        return NumReused;
+    };
+    auto Static = [&](uint32) { return Base; };
+
+    // ======== 静止相机 + Hi-Z：前两帧完整剔除 (第二帧的 Hi-Z 来自相同的相机)，之后复用，每 MaxReuseFrames 帧完整剔除一次 ========
+    {
+        FGrassCullingHistory History;
+        TArray<bool> Reused;
+        Run(History, 100, 2 + MaxReuseFrames * 3, true, Static, &Reused);
+        TestTrue(TEXT("a static camera with Hi-Z culls twice, then reuses"), !Reused[0] && !Reused[1] && Reused[2]);
+        int32 NumFullCulls = 0;
+        for (bool bReused : Reused)
+        {
+            NumFullCulls += bReused ? 0 : 1;
+        }
+        // 第 2 帧之后的 MaxReuseFrames * 3 帧中，每 MaxReuseFrames 帧一次
+        TestTrue(TEXT("reuse is capped at MaxReuseFrames frames between full culls"), NumFullCulls == 2 + 3);
+    }
+
+    // ======== 没有 Hi-Z：第二帧开始复用 ========
+    {
+        FGrassCullingHistory History;
+        TArray<bool> Reused;
+        Run(History, 0, 3, false, Static, &Reused);
+        TestTrue(TEXT("a static camera without Hi-Z reuses from the second frame"), !Reused[0] && Reused[1] && Reused[2]);
+    }
+
+    // ======== 移动的相机：每帧完整剔除；停下之后重新开始计算 ========
+    {
+        FGrassCullingHistory History;
+        auto Moving = [&](uint32 Frame)
+        {
+            FGrassCullingSignature Signature = Base;
+            Signature.ViewOrigin.X += Frame * 5.0;
+            Signature.ViewProjection = FTranslationMatrix(FVector(-Frame * 5.0, 0.0, 0.0)) * Base.ViewProjection;
+            return Signature;
+        };
+        TestTrue(TEXT("a moving camera never reuses"), Run(History, 0, 20, true, Moving) == 0);
+        TArray<bool> Reused;
+        Run(History, 20, 3, true, Static, &Reused);
+        TestTrue(TEXT("reuse restarts after the camera stops"), !Reused[0] && !Reused[1] && Reused[2]);
+    }
+
+    // ======== 误差范围内的变化 (浮点噪声) 仍然复用，超出范围的变化完整剔除 ========
+    {
+        FGrassCullingHistory History;
+        Run(History, 0, 2, true, Static);
+
+        FGrassCullingSignature Noisy = Base;
+        Noisy.ViewProjection.M[3][0] += MatrixTolerance * 0.5;
+        Noisy.ViewOrigin.Z += PositionTolerance * 0.5;
+        TestTrue(TEXT("changes within the tolerance still reuse"), History.ShouldReuse(Noisy, true, 2, MaxReuseFrames, MatrixTolerance, PositionTolerance));
+
+        auto ExpectCull = [&](const FGrassCullingSignature& Changed, const TCHAR* What)
+        {
+            FGrassCullingHistory Settled;
+            Run(Settled, 0, 2, true, Static);
+            TestTrue(What, !Settled.ShouldReuse(Changed, true, 2, MaxReuseFrames, MatrixTolerance, PositionTolerance));
+        };
+
+        FGrassCullingSignature Changed = Base;
+        Changed.ViewProjection.M[0][0] *= 1.01;
+        ExpectCull(Changed, TEXT("a changed projection culls"));
+
+        Changed = Base;
+        Changed.LocalToWorld = FTranslationMatrix(FVector(501.0, 0.0, 0.0));
+        ExpectCull(Changed, TEXT("a moved component culls"));
+
+        Changed = Base;
+        Changed.StereoViewProjection = Base.ViewProjection;
+        ExpectCull(Changed, TEXT("switching to stereo union culling culls"));
+
+        Changed = Base;
+        Changed.SettingsHash = 8;
+        ExpectCull(Changed, TEXT("changed culling settings cull"));
+
+        static const int32 OtherBuffer = 0;
+        Changed = Base;
+        Changed.OutputKey = &OtherBuffer;
+        ExpectCull(Changed, TEXT("a reallocated culling output culls"));
+
+        Changed = Base;
+        Changed.InstanceKey = &OtherBuffer;
+        ExpectCull(Changed, TEXT("regenerated instances cull"));
+    }
+
+    // ======== 失效之后完整剔除 ========
+    {
+        FGrassCullingHistory History;
+        Run(History, 0, 3, false, Static);
+        History.Invalidate();
+        TestTrue(TEXT("an invalidated history culls"), !History.ShouldReuse(Base, false, 3, MaxReuseFrames, MatrixTolerance, PositionTolerance));
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
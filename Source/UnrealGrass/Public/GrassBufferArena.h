@@ -0,0 +1,93 @@
+// GrassBufferArena.h
+// 所有草地组件共享的 GPU Buffer 池
+// 每种用途 (实例 / 可见索引 / 可见实例拷贝) 一个池，池由若干大的 StructuredBuffer 页组成，
+// 组件从页中分配一段元素区间 (FGrassRangeAllocator)，着色器通过元素偏移访问自己的区间
+// 页的 SRV / UAV 只创建一次，重新生成和流式加载组件不再反复创建 RHI Buffer 和视图
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderResource.h"
+#include "RHIResources.h"
+#include "GrassRangeAllocator.h"
+
+/** Buffer 池的用途，不同用途的区间不会落在同一个页中 (页之间可以直接 CopyBufferRegion) */
+enum class EGrassBufferPool : uint8
+{
+    Instances,          // 16 字节压缩实例 (生成输出)
+    VisibleIndices,     // uint 可见实例索引 (剔除输出，r.Grass.Culling.VisibleIndexLists)
+    VisibleInstances,   // 16 字节可见实例拷贝 (剔除输出，r.Grass.Culling.VisibleIndexLists=0)
+    Num
+};
+
+/**
+ * 从 Buffer 池中分配的一段元素区间
+ * 最后一个引用释放时把区间归还给池 (渲染线程；在其他线程释放时转发到渲染线程)
+ */
+struct UNREALGRASS_API FGrassBufferAllocation
+{
+    FBufferRHIRef Buffer;                   // 所在页的 Buffer (多个组件共享)
+    FShaderResourceViewRHIRef SRV;          // 整个页的 SRV
+    FUnorderedAccessViewRHIRef UAV;         // 整个页的 UAV
+    uint32 Offset = 0;                      // 区间在页中的起始元素
+    uint32 Count = 0;                       // 区间的元素数量
+
+    ~FGrassBufferAllocation();
+
+    EGrassBufferPool GetPool() const { return Pool; }
+
+private:
+    friend class FGrassBufferArena;
+    EGrassBufferPool Pool = EGrassBufferPool::Instances;
+    int32 PageId = INDEX_NONE;
+};
+
+using FGrassBufferAllocationRef = TSharedPtr<FGrassBufferAllocation, ESPMode::ThreadSafe>;
+
+class UNREALGRASS_API FGrassBufferArena : public FRenderResource
+{
+public:
+    static FGrassBufferArena& Get();
+
+    /** 每个元素的字节数 */
+    static uint32 GetStride(EGrassBufferPool Pool);
+
+    /**
+     * 分配 Count 个元素 (渲染线程)
+     * 现有页放不下时创建新页；超过页大小的请求 (或 bDedicated) 使用单独的页，释放时整页销毁
+     * 新页处于 SRVMask 状态，区间的内容未初始化
+     */
+    FGrassBufferAllocationRef Allocate(FRHICommandListBase& RHICmdList, EGrassBufferPool Pool, uint32 Count, bool bDedicated = false);
+
+    struct FStats
+    {
+        int32 NumPages = 0;
+        int32 NumAllocations = 0;
+        uint64 CapacityBytes = 0;
+        uint64 UsedBytes = 0;
+        uint64 LargestFreeBytes = 0;
+    };
+    FStats GetStats(EGrassBufferPool Pool) const;
+
+    virtual void ReleaseRHI() override;
+    virtual FString GetFriendlyName() const override { return TEXT("FGrassBufferArena"); }
+
+private:
+    friend struct FGrassBufferAllocation;
+
+    struct FPage
+    {
+        int32 Id = INDEX_NONE;
+        bool bDedicated = false;
+        FBufferRHIRef Buffer;
+        FShaderResourceViewRHIRef SRV;
+        FUnorderedAccessViewRHIRef UAV;
+        FGrassRangeAllocator Allocator;
+    };
+
+    FPage& CreatePage(FRHICommandListBase& RHICmdList, EGrassBufferPool Pool, uint32 NumElements, bool bDedicated);
+    void Free_RenderThread(EGrassBufferPool Pool, int32 PageId, uint32 Offset);
+
+    TArray<FPage> Pools[(int32)EGrassBufferPool::Num];
+    int32 NextPageId = 0;
+};
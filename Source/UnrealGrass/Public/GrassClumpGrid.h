@@ -0,0 +1,43 @@
+// GrassClumpGrid.h
+// Clump 空间哈希网格 (均匀网格分桶) 的 CPU 参考实现
+// 与 GrassClumpGrid.ush / GrassClumpGridCS.usf 使用相同的单元格划分和查询顺序，
+// 可在没有 GPU 的情况下校验最近 Clump 查询结果
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct UNREALGRASS_API FGrassClumpGrid
+{
+    /** 网格每边的单元格数量 */
+    int32 GridDim = 1;
+
+    /** 每个单元格在 CellClumps 中的起始偏移 (GridDim * GridDim + 1 个元素) */
+    TArray<uint32> CellStart;
+
+    /** 按单元格排序的 Clump 索引 */
+    TArray<uint32> CellClumps;
+
+    /** 根据 Clump 数量计算网格尺寸，平均每个单元格约 1 个 Clump */
+    static int32 ComputeGridDim(int32 NumClumps);
+
+    /** UV 坐标 (0-1) 所在的单元格，超出范围的坐标会被夹到边界单元格 */
+    static FIntPoint GetCell(const FVector2f& UV, int32 GridDim);
+
+    /** 使用 Clump 中心点 (UV 空间) 构建网格，单元格内按 Clump 索引升序排列 */
+    void Build(TConstArrayView<FVector2f> ClumpCentresUV);
+
+    /**
+     * 查找距离 PositionLocal 最近的 Clump (与 FindNearestClumpInGrid 一致)
+     * @param PositionLocal 草叶本地坐标 (相对于网格中心)
+     * @param HalfSizeX/HalfSizeY 网格覆盖范围的一半
+     * @param OutCentreLocal 最近 Clump 中心的本地坐标
+     * @return 最近 Clump 的索引
+     */
+    int32 FindNearest(TConstArrayView<FVector2f> ClumpCentresUV, const FVector2f& PositionLocal,
+        float HalfSizeX, float HalfSizeY, FVector2f* OutCentreLocal = nullptr) const;
+
+    /** 遍历所有 Clump 的暴力查找，作为网格查询的对照 */
+    static int32 FindNearestBruteForce(TConstArrayView<FVector2f> ClumpCentresUV, const FVector2f& PositionLocal,
+        float HalfSizeX, float HalfSizeY, FVector2f* OutCentreLocal = nullptr);
+};
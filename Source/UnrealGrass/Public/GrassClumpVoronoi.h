@@ -0,0 +1,52 @@
+// GrassClumpVoronoi.h
+// Clump Voronoi 查找纹理的 CPU 参考实现和缓存 Key
+// 与 GrassVoronoiCS.usf 输出相同的纹素内容，可在没有 GPU 的情况下校验
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Clump 数据 (Clump Buffer、空间哈希网格、Voronoi 纹理) 的缓存 Key
+ * Clump 生成只依赖这些参数；逐字段比较，不使用哈希 (碰撞时会静默复用过期的 Clump 数据)
+ */
+struct FGrassClumpCacheKey
+{
+    int32 NumClumps = 0;
+    int32 NumClumpTypes = 0;
+    int32 VoronoiTextureSize = 0;   // 未启用 Voronoi 查找时为 0
+    uint32 ClumpShaderVersion = 0;
+
+    bool operator==(const FGrassClumpCacheKey& Other) const
+    {
+        return NumClumps == Other.NumClumps
+            && NumClumpTypes == Other.NumClumpTypes
+            && VoronoiTextureSize == Other.VoronoiTextureSize
+            && ClumpShaderVersion == Other.ClumpShaderVersion;
+    }
+
+    bool operator!=(const FGrassClumpCacheKey& Other) const { return !(*this == Other); }
+};
+
+struct UNREALGRASS_API FGrassClumpVoronoi
+{
+    /** Clump 生成 Shader 的版本号，修改 GrassClumpCS / GrassVoronoiCS 的输出时需要递增 */
+    static constexpr uint32 ClumpShaderVersion = 1;
+
+    /**
+     * Clump 数据的缓存 Key (包含当前的 ClumpShaderVersion)，Key 不变时可以跳过整个 Clump Pass
+     * @param VoronoiTextureSize 未启用 Voronoi 查找时传 0
+     */
+    static FGrassClumpCacheKey ComputeCacheKey(int32 NumClumps, int32 NumClumpTypes, int32 VoronoiTextureSize);
+
+    /** UV 坐标 (0-1) 对应的纹素坐标 (与 GrassPositionCS 的 Voronoi 查找一致) */
+    static FIntPoint GetTexel(const FVector2f& UV, int32 TextureSize);
+
+    /**
+     * CPU 烘焙 Voronoi 纹理
+     * @param ClumpCentresUV Clump 中心点 (UV 空间)
+     * @param OutTexels TextureSize * TextureSize 个纹素 (行优先)，
+     *        每个纹素为 (ClumpIndex, Centre.x, Centre.y, Distance)
+     */
+    static void Bake(TConstArrayView<FVector2f> ClumpCentresUV, int32 TextureSize, TArray<FVector4f>& OutTexels);
+};
@@ -5,11 +5,20 @@
 
 #include "CoreMinimal.h"
 #include "Components/PrimitiveComponent.h"
+#include "RenderCommandFence.h"
+#include "GrassInstanceBuffers.h"
+#include "GrassCpuGenerator.h"
+#include "GrassInstanceCache.h"
+#include "GrassClumpVoronoi.h"
 #include "GrassComponent.generated.h"
 
 class UStaticMesh;
 class ALandscapeProxy;
 class ULandscapeComponent;
+class FTextureResource;
+class FGrassSceneProxy;
+class FRHIBuffer;
+class FRHIGPUBufferReadback;
 
 // ============================================================================
 // 草丛簇实例数据结构体 (GPU Buffer 格式)
@@ -101,11 +110,214 @@ struct FGrassRenderParameters
     float ViewRotationAmount = 0.3f;
 };
 
+// ============================================================================
+// Landscape 覆盖范围
+// ============================================================================
+UENUM(BlueprintType)
+enum class EGrassLandscapeCoverage : uint8
+{
+    /** 只覆盖组件所在位置的 Landscape Component */
+    ContainingComponent,
+    /** 覆盖与 GridSize x Spacing 范围相交的所有 Landscape Component */
+    GridFootprint,
+    /** 覆盖整个 Landscape 的所有 Component */
+    EntireLandscape,
+};
+
 // ============================================================================
 // 最大簇类型数量常量
 // ============================================================================
 constexpr int32 MAX_CLUMP_TYPES = 5;
 
+// ============================================================================
+// 草地生成阶段 (位掩码)
+// 编辑器中修改属性时只重新执行受影响的阶段，见 UGrassComponent::GetInvalidatedStages
+// ============================================================================
+enum class EGrassGenerationStage : uint8
+{
+    None        = 0,
+    Clumps      = 1 << 0,   // Clump 生成 + 空间哈希网格 + Voronoi 纹理 (缓存 Key 不变时仍会跳过)
+    Positions   = 1 << 1,   // 位置生成 (GrassPositionCS 同时写出所有草叶属性，压缩为 16 字节实例)
+    Allocation  = 1 << 3,   // 强制重新分配实例 / Visible / Indirect Args Buffer (实例数量变化时自动执行)
+    ProxyParams = 1 << 4,   // 只影响 SceneProxy 的参数 (风、剔除、LOD、材质)，重建 Proxy 即可
+
+    All = Clumps | Positions | Allocation | ProxyParams,
+};
+ENUM_CLASS_FLAGS(EGrassGenerationStage);
+
+// ============================================================================
+// 生成分块 (每个 Landscape Component 一个分块；不使用地形时只有一个覆盖整个网格的分块)
+// 所有分块共享 GridSize，在同一次 Dispatch 中生成 (SV_DispatchThreadID.z = 分块索引)
+// 实例 Index = (TileIndex * GridSize + y) * GridSize + x
+// ============================================================================
+struct FGrassGenerationTile
+{
+    FVector2f SampleOrigin = FVector2f::ZeroVector;     // 网格 (0, 0) 处草叶的本地坐标 (相对于草地组件)
+    FVector2f CellSize = FVector2f(100.0f, 100.0f);     // 网格间距
+    FVector2f TileMin = FVector2f::ZeroVector;          // 分块覆盖范围 (本地坐标)，高度图 UV 以 TileMin 为原点
+    FVector2f TileSize = FVector2f::ZeroVector;
+    FIntPoint SeedOffset = FIntPoint::ZeroValue;        // 哈希种子偏移，相邻分块使用连续的全局网格坐标
+
+    // Landscape 高度图 (同一个高度图 Atlas 中的分块使用同一次 Dispatch)
+    FVector4f HeightmapScaleBias = FVector4f(0, 0, 0, 0);
+    FTextureResource* HeightmapResource = nullptr;
+    uint32 HeightmapContentHash = 0;                    // 高度图内容哈希 (只用于实例缓存 Key)
+
+    // Landscape 权重图 (DensityLandscapeLayer 所在的纹理和通道；Component 没有绘制该层时为空)
+    FVector4f WeightmapScaleBias = FVector4f(0, 0, 0, 0);
+    FVector4f WeightmapChannelMask = FVector4f(0, 0, 0, 0);
+    FTextureResource* WeightmapResource = nullptr;
+    uint32 WeightmapContentHash = 0;
+
+    /** 不使用地形时覆盖 GridSize x GridSize 网格的单个分块 (以组件为中心) */
+    static FGrassGenerationTile MakeGridTile(int32 GridSize, float Spacing)
+    {
+        const float HalfSize = (GridSize - 1) * Spacing * 0.5f;
+        FGrassGenerationTile Tile;
+        Tile.SampleOrigin = FVector2f(-HalfSize, -HalfSize);
+        Tile.CellSize = FVector2f(Spacing, Spacing);
+        Tile.TileMin = FVector2f(-HalfSize, -HalfSize);
+        Tile.TileSize = FVector2f(HalfSize * 2.0f, HalfSize * 2.0f);
+        return Tile;
+    }
+};
+
+// ============================================================================
+// 一次草地生成所需的全部参数 (在游戏线程收集，拷贝到渲染线程使用)
+// ============================================================================
+struct FGrassGenerationParams
+{
+    // 需要在渲染线程执行的阶段 (不含 ProxyParams)
+    EGrassGenerationStage Stages = EGrassGenerationStage::All;
+
+    // 实例数量不变且不要求重新分配时，直接写入当前 Buffer (无效时重新分配)
+    FGrassInstanceBuffers ReuseBuffers;
+
+    int32 GridSize = 10;            // 每个分块的网格尺寸
+    float Spacing = 100.0f;
+    float JitterStrength = 0.5f;
+    bool bUseIndirectDraw = true;
+    bool bEnableFrustumCulling = true;
+    bool bVisibleIndexLists = true; // 剔除只输出实例索引 (r.Grass.Culling.VisibleIndexLists)
+
+    // 生成分块 (为空时等价于 MakeGridTile(GridSize, Spacing))
+    TArray<FGrassGenerationTile> Tiles;
+
+    // Clump 参数
+    int32 NumClumps = 50;
+    int32 NumClumpTypes = 1;
+    int32 ClumpGridDim = 1;
+    int32 VoronoiTextureSize = 0;   // 0 = 不使用 Voronoi 查找
+    bool bReuseClumpData = false;
+    TArray<FClumpTypeParameters> ClumpTypes;
+
+    // 密度遮罩 (密度 = DensityMask.r * 权重层；按密度随机剔除草叶，存活的草叶紧凑写入实例 Buffer)
+    FTextureResource* DensityMaskResource = nullptr;
+    uint32 DensityMaskContentHash = 0;
+    bool bUseDensityLayer = false;
+    bool bInvertDensityLayer = false;
+
+    // Landscape 高度图参数 (同一个 Landscape 的所有分块共享)
+    bool bUseLandscapeHeightmap = false;
+    FVector3f LandscapeScale = FVector3f(100.0f, 100.0f, 100.0f);
+    FVector3f LandscapeLocation = FVector3f(0, 0, 0);
+    FVector3f ComponentLocation = FVector3f(0, 0, 0);   // 草地组件的世界位置 (本地坐标 = 世界坐标 - ComponentLocation)
+
+    int32 GetNumTiles() const { return FMath::Max(Tiles.Num(), 1); }
+
+    /** 网格上的草叶数量 (使用密度遮罩时是实例数量的上限) */
+    int32 GetInstanceCount() const { return GridSize * GridSize * GetNumTiles(); }
+
+    /** 是否按密度剔除草叶 (实际实例数量在 GPU 生成后才能确定) */
+    bool UsesDensity() const { return DensityMaskResource != nullptr || bUseDensityLayer; }
+
+    /** 所有分块覆盖范围的并集 (本地坐标)，Clump 分布在这个范围内 */
+    FBox2f GetTileBounds() const
+    {
+        if (Tiles.Num() == 0)
+        {
+            const FGrassGenerationTile Tile = FGrassGenerationTile::MakeGridTile(GridSize, Spacing);
+            return FBox2f(Tile.TileMin, Tile.TileMin + Tile.TileSize);
+        }
+        FBox2f Bounds(ForceInit);
+        for (const FGrassGenerationTile& Tile : Tiles)
+        {
+            Bounds += Tile.TileMin;
+            Bounds += Tile.TileMin + Tile.TileSize;
+        }
+        return Bounds;
+    }
+
+    /**
+     * 实例位置的量化范围 (本地坐标)，GPU / CPU 生成、剔除和 Vertex Factory 使用同一个范围
+     * XY = 分块并集加上 Jitter 的最大偏移，Z = Landscape 高度图能表示的全部高度 (总是包含 0)
+     * 所有分块共享一个范围：密度紧凑输出后实例不再对应固定的分块
+     */
+    FGrassInstanceQuantization GetQuantization() const
+    {
+        const FBox2f TileBounds = GetTileBounds();
+        float MaxJitter = 0.0f;
+        for (int32 i = 0; i < GetNumTiles(); ++i)
+        {
+            const FVector2f CellSize = Tiles.Num() > 0 ? Tiles[i].CellSize : FVector2f(Spacing, Spacing);
+            MaxJitter = FMath::Max(MaxJitter, CellSize.GetAbsMax() * FMath::Abs(JitterStrength) * 0.5f);
+        }
+
+        float MinZ = -1.0f;
+        float MaxZ = 1.0f;
+        if (bUseLandscapeHeightmap)
+        {
+            // 高度图解码范围 [-256, 256) * Scale.Z + Location.Z (见 GrassPositionCS.usf 的 DecodeHeightValue)
+            const float LandscapeZ0 = LandscapeLocation.Z - 256.0f * LandscapeScale.Z - ComponentLocation.Z;
+            const float LandscapeZ1 = LandscapeLocation.Z + 256.0f * LandscapeScale.Z - ComponentLocation.Z;
+            MinZ = FMath::Min3(MinZ, LandscapeZ0, LandscapeZ1);
+            MaxZ = FMath::Max3(MaxZ, LandscapeZ0, LandscapeZ1);
+        }
+
+        return FGrassInstanceQuantization::FromBox(FBox3f(
+            FVector3f(TileBounds.Min.X - MaxJitter, TileBounds.Min.Y - MaxJitter, MinZ),
+            FVector3f(TileBounds.Max.X + MaxJitter, TileBounds.Max.Y + MaxJitter, MaxZ)));
+    }
+
+    // CPU 生成的实例数据 (有效时渲染线程只上传，不执行 Compute Shader)
+    TSharedPtr<const FGrassCpuInstanceData, ESPMode::ThreadSafe> CpuInstanceData;
+};
+
+/**
+ * 密度剔除 (GPU 生成且 UsesDensity) 的存活数量回读
+ * 生成命令只拷贝原子计数器，不等待 GPU；之后游戏线程每帧 (GenerationFence 通过后) 发起一次尝试，
+ * 计数就绪时渲染线程把存活的实例拷贝到刚好大小的区间、创建剔除 Buffer，再回读缓存和交换 Proxy。等待期间旧的草地继续渲染
+ */
+class FGrassCompactionReadback
+{
+public:
+    FGrassCompactionReadback(const FGrassGenerationParams& InGenParams, TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> InCacheReadback);
+    ~FGrassCompactionReadback();
+
+    /** 生成 Pass 之后拷贝存活计数 (CounterBuffer 处于 CopySrc) */
+    void EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, FRHIBuffer* CounterBuffer);
+
+    /** 计数就绪时读取存活数量并返回 true；bWait 时阻塞到 GPU 完成 (WaitForGeneration / 同步生成) */
+    bool Poll_RenderThread(FRHICommandListImmediate& RHICmdList, bool bWait);
+
+    /** 存活数量已经读取 (游戏线程在 GenerationFence 通过后检查，此时紧凑拷贝也已经完成) */
+    bool IsReady() const { return bReady; }
+
+    int32 GetNumSurvivors() const { return NumSurvivors; }
+
+    // 紧凑拷贝后创建剔除 Buffer 使用的生成参数，以及缓存未命中时的回读 (紧凑之后才能拷贝)
+    const FGrassGenerationParams GenParams;
+    const TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> CacheReadback;
+
+private:
+    TUniquePtr<FRHIGPUBufferReadback> Readback;
+    int32 NumSurvivors = 0;
+    std::atomic<bool> bReady = false;
+};
+
+/** 草地生成完成 (新的实例 Buffer 已交换到渲染代理) */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGrassGenerationComplete, int32, NumInstances);
+
 UCLASS(ClassGroup=(Rendering), meta=(BlueprintSpawnableComponent))
 class UNREALGRASS_API UGrassComponent : public UPrimitiveComponent
 {
@@ -147,6 +359,54 @@ public:
     UPROPERTY(EditAnywhere, Category = "Grass|Culling")
     bool bEnableOcclusionCulling = true;
 
+    /**
+     * 可见列表保持实例的原始顺序 (计数 / 扫描 / 分散三个 Pass，代替原子追加)
+     * 每帧的绘制顺序和截帧结果确定，空间上也更连贯；代价是剔除测试执行两次 (比较见 stat GPU 的 GrassCulling*)
+     */
+    UPROPERTY(EditAnywhere, Category = "Grass|Culling")
+    bool bStableVisibleOrder = false;
+
+    /**
+     * 两阶段遮挡剔除：上一帧可见的实例先绘制，深度预 Pass 之后用当前帧的 Hi-Z 测试其余实例，可见的在同一帧补上
+     * 被遮挡的草叶不再晚一帧出现，GrassBoundingRadius 不需要为了过时的 Hi-Z 放大；需要深度预 Pass (没有时新可见的实例下一帧绘制)
+     */
+    UPROPERTY(EditAnywhere, Category = "Grass|Culling", meta = (EditCondition = "bEnableOcclusionCulling"))
+    bool bTwoPhaseOcclusion = true;
+
+    /**
+     * 场景捕获 / 反射捕获视图的剔除预算 (每个视图单独剔除，见 r.Grass.Culling.PerView)
+     * 最大可见距离和 LOD 0 距离的缩放，以及保留的草叶比例；r.Grass.Culling.CaptureBudget 0 时捕获使用完整设置
+     */
+    UPROPERTY(EditAnywhere, Category = "Grass|Culling", meta = (ClampMin = "0.05", ClampMax = "1.0"))
+    float CaptureMaxDistanceScale = 0.5f;
+
+    UPROPERTY(EditAnywhere, Category = "Grass|Culling", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float CaptureLOD0DistanceScale = 0.5f;
+
+    UPROPERTY(EditAnywhere, Category = "Grass|Culling", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float CaptureDensity = 0.5f;
+
+    // ======== 阴影设置 ========
+
+    /**
+     * 草叶投射动态阴影 (还需要 Cast Shadow 开启，以及 Indirect Draw + GPU Culling)
+     * 每个阴影视图 (CSM 的每个级联) 单独剔除，各自有 Indirect Args；r.Grass.Shadows 0 时全局关闭
+     */
+    UPROPERTY(EditAnywhere, Category = "Grass|Shadow")
+    bool bCastGrassShadows = false;
+
+    /** 投射阴影的最大距离 (从相机计算，通常比 MaxVisibleDistance 小得多) */
+    UPROPERTY(EditAnywhere, Category = "Grass|Shadow", meta = (ClampMin = "100.0", EditCondition = "bCastGrassShadows"))
+    float ShadowMaxDistance = 2000.0f;
+
+    /** 投射阴影的草叶比例 (按实例哈希选择，每帧一致) */
+    UPROPERTY(EditAnywhere, Category = "Grass|Shadow", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "bCastGrassShadows"))
+    float ShadowDensity = 0.5f;
+
+    /** 阴影深度使用 LOD 1 草叶 (7 顶点)；关闭时使用 LOD 0 */
+    UPROPERTY(EditAnywhere, Category = "Grass|Shadow", meta = (EditCondition = "bCastGrassShadows"))
+    bool bShadowUseLOD1 = true;
+
     // ======== LOD 设置 ========
     
     /** 是否启用 LOD 系统 */
@@ -169,6 +429,24 @@ public:
     UPROPERTY(EditAnywhere, Category = "Grass|Heightmap")
     bool bUseLandscapeHeightmap = false;
 
+    /** 覆盖哪些 Landscape Component，每个 Component 生成一个分块，所有分块在同一次 Dispatch 中生成 */
+    UPROPERTY(EditAnywhere, Category = "Grass|Heightmap", meta = (EditCondition = "bUseLandscapeHeightmap"))
+    EGrassLandscapeCoverage LandscapeCoverage = EGrassLandscapeCoverage::ContainingComponent;
+
+    // ======== 密度设置 ========
+
+    /** 密度贴图 (R 通道，0=没有草，1=满密度)，拉伸覆盖整个生成范围；生成时按密度随机剔除草叶，只保留存活的实例 */
+    UPROPERTY(EditAnywhere, Category = "Grass|Density")
+    UTexture2D* DensityMask = nullptr;
+
+    /** 作为密度的 Landscape 绘制层 (例如 Grass)，需要启用 Landscape Heightmap；为空时不使用 */
+    UPROPERTY(EditAnywhere, Category = "Grass|Density", meta = (EditCondition = "bUseLandscapeHeightmap"))
+    FName DensityLandscapeLayer;
+
+    /** 反转绘制层权重 (绘制层表示没有草的区域，例如道路、岩石) */
+    UPROPERTY(EditAnywhere, Category = "Grass|Density", meta = (EditCondition = "bUseLandscapeHeightmap"))
+    bool bInvertDensityLayer = false;
+
     // ======== 风场扰动噪声设置 ========
 
     /** 风场扰动噪声纹理 */
@@ -220,10 +498,18 @@ public:
     UPROPERTY(EditAnywhere, Category = "Grass|Clump Types", meta = (TitleProperty = "BaseHeight"))
     TArray<FClumpTypeParameters> ClumpTypes;
 
-    /** 丛簇数量 */
-    UPROPERTY(EditAnywhere, Category = "Grass|Clumping", meta = (ClampMin = "1", ClampMax = "256"))
+    /** 丛簇数量（通过空间哈希网格查找最近丛簇，数量不再影响单个草叶的生成成本）*/
+    UPROPERTY(EditAnywhere, Category = "Grass|Clumping", meta = (ClampMin = "1", ClampMax = "65536"))
     int32 NumClumps = 50;
 
+    /** 使用预烘焙的 Voronoi 纹理查找最近丛簇（O(1)，精度受纹理分辨率限制；关闭时使用精确的空间哈希网格查找）*/
+    UPROPERTY(EditAnywhere, Category = "Grass|Clumping")
+    bool bUseVoronoiClumpLookup = false;
+
+    /** Voronoi 查找纹理的分辨率 */
+    UPROPERTY(EditAnywhere, Category = "Grass|Clumping", meta = (ClampMin = "64", ClampMax = "4096", EditCondition = "bUseVoronoiClumpLookup"))
+    int32 VoronoiTextureSize = 1024;
+
     /** 草叶模型，如果为空则使用默认高质量草叶 */
     UPROPERTY(EditAnywhere, Category = "Grass")
     UStaticMesh* GrassMesh;
@@ -231,13 +517,74 @@ public:
     UPROPERTY(EditAnywhere, Category = "Grass")
     UMaterialInterface* GrassMaterial;
 
+    /** 异步生成：不阻塞游戏线程，新 Buffer 就绪前继续渲染旧草地 (关闭时 GenerateGrass 会等待渲染线程完成，使用密度剔除时还会等待 GPU 读回存活数量) */
+    UPROPERTY(EditAnywhere, Category = "Grass|Generation")
+    bool bAsyncGeneration = true;
+
+    /**
+     * 在 CPU 上生成实例数据 (SIMD + 多线程) 并上传，数据同时保留在 CPU 端供游戏逻辑查询
+     * 限制：不采样地形高度图 (草叶高度为 0)，忽略密度遮罩和权重图层；渲染仍然需要 SM5，不是低端平台的回退
+     */
+    UPROPERTY(EditAnywhere, Category = "Grass|Generation")
+    bool bGenerateOnCpu = false;
+
+    /** 把 GPU 生成结果缓存到 Saved/GrassCache，生成参数和高度图不变时直接从磁盘加载，跳过所有 Compute Shader (r.Grass.InstanceCache 全局开关) */
+    UPROPERTY(EditAnywhere, Category = "Grass|Generation")
+    bool bUseInstanceCache = true;
+
+    /** 生成完成时广播 (参数为新的实例数量) */
+    UPROPERTY(BlueprintAssignable, Category = "Grass|Generation")
+    FOnGrassGenerationComplete OnGenerationComplete;
+
+    /** 请求完整生成 (r.Grass.Generation.Scheduler 开启时由 UGrassGenerationSubsystem 排队，在之后的某一帧发起) */
     UFUNCTION(CallInEditor, Category = "Grass")
     void GenerateGrass();
 
+    /** 立即发起指定生成阶段 (不经过调度器；GenerateGrass 等价于 EGrassGenerationStage::All) */
+    void RegenerateStages(EGrassGenerationStage Stages);
+
+    /** CPU 端实例数据 (只有 CPU 生成时有效，对应最近一次发起的生成) */
+    const FGrassCpuInstanceData* GetCpuInstanceData() const { return CpuInstanceData.Get(); }
+
+    /** 属性依赖表：返回修改某个属性后需要重新执行的生成阶段 */
+    static EGrassGenerationStage GetInvalidatedStages(FName PropertyName, FName MemberPropertyName);
+
+    /** 是否有尚未完成的异步生成 */
+    UFUNCTION(BlueprintCallable, Category = "Grass|Generation")
+    bool IsGenerationInFlight() const { return bGenerationInFlight; }
+
+    /** 阻塞等待所有进行中的生成完成，包括还在调度器队列中的请求 (用于工具和自动化测试) */
+    UFUNCTION(BlueprintCallable, Category = "Grass|Generation")
+    void WaitForGeneration();
+
+    // ======== 显存预算 (r.Grass.MemoryBudgetMB，由 UGrassGenerationSubsystem 管理) ========
+
+    /** 当前常驻的实例数据显存字节数 */
+    uint64 GetResidentGpuBytes() const { return InstanceBuffers.GetResidentBytes(); }
+
+    /** 按类别统计的显存占用 (grass.MemReport) */
+    FGrassMemoryFootprint GetGpuMemoryFootprint() const { return InstanceBuffers.GetMemoryFootprint(); }
+
+    /** 释放实例数据 (Proxy 随之销毁，不再渲染)；有进行中的生成或者没有数据时返回 false */
+    bool EvictInstanceData();
+
+    /** 重新加载被释放的实例数据 (经过生成调度器，实例缓存命中时直接从磁盘读取) */
+    void ReloadInstanceData();
+
+    bool IsInstanceDataEvicted() const { return bInstanceDataEvicted; }
+
+    /** 被释放前的显存字节数 (估算重新加载的开销) */
+    uint64 GetEvictedGpuBytes() const { return EvictedGpuBytes; }
+
+    /** 最近一次生成完成的时间 (FPlatformTime::Seconds)，刚加载的组件在一段时间内不会被释放 */
+    double GetResidentSinceTime() const { return ResidentSinceTime; }
+
     // 生命周期函数
     virtual void BeginPlay() override;
     virtual void OnRegister() override;
+    virtual void OnUnregister() override;
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual bool IsReadyForFinishDestroy() override;
 
     virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
     virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
@@ -246,68 +593,12 @@ public:
 
     // ======== GPU Buffer 数据 ========
     
-    // 所有实例的位置 Buffer（输入）
-    FBufferRHIRef PositionBuffer;
-    FShaderResourceViewRHIRef PositionBufferSRV;
+    // 实例数量 (GenerateGrass 调用时更新为请求的数量，异步生成完成前可能与 InstanceBuffers 不同；
+    // 使用密度遮罩时请求的是上限，生成完成后更新为实际存活的数量)
     int32 InstanceCount = 0;
 
-    // 草叶实例数据 Buffer（包含 Height, Width, Tilt, Bend 等属性）
-    FBufferRHIRef GrassDataBuffer;      // GrassData0: Height, Width, Tilt, Bend
-    FShaderResourceViewRHIRef GrassDataBufferSRV;
-    FBufferRHIRef GrassData1Buffer;     // GrassData1: TaperAmount, FacingDir.x, FacingDir.y, P1Offset
-    FShaderResourceViewRHIRef GrassData1BufferSRV;
-    FBufferRHIRef GrassData2Buffer;     // GrassData2: P2Offset
-    FShaderResourceViewRHIRef GrassData2BufferSRV;
-
-    // 可见实例的位置 Buffer（剔除后输出）
-    FBufferRHIRef VisiblePositionBuffer;
-    FShaderResourceViewRHIRef VisiblePositionBufferSRV;
-    FUnorderedAccessViewRHIRef VisiblePositionBufferUAV;
-
-    // 可见实例的数据 Buffer（剔除后输出）
-    FBufferRHIRef VisibleGrassData0Buffer;
-    FShaderResourceViewRHIRef VisibleGrassData0BufferSRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData0BufferUAV;
-    
-    FBufferRHIRef VisibleGrassData1Buffer;
-    FShaderResourceViewRHIRef VisibleGrassData1BufferSRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData1BufferUAV;
-    
-    FBufferRHIRef VisibleGrassData2Buffer;
-    FShaderResourceViewRHIRef VisibleGrassData2BufferSRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData2BufferUAV;
-
-    // Indirect Draw 参数 Buffer
-    // 存储 DrawIndexedInstancedIndirect 的参数:
-    // [0] IndexCountPerInstance
-    // [1] InstanceCount
-    // [2] StartIndexLocation
-    // [3] BaseVertexLocation
-    // [4] StartInstanceLocation
-    FBufferRHIRef IndirectArgsBuffer;
-    FUnorderedAccessViewRHIRef IndirectArgsBufferUAV;
-
-    // LOD 1 的 Indirect Draw 参数 Buffer (用于简化版草叶)
-    FBufferRHIRef IndirectArgsBufferLOD1;
-    FUnorderedAccessViewRHIRef IndirectArgsBufferLOD1UAV;
-
-    // ======== LOD 1 独立的 Visible Buffers ========
-    // LOD 1 使用独立的 buffer，避免与 LOD 0 数据冲突
-    FBufferRHIRef VisiblePositionBufferLOD1;
-    FShaderResourceViewRHIRef VisiblePositionBufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisiblePositionBufferLOD1UAV;
-    
-    FBufferRHIRef VisibleGrassData0BufferLOD1;
-    FShaderResourceViewRHIRef VisibleGrassData0BufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData0BufferLOD1UAV;
-    
-    FBufferRHIRef VisibleGrassData1BufferLOD1;
-    FShaderResourceViewRHIRef VisibleGrassData1BufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData1BufferLOD1UAV;
-    
-    FBufferRHIRef VisibleGrassData2BufferLOD1;
-    FShaderResourceViewRHIRef VisibleGrassData2BufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData2BufferLOD1UAV;
+    // 当前用于渲染的实例 Buffer（位置、草叶属性、剔除输出、Indirect Args）
+    FGrassInstanceBuffers InstanceBuffers;
 
     // 用于传递给 SceneProxy 的 Mesh 信息
     int32 NumIndices = 0;
@@ -320,11 +611,34 @@ public:
     FBufferRHIRef ClumpData1Buffer;       // ClumpData1: HeightScale, WidthScale, WindPhase, Padding
     FShaderResourceViewRHIRef ClumpData1BufferSRV;
 
+    // ======== Clump 空间哈希网格 ========
+    // Clump 按中心点分桶到 ClumpGridDim x ClumpGridDim 的均匀网格
+    FBufferRHIRef ClumpGridCellStartBuffer;   // 每个单元格在 ClumpGridIndices 中的起始偏移 (NumCells + 1)
+    FShaderResourceViewRHIRef ClumpGridCellStartSRV;
+    FBufferRHIRef ClumpGridIndicesBuffer;     // 按单元格排序的 Clump 索引
+    FShaderResourceViewRHIRef ClumpGridIndicesSRV;
+    int32 ClumpGridDim = 1;
+
+    // ======== Clump Voronoi 查找纹理 ========
+    // R=ClumpIndex, G=CentreX, B=CentreY, A=Distance (仅在 bUseVoronoiClumpLookup 时创建)
+    FTextureRHIRef VoronoiTexture;
+
+    // 渲染线程持有的 Clump 数据对应的缓存 Key (FinishGeneration 时提交，未设置表示没有可复用的 Clump 数据)
+    // Key 相同时重新生成会跳过 Clump Pass，直接复用上面的 Clump Buffer / 网格 / Voronoi 纹理
+    // 上面的资源在渲染命令中替换，复用判断只使用这两个游戏线程的 Key
+    TOptional<FGrassClumpCacheKey> ClumpCacheKey;
+
+    // 正在进行的生成完成后渲染线程持有的 Clump 数据 (SubmitGeneration 时设置)
+    TOptional<FGrassClumpCacheKey> PendingClumpCacheKey;
+
     // ======== Clump Type 参数 Buffer ========
     // 存储每种簇类型的参数，供 GPU 读取
     FBufferRHIRef ClumpTypeParamsBuffer;
     FShaderResourceViewRHIRef ClumpTypeParamsBufferSRV;
 
+    // 最近一次生成覆盖的范围 (本地坐标，CalcBounds 使用；无效时按 GridSize x Spacing 计算)
+    FBox GeneratedLocalBounds = FBox(ForceInit);
+
     // ======== Landscape 高度图 Texture 数据 ========
     // 从 Landscape Component 自动获取的高度图 SRV
     FShaderResourceViewRHIRef HeightmapTextureSRV;
@@ -347,5 +661,74 @@ public:
     UPROPERTY(EditAnywhere, Category = "Grass|Editor")
     bool bEnableRealtimePreview = true;
 #endif
+
+private:
+    /**
+     * 渲染线程：执行 Clump / 位置生成并创建所有实例 Buffer
+     * 密度剔除时只输出到网格大小的临时页并拷贝存活计数 (CompactionReadback)，剔除 Buffer 由 CompactInstanceBuffers_RenderThread 创建
+     */
+    void GenerateGrass_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassGenerationParams& GenParams, FGrassInstanceBuffers& OutBuffers,
+        FGrassCompactionReadback* CompactionReadback);
+
+    /** 渲染线程：存活数量读回后，把临时页前部的存活实例拷贝到刚好大小的区间并创建剔除 Buffer */
+    void CompactInstanceBuffers_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassGenerationParams& GenParams, int32 NumSurvivors, FGrassInstanceBuffers& InOutBuffers);
+
+    /** 游戏线程：收集 LandscapeCoverage 覆盖的 Landscape Component，每个 Component 生成一个分块 */
+    void CollectLandscapeTiles(FGrassGenerationParams& GenParams) const;
+
+    /** 游戏线程：把生成命令提交到渲染线程 (CacheReadback 有效时生成后回读结果写入实例缓存) */
+    void SubmitGeneration(const FGrassGenerationParams& GenParams, TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> CacheReadback = nullptr);
+
+    /** 游戏线程：实例缓存读取完成，命中时上传缓存数据，失败时回退到 GPU 生成 */
+    void FinishCacheLoad();
+
+    /** 游戏线程：生成完成后提交新 Buffer 并广播 OnGenerationComplete (密度剔除的紧凑拷贝完成之前只发起下一次尝试) */
+    void FinishGeneration();
+
+    /** 游戏线程：发起一次紧凑拷贝尝试 (计数未就绪时渲染线程什么都不做)，bWait 时渲染线程等待 GPU */
+    void EnqueueCompaction(bool bWait);
+
+    // ======== 异步生成状态 ========
+    // 渲染线程写入的后台 Buffer，生成完成 (GenerationFence 通过) 后才在游戏线程读取
+    FGrassInstanceBuffers PendingInstanceBuffers;
+
+    // CPU 生成的实例数据 (与渲染线程共享，只读)
+    TSharedPtr<const FGrassCpuInstanceData, ESPMode::ThreadSafe> CpuInstanceData;
+
+    // 标记生成命令在渲染线程执行完毕
+    FRenderCommandFence GenerationFence;
+
+    // 发起生成时的渲染代理 (只用于比较，渲染线程会直接把新 Buffer 交换进去)
+    FGrassSceneProxy* GenerationProxy = nullptr;
+
+    bool bGenerationInFlight = false;
+
+    // 密度剔除的存活数量回读 (有效时 PendingInstanceBuffers 还是网格大小的临时页，紧凑拷贝完成后才能提交)
+    TSharedPtr<FGrassCompactionReadback, ESPMode::ThreadSafe> PendingCompaction;
+
+    // ======== 实例缓存状态 ========
+    // 正在读取的缓存文件 (有效时生成尚未提交到渲染线程，参数保存在 PendingCacheParams)
+    TFuture<FGrassCpuInstanceDataPtr> PendingCacheLoad;
+    FGrassGenerationParams PendingCacheParams;
+    FString PendingCacheKey;
+
+    // 缓存未命中时 GPU 生成结果的回读，完成后写入缓存文件
+    TSharedPtr<FGrassCacheReadback, ESPMode::ThreadSafe> PendingCacheReadback;
+
+    // 缓存读取 / 未命中生成的开始时间 (用于命中和未命中耗时统计)
+    double CacheRequestStartTime = 0.0;
+    bool bRecordCacheMiss = false;
+
+    // 生成期间再次请求的阶段合并在这里，完成后使用最新参数重新生成一次
+    EGrassGenerationStage RequestedStages = EGrassGenerationStage::None;
+
+    // ======== 显存预算状态 ========
+    bool bInstanceDataEvicted = false;
+    uint64 EvictedGpuBytes = 0;
+    double ResidentSinceTime = 0.0;
+
+    // 已计入 stat Grass 内存计数器的占用，提交 / 释放实例数据和注册状态变化时更新
+    FGrassMemoryFootprint ReportedMemoryFootprint;
+    void UpdateMemoryStats();
 };
 
@@ -0,0 +1,61 @@
+// GrassCpuGenerator.h
+// 草地实例数据的 CPU 生成 (SIMD + ParallelFor)
+// 与 GrassClumpCS.usf / GrassPositionCS.usf 使用相同的哈希、Clump 查找和属性计算，输出相同的压缩实例格式
+// 用途：游戏逻辑可查询的 CPU 端实例数据、无 GPU 时的结果校验 (UGrassComponent::bGenerateOnCpu 显式开启)
+// 限制：不采样地形高度图 (高度为 0)，不支持密度遮罩和权重图层，不作为不支持 SM5 时的回退
+//
+// 注意：哈希基于 sin，GPU 的 sin 精度由硬件决定，因此与 Compute Shader 的结果只保证在容差范围内一致；
+// CPU 上 SIMD 与标量路径 (bUseSimd) 的结果逐位相同，相同参数重复生成的结果也相同，可以作为无 GPU 测试的参照
+// (测试见自动化测试 UnrealGrass.CpuGenerator，基准测试见 UnrealGrass.CpuGenerator.Benchmark)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrassInstancePacking.h"
+
+struct FGrassGenerationParams;
+
+/** CPU 生成的 Clump 数据 (与 GrassClumpCS 输出的两个 Buffer 布局相同) */
+struct UNREALGRASS_API FGrassCpuClumpData
+{
+    TArray<FVector4f> ClumpData0;   // Centre.x, Centre.y, Direction.x, Direction.y
+    TArray<FVector4f> ClumpData1;   // HeightScale, WidthScale, WindPhase, ClumpTypeIndex
+};
+
+/** CPU 生成的实例数据 (与 FGrassInstanceBuffers::InstanceBuffer 布局相同，使用 FGrassInstancePacking 解码) */
+struct UNREALGRASS_API FGrassCpuInstanceData
+{
+    TArray<FUintVector4> Instances;             // 16 字节压缩格式
+    FGrassInstanceQuantization Quantization;    // 位置量化范围 (本地坐标)
+
+    int32 Num() const { return Instances.Num(); }
+
+    FGrassInstance GetInstance(int32 Index) const { return FGrassInstancePacking::Unpack(Instances[Index], Quantization); }
+
+    SIZE_T GetAllocatedSize() const { return Instances.GetAllocatedSize(); }
+};
+
+struct UNREALGRASS_API FGrassCpuGenerator
+{
+    /**
+     * 地形高度采样 (世界坐标 XY -> 世界高度)
+     * 在 ParallelFor 的工作线程上调用，必须是线程安全的
+     */
+    using FHeightSampler = TFunction<float(const FVector2f& WorldXY)>;
+
+    /** 生成 Clump 数据 (与 GrassClumpCS.usf 一致) */
+    static void GenerateClumps(int32 NumClumps, int32 NumClumpTypes, FGrassCpuClumpData& OutClumps);
+
+    /**
+     * 生成所有草叶的位置和属性 (与 GrassPositionCS.usf 一致)
+     * 按行 ParallelFor，每行内 4 个草叶一组使用 VectorRegister4Float 计算哈希
+     * @param HeightSampler 为空时 bUseLandscapeHeightmap 只影响网格范围，高度为 0
+     * @param bUseSimd false 时逐个草叶计算哈希 (只使用一个通道，结果与 SIMD 路径相同；对照 / 基准测试)
+     */
+    static void GenerateInstances(const FGrassGenerationParams& Params, const FGrassCpuClumpData& Clumps,
+        FGrassCpuInstanceData& OutInstances, const FHeightSampler& HeightSampler = nullptr, bool bUseSimd = true);
+
+    /** 完整生成流程：Clump + 实例 */
+    static void Generate(const FGrassGenerationParams& Params, FGrassCpuInstanceData& OutInstances,
+        const FHeightSampler& HeightSampler = nullptr, bool bUseSimd = true);
+};
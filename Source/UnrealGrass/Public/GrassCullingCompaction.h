@@ -0,0 +1,48 @@
+// GrassCullingCompaction.h
+// GPU 剔除可见列表压缩 (GrassFrustumCulling.usf CullInstance) 的 CPU 模型
+// 按着色器的方式分配组内偏移和全局偏移，线程组 / Wave 之间的原子操作顺序随机，用于无 GPU 地验证输出数量和集合 (稳定顺序时验证顺序)
+// 本身不依赖 RHI (测试见自动化测试 UnrealGrass.CullingCompaction)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** 可见列表压缩方式，与 GRASS_USE_WAVE_OPS / GRASS_COMPACTION_PASS 对应 */
+enum class EGrassCullingCompaction : uint8
+{
+    GroupShared,    // groupshared 计数器分配组内偏移，每个线程组每个 LOD 一次全局原子操作
+    Wave,           // WavePrefixCountBits 计算组内偏移，每个 Wave 每个 LOD 一次全局原子操作
+    Stable,         // 计数 / 扫描 / 分散，没有全局原子操作，输出保持实例顺序
+};
+
+/** 每个实例的剔除结果 */
+enum class EGrassCulledLOD : uint8
+{
+    Culled,
+    LOD0,
+    LOD1,
+};
+
+struct UNREALGRASS_API FGrassCullingCompaction
+{
+    struct FResult
+    {
+        // 按写入位置排列的实例索引 (与 OutVisibleInstances / OutVisibleInstancesLOD1 相同)，未写入的位置为 INDEX_NONE
+        TArray<int32> VisibleLOD0;
+        TArray<int32> VisibleLOD1;
+        // 全局计数器 (OutIndirectArgs[1] / OutIndirectArgsLOD1[1]) 上的原子操作次数
+        int32 NumGlobalAtomics = 0;
+    };
+
+    /**
+     * 模拟一次 MainCS Dispatch (每个线程一个实例，不足一组的部分按超出范围处理)
+     * @param GroupSize  线程组大小 (MainCS 为 64)
+     * @param WaveSize   Wave 模式下的 Wave 大小 (GroupSize 的约数)
+     * @param Random     决定线程组 / Wave / 组内原子操作的执行顺序
+     */
+    static void Simulate(EGrassCullingCompaction Mode, TConstArrayView<EGrassCulledLOD> Instances, int32 GroupSize, int32 WaveSize,
+        FRandomStream& Random, FResult& OutResult);
+
+private:
+    static void SimulateStable(TConstArrayView<EGrassCulledLOD> Instances, int32 GroupSize, FResult& OutResult);
+};
@@ -0,0 +1,68 @@
+// GrassCullingGraph.h
+// 剔除的 RDG 封装：剔除使用的外部 Buffer 注册到 RDG，每个 Pass 声明自己访问的 Buffer 和状态，
+// RDG 据此插入状态转换、合并屏障，剔除可以放到异步计算管线 (r.Grass.Culling.AsyncCompute)，与图中之前的图形 Pass 重叠
+// Pass 内仍然绑定资源创建时的 SRV / UAV (Buffer 池的页和 Indirect Args 的视图只创建一次)
+//
+// 常驻状态：RDG 之外的代码 (生成、Buffer 池、次要视图槽位的创建) 假定 Buffer 处于固定的状态
+// (实例 / 可见列表 / 剔除块 SRVMask，Indirect Args IndirectArgs，可见位 UAVCompute)，注册时设为 RDG 结束时的状态
+// 剔除输出由 Mesh 绘制读取，RDG 不知道这些读取：深度预 Pass / Base Pass / 阴影深度之前 PublishDrawnBuffers 在图形管线上读取它们，
+// RDG 在这里等待异步计算的剔除并转换为绘制需要的状态
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphDefinitions.h"
+#include "RenderGraphResources.h"
+#include "ShaderParameterMacros.h"
+
+class FRDGBuilder;
+
+/** 一个剔除 Pass 访问的外部资源 (RDG 根据访问插入状态转换，Pass 内直接绑定 RHI 视图) */
+BEGIN_SHADER_PARAMETER_STRUCT(FGrassRDGPassAccess, )
+    RDG_BUFFER_ACCESS_ARRAY(Buffers)
+    RDG_TEXTURE_ACCESS(HiZTexture, ERHIAccess::SRVCompute)
+END_SHADER_PARAMETER_STRUCT()
+
+class UNREALGRASS_API FGrassCullingGraph
+{
+public:
+    /**
+     * bAllowAsyncCompute：这一批剔除的输出在 PublishDrawnBuffers 之前不会被绘制，可以在异步计算管线上执行
+     * (还需要 r.Grass.Culling.AsyncCompute 和 GSupportsEfficientAsyncCompute)
+     */
+    FGrassCullingGraph(FRDGBuilder& InGraphBuilder, bool bAllowAsyncCompute);
+
+    FRDGBuilder& GraphBuilder;
+
+    /** 剔除 Pass 的标志：异步计算或图形管线的 Compute，总是 NeverCull (输出在 RDG 之外被读取) */
+    ERDGPassFlags GetPassFlags() const { return PassFlags; }
+    bool IsAsyncCompute() const { return EnumHasAnyFlags(PassFlags, ERDGPassFlags::AsyncCompute); }
+
+    /** 注册外部 Buffer，AccessFinal 是 RDG 之外假定的常驻状态；Buffer 为空时返回 nullptr */
+    FRDGBufferRef RegisterBuffer(FRHIBuffer* Buffer, const TCHAR* Name, ERHIAccess AccessFinal) const;
+
+    /** 注册剔除输出 (可见列表 / Indirect Args)：同 RegisterBuffer，下一次 PublishDrawnBuffers 时转换为 DrawAccess */
+    FRDGBufferRef RegisterDrawnBuffer(FRHIBuffer* Buffer, const TCHAR* Name, ERHIAccess DrawAccess) const;
+
+    /** 分配一个 Pass 的访问声明 (读取 Hi-Z 的 Pass 传入注册过的 Hi-Z 纹理) */
+    FGrassRDGPassAccess* AllocPassAccess(FRDGTextureRef HiZTexture = nullptr) const;
+
+    /** 加入一个 Buffer 访问；Buffer 为空时忽略，同一个 Pass 中每个 Buffer 只能加入一次 */
+    static void AddAccess(FGrassRDGPassAccess& PassAccess, FRDGBufferRef Buffer, ERHIAccess Access);
+
+    /** 添加剔除 Pass (Lambda 的参数为 FRHIComputeCommandList&) */
+    template <typename ExecuteLambdaType>
+    void AddPass(FRDGEventName&& Name, FGrassRDGPassAccess* PassAccess, ExecuteLambdaType&& ExecuteLambda) const
+    {
+        GraphBuilder.AddPass(MoveTemp(Name), PassAccess, PassFlags, Forward<ExecuteLambdaType>(ExecuteLambda));
+    }
+
+    /** 在图形管线上读取上次调用以来注册的所有剔除输出 (深度预 Pass / Base Pass / 阴影深度之前) */
+    static void PublishDrawnBuffers(FRDGBuilder& GraphBuilder);
+
+    /** 释放只剩 RDG 包装引用的 Buffer (组件和槽位已经释放)，每帧一次 */
+    static void PruneExternalBuffers();
+
+private:
+    ERDGPassFlags PassFlags;
+};
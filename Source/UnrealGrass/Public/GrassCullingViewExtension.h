@@ -6,6 +6,7 @@
 #include "CoreMinimal.h"
 #include "SceneViewExtension.h"
 #include "RenderGraphResources.h"
+#include "RendererInterface.h"
 
 class FGrassSceneProxy;
 
@@ -14,6 +15,22 @@ class FGrassSceneProxy;
  * before the main render pass begins.
  * 
  * 同时负责生成 Hi-Z (Hierarchical Z-Buffer) 用于遮挡剔除
+ *
+ * 两阶段遮挡剔除 (FGrassSceneProxy::UsesTwoPhaseOcclusion)：
+ * PreRenderViewFamily 执行主 Pass (上一帧可见的实例)；深度预 Pass 之后 (PreRenderBasePass) 用当前帧深度重建 Hi-Z，
+ * 再执行后 Pass 测试其余实例，Base Pass 绘制两个 Pass 的输出。没有深度预 Pass 时后 Pass 在 Base Pass 之后执行，只更新可见位
+ *
+ * 每视图剔除 (r.Grass.Culling.PerView)：只有本帧第一个非捕获视图 (主视图) 执行上面的流程并生成 Hi-Z；
+ * 其余视图 (分屏、编辑器的其他视口、场景捕获) 由 FGrassSceneProxy::PerformGPUCullingForView 剔除到各自的可见列表
+ * 立体渲染 (r.Grass.Culling.StereoUnion) 时两只眼睛用并集视锥剔除一次，另一只眼睛绘制同一个可见列表，不生成 Hi-Z；
+ * 实例化立体渲染 (一次绘制两只眼睛，实例数量乘 2) 在所有剔除路径上都这样剔除，不受 StereoUnion / PerView 影响
+ *
+ * 阴影 (r.Grass.Shadows)：PreRenderViewFamily 准备阴影级联的槽位，阴影收集时每个阴影视图领取一个，
+ * Base Pass 之后 (PostRenderBasePassDeferred，阴影深度绘制之前) 剔除所有领取的级联
+ *
+ * RDG (FGrassCullingGraph)：剔除和 Hi-Z 生成都是视图族 RDG 中的 Pass，状态转换由 RDG 插入；
+ * PreRenderViewFamily 的剔除可以在异步计算管线上执行 (r.Grass.Culling.AsyncCompute)，Hi-Z 生成读取深度，留在图形管线。
+ * 每个阶段结束时 PublishDrawnBuffers 在深度预 Pass / Base Pass / 阴影深度之前等待剔除输出
  */
 class FGrassCullingViewExtension : public FSceneViewExtensionBase
 {
@@ -30,6 +47,9 @@ public:
     virtual void PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override;
     
     virtual void PreRenderView_RenderThread(FRDGBuilder& GraphBuilder, FSceneView& InView) override {}
+
+    /** 深度预 Pass 之后、Base Pass 之前：重建 Hi-Z 并执行两阶段遮挡剔除的后 Pass */
+    virtual void PreRenderBasePass_RenderThread(FRDGBuilder& GraphBuilder, bool bDepthBufferIsPopulated) override;
     
     /** Called after base pass - we can access scene depth here to build Hi-Z */
     virtual void PostRenderBasePassDeferred_RenderThread(FRDGBuilder& GraphBuilder, FSceneView& InView, const FRenderTargetBindingSlots& RenderTargets, TRDGUniformBufferRef<FSceneTextureUniformParameters> SceneTextures) override;
@@ -54,6 +74,9 @@ public:
     /** 获取 Hi-Z 纹理尺寸 */
     FIntPoint GetHiZSize() const { return HiZSize; }
 
+    /** 把 Hi-Z 纹理注册到 RDG (跨帧保留，RDG 之外处于 SRVMask)；纹理不存在时返回 nullptr */
+    FRDGTextureRef RegisterHiZTexture(FRDGBuilder& GraphBuilder) const;
+
 private:
     /** All registered grass proxies that need culling */
     TSet<FGrassSceneProxy*> RegisteredProxies;
@@ -67,7 +90,10 @@ private:
     // ======== Hi-Z 资源 ========
     /** Hi-Z 纹理 (包含多级 Mip) */
     FTextureRHIRef HiZTexture;
-    FShaderResourceViewRHIRef HiZTextureSRV;
+
+    /** Hi-Z 纹理的 RDG 包装 (每个 Mip 的 UAV / SRV 由 RDG 在生成时创建) */
+    TRefCountPtr<IPooledRenderTarget> HiZRenderTarget;
+    int32 HiZNumMips = 0;
     
     /** Hi-Z 尺寸 (Mip 0 的尺寸) */
     FIntPoint HiZSize;
@@ -80,10 +106,32 @@ private:
     
     /** 上一帧的帧号 */
     uint32 LastFrameNumberHiZBuilt = 0;
+
+    /** 本帧的主视图 (执行主 Pass，后 Pass 和 Hi-Z 使用相同的视图，只在本帧渲染期间有效) */
+    const FSceneView* CulledView = nullptr;
+    uint32 CulledViewFrameNumber = 0;
+
+    /** 是否有注册的代理使用两阶段遮挡剔除 */
+    bool AnyProxyUsesTwoPhaseOcclusion();
+
+    /** 剔除所有代理在本视图族阴影收集时领取的阴影级联 */
+    void PerformShadowCulling(FRDGBuilder& GraphBuilder);
+
+    /** 对所有两阶段遮挡剔除的代理执行后 Pass (使用刚刚生成的 Hi-Z) */
+    void PerformPostPassCulling(FRDGBuilder& GraphBuilder, const FSceneView* View, const FMatrix& ViewProjectionMatrix);
+
+    /** 深度预 Pass 之后：从深度重建 Hi-Z 并执行后 Pass，剔除输出在 Base Pass 之前发布 */
+    void PerformTwoPhaseOcclusion(FRDGBuilder& GraphBuilder, FRDGTextureRef SceneDepth, FIntPoint DepthSize);
     
     /** 创建或调整 Hi-Z 纹理大小 */
-    void EnsureHiZTexture(FRHICommandListImmediate& RHICmdList, FIntPoint SceneDepthSize);
+    void EnsureHiZTexture(FIntPoint SceneDepthSize);
     
-    /** 从场景深度构建 Hi-Z */
-    void BuildHiZFromSceneDepth(FRHICommandListImmediate& RHICmdList, FRHITexture* SceneDepthTexture, FIntPoint DepthSize);
+    /** 从场景深度构建 Hi-Z (r.Grass.HiZSinglePass 选择下面两种方式) */
+    void BuildHiZFromSceneDepth(FRDGBuilder& GraphBuilder, FRDGTextureRef SceneDepthTexture, FIntPoint DepthSize);
+
+    /** BuildHiZMipChainCS：每次 Dispatch 生成 5 级 Mip (10 级 Mip 两次 Dispatch) */
+    void BuildHiZMipChain(FRDGBuilder& GraphBuilder, FRDGTextureRef SceneDepthTexture, FRDGTextureRef HiZ, FIntPoint DepthSize);
+
+    /** Mip 0 + 每级 Mip 一次 Dispatch */
+    void BuildHiZPerMip(FRDGBuilder& GraphBuilder, FRDGTextureRef SceneDepthTexture, FRDGTextureRef HiZ, FIntPoint DepthSize);
 };
@@ -0,0 +1,103 @@
+// GrassFrustum.h
+// 视锥的 6 个平面 + SIMD 球 / 包围盒测试
+// 平面从 ViewProjection 矩阵提取 (Gribb-Hartmann)，法线指向视锥内部并归一化；GPU 剔除和 CPU 四叉树预剔除共用
+// 传入 LocalToWorld * ViewProjection 时得到本地空间的平面 (FGrassQuadtree 在组件本地空间查询)
+// 立体渲染的两只眼睛可以合并成一个保守的并集视锥 (FromViewProjectionUnion)；阴影视图的剔除体从 FConvexVolume 的平面转换 (FromConvexPlanes)
+// 本身不依赖 RHI (测试见自动化测试 UnrealGrass.Quadtree、UnrealGrass.Frustum.StereoUnion 和 UnrealGrass.Frustum.ShadowVolume)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** 包围体与视锥的关系 */
+enum class EGrassFrustumTest : uint8
+{
+    Outside,        // 完全在某个平面外
+    Intersects,     // 与至少一个平面相交
+    Inside,         // 完全在所有平面内
+};
+
+struct UNREALGRASS_API FGrassFrustum
+{
+    // Left, Right, Bottom, Top, Near, Far；dot(Plane.xyz, P) + Plane.w >= 0 表示在平面内侧
+    FVector4f Planes[6];
+
+    // SIMD 布局 (SoA)：[0] 是平面 0-3，[1] 是平面 4-5 (后两项重复平面 4-5，不影响结果)
+    VectorRegister4Float PlaneX[2];
+    VectorRegister4Float PlaneY[2];
+    VectorRegister4Float PlaneZ[2];
+    VectorRegister4Float PlaneW[2];
+    VectorRegister4Float AbsPlaneX[2];
+    VectorRegister4Float AbsPlaneY[2];
+    VectorRegister4Float AbsPlaneZ[2];
+
+    static FGrassFrustum FromViewProjection(const FMatrix& ViewProjectionMatrix);
+
+    /**
+     * 两个视锥 (立体渲染的两只眼睛) 的保守并集：两个视锥内的点一定在并集内
+     * 每个平面取两只眼睛中能包含两个视锥所有棱方向、外推最少的法线 (都不行时取两者之和并向中心方向倾斜)，再外推到包含两个视锥的所有角点
+     * 投影可以不对称、两眼可以有夹角；反向 Z 无限远平面的角点按方向处理；退化的平面不剔除
+     */
+    static FGrassFrustum FromViewProjectionUnion(const FMatrix& ViewProjectionA, const FMatrix& ViewProjectionB);
+
+    /**
+     * 从 FConvexVolume 的平面 (法线指向外部，PlaneDot > 0 在外) 转换，平面所在空间相对世界空间平移了 PlaneTranslation
+     * (阴影视图的剔除体在 P + PreShadowTranslation 空间)；不足 6 个平面时补不剔除的平面，多于 6 个时只取前 6 个 (结果偏保守)
+     */
+    static FGrassFrustum FromConvexPlanes(TConstArrayView<FPlane> OutwardPlanes, const FVector& PlaneTranslation);
+
+    /** 变换到 LocalToWorld 的本地空间 (本地点经 LocalToWorld 变换后在视锥内，等价于在返回的视锥内) */
+    FGrassFrustum TransformBy(const FMatrix& LocalToWorld) const;
+
+    /** 球是否与视锥相交 (SIMD，一次测试 4 个平面) */
+    FORCEINLINE bool IntersectsSphere(const FVector3f& Center, float Radius) const
+    {
+        const VectorRegister4Float CX = VectorSetFloat1(Center.X);
+        const VectorRegister4Float CY = VectorSetFloat1(Center.Y);
+        const VectorRegister4Float CZ = VectorSetFloat1(Center.Z);
+        const VectorRegister4Float NegRadius = VectorSetFloat1(-Radius);
+
+        for (int32 Group = 0; Group < 2; ++Group)
+        {
+            const VectorRegister4Float Distance = VectorMultiplyAdd(PlaneX[Group], CX, VectorMultiplyAdd(PlaneY[Group], CY, VectorMultiplyAdd(PlaneZ[Group], CZ, PlaneW[Group])));
+            if (VectorMaskBits(VectorCompareLT(Distance, NegRadius)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** 轴对齐包围盒 (中心 + 半长) 与视锥的关系 (SIMD，一次测试 4 个平面) */
+    FORCEINLINE EGrassFrustumTest TestBox(const FVector3f& Center, const FVector3f& Extent) const
+    {
+        const VectorRegister4Float CX = VectorSetFloat1(Center.X);
+        const VectorRegister4Float CY = VectorSetFloat1(Center.Y);
+        const VectorRegister4Float CZ = VectorSetFloat1(Center.Z);
+        const VectorRegister4Float EX = VectorSetFloat1(Extent.X);
+        const VectorRegister4Float EY = VectorSetFloat1(Extent.Y);
+        const VectorRegister4Float EZ = VectorSetFloat1(Extent.Z);
+
+        bool bIntersects = false;
+        for (int32 Group = 0; Group < 2; ++Group)
+        {
+            const VectorRegister4Float Distance = VectorMultiplyAdd(PlaneX[Group], CX, VectorMultiplyAdd(PlaneY[Group], CY, VectorMultiplyAdd(PlaneZ[Group], CZ, PlaneW[Group])));
+            // 包围盒在平面法线方向上的投影半径
+            const VectorRegister4Float Radius = VectorMultiplyAdd(AbsPlaneX[Group], EX, VectorMultiplyAdd(AbsPlaneY[Group], EY, VectorMultiply(AbsPlaneZ[Group], EZ)));
+            if (VectorMaskBits(VectorCompareLT(Distance, VectorNegate(Radius))))
+            {
+                return EGrassFrustumTest::Outside;
+            }
+            bIntersects |= VectorMaskBits(VectorCompareLT(Distance, Radius)) != 0;
+        }
+        return bIntersects ? EGrassFrustumTest::Intersects : EGrassFrustumTest::Inside;
+    }
+
+    /** 标量版本 (测试中作为参照) */
+    bool IntersectsSphereScalar(const FVector3f& Center, float Radius) const;
+    EGrassFrustumTest TestBoxScalar(const FVector3f& Center, const FVector3f& Extent) const;
+
+private:
+    /** 归一化平面并填充 SoA 布局 */
+    static FGrassFrustum FromPlanes(FPlane (&RawPlanes)[6]);
+};
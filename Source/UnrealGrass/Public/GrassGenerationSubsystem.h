@@ -0,0 +1,69 @@
+// GrassGenerationSubsystem.h
+// 世界级的草地生成调度器
+// 关卡流送时几十个草地组件会在同一帧请求生成，这里把请求排队，按到相机的距离排序，
+// 每帧在 r.Grass.Generation.BudgetMs / r.Grass.Generation.MaxInstancesPerFrame 的预算内发起生成
+// 同时管理全局显存预算 (r.Grass.MemoryBudgetMB)：超出时释放离相机最远、最久没有被看到的组件的实例数据，
+// 回到范围内时重新加载
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GrassComponent.h"
+#include "GrassGenerationSubsystem.generated.h"
+
+UCLASS()
+class UNREALGRASS_API UGrassGenerationSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    /** r.Grass.Generation.Scheduler 全局开关 (关闭时 GenerateGrass 立即发起生成) */
+    static bool IsEnabled();
+
+    /** 加入生成队列；组件已在队列中时合并阶段 */
+    void RequestGeneration(UGrassComponent* Component, EGrassGenerationStage Stages);
+
+    /** 从队列中移除 (组件注销时调用) */
+    void CancelGeneration(UGrassComponent* Component);
+
+    /** 组件在队列中时立即发起它的生成 (WaitForGeneration 使用)，返回是否发起了生成 */
+    bool FlushGeneration(UGrassComponent* Component);
+
+    bool IsQueued(const UGrassComponent* Component) const;
+    int32 GetQueueDepth() const { return Queue.Num(); }
+
+    /** 纳入显存预算管理 (组件注册 / 注销时调用) */
+    void RegisterComponent(UGrassComponent* Component);
+    void UnregisterComponent(UGrassComponent* Component);
+
+    /** 所有受管理组件当前常驻的实例数据显存 */
+    uint64 GetResidentBytes() const;
+
+    // UTickableWorldSubsystem
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual bool IsTickableInEditor() const override { return true; }
+
+private:
+    struct FGenerationRequest
+    {
+        TWeakObjectPtr<UGrassComponent> Component;
+        EGrassGenerationStage Stages = EGrassGenerationStage::None;
+        double RequestTime = 0.0;
+    };
+
+    /** 当前帧的相机位置 (上一帧渲染的视图；没有时使用 PlayerController 的视点) */
+    void GatherViewLocations(TArray<FVector>& OutViewLocations) const;
+
+    /** 按距离排序队列并在预算内发起生成 */
+    void IssueQueuedGeneration(const TArray<FVector>& ViewLocations);
+
+    /** 超出显存预算时释放远处的组件，预算有空余时重新加载近处被释放的组件 */
+    void UpdateMemoryBudget(const TArray<FVector>& ViewLocations);
+
+    TArray<FGenerationRequest> Queue;
+
+    TArray<TWeakObjectPtr<UGrassComponent>> ManagedComponents;
+};
@@ -0,0 +1,130 @@
+// GrassInstanceBuffers.h
+// 草地实例 GPU Buffer 集合：生成输出 + 剔除输出 + Indirect Args
+// UGrassComponent 和 FGrassSceneProxy 共享同一份布局，异步生成时整体交换
+// 实例和可见 Buffer 是 FGrassBufferArena 共享页中的一段区间：Buffer / SRV / UAV 是整个页的，着色器按 *Offset 访问
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHIResources.h"
+#include "GrassInstancePacking.h"
+#include "GrassBufferArena.h"
+#include "GrassMemory.h"
+#include "GrassQuadtree.h"
+
+struct FGrassInstanceBuffers
+{
+    // 剔除块的大小和布局，与 GrassCullTile.ush 的 GRASS_CULL_TILE_SIZE / FGrassCullTile 一致
+    static constexpr int32 CullTileSize = 64;
+    static constexpr uint32 CullTileStride = 32;
+    // 两阶段遮挡剔除每个剔除块的可见位 (每个实例一位)
+    static constexpr int32 VisibilityWordsPerCullTile = CullTileSize / 32;
+
+    // ======== 所有实例 (Compute Shader 生成) ========
+    // 每个实例 16 字节 (uint4)，布局见 GrassInstancePacking.ush
+    FBufferRHIRef InstanceBuffer;
+    FShaderResourceViewRHIRef InstanceBufferSRV;
+    FUnorderedAccessViewRHIRef InstanceBufferUAV;
+    uint32 InstanceOffset = 0;
+    FGrassBufferAllocationRef InstanceAllocation;
+    int32 InstanceCount = 0;
+
+    // 位置量化范围 (本地坐标)，剔除和 Vertex Factory 解码位置时使用
+    FGrassInstanceQuantization Quantization;
+
+    // ======== LOD 0 可见实例 (剔除输出) ========
+    // bVisibleIndexLists 时每个元素是 InstanceBuffer 中的实例索引 (uint)，Vertex Factory 通过索引读取实例；
+    // 否则是与 InstanceBuffer 相同压缩格式的完整拷贝 (uint4)
+    bool bVisibleIndexLists = false;
+    FBufferRHIRef VisibleInstanceBuffer;
+    FShaderResourceViewRHIRef VisibleInstanceBufferSRV;
+    FUnorderedAccessViewRHIRef VisibleInstanceBufferUAV;
+    uint32 VisibleInstanceOffset = 0;
+    FGrassBufferAllocationRef VisibleInstanceAllocation;
+
+    // ======== Indirect Draw 参数 ========
+    // [0] IndexCountPerInstance
+    // [1] InstanceCount
+    // [2] StartIndexLocation
+    // [3] BaseVertexLocation
+    // [4] StartInstanceLocation
+    FBufferRHIRef IndirectArgsBuffer;
+    FUnorderedAccessViewRHIRef IndirectArgsBufferUAV;
+
+    // LOD 1 的 Indirect Draw 参数 (用于简化版草叶)
+    FBufferRHIRef IndirectArgsBufferLOD1;
+    FUnorderedAccessViewRHIRef IndirectArgsBufferLOD1UAV;
+
+    // ======== LOD 1 独立的 Visible Buffer ========
+    // LOD 1 使用独立的 buffer，避免与 LOD 0 数据冲突
+    FBufferRHIRef VisibleInstanceBufferLOD1;
+    FShaderResourceViewRHIRef VisibleInstanceBufferLOD1SRV;
+    FUnorderedAccessViewRHIRef VisibleInstanceBufferLOD1UAV;
+    uint32 VisibleInstanceLOD1Offset = 0;
+    FGrassBufferAllocationRef VisibleInstanceLOD1Allocation;
+
+    // ======== 分块层次剔除 (r.Grass.Culling.Tiles) ========
+    // 每 CullTileSize 个连续实例一个剔除块 (本地包围盒)，生成结束时由 GrassCullTileBuildCS 计算
+    FBufferRHIRef CullTileBuffer;
+    FShaderResourceViewRHIRef CullTileBufferSRV;
+    FUnorderedAccessViewRHIRef CullTileBufferUAV;
+    int32 NumCullTiles = 0;
+
+    // 每帧剔除时存活的块索引
+    FBufferRHIRef VisibleTileBuffer;
+    FShaderResourceViewRHIRef VisibleTileBufferSRV;
+    FUnorderedAccessViewRHIRef VisibleTileBufferUAV;
+
+    // 逐实例 Pass 的间接 Dispatch 参数: [0..2] 线程组数量, [3] 存活的块数量
+    FBufferRHIRef TileDispatchArgsBuffer;
+    FShaderResourceViewRHIRef TileDispatchArgsBufferSRV;
+    FUnorderedAccessViewRHIRef TileDispatchArgsBufferUAV;
+
+    // 稳定顺序剔除 (bStableVisibleOrder)：每个块的可见数量 (LOD 0, LOD 1)，扫描后原地变为输出起点
+    FBufferRHIRef TileVisibleCountBuffer;
+    FShaderResourceViewRHIRef TileVisibleCountBufferSRV;
+    FUnorderedAccessViewRHIRef TileVisibleCountBufferUAV;
+
+    // 两阶段遮挡剔除 (bTwoPhaseOcclusion)：每个实例一位，记录上一帧是否绘制，跨帧保留 (一直处于 UAVCompute)
+    FBufferRHIRef VisibilityBitsBuffer;
+    FUnorderedAccessViewRHIRef VisibilityBitsBufferUAV;
+
+    // 剔除块包围盒的 CPU 四叉树 (r.Grass.Culling.CpuQuadtree)，每次生成创建新的，回读完成前为空树
+    TSharedPtr<FGrassCullTileHierarchy, ESPMode::ThreadSafe> CullTileHierarchy;
+
+    // 生成这组实例时使用的 Clump 资源大小 (资源本身由 UGrassComponent 持有，只用于内存统计)
+    uint64 ClumpBytes = 0;
+
+    /** 是否已生成可用于渲染的实例数据 */
+    bool IsValid() const { return InstanceCount > 0 && InstanceBufferSRV.IsValid(); }
+
+    /** 剔除块 Buffer 是否可用 (启用 GPU Culling 且实例非空时创建) */
+    bool HasCullTiles() const { return NumCullTiles > 0 && CullTileBufferSRV.IsValid() && VisibleTileBufferUAV.IsValid() && TileDispatchArgsBufferUAV.IsValid(); }
+
+    /** 稳定顺序剔除 (计数 / 扫描 / 分散) 是否可用 */
+    bool HasStableCompaction() const { return NumCullTiles > 0 && TileVisibleCountBufferUAV.IsValid(); }
+
+    /** 两阶段遮挡剔除的可见位是否可用 */
+    bool HasVisibilityBits() const { return NumCullTiles > 0 && VisibilityBitsBufferUAV.IsValid(); }
+
+    static int32 GetNumCullTiles(int32 NumInstances) { return FMath::DivideAndRoundUp(NumInstances, CullTileSize); }
+
+    /** 这组 Buffer 占用的显存 (Buffer 池中的区间大小，不含页中的空闲部分) */
+    FGrassMemoryFootprint GetMemoryFootprint() const
+    {
+        const uint64 VisibleStride = bVisibleIndexLists ? sizeof(uint32) : FGrassInstancePacking::PackedStride;
+        const uint64 IndirectArgsBytes = 5 * sizeof(uint32);
+
+        FGrassMemoryFootprint Footprint;
+        Footprint.InstanceBytes = InstanceAllocation.IsValid() ? (uint64)InstanceAllocation->Count * FGrassInstancePacking::PackedStride : 0;
+        Footprint.VisibleBytes = (VisibleInstanceAllocation.IsValid() ? (uint64)VisibleInstanceAllocation->Count * VisibleStride : 0)
+            + (VisibleInstanceLOD1Allocation.IsValid() ? (uint64)VisibleInstanceLOD1Allocation->Count * VisibleStride : 0);
+        Footprint.IndirectArgsBytes = (IndirectArgsBuffer.IsValid() ? IndirectArgsBytes : 0) + (IndirectArgsBufferLOD1.IsValid() ? IndirectArgsBytes : 0);
+        Footprint.CullTileBytes = CullTileBuffer.IsValid() ? (uint64)NumCullTiles * (CullTileStride + sizeof(uint32) + (2 + VisibilityWordsPerCullTile) * sizeof(uint32)) + 4 * sizeof(uint32) : 0;
+        Footprint.ClumpBytes = ClumpBytes;
+        return Footprint;
+    }
+
+    /** 实例数据占用的显存，显存预算使用 */
+    uint64 GetResidentBytes() const { return GetMemoryFootprint().GetInstanceDataBytes(); }
+};
@@ -0,0 +1,80 @@
+// GrassInstanceCache.h
+// 草地实例数据的磁盘缓存 (Saved/GrassCache/<Key>.grass)
+// 生成结果只依赖生成参数和高度图内容，Key 命中时直接异步读取文件并上传，跳过所有 Compute Shader
+// 未命中时在 GPU 生成完成后回读 Buffer 并异步写入文件
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "GrassCpuGenerator.h"
+
+struct FGrassGenerationParams;
+struct FGrassInstanceBuffers;
+class FRHIGPUBufferReadback;
+class FRHICommandListImmediate;
+class UTexture2D;
+
+using FGrassCpuInstanceDataPtr = TSharedPtr<FGrassCpuInstanceData, ESPMode::ThreadSafe>;
+
+struct UNREALGRASS_API FGrassInstanceCache
+{
+    /** 缓存文件格式版本，修改文件布局或生成 Shader 的输出时需要递增 */
+    static constexpr uint32 CacheVersion = 3;
+
+    /** 缓存 Key：生成参数 + 高度图内容哈希 (十六进制 SHA1) */
+    static FString ComputeKey(const FGrassGenerationParams& Params);
+
+    /** 纹理内容哈希 (高度图 / 权重图 / 密度贴图；编辑器中使用源数据 Id，修改地形或贴图后会变化) */
+    static uint32 HashTexture(const UTexture2D* Texture);
+
+    /** r.Grass.InstanceCache 全局开关 */
+    static bool IsEnabled();
+
+    static FString GetCacheFilePath(const FString& Key);
+    static bool Contains(const FString& Key);
+
+    /** 在线程池中读取并校验缓存文件，失败时返回空指针 (使用密度遮罩时实际数量小于 MaxInstanceCount) */
+    static TFuture<FGrassCpuInstanceDataPtr> LoadAsync(const FString& Key, int32 MaxInstanceCount);
+
+    /** 在线程池中写入缓存文件 */
+    static void SaveAsync(const FString& Key, FGrassCpuInstanceDataPtr Data);
+
+    /** 同步读写 (供上面的异步版本和工具使用) */
+    static FGrassCpuInstanceDataPtr Load(const FString& Key, int32 MaxInstanceCount);
+    static bool Save(const FString& Key, const FGrassCpuInstanceData& Data);
+
+    // ======== 统计 (grass.CacheStats) ========
+    static void RecordHit(int64 BytesLoaded, double LoadSeconds);
+    static void RecordMiss(double GenerateSeconds);
+    static void LogStats();
+};
+
+/**
+ * GPU 生成结果的回读 (缓存未命中时使用)
+ * 渲染线程发起拷贝，之后由游戏线程每帧发起一次轮询，就绪后在线程池中写入缓存文件
+ */
+class UNREALGRASS_API FGrassCacheReadback
+{
+public:
+    explicit FGrassCacheReadback(const FString& InKey);
+    ~FGrassCacheReadback();
+
+    /** 拷贝 Buffers 中的全部实例 (数量以 Buffers.InstanceCount 为准，密度遮罩剔除后才能确定) */
+    void EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, const FGrassInstanceBuffers& Buffers);
+
+    /** 拷贝完成时读取数据并发起写入，返回是否已经完成 */
+    bool Poll_RenderThread();
+
+    bool IsComplete() const { return bComplete; }
+
+private:
+    FString Key;
+    int32 InstanceCount = 0;
+
+    FGrassInstanceQuantization Quantization;
+
+    TUniquePtr<FRHIGPUBufferReadback> InstanceReadback;
+
+    std::atomic<bool> bComplete = false;
+};
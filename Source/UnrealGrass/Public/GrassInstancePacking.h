@@ -0,0 +1,62 @@
+// GrassInstancePacking.h
+// 草叶实例的 16 字节压缩格式的 CPU 编解码
+// 与 GrassInstancePacking.ush 使用相同的位布局 (CPU 生成、磁盘缓存和调试工具使用)，修改时必须同步
+//
+// 每个实例从 48 字节 (Position float3 + GrassData0 float4 + GrassData1 float4 + GrassData2 float) 压缩为 16 字节:
+// Position    20 / 20 / 16 bit，相对于生成范围量化
+// FacingAngle 8 bit (256 等分)
+// Height / Width  half
+// Tilt / Bend / P1Offset / P2Offset  8 bit unorm
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** 解码后的草叶实例 */
+struct FGrassInstance
+{
+    FVector3f Position = FVector3f::ZeroVector;     // 本地坐标 (相对于草地组件)
+    float Height = 0.0f;
+    float Width = 0.0f;
+    float Tilt = 0.0f;
+    float Bend = 0.0f;
+    FVector2f FacingDir = FVector2f(1.0f, 0.0f);    // 单位向量
+    float P1Offset = 0.0f;
+    float P2Offset = 0.0f;
+};
+
+/** 位置量化范围 (本地坐标)，随实例 Buffer 一起传给剔除和 Vertex Factory */
+struct FGrassInstanceQuantization
+{
+    FVector3f Min = FVector3f::ZeroVector;
+    FVector3f Size = FVector3f::OneVector;
+
+    static FGrassInstanceQuantization FromBox(const FBox3f& Box)
+    {
+        FGrassInstanceQuantization Quantization;
+        Quantization.Min = Box.Min;
+        Quantization.Size = (Box.Max - Box.Min).ComponentMax(FVector3f(1e-4f));
+        return Quantization;
+    }
+
+    bool operator==(const FGrassInstanceQuantization& Other) const { return Min == Other.Min && Size == Other.Size; }
+};
+
+struct UNREALGRASS_API FGrassInstancePacking
+{
+    static constexpr uint32 PositionXYBits = 20;
+    static constexpr uint32 PositionZBits = 16;
+    static constexpr uint32 FacingSteps = 256;
+
+    /** 压缩后每个实例的字节数 */
+    static constexpr uint32 PackedStride = sizeof(FUintVector4);
+
+    static FUintVector4 Pack(const FGrassInstance& Instance, const FGrassInstanceQuantization& Quantization);
+    static FGrassInstance Unpack(const FUintVector4& Packed, const FGrassInstanceQuantization& Quantization);
+
+    /** 只解码位置 (剔除使用) */
+    static FVector3f UnpackPosition(const FUintVector4& Packed, const FGrassInstanceQuantization& Quantization);
+
+    /** 位置的最大量化误差 (每个轴半个量化步长) */
+    static FVector3f GetMaxPositionError(const FGrassInstanceQuantization& Quantization);
+};
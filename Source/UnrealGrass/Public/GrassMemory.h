@@ -0,0 +1,37 @@
+// GrassMemory.h
+// 草地 GPU 内存统计
+// 每个组件按类别汇总自己占用的显存 (FGrassMemoryFootprint)，提交生成结果时更新 stat Grass 的内存计数器，
+// grass.MemReport 列出每个组件的明细 (测试见自动化测试 UnrealGrass.MemoryAccounting)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct UNREALGRASS_API FGrassMemoryFootprint
+{
+    uint64 InstanceBytes = 0;       // 实例区间 (16 字节 / 实例)
+    uint64 VisibleBytes = 0;        // LOD 0 + LOD 1 可见区间 (索引 4 字节 / 完整拷贝 16 字节)
+    uint64 IndirectArgsBytes = 0;   // LOD 0 + LOD 1 Indirect Draw 参数
+    uint64 CullTileBytes = 0;       // 剔除块包围盒 + 存活块列表 + 间接 Dispatch 参数
+    uint64 ClumpBytes = 0;          // Clump 数据 + 空间哈希网格 + Voronoi 纹理 + ClumpType 参数
+
+    /** 实例数据的显存 (显存预算释放组件时能回收的部分，Clump 数据留在组件上) */
+    uint64 GetInstanceDataBytes() const { return InstanceBytes + VisibleBytes + IndirectArgsBytes + CullTileBytes; }
+    uint64 GetTotalBytes() const { return GetInstanceDataBytes() + ClumpBytes; }
+
+    FGrassMemoryFootprint& operator+=(const FGrassMemoryFootprint& Other)
+    {
+        InstanceBytes += Other.InstanceBytes;
+        VisibleBytes += Other.VisibleBytes;
+        IndirectArgsBytes += Other.IndirectArgsBytes;
+        CullTileBytes += Other.CullTileBytes;
+        ClumpBytes += Other.ClumpBytes;
+        return *this;
+    }
+
+    /** 一次 GPU 生成创建的 Clump 相关资源大小 (与 GenerateGrass_RenderThread 中的 Buffer / 纹理一一对应) */
+    static uint64 ComputeClumpBytes(int32 NumClumps, int32 ClumpGridDim, int32 VoronoiTextureSize, int32 NumClumpTypes);
+
+    /** 把组件的统计从 Old 改为 New (stat Grass 内存计数器，组件注册期间有效) */
+    static void UpdateStats(const FGrassMemoryFootprint& Old, const FGrassMemoryFootprint& New);
+};
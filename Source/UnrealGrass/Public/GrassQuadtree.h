@@ -0,0 +1,108 @@
+// GrassQuadtree.h
+// 剔除块的 CPU 四叉树 (渲染线程在 GPU 剔除之前预剔除)
+// 叶子是剔除块 (每块 FGrassInstanceBuffers::CullTileSize 个连续实例)，每 4 个相邻节点合并为一个父节点，
+// 所以任何节点都对应一段连续的实例区间；生成按网格行 / 线程组连续输出，相邻的块在空间上也相邻
+// 查询返回与视锥相交且在可见距离内的实例区间 (按起点排序，相邻区间合并)，GPU 剔除只对这些区间 Dispatch
+// FGrassQuadtree 本身不依赖 RHI (测试见自动化测试 UnrealGrass.Quadtree，基准测试见 grass.BenchmarkQuadtree)；
+// 包围盒来自 GrassCullTileBuildCS 的输出，由 FGrassCullTileHierarchy 在生成时异步回读
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrassFrustum.h"
+
+class FRHIBuffer;
+class FRHIGPUBufferReadback;
+class FRHICommandListImmediate;
+
+/** 一个剔除块的本地包围盒，与 GPU 端 FGrassCullTile (GrassCullTile.ush) 的布局相同，回读结果可以直接使用 */
+struct FGrassQuadtreeTile
+{
+    FVector3f BoundsMin;
+    uint32 NumInstances = 0;
+    FVector3f BoundsMax;
+    uint32 Padding = 0;
+};
+static_assert(sizeof(FGrassQuadtreeTile) == 32, "FGrassQuadtreeTile must match FGrassCullTile in GrassCullTile.ush");
+
+/** 一段连续的实例 */
+struct FGrassInstanceRange
+{
+    uint32 FirstInstance = 0;
+    uint32 NumInstances = 0;
+};
+
+class UNREALGRASS_API FGrassQuadtree
+{
+public:
+    /** 每个节点的子节点数量 */
+    static constexpr int32 Fanout = 4;
+
+    /** 从剔除块构建 (TileSize 个实例一块，最后一块可以不满) */
+    void Build(TConstArrayView<FGrassQuadtreeTile> Tiles, int32 TileSize);
+
+    void Reset();
+
+    bool IsValid() const { return Nodes.Num() > 0; }
+    int32 GetNumNodes() const { return Nodes.Num(); }
+    int32 GetNumTiles() const { return NumTiles; }
+    uint32 GetNumInstances() const { return NumInstances; }
+    SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize(); }
+
+    struct FQueryStats
+    {
+        int32 NodesTested = 0;
+        int32 NodesAccepted = 0;    // 完全在视锥内、不再细分直接接受的节点 (包括叶子)
+    };
+
+    /**
+     * 查询与视锥相交的实例区间 (视锥和视点都在四叉树的本地空间)
+     * @param BoundsExpand  包围盒向外扩展的距离 (草叶的包围半径)
+     * @param MaxDistance   <= 0 时不做距离剔除
+     * @param MaxRanges     区间数量上限，超过时合并间隔最小的相邻区间 (每个区间一次 Dispatch)
+     */
+    void Query(const FGrassFrustum& Frustum, const FVector3f& ViewOrigin, float MaxDistance, float BoundsExpand, int32 MaxRanges,
+        TArray<FGrassInstanceRange>& OutRanges, FQueryStats* OutStats = nullptr) const;
+
+private:
+    struct FNode
+    {
+        FVector3f Center;
+        uint32 FirstTile = 0;
+        FVector3f Extent;
+        uint32 NumTiles = 0;
+        int32 FirstChild = INDEX_NONE;   // 子节点在 Nodes 中连续存放
+        int32 NumChildren = 0;
+    };
+
+    // 按层存放，叶子在前，根节点是最后一个
+    TArray<FNode> Nodes;
+    int32 NumTiles = 0;
+    int32 TileSize = 0;
+    uint32 NumInstances = 0;
+};
+
+/**
+ * 一组实例 Buffer 的 CPU 四叉树 (FGrassInstanceBuffers::CullTileHierarchy，只在渲染线程访问)
+ * 生成时回读剔除块 Buffer，回读完成前 Poll 返回 false，剔除按全部实例 Dispatch
+ */
+class UNREALGRASS_API FGrassCullTileHierarchy
+{
+public:
+    FGrassCullTileHierarchy();
+    ~FGrassCullTileHierarchy();
+
+    /** 拷贝剔除块包围盒 (GrassCullTileBuildCS 之后调用，CullTileBuffer 处于 SRVMask) */
+    void EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, FRHIBuffer* CullTileBuffer, int32 InNumTiles, int32 InTileSize);
+
+    /** 回读完成时构建四叉树，返回四叉树是否可用 */
+    bool Poll_RenderThread();
+
+    const FGrassQuadtree& GetQuadtree() const { return Quadtree; }
+
+private:
+    TUniquePtr<FRHIGPUBufferReadback> Readback;
+    FGrassQuadtree Quadtree;
+    int32 NumTiles = 0;
+    int32 TileSize = 0;
+};
@@ -0,0 +1,55 @@
+// GrassRangeAllocator.h
+// 一维区间分配器 (Best-Fit 空闲链表 + 相邻空闲区间合并)
+// FGrassBufferArena 用它在大块 GPU Buffer 中分配元素区间，本身不依赖 RHI (测试见自动化测试 UnrealGrass.RangeAllocator)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UNREALGRASS_API FGrassRangeAllocator
+{
+public:
+    static constexpr uint32 InvalidOffset = MAX_uint32;
+
+    FGrassRangeAllocator() = default;
+    explicit FGrassRangeAllocator(uint32 InCapacity) { Reset(InCapacity); }
+
+    /** 清空所有分配，整个 [0, Capacity) 变为一个空闲区间 */
+    void Reset(uint32 InCapacity);
+
+    /** 分配 Size 个元素，返回起始偏移；空间不足 (或碎片过多) 时返回 InvalidOffset */
+    uint32 Allocate(uint32 Size);
+
+    /** 释放 Allocate 返回的区间 (只需要起始偏移)，与相邻的空闲区间合并 */
+    void Free(uint32 Offset);
+
+    /** 返回 Offset 处分配的大小，没有分配时返回 0 */
+    uint32 GetAllocationSize(uint32 Offset) const;
+
+    uint32 GetCapacity() const { return Capacity; }
+    uint32 GetUsedSize() const { return UsedSize; }
+    uint32 GetFreeSize() const { return Capacity - UsedSize; }
+    int32 GetNumAllocations() const { return Allocations.Num(); }
+    int32 GetNumFreeRanges() const { return FreeRanges.Num(); }
+    uint32 GetLargestFreeRange() const;
+    bool IsEmpty() const { return UsedSize == 0; }
+
+    /** 检查内部一致性 (空闲区间有序、不重叠、没有相邻未合并，与分配表一起正好覆盖整个容量) */
+    bool Validate() const;
+
+private:
+    struct FRange
+    {
+        uint32 Offset;
+        uint32 Size;
+    };
+
+    /** 按 Offset 排序的空闲区间 */
+    TArray<FRange> FreeRanges;
+
+    /** 已分配区间：Offset -> Size */
+    TMap<uint32, uint32> Allocations;
+
+    uint32 Capacity = 0;
+    uint32 UsedSize = 0;
+};
@@ -6,10 +6,24 @@
 #include "CoreMinimal.h"
 #include "PrimitiveSceneProxy.h"
 #include "GrassVertexFactory.h"
+#include "GrassInstanceBuffers.h"
+#include "GrassViewCulling.h"
+#include "GrassShadowCulling.h"
 #include "StaticMeshResources.h"
+#include "RenderGraphDefinitions.h"
 
 class UGrassComponent;
 class FGrassCullingViewExtension;
+class FGrassCullingGraph;
+
+/** 两阶段遮挡剔除的阶段，与 GrassFrustumCulling.usf 的 GRASS_OCCLUSION_PHASE 对应 */
+enum class EGrassOcclusionPhase : int32
+{
+    Single = 0,     // 只用上一帧的 Hi-Z 剔除一次
+    Main = 1,       // 主 Pass：上一帧可见的实例
+    Post = 2,       // 后 Pass：其余实例，使用当前帧的 Hi-Z
+    Amortized = 3,  // 单 Pass，远处实例的 Hi-Z 测试分摊到多帧 (结果保存在可见位)
+};
 
 class FGrassSceneProxy : public FPrimitiveSceneProxy
 {
@@ -24,20 +38,60 @@ public:
     virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override;
     virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const override;
 
-    /** 执行 GPU Frustum Culling (必须在渲染线程调用) */
+    /** 执行 GPU Frustum Culling (必须在渲染线程调用，不在场景渲染中：在本地的 RDG 中执行) */
     void PerformGPUCulling(FRHICommandListImmediate& RHICmdList, const FSceneView* View) const;
 
-    /** 执行带 Hi-Z 遮挡剔除的 GPU Culling */
+    /**
+     * 执行带 Hi-Z 遮挡剔除的 GPU Culling
+     * StereoPairView 是立体渲染的另一只眼睛：两只眼睛视锥的并集剔除一次，LOD 从两眼中点选择 (不使用 Hi-Z)；
+     * 实例化立体渲染时 Indirect Args 的实例数量乘 2，一次绘制两只眼睛
+     * 剔除 Pass 添加到 Graph 中 (Graph 允许时在异步计算管线上执行)，输出在下一次 PublishDrawnBuffers 之后可以绘制
+     */
     void PerformGPUCullingWithHiZ(
-        FRHICommandListImmediate& RHICmdList,
+        const FGrassCullingGraph& Graph,
+        const FSceneView* View,
+        FRDGTextureRef HiZTexture,
+        FIntPoint HiZSize,
+        const FMatrix& HiZViewProjectionMatrix,
+        const FSceneView* StereoPairView = nullptr) const;
+
+    /**
+     * 两阶段遮挡剔除的后 Pass：用当前帧深度生成的 Hi-Z 测试主 Pass 没有绘制的实例，可见的追加到本帧的可见列表
+     * 只在本帧已经执行过主 Pass (PerformGPUCullingWithHiZ) 时生效
+     */
+    void PerformGPUCullingPostPass(
+        const FGrassCullingGraph& Graph,
         const FSceneView* View,
-        FRHITexture* HiZTexture,
+        FRDGTextureRef HiZTexture,
         FIntPoint HiZSize,
         const FMatrix& HiZViewProjectionMatrix) const;
 
-    /** 在渲染线程上执行 GPU Frustum Culling (使用预提取的数据) */
+    /** 是否使用两阶段遮挡剔除 (组件设置 + r.Grass.Culling.TwoPhaseOcclusion，必须在渲染线程调用) */
+    bool UsesTwoPhaseOcclusion() const;
+
+    /**
+     * 次要视图的剔除 (分屏的其余视图、其他视口、场景捕获)：输出到视图池中这个视图的槽位，只做视锥 / 距离剔除
+     * bCaptureView 时应用组件的捕获预算；池满 (r.Grass.Culling.MaxViewSlots) 时不剔除，视图绘制主视图的剔除输出
+     * StereoPairView 与 PerformGPUCullingWithHiZ 相同 (实例化立体渲染的眼睛在槽位中剔除时)
+     */
+    void PerformGPUCullingForView(const FGrassCullingGraph& Graph, const FSceneView* View, bool bCaptureView,
+        const FSceneView* StereoPairView = nullptr) const;
+
+    /** 是否投射草叶阴影 (组件的 bCastGrassShadows + r.Grass.Shadows，需要 Indirect Draw 和 GPU Culling) */
+    bool CastsGrassShadows() const;
+
+    /** 视图族开始时 (渲染线程)：按 r.Grass.Shadow.MaxCascades 准备阴影级联的槽位，清空上一个视图族的领取 */
+    void BeginShadowCulling_RenderThread(FRHICommandListImmediate& RHICmdList) const;
+
+    /** 剔除本视图族阴影收集时领取的所有级联 (渲染线程，阴影收集之后、阴影深度绘制之前)，已经剔除的级联跳过 */
+    void PerformShadowCulling_RenderThread(const FGrassCullingGraph& Graph) const;
+
+    /** 在渲染线程上执行 GPU Frustum Culling (使用预提取的数据，在本地的 RDG 中执行) */
     void PerformGPUCullingRenderThread(FRHICommandListImmediate& RHICmdList, const FMatrix& ViewProjectionMatrix, const FVector& ViewOrigin, const FMatrix& LocalToWorldMatrix) const;
 
+    /** 替换实例 Buffer (异步生成完成时调用，必须在渲染线程调用) */
+    void SwapInstanceBuffers_RenderThread(const FGrassInstanceBuffers& NewBuffers);
+
     /** 是否启用了 GPU Culling */
     bool IsGPUCullingEnabled() const { return bEnableFrustumCulling && bUseIndirectDraw; }
 
@@ -51,6 +105,43 @@ private:
     /** 初始化 LOD 1 草叶网格 (7 顶点简化版) */
     void InitLOD1GrassBlade();
 
+    /** 根据当前 InstanceBuffers 为 LOD 0 / LOD 1 Vertex Factory 设置实例 SRV */
+    void UpdateVertexFactoryBuffers();
+
+    /**
+     * 带 Hi-Z 的剔除 (PerformGPUCullingWithHiZ / PerformGPUCullingPostPass / PerformGPUCullingForView 共用)，后 Pass 不重置 Indirect Args
+     * Buffers 是主视图的 InstanceBuffers 或次要视图槽位的 Buffers
+     */
+    void CullWithHiZ_RenderThread(
+        const FGrassCullingGraph& Graph,
+        const FGrassInstanceBuffers& Buffers,
+        const FSceneView* View,
+        FRDGTextureRef HiZTexture,
+        FIntPoint HiZSize,
+        const FMatrix& HiZViewProjectionMatrix,
+        EGrassOcclusionPhase Phase,
+        const FGrassViewCullingBudget& Budget = FGrassViewCullingBudget(),
+        const FSceneView* StereoPairView = nullptr) const;
+
+    /**
+     * 剔除结果的时间复用 (r.Grass.Culling.TemporalReuse)：签名与 History 一致时返回 true，调用方沿用上一次的剔除输出
+     * 返回 false 时 History 已经记录本帧的签名，调用方执行完整剔除
+     */
+    bool ShouldReuseCulling(
+        FGrassCullingHistory& History,
+        const FSceneView& View,
+        const FSceneView* StereoPairView,
+        const FGrassInstanceBuffers& Buffers,
+        bool bUsesHiZ,
+        EGrassOcclusionPhase Phase,
+        const FGrassViewCullingBudget& Budget) const;
+
+    /** 一个阴影级联的剔除：级联的剔除体 + 阴影距离上限 + 阴影密度，所有可见实例输出到一个可见列表 (不使用 Hi-Z) */
+    void CullShadowCascade_RenderThread(const FGrassCullingGraph& Graph, const FGrassShadowCascade& Cascade) const;
+
+    /** 阴影深度使用的 Mesh 是否为 LOD 1 */
+    bool UsesLOD1ForShadow() const { return bShadowUseLOD1 && VertexFactoryLOD1.IsInitialized() && NumIndicesLOD1 > 0; }
+
     // ======== LOD 0 草叶 Mesh (15 顶点) ========
     FStaticMeshVertexBuffers VertexBuffers;
     FGrassVertexFactory VertexFactory;  // 使用自定义 Vertex Factory
@@ -68,66 +159,28 @@ private:
     int32 NumPrimitivesLOD1 = 0;
 
     // ======== 实例数据 ========
-    // 所有实例位置 Buffer (用于 Culling 输入)
-    FBufferRHIRef PositionBuffer;
-    FShaderResourceViewRHIRef PositionBufferSRV;
+    // 所有实例 / 可见实例 / Indirect Args Buffers (与 UGrassComponent 共享布局)
+    FGrassInstanceBuffers InstanceBuffers;
     int32 TotalInstanceCount = 0;  // 总实例数量
 
-    // 草叶属性数据 Buffers (用于 Bezier 变形)
-    FShaderResourceViewRHIRef GrassData0SRV;  // Height, Width, Tilt, Bend
-    FShaderResourceViewRHIRef GrassData1SRV;  // TaperAmount, FacingDir.x, FacingDir.y, P1Offset
-    FShaderResourceViewRHIRef GrassData2SRV;  // P2Offset
-
-    // 可见实例位置 Buffer (Culling 输出，用于渲染)
-    FBufferRHIRef VisiblePositionBuffer;
-    FShaderResourceViewRHIRef VisiblePositionBufferSRV;
-    FUnorderedAccessViewRHIRef VisiblePositionBufferUAV;
-
-    // 可见实例属性 Buffers (Culling 输出，用于渲染)
-    FBufferRHIRef VisibleGrassData0Buffer;  // Height, Width, Tilt, Bend
-    FShaderResourceViewRHIRef VisibleGrassData0SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData0UAV;
-    
-    FBufferRHIRef VisibleGrassData1Buffer;  // TaperAmount, FacingDir.x, FacingDir.y, P1Offset
-    FShaderResourceViewRHIRef VisibleGrassData1SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData1UAV;
-    
-    FBufferRHIRef VisibleGrassData2Buffer;  // P2Offset
-    FShaderResourceViewRHIRef VisibleGrassData2SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData2UAV;
-
     // ======== Indirect Draw 支持 ========
     bool bUseIndirectDraw = false;
-    FBufferRHIRef IndirectArgsBuffer;
-    FUnorderedAccessViewRHIRef IndirectArgsBufferUAV;
-    
-    // LOD 1 的 Indirect Draw Args
-    FBufferRHIRef IndirectArgsBufferLOD1;
-    FUnorderedAccessViewRHIRef IndirectArgsBufferLOD1UAV;
-
-    // ======== LOD 1 独立的 Visible Buffers ========
-    FBufferRHIRef VisiblePositionBufferLOD1;
-    FShaderResourceViewRHIRef VisiblePositionBufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisiblePositionBufferLOD1UAV;
-    
-    FBufferRHIRef VisibleGrassData0BufferLOD1;
-    FShaderResourceViewRHIRef VisibleGrassData0BufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData0BufferLOD1UAV;
-    
-    FBufferRHIRef VisibleGrassData1BufferLOD1;
-    FShaderResourceViewRHIRef VisibleGrassData1BufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData1BufferLOD1UAV;
-    
-    FBufferRHIRef VisibleGrassData2BufferLOD1;
-    FShaderResourceViewRHIRef VisibleGrassData2BufferLOD1SRV;
-    FUnorderedAccessViewRHIRef VisibleGrassData2BufferLOD1UAV;
 
     // ======== GPU Culling 参数 ========
     bool bEnableFrustumCulling = false;
     bool bEnableDistanceCulling = false;
     bool bEnableOcclusionCulling = false;  // Hi-Z 遮挡剔除
+    bool bStableVisibleOrder = false;      // 可见列表保持实例顺序 (计数 / 扫描 / 分散)
+    bool bTwoPhaseOcclusion = false;       // 两阶段遮挡剔除 (上一帧可见的实例先绘制，其余用当前帧 Hi-Z 测试)
     float MaxVisibleDistance = 10000.0f;
     float GrassBoundingRadius = 50.0f;
+    FGrassViewCullingBudget CaptureBudget;  // 场景捕获 / 反射捕获视图的剔除预算
+
+    // ======== 阴影参数 ========
+    bool bCastGrassShadows = false;
+    float ShadowMaxDistance = 2000.0f;
+    float ShadowDensity = 0.5f;
+    bool bShadowUseLOD1 = true;
 
     // ======== LOD 参数 ========
     bool bEnableLOD = true;
@@ -140,6 +193,20 @@ private:
     // 标记当前帧是否已执行剔除
     mutable bool bCullingPerformedThisFrame = false;
     mutable uint32 LastFrameNumber = 0;
+    mutable uint32 LastPostPassFrameNumber = 0;
+
+    // 主视图最近一次完整剔除的签名；本帧沿用上一次的输出时不执行后 Pass
+    mutable FGrassCullingHistory PrimaryCullingHistory;
+    mutable bool bPrimaryCullingReused = false;
+
+    // 分摊的遮挡测试 (r.Grass.Culling.Amortize.Frames) 正在使用的可见位 Buffer (换成其他 Buffer 或停止分摊后重新初始化)
+    mutable FBufferRHIRef AmortizedVisibilityBits;
+
+    // 次要视图的剔除输出 (每个视图一个槽位，只在渲染线程访问)
+    mutable FGrassViewCullingPool ViewCullingPool;
+
+    // 阴影级联的剔除输出 (领取在阴影收集时，可能不在渲染线程)
+    mutable FGrassShadowCascadePool ShadowCascadePool;
 
     // 材质
     UMaterialInterface* Material = nullptr;
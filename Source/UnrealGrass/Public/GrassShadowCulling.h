@@ -0,0 +1,67 @@
+// GrassShadowCulling.h
+// 阴影深度的剔除：每个阴影视图 (CSM 的每个级联、其他投射阴影的光源) 单独剔除，各自有可见列表和 Indirect Args
+// GetDynamicMeshElements 收集阴影时 (视图带有 ShadowCullFrustum) 领取一个级联槽位并记录光源空间的剔除体，
+// Base Pass 之后 (FGrassCullingViewExtension::PostRenderBasePassDeferred_RenderThread) 剔除本视图族领取的所有级联；
+// 槽位在视图族开始时 (PreRenderViewFamily) 按 r.Grass.Shadow.MaxCascades 预先分配，收集阶段不创建资源
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrassInstanceBuffers.h"
+#include "GrassVertexFactory.h"
+#include "GrassFrustum.h"
+
+struct FConvexVolume;
+class FRHICommandListImmediate;
+
+/** 一个阴影视图的剔除输出 (只有一个可见列表，阴影只绘制一个 Mesh) */
+struct FGrassShadowCascade
+{
+    FGrassInstanceBuffers Buffers;
+
+    // 绘制时通过 FMeshBatchElement::UserData 传给 Vertex Factory
+    FGrassVisibleListBinding Binding;
+
+    // 领取时记录：世界空间的剔除体 (已经去掉 PreShadowTranslation)，距离上限从主视图的相机位置计算
+    FGrassFrustum Frustum;
+    FVector ViewOrigin = FVector::ZeroVector;
+
+    bool bClaimed = false;
+    bool bCulled = false;
+};
+
+class UNREALGRASS_API FGrassShadowCascadePool
+{
+public:
+    FGrassShadowCascadePool() = default;
+    ~FGrassShadowCascadePool();
+
+    FGrassShadowCascadePool(const FGrassShadowCascadePool&) = delete;
+    FGrassShadowCascadePool& operator=(const FGrassShadowCascadePool&) = delete;
+
+    /**
+     * 视图族开始时 (渲染线程)：保证有 NumCascades 个槽位 (实例 Buffer 改变时重新分配)，清空上一个视图族的领取
+     * NumCascades 为 0 时释放所有槽位
+     */
+    void Begin(FRHICommandListImmediate& RHICmdList, const FGrassInstanceBuffers& Shared, int32 NumCascades);
+
+    /** 阴影收集时领取一个槽位 (任意线程)，槽位用完时返回 nullptr (这个阴影视图不绘制草) */
+    const FGrassShadowCascade* Claim(const FConvexVolume& ShadowCullVolume, const FVector& PreShadowTranslation, const FVector& ViewOrigin);
+
+    /** 已经领取、还没有剔除的级联 (渲染线程)，返回时标记为已剔除 */
+    void TakePendingCascades(TArray<const FGrassShadowCascade*, TInlineAllocator<8>>& OutCascades);
+
+    /** 释放所有槽位 (实例 Buffer 交换时，可见列表的大小随之改变) */
+    void Reset();
+
+    int32 Num() const { return Cascades.Num(); }
+    uint64 GetAllocatedBytes() const { return AllocatedBytes; }
+
+private:
+    // 槽位地址在绘制期间被 FMeshBatchElement::UserData 引用，单独分配
+    TArray<TUniquePtr<FGrassShadowCascade>> Cascades;
+    uint64 AllocatedBytes = 0;
+
+    // 阴影收集可能在多个任务中并行执行
+    FCriticalSection ClaimLock;
+};
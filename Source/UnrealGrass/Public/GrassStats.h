@@ -0,0 +1,60 @@
+// GrassStats.h
+// 草地插件的 Stat 分组和计数器 (stat Grass) 以及 LLM 标签 (-llm 时在 Grass/* 下统计)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/LowLevelMemTracker.h"
+
+DECLARE_STATS_GROUP(TEXT("Grass"), STATGROUP_Grass, STATCAT_Advanced);
+
+// ======== LLM 标签 (GrassMemory.cpp) ========
+LLM_DECLARE_TAG_API(Grass, UNREALGRASS_API);
+LLM_DECLARE_TAG_API(Grass_Instances, UNREALGRASS_API);
+LLM_DECLARE_TAG_API(Grass_VisibleBuffers, UNREALGRASS_API);
+LLM_DECLARE_TAG_API(Grass_IndirectArgs, UNREALGRASS_API);
+LLM_DECLARE_TAG_API(Grass_CullTiles, UNREALGRASS_API);
+LLM_DECLARE_TAG_API(Grass_Clumps, UNREALGRASS_API);
+LLM_DECLARE_TAG_API(Grass_HiZ, UNREALGRASS_API);
+
+// ======== GPU 内存 (GrassMemory.cpp) ========
+// 前五项是所有已注册组件提交的数据之和 (FGrassMemoryFootprint)；Buffer 池是实际创建的页 (含空闲区间)
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Instance Buffers"), STAT_GrassInstanceBufferMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Visible Buffers"), STAT_GrassVisibleBufferMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Indirect Args Buffers"), STAT_GrassIndirectArgsMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Cull Tile Buffers"), STAT_GrassCullTileMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Clump Data"), STAT_GrassClumpMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Buffer Arena Pages"), STAT_GrassBufferArenaMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Hi-Z Texture"), STAT_GrassHiZMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Per-View Culling Buffers"), STAT_GrassViewCullingMemory, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Shadow Cascade Culling Buffers"), STAT_GrassShadowCullingMemory, STATGROUP_Grass, UNREALGRASS_API);
+
+// ======== 实例数据磁盘缓存 ========
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Instance Cache Hits"), STAT_GrassInstanceCacheHits, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Instance Cache Misses"), STAT_GrassInstanceCacheMisses, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Instance Cache Bytes Loaded"), STAT_GrassInstanceCacheBytesLoaded, STATGROUP_Grass, UNREALGRASS_API);
+
+// ======== 生成调度器 (UGrassGenerationSubsystem) ========
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Generation Queue Depth"), STAT_GrassGenerationQueueDepth, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Generation Requests Issued"), STAT_GrassGenerationRequestsIssued, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Generation Instances Issued"), STAT_GrassGenerationInstancesIssued, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generation Scheduler"), STAT_GrassGenerationSchedulerTime, STATGROUP_Grass, UNREALGRASS_API);
+
+// ======== 显存预算 (r.Grass.MemoryBudgetMB) ========
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Resident Instance Memory"), STAT_GrassResidentBytes, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Instance Memory Budget"), STAT_GrassMemoryBudget, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Evicted Components"), STAT_GrassEvictedComponents, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Evictions"), STAT_GrassEvictions, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Reloads"), STAT_GrassReloads, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Memory Budget Update"), STAT_GrassMemoryBudgetTime, STATGROUP_Grass, UNREALGRASS_API);
+
+// ======== CPU 四叉树预剔除 (r.Grass.Culling.CpuQuadtree，GrassSceneProxy.cpp) ========
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Quadtree Dispatched Instances"), STAT_GrassQuadtreeDispatchedInstances, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Quadtree Skipped Instances"), STAT_GrassQuadtreeSkippedInstances, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Quadtree Dispatch Ranges"), STAT_GrassQuadtreeRanges, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Quadtree Query"), STAT_GrassQuadtreeQueryTime, STATGROUP_Grass, UNREALGRASS_API);
+
+// ======== 剔除结果的时间复用 (r.Grass.Culling.TemporalReuse，GrassSceneProxy.cpp) ========
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Culling Reused Views"), STAT_GrassCullingReusedViews, STATGROUP_Grass, UNREALGRASS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Culling Full Views"), STAT_GrassCullingFullViews, STATGROUP_Grass, UNREALGRASS_API);
@@ -8,6 +8,17 @@
 #include "ShaderParameters.h"
 #include "RenderResource.h"
 #include "RHIResources.h"
+#include "GrassInstancePacking.h"
+
+/**
+ * 某个视图自己的剔除输出 (FMeshBatchElement::UserData，每视图剔除的次要视图使用)
+ * 代替 Vertex Factory 上的可见列表：可见索引列表模式下替换可见索引 SRV，否则替换实例 SRV (可见实例拷贝)
+ */
+struct FGrassVisibleListBinding
+{
+    FRHIShaderResourceView* SRV = nullptr;
+    uint32 BaseOffset = 0;
+};
 
 /**
  * 草地 Vertex Factory
@@ -20,11 +31,21 @@ class FGrassVertexFactory : public FLocalVertexFactory
 public:
     FGrassVertexFactory(ERHIFeatureLevel::Type InFeatureLevel, const char* InDebugName);
 
-    // 设置实例位置缓冲区 SRV 和实例数量
-    void SetInstancePositionSRV(FRHIShaderResourceView* InSRV, uint32 InNumInstances);
-    
-    // 设置草叶数据缓冲区 SRV
-    void SetGrassDataSRV(FRHIShaderResourceView* InData0SRV, FRHIShaderResourceView* InData1SRV, FRHIShaderResourceView* InData2SRV);
+    // 设置实例缓冲区 SRV (16 字节压缩格式，见 GrassInstancePacking.ush)、实例数量和区间在 Buffer 池页中的起始元素
+    void SetInstanceSRV(FRHIShaderResourceView* InSRV, uint32 InNumInstances, uint32 InBaseOffset = 0);
+
+    // 设置剔除输出的可见实例索引列表 (uint)，为空时 InstanceID 直接索引实例缓冲区
+    void SetVisibleIndexSRV(FRHIShaderResourceView* InSRV, uint32 InBaseOffset = 0) { VisibleIndexSRV = InSRV; VisibleIndexBaseOffset = InBaseOffset; }
+    FRHIShaderResourceView* GetVisibleIndexSRV() const { return VisibleIndexSRV; }
+    uint32 GetVisibleIndexBaseOffset() const { return VisibleIndexBaseOffset; }
+
+    // 设置实例位置的量化范围 (与实例 Buffer 一起生成)
+    void SetQuantization(const FGrassInstanceQuantization& InQuantization) { Quantization = InQuantization; }
+    const FGrassInstanceQuantization& GetQuantization() const { return Quantization; }
+
+    // 设置草叶收尖程度 (全局参数，不写入实例数据)
+    void SetTaperAmount(float InAmount) { TaperAmount = InAmount; }
+    float GetTaperAmount() const { return TaperAmount; }
 
     // 设置 LOD 级别 (0 = 高质量, 1 = 简化版)
     void SetLODLevel(uint32 InLODLevel) { LODLevel = InLODLevel; }
@@ -70,21 +91,21 @@ public:
     void SetLocalWindRotateAmount(float InAmount) { LocalWindRotateAmount = InAmount; }
     float GetLocalWindRotateAmount() const { return LocalWindRotateAmount; }
 
-    FRHIShaderResourceView* GetInstancePositionSRV() const { return InstancePositionSRV; }
-    FRHIShaderResourceView* GetGrassData0SRV() const { return GrassData0SRV; }
-    FRHIShaderResourceView* GetGrassData1SRV() const { return GrassData1SRV; }
-    FRHIShaderResourceView* GetGrassData2SRV() const { return GrassData2SRV; }
+    FRHIShaderResourceView* GetInstanceSRV() const { return InstanceSRV; }
+    uint32 GetInstanceBaseOffset() const { return InstanceBaseOffset; }
     uint32 GetNumInstances() const { return NumInstances; }
 
     static bool ShouldCompilePermutation(const FVertexFactoryShaderPermutationParameters& Parameters);
     static void ModifyCompilationEnvironment(const FVertexFactoryShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment);
 
 private:
-    FRHIShaderResourceView* InstancePositionSRV = nullptr;
-    FRHIShaderResourceView* GrassData0SRV = nullptr;  // Height, Width, Tilt, Bend
-    FRHIShaderResourceView* GrassData1SRV = nullptr;  // TaperAmount, FacingDir.x, FacingDir.y, P1Offset
-    FRHIShaderResourceView* GrassData2SRV = nullptr;  // P2Offset
+    FRHIShaderResourceView* InstanceSRV = nullptr;
+    FRHIShaderResourceView* VisibleIndexSRV = nullptr;
+    uint32 InstanceBaseOffset = 0;
+    uint32 VisibleIndexBaseOffset = 0;
+    FGrassInstanceQuantization Quantization;
     uint32 NumInstances = 0;
+    float TaperAmount = 0.8f;  // 草叶收尖程度
     uint32 LODLevel = 0;  // LOD 级别: 0 = LOD0 高质量, 1 = LOD1 简化版
     float CurvedNormalAmount = 0.5f;  // 弯曲法线程度
     float ViewRotationAmount = 0.3f;  // 视角依赖旋转强度 (0 = 无, 1 = 最大)
@@ -122,10 +143,14 @@ public:
         FVertexInputStreamArray& VertexStreams
     ) const;
 
-    LAYOUT_FIELD(FShaderResourceParameter, InstancePositionBuffer);
-    LAYOUT_FIELD(FShaderResourceParameter, GrassData0Buffer);  // Height, Width, Tilt, Bend
-    LAYOUT_FIELD(FShaderResourceParameter, GrassData1Buffer);  // TaperAmount, FacingDir.x, FacingDir.y, P1Offset
-    LAYOUT_FIELD(FShaderResourceParameter, GrassData2Buffer);  // P2Offset
+    LAYOUT_FIELD(FShaderResourceParameter, InstanceBuffer);  // 16 字节压缩实例
+    LAYOUT_FIELD(FShaderResourceParameter, VisibleIndexBuffer);  // 可见实例索引列表
+    LAYOUT_FIELD(FShaderParameter, GrassUseVisibleIndices);
+    LAYOUT_FIELD(FShaderParameter, GrassInstanceBaseOffset);  // 区间在 Buffer 池页中的起始元素
+    LAYOUT_FIELD(FShaderParameter, GrassVisibleIndexBaseOffset);
+    LAYOUT_FIELD(FShaderParameter, GrassQuantizationMin);  // 位置量化范围
+    LAYOUT_FIELD(FShaderParameter, GrassQuantizationSize);
+    LAYOUT_FIELD(FShaderParameter, GrassTaperAmount);  // 草叶收尖程度
     LAYOUT_FIELD(FShaderParameter, GrassLODLevel);  // LOD 级别参数
     LAYOUT_FIELD(FShaderParameter, GrassCurvedNormalAmount);  // 弯曲法线程度参数
     LAYOUT_FIELD(FShaderParameter, GrassViewRotationAmount);  // 视角依赖旋转强度参数
@@ -0,0 +1,124 @@
+// GrassViewCulling.h
+// 每视图剔除：分屏的其余视图、场景捕获、编辑器的多个视口各自剔除，各自有可见列表和 Indirect Args
+// 主视图 (本帧第一个非捕获视图) 仍使用 FGrassSceneProxy::InstanceBuffers 的剔除输出 (Hi-Z / 两阶段遮挡剔除)；
+// 其余视图从代理的视图池中取一个槽位，槽位按视图状态 (FSceneViewStateInterface::GetViewKey) 跨帧保留，
+// 没有视图状态的视图 (一次性捕获) 只在本帧占用槽位；池满时该视图回退到主视图的剔除输出
+// 相机、组件变换和剔除设置都没有变化时沿用上一次的剔除输出 (FGrassCullingHistory，测试见自动化测试 UnrealGrass.CullingReuse)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrassInstanceBuffers.h"
+#include "GrassVertexFactory.h"
+
+class FSceneView;
+class FRHICommandListImmediate;
+
+/** 次要视图的剔除预算 (场景捕获 / 反射捕获使用更少的草) */
+struct FGrassViewCullingBudget
+{
+    float MaxDistanceScale = 1.0f;      // MaxVisibleDistance 的缩放
+    float LOD0DistanceScale = 1.0f;     // LOD0Distance 的缩放 (更早切换到 LOD 1)
+    float DensityScale = 1.0f;          // 保留的实例比例
+};
+
+/** 一个视图的剔除签名：剔除结果只取决于这些输入 (实例数据不变时) */
+struct FGrassCullingSignature
+{
+    FMatrix ViewProjection = FMatrix::Identity;         // 不含 TAA 抖动 (抖动每帧变化，剔除结果不受影响)
+    FMatrix StereoViewProjection = FMatrix::Identity;   // 立体并集剔除时另一只眼睛
+    FMatrix LocalToWorld = FMatrix::Identity;
+    FVector ViewOrigin = FVector::ZeroVector;
+    const void* OutputKey = nullptr;                    // 剔除输出的 Indirect Args (Buffer 重新分配后不同)
+    const void* InstanceKey = nullptr;                  // 实例数据 (重新生成后不同)
+    uint32 SettingsHash = 0;                            // 遮挡剔除阶段、预算、LOD 等设置
+
+    bool Matches(const FGrassCullingSignature& Other, double MatrixTolerance, double PositionTolerance) const;
+};
+
+/**
+ * 剔除结果的时间复用 (菜单、拍照模式、过场停顿、静止的编辑器视口)：签名与上一帧一致时沿用上一次的可见列表和 Indirect Args
+ * 使用 Hi-Z 时相机静止后先完整剔除一次 (这时上一帧的 Hi-Z 才来自相同的相机)，之后开始复用；
+ * 复用超过 MaxReuseFrames 帧时完整剔除一次 (场景中移动的遮挡物)
+ */
+struct UNREALGRASS_API FGrassCullingHistory
+{
+    FGrassCullingSignature Signature;   // 最近一次完整剔除的签名
+    uint32 LastCullFrame = 0;           // 最近一次完整剔除的帧号
+    bool bValid = false;
+    bool bSettled = false;              // 最近一次完整剔除时相机已经静止
+
+    /** 本帧是否沿用上次的剔除输出；不沿用时记录本帧的签名 (调用方执行完整剔除)。MaxReuseFrames 为 0 时不限制 */
+    bool ShouldReuse(const FGrassCullingSignature& Current, bool bUsesHiZ, uint32 FrameNumber, uint32 MaxReuseFrames, double MatrixTolerance, double PositionTolerance);
+
+    /** 剔除输出被其他路径改写或不再有效 (下一次必须完整剔除) */
+    void Invalidate() { bValid = false; bSettled = false; }
+};
+
+/**
+ * 按 Shared 创建一份剔除输出：实例 / 剔除块与 Shared 共享，可见列表从 Buffer 池分配 (实例数量大小)，Indirect Args 单独创建，不共享可见位
+ * bWithLOD1 且 Shared 有 LOD 1 输出时同时创建 LOD 1 的可见列表和 Indirect Args (视图槽位和阴影级联共用)
+ */
+UNREALGRASS_API void CreateGrassCullingOutput(FRHICommandListImmediate& RHICmdList, const FGrassInstanceBuffers& Shared, bool bWithLOD1, const TCHAR* DebugName, FGrassInstanceBuffers& OutBuffers);
+
+/** CreateGrassCullingOutput 创建的可见列表和 Indirect Args 的字节数 */
+UNREALGRASS_API uint64 GetGrassCullingOutputBytes(const FGrassInstanceBuffers& Buffers);
+
+/** 一个视图的剔除输出 */
+struct FGrassViewCullingSlot
+{
+    uint64 ViewKey = 0;
+    bool bTransientKey = false;         // 没有视图状态，键只在本帧有效
+    uint32 LastUsedFrame = 0;           // 最近一次剔除的帧号 (Acquire 时更新)
+
+    // 实例 / 剔除块与代理共享，可见列表和 Indirect Args 是这个视图自己的 (两阶段遮挡剔除的可见位不共享)
+    FGrassInstanceBuffers Buffers;
+
+    // 绘制时通过 FMeshBatchElement::UserData 传给 Vertex Factory
+    FGrassVisibleListBinding BindingLOD0;
+    FGrassVisibleListBinding BindingLOD1;
+
+    // 上一次剔除的签名 (槽位换给其他视图或重新分配时失效)
+    FGrassCullingHistory History;
+
+    uint64 GetAllocatedBytes() const { return GetGrassCullingOutputBytes(Buffers); }
+};
+
+class UNREALGRASS_API FGrassViewCullingPool
+{
+public:
+    /** 超过这么多帧没有剔除的槽位被释放 */
+    static constexpr uint32 MaxIdleFrames = 60;
+
+    FGrassViewCullingPool() = default;
+    ~FGrassViewCullingPool();
+
+    FGrassViewCullingPool(const FGrassViewCullingPool&) = delete;
+    FGrassViewCullingPool& operator=(const FGrassViewCullingPool&) = delete;
+
+    /** 视图状态的键 (有视图状态时跨帧不变)，没有视图状态时使用视图指针 (bOutTransient) */
+    static uint64 GetViewKey(const FSceneView& View, bool& bOutTransient);
+
+    /**
+     * 取视图的槽位 (渲染线程)：已有的直接返回；否则复用本帧没有使用的临时或空闲槽位，或在 MaxSlots 之内新建
+     * 可见列表按 Shared 的实例数量从 Buffer 池分配；池满时返回 nullptr
+     */
+    FGrassViewCullingSlot* Acquire(FRHICommandListImmediate& RHICmdList, const FSceneView& View, const FGrassInstanceBuffers& Shared, int32 MaxSlots, uint32 FrameNumber);
+
+    /** 本帧已经剔除过的视图槽位 (GetDynamicMeshElements 选择绘制的可见列表)，没有时返回 nullptr */
+    const FGrassViewCullingSlot* Find(const FSceneView& View, uint32 FrameNumber) const;
+
+    /** 释放所有槽位 (实例 Buffer 交换时，可见列表的大小随之改变) */
+    void Reset();
+
+    int32 Num() const { return Slots.Num(); }
+    uint64 GetAllocatedBytes() const { return AllocatedBytes; }
+
+private:
+    void InitSlotBuffers(FRHICommandListImmediate& RHICmdList, FGrassViewCullingSlot& Slot, const FGrassInstanceBuffers& Shared);
+    void ReleaseSlot(int32 Index);
+
+    // 槽位地址在绘制期间被 FMeshBatchElement::UserData 引用，单独分配
+    TArray<TUniquePtr<FGrassViewCullingSlot>> Slots;
+    uint64 AllocatedBytes = 0;
+};